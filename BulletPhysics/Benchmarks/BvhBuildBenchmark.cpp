@@ -0,0 +1,159 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///BvhBuildBenchmark builds the quantized BVH of a triangle mesh with btQuantizedBvh::BUILD_MEDIAN_SPLIT and with
+///btQuantizedBvh::BUILD_BINNED_SAH, then runs the same ray and AABB queries on both trees. It prints the build and
+///query times, and returns 1 if the two trees report different triangles.
+///Usage: BvhBuildBenchmark [terrainResolution] [numScatteredTriangles]
+
+#include "btBulletCollisionCommon.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_QUERIES 10000
+
+///counts the reported triangles and sums their indices, to compare the results of two trees
+struct TriangleCounter : public btTriangleCallback
+{
+	int				m_numTriangles;
+	unsigned int	m_indexSum;
+
+	TriangleCounter()
+		:m_numTriangles(0),
+		m_indexSum(0)
+	{
+	}
+
+	virtual void processTriangle(btVector3* triangle, int partId, int triangleIndex)
+	{
+		(void)triangle;
+		(void)partId;
+		m_numTriangles++;
+		m_indexSum += (unsigned int)triangleIndex;
+	}
+};
+
+static btScalar	randomScalar(btScalar minValue, btScalar maxValue)
+{
+	return minValue + (maxValue - minValue) * btScalar(rand()) / btScalar(RAND_MAX);
+}
+
+///a bumpy terrain with clusters of small triangles scattered above it, so the leaves are not evenly spread
+static void	createMesh(int terrainResolution, int numScatteredTriangles, btAlignedObjectArray<btVector3>& vertices, btAlignedObjectArray<int>& indices)
+{
+	const btScalar size = btScalar(100.);
+	for (int i = 0; i < terrainResolution; i++)
+	{
+		for (int j = 0; j < terrainResolution; j++)
+		{
+			btScalar x = size * btScalar(i) / btScalar(terrainResolution - 1) - size * btScalar(0.5);
+			btScalar z = size * btScalar(j) / btScalar(terrainResolution - 1) - size * btScalar(0.5);
+			btScalar y = btScalar(4.) * btSin(x * btScalar(0.15)) * btCos(z * btScalar(0.1)) + randomScalar(btScalar(0.), btScalar(0.3));
+			vertices.push_back(btVector3(x, y, z));
+		}
+	}
+	for (int i = 0; i < terrainResolution - 1; i++)
+	{
+		for (int j = 0; j < terrainResolution - 1; j++)
+		{
+			int v = i * terrainResolution + j;
+			indices.push_back(v);
+			indices.push_back(v + 1);
+			indices.push_back(v + terrainResolution);
+			indices.push_back(v + 1);
+			indices.push_back(v + terrainResolution + 1);
+			indices.push_back(v + terrainResolution);
+		}
+	}
+
+	const int numClusters = 64;
+	btVector3 clusterCenters[numClusters];
+	for (int i = 0; i < numClusters; i++)
+	{
+		clusterCenters[i] = btVector3(randomScalar(-size * btScalar(0.5), size * btScalar(0.5)), randomScalar(btScalar(5.), btScalar(30.)),
+			randomScalar(-size * btScalar(0.5), size * btScalar(0.5)));
+	}
+	for (int i = 0; i < numScatteredTriangles; i++)
+	{
+		btVector3 center = clusterCenters[rand() % numClusters];
+		center += btVector3(randomScalar(-3, 3), randomScalar(-3, 3), randomScalar(-3, 3));
+		for (int v = 0; v < 3; v++)
+		{
+			indices.push_back(vertices.size());
+			vertices.push_back(center + btVector3(randomScalar(btScalar(-0.2), btScalar(0.2)), randomScalar(btScalar(-0.2), btScalar(0.2)),
+				randomScalar(btScalar(-0.2), btScalar(0.2))));
+		}
+	}
+}
+
+///builds the tree in the given mode and runs the queries on it, the query results go to counter
+static void	runBvh(btQuantizedBvh::btBuildMode buildMode, btStridingMeshInterface* meshInterface, TriangleCounter& counter)
+{
+	btQuantizedBvh::setBuildMode(buildMode);
+
+	btClock clock;
+	btBvhTriangleMeshShape* shape = new btBvhTriangleMeshShape(meshInterface, true);
+	unsigned long int buildTime = clock.getTimeMicroseconds();
+
+	//the same random queries for both trees
+	srand(1);
+	clock.reset();
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		btVector3 from(randomScalar(-50, 50), btScalar(40.), randomScalar(-50, 50));
+		btVector3 to(randomScalar(-50, 50), btScalar(-10.), randomScalar(-50, 50));
+		shape->performRaycast(&counter, from, to);
+
+		btVector3 center(randomScalar(-50, 50), randomScalar(-5, 30), randomScalar(-50, 50));
+		btVector3 extents(randomScalar(btScalar(0.5), btScalar(3.)), randomScalar(btScalar(0.5), btScalar(3.)), randomScalar(btScalar(0.5), btScalar(3.)));
+		shape->processAllTriangles(&counter, center - extents, center + extents);
+	}
+	unsigned long int queryTime = clock.getTimeMicroseconds();
+
+	printf("%s: build %.1f ms, queries %.1f ms, %d triangles reported\n",
+		buildMode == btQuantizedBvh::BUILD_BINNED_SAH ? "binned SAH" : "median split",
+		buildTime * 0.001, queryTime * 0.001, counter.m_numTriangles);
+	delete shape;
+}
+
+int main(int argc, char** argv)
+{
+	int terrainResolution = argc > 1 ? atoi(argv[1]) : 256;
+	int numScatteredTriangles = argc > 2 ? atoi(argv[2]) : 100000;
+
+	btAlignedObjectArray<btVector3> vertices;
+	btAlignedObjectArray<int> indices;
+	srand(0);
+	createMesh(terrainResolution, numScatteredTriangles, vertices, indices);
+	printf("%d triangles, %d queries\n", indices.size() / 3, NUM_QUERIES);
+
+	btTriangleIndexVertexArray meshInterface(indices.size() / 3, &indices[0], 3 * sizeof(int),
+		vertices.size(), (btScalar*)&vertices[0].x(), sizeof(btVector3));
+
+	TriangleCounter medianCounter;
+	runBvh(btQuantizedBvh::BUILD_MEDIAN_SPLIT, &meshInterface, medianCounter);
+
+	TriangleCounter sahCounter;
+	runBvh(btQuantizedBvh::BUILD_BINNED_SAH, &meshInterface, sahCounter);
+
+	btQuantizedBvh::setBuildMode(btQuantizedBvh::BUILD_MEDIAN_SPLIT);
+
+	if (medianCounter.m_numTriangles != sahCounter.m_numTriangles || medianCounter.m_indexSum != sahCounter.m_indexSum)
+	{
+		printf("the trees reported different triangles\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,12 @@
+# Times the median split and the binned SAH builders of btQuantizedBvh, and queries on the built trees.
+# Build with qmake && make, run as BvhBuildBenchmark [terrainResolution] [numScatteredTriangles].
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+TARGET = BvhBuildBenchmark
+
+include(../BulletPhysics.pri)
+
+SOURCES += BvhBuildBenchmark.cpp
+
+unix:LIBS += -lpthread
@@ -0,0 +1,121 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///SoftBodyBenchmark steps the same cloth scene with btDefaultSoftBodySolver and with btCPUSoftBodySolver,
+///first on the calling thread and then with a btThreadSupportTaskScheduler installed, and prints the time each run took.
+///Usage: SoftBodyBenchmark [numThreads] [clothResolution] [numCloths]
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+#include "BulletSoftBody/btSoftBodyHelpers.h"
+#include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
+#include "BulletSoftBody/btDefaultSoftBodySolver.h"
+#include "BulletMultiThreaded/GpuSoftBodySolvers/CPU/btSoftBodySolver_CPU.h"
+#include "BulletMultiThreaded/btThreadSupportTaskScheduler.h"
+#ifdef _WIN32
+#include "BulletMultiThreaded/Win32ThreadSupport.h"
+#endif
+#include "BulletMultiThreaded/PosixThreadSupport.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_STEPS 100
+
+///steps the cloth scene with the given solver and returns the time in milliseconds
+static unsigned long int	runClothScene(btSoftBodySolver* solver, int clothResolution, int numCloths)
+{
+	btSoftBodyRigidBodyCollisionConfiguration collisionConfiguration;
+	btCollisionDispatcher dispatcher(&collisionConfiguration);
+	btDbvtBroadphase broadphase;
+	btSequentialImpulseConstraintSolver constraintSolver;
+	btSoftRigidDynamicsWorld* world = new btSoftRigidDynamicsWorld(&dispatcher, &broadphase, &constraintSolver, &collisionConfiguration, solver);
+	world->setGravity(btVector3(0, -10, 0));
+
+	btSoftBodyWorldInfo& worldInfo = world->getWorldInfo();
+	worldInfo.m_gravity = btVector3(0, -10, 0);
+	worldInfo.m_sparsesdf.Initialize();
+
+	btAlignedObjectArray<btSoftBody*> cloths;
+	for (int i = 0; i < numCloths; i++)
+	{
+		btScalar z = btScalar(i * 12);
+		//two corners are fixed
+		btSoftBody* cloth = btSoftBodyHelpers::CreatePatch(worldInfo, btVector3(-5, 10, z - 5), btVector3(5, 10, z - 5),
+			btVector3(-5, 10, z + 5), btVector3(5, 10, z + 5), clothResolution, clothResolution, 1 + 2, true);
+		cloth->m_cfg.piterations = 10;
+		cloth->m_cfg.viterations = 10;
+		cloth->setTotalMass(1);
+		world->addSoftBody(cloth);
+		cloths.push_back(cloth);
+	}
+
+	btClock clock;
+	for (int i = 0; i < NUM_STEPS; i++)
+	{
+		world->stepSimulation(btScalar(1.) / btScalar(60.), 1, btScalar(1.) / btScalar(60.));
+	}
+	solver->copyBackToSoftBodies();
+	unsigned long int time = clock.getTimeMilliseconds();
+
+	for (int i = 0; i < cloths.size(); i++)
+	{
+		world->removeSoftBody(cloths[i]);
+		delete cloths[i];
+	}
+	delete world;
+	return time;
+}
+
+int main(int argc, char** argv)
+{
+	int numThreads = argc > 1 ? atoi(argv[1]) : 4;
+	int clothResolution = argc > 2 ? atoi(argv[2]) : 64;
+	int numCloths = argc > 3 ? atoi(argv[3]) : 4;
+	printf("%d cloths of %dx%d nodes, %d steps\n", numCloths, clothResolution, clothResolution, NUM_STEPS);
+
+	btDefaultSoftBodySolver defaultSolver;
+	printf("btDefaultSoftBodySolver: %lu ms\n", runClothScene(&defaultSolver, clothResolution, numCloths));
+
+	btCPUSoftBodySolver cpuSolver;
+	printf("btCPUSoftBodySolver, 1 thread: %lu ms\n", runClothScene(&cpuSolver, clothResolution, numCloths));
+
+	if (numThreads > 1)
+	{
+		//the calling thread works on the batches too
+		int numWorkerThreads = numThreads - 1;
+		btThreadSupportInterface* threadSupport = 0;
+#if defined(_WIN32)
+		Win32ThreadSupport::Win32ThreadConstructionInfo threadConstructionInfo("SoftBodyBenchmark", processParallelForTask, createParallelForLocalStoreMemory, numWorkerThreads);
+		threadSupport = new Win32ThreadSupport(threadConstructionInfo);
+#elif defined(USE_PTHREADS)
+		PosixThreadSupport::ThreadConstructionInfo threadConstructionInfo("SoftBodyBenchmark", processParallelForTask, createParallelForLocalStoreMemory, numWorkerThreads);
+		threadSupport = new PosixThreadSupport(threadConstructionInfo);
+#endif
+		if (threadSupport)
+		{
+			btThreadSupportTaskScheduler* scheduler = new btThreadSupportTaskScheduler(threadSupport);
+			btSetTaskScheduler(scheduler);
+
+			btCPUSoftBodySolver threadedSolver;
+			printf("btCPUSoftBodySolver, %d threads: %lu ms\n", btGetTaskSchedulerNumThreads(),
+				runClothScene(&threadedSolver, clothResolution, numCloths));
+
+			btSetTaskScheduler(0);
+			delete scheduler;
+			delete threadSupport;
+		}
+	}
+	return 0;
+}
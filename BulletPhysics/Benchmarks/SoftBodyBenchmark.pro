@@ -0,0 +1,12 @@
+# Times btCPUSoftBodySolver against btDefaultSoftBodySolver on a cloth scene.
+# Build with qmake && make, run as SoftBodyBenchmark [numThreads] [clothResolution] [numCloths].
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+TARGET = SoftBodyBenchmark
+
+include(../BulletPhysics.pri)
+
+SOURCES += SoftBodyBenchmark.cpp
+
+unix:LIBS += -lpthread
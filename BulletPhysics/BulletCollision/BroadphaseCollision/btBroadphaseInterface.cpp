@@ -0,0 +1,62 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2006 Erwin Coumans  http://continuousphysics.com/Bullet/
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose, 
+including commercial applications, and to alter it and redistribute it freely, 
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btBroadphaseInterface.h"
+
+///forwards the proxies of a single ray query to one lane of a packet
+struct	btRayPacketLaneCallback : public btBroadphaseRayCallback
+{
+	btBroadphaseRayPacketCallback&	m_packetCallback;
+	int		m_lane;
+
+	btRayPacketLaneCallback(btBroadphaseRayPacketCallback& packetCallback, int lane)
+		:m_packetCallback(packetCallback),
+		m_lane(lane)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			m_rayDirectionInverse[k] = packetCallback.m_directionInverse[k][lane];
+			m_signs[k] = m_rayDirectionInverse[k] < btScalar(0.0);
+		}
+		m_lambda_max = packetCallback.m_lambdaMax[lane];
+	}
+
+	virtual bool	process(const btBroadphaseProxy* proxy)
+	{
+		int laneMask = 1 << m_lane;
+		//not every broadphase culls with the ray, do it here
+		if (m_packetCallback.testAabb(proxy->m_aabbMin, proxy->m_aabbMax) & laneMask)
+		{
+			m_packetCallback.process(proxy, laneMask);
+			m_lambda_max = m_packetCallback.m_lambdaMax[m_lane];
+		}
+		return true;
+	}
+};
+
+void	btBroadphaseInterface::rayTestPacket(btBroadphaseRayPacketCallback& packetCallback)
+{
+	for (int lane = 0; lane < BT_RAY_PACKET_SIZE; lane++)
+	{
+		if (packetCallback.m_activeMask & (1 << lane))
+		{
+			btVector3 rayFrom(packetCallback.m_origin[0][lane], packetCallback.m_origin[1][lane], packetCallback.m_origin[2][lane]);
+			btVector3 direction(packetCallback.m_direction[0][lane], packetCallback.m_direction[1][lane], packetCallback.m_direction[2][lane]);
+			btVector3 rayTo = rayFrom + direction * packetCallback.m_lambdaMax[lane];
+			btRayPacketLaneCallback laneCallback(packetCallback, lane);
+			rayTest(rayFrom, rayTo, laneCallback);
+		}
+	}
+}
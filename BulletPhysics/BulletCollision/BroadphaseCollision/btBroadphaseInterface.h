@@ -45,6 +45,69 @@ struct	btBroadphaseRayCallback : public btBroadphaseAabbCallback
 
 #include "LinearMath/btVector3.h"
 
+///number of rays in a btBroadphaseRayPacketCallback
+#define BT_RAY_PACKET_SIZE 4
+
+///btBroadphaseRayPacketCallback traces BT_RAY_PACKET_SIZE rays together, stored in structure of arrays layout.
+///Lane i starts at m_origin[.][i] and goes along the normalized m_direction[.][i] up to distance m_lambdaMax[i].
+///process is called for each proxy whose AABB is hit by at least one active lane. It may shorten m_lambdaMax
+///of the lanes that hit something, so that the rest of the traversal culls more.
+struct	btBroadphaseRayPacketCallback
+{
+	btScalar	m_origin[3][BT_RAY_PACKET_SIZE];
+	btScalar	m_direction[3][BT_RAY_PACKET_SIZE];
+	btScalar	m_directionInverse[3][BT_RAY_PACKET_SIZE];
+	btScalar	m_lambdaMax[BT_RAY_PACKET_SIZE];
+	///bit i is set when lane i holds a ray
+	int			m_activeMask;
+
+	virtual ~btBroadphaseRayPacketCallback() {}
+
+	virtual void	process(const btBroadphaseProxy* proxy, int laneMask) = 0;
+
+	///sets lane i, the direction must be normalized
+	void	setRay(int lane, const btVector3& origin, const btVector3& direction, btScalar lambdaMax)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			m_origin[k][lane] = origin[k];
+			m_direction[k][lane] = direction[k];
+			m_directionInverse[k][lane] = direction[k] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[k];
+		}
+		m_lambdaMax[lane] = lambdaMax;
+		m_activeMask |= 1 << lane;
+	}
+
+	///slab test of all lanes against an AABB, returns the mask of the active lanes that hit it
+	int		testAabb(const btVector3& aabbMin, const btVector3& aabbMax) const
+	{
+		btScalar tNear[BT_RAY_PACKET_SIZE];
+		btScalar tFar[BT_RAY_PACKET_SIZE];
+		int i;
+		for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+		{
+			tNear[i] = btScalar(0.0);
+			tFar[i] = m_lambdaMax[i];
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+			{
+				btScalar t0 = (aabbMin[k] - m_origin[k][i]) * m_directionInverse[k][i];
+				btScalar t1 = (aabbMax[k] - m_origin[k][i]) * m_directionInverse[k][i];
+				tNear[i] = btMax(tNear[i], btMin(t0, t1));
+				tFar[i] = btMin(tFar[i], btMax(t0, t1));
+			}
+		}
+		int mask = 0;
+		for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+		{
+			mask |= (tNear[i] <= tFar[i]) << i;
+		}
+		return mask & m_activeMask;
+	}
+};
+
 ///The btBroadphaseInterface class provides an interface to detect aabb-overlapping object pairs.
 ///Some implementations for this broadphase interface include btAxisSweep3, bt32BitAxisSweep3 and btDbvtBroadphase.
 ///The actual overlapping pair management, storage, adding and removing of pairs is dealt by the btOverlappingPairCache class.
@@ -62,6 +125,9 @@ public:
 
 	virtual void	aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback) = 0;
 
+	///traces a packet of rays, the default implementation traces the active lanes one at a time with rayTest
+	virtual void	rayTestPacket(btBroadphaseRayPacketCallback& packetCallback);
+
 	///calculateOverlappingPairs is optional: incremental algorithms (sweep and prune) might do it during the set aabb
 	virtual void	calculateOverlappingPairs(btDispatcher* dispatcher)=0;
 
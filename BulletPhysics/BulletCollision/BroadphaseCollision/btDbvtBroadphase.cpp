@@ -251,6 +251,58 @@ void	btDbvtBroadphase::rayTest(const btVector3& rayFrom,const btVector3& rayTo,
 }
 
 
+static void	rayTestPacketTree(const btDbvtNode* root, btBroadphaseRayPacketCallback& packetCallback)
+{
+	const btDbvtNode*	stack[btDbvt::DOUBLE_STACKSIZE];
+	int depth = 1;
+	stack[0] = root;
+	while (depth)
+	{
+		const btDbvtNode* node = stack[--depth];
+		int laneMask = packetCallback.testAabb(node->volume.Mins(), node->volume.Maxs());
+		if (!laneMask)
+		{
+			continue;
+		}
+		if (node->isinternal())
+		{
+			if (depth + 2 > btDbvt::DOUBLE_STACKSIZE)
+			{
+				//very unbalanced tree, continue this subtree with a fresh stack
+				rayTestPacketTree(node->childs[0], packetCallback);
+				rayTestPacketTree(node->childs[1], packetCallback);
+				continue;
+			}
+			//visit the child that is nearer along the first hitting lane first, so that hits shorten the lanes early
+			int lane = 0;
+			while (!(laneMask & (1 << lane)))
+			{
+				lane++;
+			}
+			btVector3 direction(packetCallback.m_direction[0][lane], packetCallback.m_direction[1][lane], packetCallback.m_direction[2][lane]);
+			bool firstChildNearer = (node->childs[1]->volume.Center() - node->childs[0]->volume.Center()).dot(direction) > btScalar(0.0);
+			stack[depth++] = node->childs[firstChildNearer ? 1 : 0];
+			stack[depth++] = node->childs[firstChildNearer ? 0 : 1];
+		} else
+		{
+			packetCallback.process((btDbvtProxy*)node->data, laneMask);
+		}
+	}
+}
+
+void	btDbvtBroadphase::rayTestPacket(btBroadphaseRayPacketCallback& packetCallback)
+{
+	if (m_sets[0].m_root)
+	{
+		rayTestPacketTree(m_sets[0].m_root, packetCallback);
+	}
+	if (m_sets[1].m_root)
+	{
+		rayTestPacketTree(m_sets[1].m_root, packetCallback);
+	}
+}
+
+
 struct	BroadphaseAabbTester : btDbvt::ICollide
 {
         btBroadphaseAabbCallback& m_aabbCallback;
@@ -109,6 +109,8 @@ struct	btDbvtBroadphase : btBroadphaseInterface
 	virtual void					setAabb(btBroadphaseProxy* proxy,const btVector3& aabbMin,const btVector3& aabbMax,btDispatcher* dispatcher);
 	virtual void					rayTest(const btVector3& rayFrom,const btVector3& rayTo, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin=btVector3(0,0,0), const btVector3& aabbMax = btVector3(0,0,0));
 	virtual void					aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback);
+	///traverses both trees once for the whole packet, a node is skipped when none of the lanes hits it
+	virtual void					rayTestPacket(btBroadphaseRayPacketCallback& packetCallback);
 
 	virtual void					getAabb(btBroadphaseProxy* proxy,btVector3& aabbMin, btVector3& aabbMax ) const;
 	virtual	void					calculateOverlappingPairs(btDispatcher* dispatcher);
@@ -48,6 +48,7 @@ struct btDispatcherInfo
 		m_allowedCcdPenetration(btScalar(0.04)),
 		m_useConvexConservativeDistanceUtil(false),
 		m_convexConservativeDistanceThreshold(0.0f),
+		m_useSpeculativeContacts(false),
 		m_stackAllocator(0)
 	{
 
@@ -64,6 +65,10 @@ struct btDispatcherInfo
 	btScalar	m_allowedCcdPenetration;
 	bool		m_useConvexConservativeDistanceUtil;
 	btScalar	m_convexConservativeDistanceThreshold;
+	///box-box and convex-plane pairs also report separated contacts, up to the relative motion of the objects over the time step.
+	///the solver only lets such a contact push when the objects would otherwise close the gap, so fast bodies don't tunnel
+	///without a separate swept query. needs the swept aabbs of m_useContinuous to find the pairs in the broadphase
+	bool		m_useSpeculativeContacts;
 	btStackAlloc*	m_stackAllocator;
 };
 
@@ -18,9 +18,12 @@ subject to the following restrictions:
 #include "LinearMath/btAabbUtil2.h"
 #include "LinearMath/btIDebugDraw.h"
 #include "LinearMath/btSerializer.h"
+#include "LinearMath/btThreads.h"
 
 #define RAYAABB2
 
+btQuantizedBvh::btBuildMode	btQuantizedBvh::m_buildMode = btQuantizedBvh::BUILD_MEDIAN_SPLIT;
+
 btQuantizedBvh::btQuantizedBvh() : 
 					m_bulletVersion(BT_BULLET_VERSION),
 					m_useQuantization(false), 
@@ -52,9 +55,15 @@ void btQuantizedBvh::buildInternal()
 
 	}
 
-	m_curNodeIndex = 0;
+	if (m_buildMode == BUILD_BINNED_SAH)
+	{
+		buildTreeBinnedSah(numLeafNodes);
+	} else
+	{
+		m_curNodeIndex = 0;
 
-	buildTree(0,numLeafNodes);
+		buildTree(0,numLeafNodes);
+	}
 
 	///if the entire tree is small then subtree size, we need to create a header info for the tree
 	if(m_useQuantization && !m_SubtreeHeaders.size())
@@ -310,6 +319,285 @@ int	btQuantizedBvh::calcSplittingAxis(int startIndex,int endIndex)
 
 
 
+///leaf bounds copied out of the (quantized) leaf nodes, the builder partitions these in place
+struct btBvhSahLeaf
+{
+	btVector3	m_aabbMin;
+	btVector3	m_aabbMax;
+	btVector3	m_center;
+	int			m_leafIndex;
+};
+
+struct btBvhSahBuildContext
+{
+	btAlignedObjectArray<btBvhSahLeaf>	m_leaves;
+};
+
+static SIMD_FORCE_INLINE btScalar	btBvhHalfSurfaceArea(const btVector3& aabbMin, const btVector3& aabbMax)
+{
+	btVector3 extent = aabbMax - aabbMin;
+	return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+}
+
+struct btBvhSahBin
+{
+	btVector3	m_aabbMin;
+	btVector3	m_aabbMax;
+	int			m_count;
+};
+
+void	btQuantizedBvh::buildSahRange(btBvhSahBuildContext& context, int startIndex, int endIndex, int nodeIndex, btAlignedObjectArray<int>* deferredRanges, int deferLeafCount)
+{
+	btBvhSahLeaf* leaves = &context.m_leaves[0];
+
+	//explicit stack of (start, end, node index), SAH trees can be deeper than the median split ones
+	btAlignedObjectArray<int> stack;
+	stack.push_back(startIndex);
+	stack.push_back(endIndex);
+	stack.push_back(nodeIndex);
+
+	while (stack.size())
+	{
+		int curNodeIndex = stack[stack.size() - 1];
+		int curEndIndex = stack[stack.size() - 2];
+		int curStartIndex = stack[stack.size() - 3];
+		stack.resize(stack.size() - 3);
+
+		int numIndices = curEndIndex - curStartIndex;
+		btAssert(numIndices > 0);
+		if (numIndices == 1)
+		{
+			assignInternalNodeFromLeafNode(curNodeIndex, leaves[curStartIndex].m_leafIndex);
+			continue;
+		}
+
+		int i;
+		btVector3 aabbMin = leaves[curStartIndex].m_aabbMin;
+		btVector3 aabbMax = leaves[curStartIndex].m_aabbMax;
+		btVector3 centerMin = leaves[curStartIndex].m_center;
+		btVector3 centerMax = centerMin;
+		for (i = curStartIndex + 1; i < curEndIndex; i++)
+		{
+			aabbMin.setMin(leaves[i].m_aabbMin);
+			aabbMax.setMax(leaves[i].m_aabbMax);
+			centerMin.setMin(leaves[i].m_center);
+			centerMax.setMax(leaves[i].m_center);
+		}
+
+		//same bounds as merging all leaves with mergeInternalNodeAabb, the quantization rounds outwards
+		setInternalNodeAabbMin(curNodeIndex, aabbMin);
+		setInternalNodeAabbMax(curNodeIndex, aabbMax);
+		//a subtree with n leaves always has 2n-1 nodes, so the right child position is known before the left child is built
+		setInternalNodeEscapeIndex(curNodeIndex, 2 * numIndices - 1);
+
+		//the split is searched along the longest axis of the center bounds only, which is nearly as good as
+		//binning all three axes and a lot cheaper
+		btVector3 centerExtent = centerMax - centerMin;
+		int splitAxis = centerExtent.maxAxis();
+		btScalar binScale = btScalar(BT_BVH_SAH_BIN_COUNT) * (btScalar(1.) - SIMD_EPSILON) / centerExtent[splitAxis];
+		int splitBin = -1;
+		if (centerExtent[splitAxis] <= SIMD_EPSILON)
+		{
+			//all centers coincide, any split is as good as another
+		} else if (numIndices <= BT_BVH_SAH_MIN_BINNED_LEAVES)
+		{
+			//too few leaves for the binning to pay off, split in the middle
+			splitBin = BT_BVH_SAH_BIN_COUNT / 2 - 1;
+		} else
+		{
+			btBvhSahBin bins[BT_BVH_SAH_BIN_COUNT];
+			int b;
+			for (b = 0; b < BT_BVH_SAH_BIN_COUNT; b++)
+			{
+				bins[b].m_aabbMin = aabbMax;
+				bins[b].m_aabbMax = aabbMin;
+				bins[b].m_count = 0;
+			}
+			for (i = curStartIndex; i < curEndIndex; i++)
+			{
+				const btBvhSahLeaf& leaf = leaves[i];
+				btBvhSahBin& bin = bins[btMin(int((leaf.m_center[splitAxis] - centerMin[splitAxis]) * binScale), BT_BVH_SAH_BIN_COUNT - 1)];
+				bin.m_aabbMin.setMin(leaf.m_aabbMin);
+				bin.m_aabbMax.setMax(leaf.m_aabbMax);
+				bin.m_count++;
+			}
+
+			//sweep from the right to get the area and count right of each plane, then from the left to find the cheapest plane
+			btScalar rightArea[BT_BVH_SAH_BIN_COUNT];
+			int rightCount[BT_BVH_SAH_BIN_COUNT];
+			btVector3 sweepMin = aabbMax;
+			btVector3 sweepMax = aabbMin;
+			int count = 0;
+			for (b = BT_BVH_SAH_BIN_COUNT - 1; b > 0; b--)
+			{
+				sweepMin.setMin(bins[b].m_aabbMin);
+				sweepMax.setMax(bins[b].m_aabbMax);
+				count += bins[b].m_count;
+				rightArea[b - 1] = count ? btBvhHalfSurfaceArea(sweepMin, sweepMax) : btScalar(0.);
+				rightCount[b - 1] = count;
+			}
+			btScalar bestCost = SIMD_INFINITY;
+			sweepMin = aabbMax;
+			sweepMax = aabbMin;
+			count = 0;
+			for (b = 0; b < BT_BVH_SAH_BIN_COUNT - 1; b++)
+			{
+				sweepMin.setMin(bins[b].m_aabbMin);
+				sweepMax.setMax(bins[b].m_aabbMax);
+				count += bins[b].m_count;
+				if (!count || !rightCount[b])
+				{
+					continue;
+				}
+				btScalar cost = btBvhHalfSurfaceArea(sweepMin, sweepMax) * btScalar(count) + rightArea[b] * btScalar(rightCount[b]);
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					splitBin = b;
+				}
+			}
+		}
+
+		int splitIndex = curStartIndex;
+		if (splitBin >= 0)
+		{
+			int j = curEndIndex - 1;
+			while (splitIndex <= j)
+			{
+				if (btMin(int((leaves[splitIndex].m_center[splitAxis] - centerMin[splitAxis]) * binScale), BT_BVH_SAH_BIN_COUNT - 1) <= splitBin)
+				{
+					splitIndex++;
+				} else
+				{
+					btSwap(leaves[splitIndex], leaves[j]);
+					j--;
+				}
+			}
+		}
+		if (splitIndex == curStartIndex || splitIndex == curEndIndex)
+		{
+			splitIndex = curStartIndex + (numIndices >> 1);
+		}
+
+		int leftNodeIndex = curNodeIndex + 1;
+		int rightNodeIndex = leftNodeIndex + 2 * (splitIndex - curStartIndex) - 1;
+		//push the right child first, so the left one is built first
+		int ranges[2][3] = {{splitIndex, curEndIndex, rightNodeIndex}, {curStartIndex, splitIndex, leftNodeIndex}};
+		for (int child = 0; child < 2; child++)
+		{
+			btAlignedObjectArray<int>& target = (deferredRanges && ranges[child][1] - ranges[child][0] <= deferLeafCount) ? *deferredRanges : stack;
+			target.push_back(ranges[child][0]);
+			target.push_back(ranges[child][1]);
+			target.push_back(ranges[child][2]);
+		}
+	}
+}
+
+struct btBvhSahBuildBody : public btIParallelForBody
+{
+	btQuantizedBvh*			m_bvh;
+	btBvhSahBuildContext*	m_context;
+	const int*				m_ranges;
+
+	btBvhSahBuildBody(btQuantizedBvh* bvh, btBvhSahBuildContext* context, const int* ranges)
+		:m_bvh(bvh),
+		m_context(context),
+		m_ranges(ranges)
+	{
+	}
+
+	virtual void	forLoop(int iBegin, int iEnd) const;
+};
+
+void	btQuantizedBvh::buildTreeBinnedSah(int numLeafNodes)
+{
+	btAssert(numLeafNodes > 0);
+
+	btBvhSahBuildContext context;
+	context.m_leaves.resize(numLeafNodes);
+	for (int i = 0; i < numLeafNodes; i++)
+	{
+		btBvhSahLeaf& leaf = context.m_leaves[i];
+		leaf.m_aabbMin = getAabbMin(i);
+		leaf.m_aabbMax = getAabbMax(i);
+		leaf.m_center = btScalar(0.5) * (leaf.m_aabbMin + leaf.m_aabbMax);
+		leaf.m_leafIndex = i;
+	}
+
+	int numThreads = btGetTaskSchedulerNumThreads();
+	if (numThreads > 1 && numLeafNodes > BT_BVH_PARALLEL_MIN_LEAVES)
+	{
+		//build the top of the tree here, until the remaining subtrees are small enough to balance over the threads
+		int deferLeafCount = btMax(BT_BVH_PARALLEL_MIN_LEAVES, numLeafNodes / (numThreads * 4));
+		btAlignedObjectArray<int> deferredRanges;
+		buildSahRange(context, 0, numLeafNodes, 0, &deferredRanges, deferLeafCount);
+		if (deferredRanges.size())
+		{
+			btBvhSahBuildBody body(this, &context, &deferredRanges[0]);
+			btParallelFor(0, deferredRanges.size() / 3, 1, body);
+		}
+	} else
+	{
+		buildSahRange(context, 0, numLeafNodes, 0, 0, 0);
+	}
+
+	m_curNodeIndex = 2 * numLeafNodes - 1;
+	buildSubtreeHeaders();
+}
+
+void	btBvhSahBuildBody::forLoop(int iBegin, int iEnd) const
+{
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		const int* range = &m_ranges[i * 3];
+		m_bvh->buildSahRange(*m_context, range[0], range[1], range[2], 0, 0);
+	}
+}
+
+void	btQuantizedBvh::buildSubtreeHeaders()
+{
+	if (!m_useQuantization)
+	{
+		return;
+	}
+
+	//post-order walk, updateSubtreeHeaders runs when buildTree would have returned from a node.
+	//a negative entry is a node whose children are done
+	btAlignedObjectArray<int> stack;
+	stack.push_back(0);
+	while (stack.size())
+	{
+		int nodeIndex = stack[stack.size() - 1];
+		stack.pop_back();
+		if (nodeIndex < 0)
+		{
+			nodeIndex = ~nodeIndex;
+			int leftChildNodeIndex = nodeIndex + 1;
+			const btQuantizedBvhNode& leftChildNode = m_quantizedContiguousNodes[leftChildNodeIndex];
+			int rightChildNodeIndex = leftChildNodeIndex + (leftChildNode.isLeafNode() ? 1 : leftChildNode.getEscapeIndex());
+			int treeSizeInBytes = m_quantizedContiguousNodes[nodeIndex].getEscapeIndex() * static_cast<int>(sizeof(btQuantizedBvhNode));
+			if (treeSizeInBytes > MAX_SUBTREE_SIZE_IN_BYTES)
+			{
+				updateSubtreeHeaders(leftChildNodeIndex, rightChildNodeIndex);
+			}
+			continue;
+		}
+
+		const btQuantizedBvhNode& node = m_quantizedContiguousNodes[nodeIndex];
+		if (node.isLeafNode())
+		{
+			continue;
+		}
+		int leftChildNodeIndex = nodeIndex + 1;
+		const btQuantizedBvhNode& leftChildNode = m_quantizedContiguousNodes[leftChildNodeIndex];
+		int rightChildNodeIndex = leftChildNodeIndex + (leftChildNode.isLeafNode() ? 1 : leftChildNode.getEscapeIndex());
+		stack.push_back(~nodeIndex);
+		stack.push_back(rightChildNodeIndex);
+		stack.push_back(leftChildNodeIndex);
+	}
+}
+
+
 void	btQuantizedBvh::reportAabbOverlappingNodex(btNodeOverlapCallback* nodeCallback,const btVector3& aabbMin,const btVector3& aabbMax) const
 {
 	//either choose recursive traversal (walkTree) or stackless (walkStacklessTree)
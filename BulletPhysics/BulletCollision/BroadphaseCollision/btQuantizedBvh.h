@@ -49,6 +49,15 @@ class btSerializer;
 //Note: currently we have 16 bytes per quantized node
 #define MAX_SUBTREE_SIZE_IN_BYTES  2048
 
+///number of centroid bins per axis used by the binned SAH builder
+#define BT_BVH_SAH_BIN_COUNT 16
+
+///ranges with at most this many leaves are split in the middle of the longest axis instead of binned
+#define BT_BVH_SAH_MIN_BINNED_LEAVES 4
+
+///subtrees with fewer leaves than this are not split into separate parallel build tasks
+#define BT_BVH_PARALLEL_MIN_LEAVES 1024
+
 // 10 gives the potential for 1024 parts, with at most 2^21 (2097152) (minus one
 // actually) triangles each (since the sign bit is reserved
 #define MAX_NUM_PARTS_IN_BITS 10
@@ -165,6 +174,8 @@ typedef btAlignedObjectArray<btOptimizedBvhNode>	NodeArray;
 typedef btAlignedObjectArray<btQuantizedBvhNode>	QuantizedNodeArray;
 typedef btAlignedObjectArray<btBvhSubtreeInfo>		BvhSubtreeInfoArray;
 
+struct btBvhSahBuildContext;
+
 
 ///The btQuantizedBvh class stores an AABB tree that can be quickly traversed on CPU and Cell SPU.
 ///It is used by the btBvhTriangleMeshShape as midphase, and by the btMultiSapBroadphase.
@@ -179,8 +190,19 @@ public:
 		TRAVERSAL_RECURSIVE
 	};
 
+	enum btBuildMode
+	{
+		///recursive split at the mean of the centers along the axis of largest variance
+		BUILD_MEDIAN_SPLIT = 0,
+		///binned surface area heuristic, large subtrees are built in parallel through btParallelFor
+		BUILD_BINNED_SAH
+	};
+
 protected:
 
+	///build mode used by buildInternal and btOptimizedBvh::build, shared by all trees so the in-place serialized layout doesn't change
+	static btBuildMode	m_buildMode;
+
 
 	btVector3			m_bvhAabbMin;
 	btVector3			m_bvhAabbMax;
@@ -306,6 +328,18 @@ protected:
 	int	calcSplittingAxis(int startIndex,int endIndex);
 
 	int	sortAndCalcSplittingIndex(int startIndex,int endIndex,int splitAxis);
+
+	///builds the tree over the leaf nodes with the binned SAH builder, in the same node layout as buildTree
+	void	buildTreeBinnedSah(int numLeafNodes);
+
+	///builds the nodes of the leaves [startIndex,endIndex) of the build context, starting at nodeIndex.
+	///Subtrees of at most deferLeafCount leaves are appended to deferredRanges instead (start, end, node index)
+	void	buildSahRange(btBvhSahBuildContext& context, int startIndex, int endIndex, int nodeIndex, btAlignedObjectArray<int>* deferredRanges, int deferLeafCount);
+
+	///adds the subtree headers for a finished tree, in the same order buildTree adds them
+	void	buildSubtreeHeaders();
+
+	friend struct btBvhSahBuildBody;
 	
 	void	walkStacklessTree(btNodeOverlapCallback* nodeCallback,const btVector3& aabbMin,const btVector3& aabbMax) const;
 
@@ -341,6 +375,17 @@ public:
 	QuantizedNodeArray&	getLeafNodeArray() {			return	m_quantizedLeafNodes;	}
 	///buildInternal is expert use only: assumes that setQuantizationValues and LeafNodeArray are initialized
 	void	buildInternal();
+
+	///selects the tree builder, for all trees built afterwards. The default is BUILD_MEDIAN_SPLIT
+	static void	setBuildMode(btBuildMode buildMode)
+	{
+		m_buildMode = buildMode;
+	}
+
+	static btBuildMode	getBuildMode()
+	{
+		return m_buildMode;
+	}
 	///***************************************** expert/internal use only *************************
 
 	void	reportAabbOverlappingNodex(btNodeOverlapCallback* nodeCallback,const btVector3& aabbMin,const btVector3& aabbMax) const;
@@ -59,6 +59,7 @@ void btBoxBoxCollisionAlgorithm::processCollision (btCollisionObject* body0,btCo
 #ifndef USE_PERSISTENT_CONTACTS	
 	m_manifoldPtr->clearManifold();
 #endif //USE_PERSISTENT_CONTACTS
+	resultOut->updateSpeculativeDistance(dispatchInfo);
 
 	btDiscreteCollisionDetectorInterface::ClosestPointInput input;
 	input.m_maximumDistanceSquared = BT_LARGE_FLOAT;
@@ -66,6 +67,7 @@ void btBoxBoxCollisionAlgorithm::processCollision (btCollisionObject* body0,btCo
 	input.m_transformB = body1->getWorldTransform();
 
 	btBoxBoxDetector detector(box0,box1);
+	detector.m_maxSeparation = m_manifoldPtr->getSpeculativeDistance();
 	detector.getClosestPoints(input,*resultOut,dispatchInfo.m_debugDraw);
 
 #ifdef USE_PERSISTENT_CONTACTS
@@ -26,7 +26,8 @@ subject to the following restrictions:
 
 btBoxBoxDetector::btBoxBoxDetector(btBoxShape* box1,btBoxShape* box2)
 : m_box1(box1),
-m_box2(box2)
+m_box2(box2),
+m_maxSeparation(btScalar(0.))
 {
 
 }
@@ -258,12 +259,12 @@ int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
 	     const btVector3& side1, const btVector3& p2,
 	     const dMatrix3 R2, const btVector3& side2,
 	     btVector3& normal, btScalar *depth, int *return_code,
-		 int maxc, dContactGeom * /*contact*/, int /*skip*/,btDiscreteCollisionDetectorInterface::Result& output);
+		 int maxc, dContactGeom * /*contact*/, int /*skip*/,btScalar maxSeparation,btDiscreteCollisionDetectorInterface::Result& output);
 int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
 	     const btVector3& side1, const btVector3& p2,
 	     const dMatrix3 R2, const btVector3& side2,
 	     btVector3& normal, btScalar *depth, int *return_code,
-		 int maxc, dContactGeom * /*contact*/, int /*skip*/,btDiscreteCollisionDetectorInterface::Result& output)
+		 int maxc, dContactGeom * /*contact*/, int /*skip*/,btScalar maxSeparation,btDiscreteCollisionDetectorInterface::Result& output)
 {
   const btScalar fudge_factor = btScalar(1.05);
   btVector3 p,pp,normalC(0.f,0.f,0.f);
@@ -294,18 +295,20 @@ int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
   Q31 = btFabs(R31); Q32 = btFabs(R32); Q33 = btFabs(R33);
 
   // for all 15 possible separating axes:
-  //   * see if the axis separates the boxes. if so, return 0.
+  //   * see if the axis separates the boxes by more than maxSeparation. if
+  //     so, return 0.
   //   * find the depth of the penetration along the separating axis (s2)
   //   * if this is the largest depth so far, record it.
   // the normal vector will be set to the separating axis with the smallest
   // depth. note: normalR is set to point to a column of R1 or R2 if that is
   // the smallest depth normal so far. otherwise normalR is 0 and normalC is
   // set to a vector relative to body 1. invert_normal is 1 if the sign of
-  // the normal should be flipped.
+  // the normal should be flipped. a separation (s2 > 0) within maxSeparation
+  // is kept as a negative depth, which gives speculative contacts.
 
 #define TST(expr1,expr2,norm,cc) \
   s2 = btFabs(expr1) - (expr2); \
-  if (s2 > 0) return 0; \
+  if (s2 > maxSeparation) return 0; \
   if (s2 > s) { \
     s = s2; \
     normalR = norm; \
@@ -332,11 +335,11 @@ int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
 #undef TST
 #define TST(expr1,expr2,n1,n2,n3,cc) \
   s2 = btFabs(expr1) - (expr2); \
-  if (s2 > SIMD_EPSILON) return 0; \
+  if (s2 > maxSeparation + SIMD_EPSILON) return 0; \
   l = btSqrt((n1)*(n1) + (n2)*(n2) + (n3)*(n3)); \
   if (l > SIMD_EPSILON) { \
     s2 /= l; \
-    if (s2*fudge_factor > s) { \
+    if ((s2 > 0 ? s2/fudge_factor : s2*fudge_factor) > s) { \
       s = s2; \
       normalR = 0; \
       normalC[0] = (n1)/l; normalC[1] = (n2)/l; normalC[2] = (n3)/l; \
@@ -378,7 +381,8 @@ int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
 
   if (!code) return 0;
 
-  // if we get to this point, the boxes interpenetrate. compute the normal
+  // if we get to this point, the boxes interpenetrate or are within
+  // maxSeparation of each other. compute the normal
   // in global coordinates.
   if (normalR) {
     normal[0] = normalR[0];
@@ -578,7 +582,8 @@ int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
 
   // convert the intersection points into reference-face coordinates,
   // and compute the contact position and depth for each point. only keep
-  // those points that have a positive (penetrating) depth. delete points in
+  // those points that penetrate, or are separated by no more than
+  // maxSeparation. delete points in
   // the 'ret' array as necessary so that 'point' and 'ret' correspond.
   btScalar point[3*8];		// penetrating contact points
   btScalar dep[8];			// depths for those points
@@ -594,7 +599,7 @@ int dBoxBox2 (const btVector3& p1, const dMatrix3 R1,
     for (i=0; i<3; i++) point[cnum*3+i] =
 			  center[i] + k1*Rb[i*4+a1] + k2*Rb[i*4+a2];
     dep[cnum] = Sa[codeN] - dDOT(normal2,point+cnum*3);
-    if (dep[cnum] >= 0) {
+    if (dep[cnum] >= -maxSeparation) {
       ret[cnum*2] = ret[j*2];
       ret[cnum*2+1] = ret[j*2+1];
       cnum++;
@@ -712,6 +717,7 @@ void	btBoxBoxDetector::getClosestPoints(const ClosestPointInput& input,Result& o
 	2.f*m_box2->getHalfExtentsWithMargin(),
 	normal, &depth, &return_code,
 	maxc, contact, skip,
+	m_maxSeparation,
 	output
 	);
 
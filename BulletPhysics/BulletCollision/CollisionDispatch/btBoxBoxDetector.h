@@ -31,6 +31,9 @@ struct btBoxBoxDetector : public btDiscreteCollisionDetectorInterface
 	btBoxShape* m_box1;
 	btBoxShape* m_box2;
 
+	///separated boxes closer than this still report contacts, with positive distance (speculative contacts)
+	btScalar	m_maxSeparation;
+
 public:
 
 	btBoxBoxDetector(btBoxShape* box1,btBoxShape* box2);
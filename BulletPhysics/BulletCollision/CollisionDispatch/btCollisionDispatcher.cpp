@@ -85,12 +85,9 @@ btPersistentManifold*	btCollisionDispatcher::getNewManifold(void* b0,void* b1)
 
 	btScalar contactProcessingThreshold = btMin(body0->getContactProcessingThreshold(),body1->getContactProcessingThreshold());
 		
-	void* mem = 0;
+	void* mem = m_persistentManifoldPoolAllocator->allocate(sizeof(btPersistentManifold));
 	
-	if (m_persistentManifoldPoolAllocator->getFreeCount())
-	{
-		mem = m_persistentManifoldPoolAllocator->allocate(sizeof(btPersistentManifold));
-	} else
+	if (!mem)
 	{
 		//we got a pool memory overflow, by default we fallback to dynamically allocate memory. If we require a contiguous contact pool then assert.
 		if ((m_dispatcherFlags&CD_DISABLE_CONTACTPOOL_DYNAMIC_ALLOCATION)==0)
@@ -289,12 +286,13 @@ void btCollisionDispatcher::defaultNearCallback(btBroadphasePair& collisionPair,
 
 void* btCollisionDispatcher::allocateCollisionAlgorithm(int size)
 {
-	if (m_collisionAlgorithmPoolAllocator->getFreeCount())
+	void* mem = m_collisionAlgorithmPoolAllocator->allocate(size);
+	if (mem)
 	{
-		return m_collisionAlgorithmPoolAllocator->allocate(size);
+		return mem;
 	}
 	
-	//warn user for overflow?
+	//overflows are counted by the pool, see btPoolAllocator::getOverflowCount
 	return	btAlignedAlloc(static_cast<size_t>(size), 16);
 }
 
@@ -21,6 +21,7 @@ subject to the following restrictions:
 #include "BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h"
 #include "BulletCollision/CollisionShapes/btSphereShape.h" //for raycasting
 #include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h" //for raycasting
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h" //for raycasting
 #include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
 #include "BulletCollision/NarrowPhaseCollision/btSubSimplexConvexCast.h"
@@ -31,6 +32,7 @@ subject to the following restrictions:
 #include "BulletCollision/BroadphaseCollision/btDbvt.h"
 #include "LinearMath/btAabbUtil2.h"
 #include "LinearMath/btQuickprof.h"
+#include "LinearMath/btThreads.h"
 #include "LinearMath/btStackAlloc.h"
 #include "LinearMath/btSerializer.h"
 #include "BulletCollision/CollisionShapes/btConvexPolyhedron.h"
@@ -220,6 +222,7 @@ void	btCollisionWorld::performDiscreteCollisionDetection()
 		BT_PROFILE("calculateOverlappingPairs");
 		m_broadphasePairCache->calculateOverlappingPairs(m_dispatcher1);
 	}
+	BT_PROFILE_COUNTER(BT_PROFILE_COUNTER_PAIRS, m_broadphasePairCache->getOverlappingPairCache()->getNumOverlappingPairs());
 
 
 	btDispatcher* dispatcher = getDispatcher();
@@ -229,6 +232,20 @@ void	btCollisionWorld::performDiscreteCollisionDetection()
 			dispatcher->dispatchAllCollisionPairs(m_broadphasePairCache->getOverlappingPairCache(),dispatchInfo,m_dispatcher1);
 	}
 
+#ifndef BT_NO_PROFILE
+	if (dispatcher && btProfiler::isEnabled())
+	{
+		int numManifolds = dispatcher->getNumManifolds();
+		int numContacts = 0;
+		for (int i = 0; i < numManifolds; i++)
+		{
+			numContacts += dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+		}
+		btProfiler::addCounter(BT_PROFILE_COUNTER_MANIFOLDS, numManifolds);
+		btProfiler::addCounter(BT_PROFILE_COUNTER_CONTACTS, numContacts);
+	}
+#endif //BT_NO_PROFILE
+
 }
 
 
@@ -426,12 +443,19 @@ void	btCollisionWorld::rayTestSingle(const btTransform& rayFromTrans,const btTra
 				BridgeTriangleRaycastCallback	rcb(rayFromLocal,rayToLocal,&resultCallback,collisionObject,concaveShape, colObjWorldTransform);
 				rcb.m_hitFraction = resultCallback.m_closestHitFraction;
 
-				btVector3 rayAabbMinLocal = rayFromLocal;
-				rayAabbMinLocal.setMin(rayToLocal);
-				btVector3 rayAabbMaxLocal = rayFromLocal;
-				rayAabbMaxLocal.setMax(rayToLocal);
+				if (collisionShape->getShapeType()==TERRAIN_SHAPE_PROXYTYPE)
+				{
+					///walks the min/max quadtree of the heightfield when it has one
+					((btHeightfieldTerrainShape*)collisionShape)->performRaycast(&rcb,rayFromLocal,rayToLocal);
+				} else
+				{
+					btVector3 rayAabbMinLocal = rayFromLocal;
+					rayAabbMinLocal.setMin(rayToLocal);
+					btVector3 rayAabbMaxLocal = rayFromLocal;
+					rayAabbMaxLocal.setMax(rayToLocal);
 
-				concaveShape->processAllTriangles(&rcb,rayAabbMinLocal,rayAabbMaxLocal);
+					concaveShape->processAllTriangles(&rcb,rayAabbMinLocal,rayAabbMaxLocal);
+				}
 			}
 		} else {
 			//			BT_PROFILE("rayTestCompound");
@@ -917,6 +941,236 @@ void	btCollisionWorld::rayTest(const btVector3& rayFromWorld, const btVector3& r
 }
 
 
+///finds the closest hit for each lane of a ray packet, the kernels below handle BT_RAY_PACKET_SIZE rays at once
+struct btRayBatchPacketCallback : public btBroadphaseRayPacketCallback
+{
+	const btCollisionWorld::RayBatch&	m_rays;
+	btCollisionWorld::RayBatchHit*	m_hits;
+	///ray index of lane 0
+	int		m_firstRay;
+
+	btRayBatchPacketCallback(const btCollisionWorld::RayBatch& rays, btCollisionWorld::RayBatchHit* hits)
+		:m_rays(rays),
+		m_hits(hits),
+		m_firstRay(0)
+	{
+	}
+
+	///loads the rays starting at firstRay into the lanes and clears their hits
+	void	loadRays(int firstRay)
+	{
+		m_activeMask = 0;
+		for (int lane = 0; lane < BT_RAY_PACKET_SIZE; lane++)
+		{
+			int ray = firstRay + lane;
+			if (ray >= m_rays.m_numRays)
+			{
+				//inactive lanes get a harmless ray, so the kernels don't need to check the mask
+				setRay(lane, btVector3(0, 0, 0), btVector3(1, 0, 0), btScalar(0.0));
+				m_activeMask &= ~(1 << lane);
+				continue;
+			}
+			setRay(lane, btVector3(m_rays.m_originX[ray], m_rays.m_originY[ray], m_rays.m_originZ[ray]),
+				btVector3(m_rays.m_directionX[ray], m_rays.m_directionY[ray], m_rays.m_directionZ[ray]),
+				m_rays.m_length[ray]);
+			btCollisionWorld::RayBatchHit& hit = m_hits[ray];
+			hit.m_collisionObject = 0;
+			hit.m_hitFraction = btScalar(1.0);
+		}
+		m_firstRay = firstRay;
+	}
+
+	void	reportHit(int lane, btCollisionObject* collisionObject, btScalar lambda, const btVector3& hitNormalWorld)
+	{
+		btCollisionWorld::RayBatchHit& hit = m_hits[m_firstRay + lane];
+		btScalar length = m_rays.m_length[m_firstRay + lane];
+		hit.m_collisionObject = collisionObject;
+		hit.m_hitFraction = length > btScalar(0.0) ? lambda / length : btScalar(0.0);
+		hit.m_hitPointWorld.setValue(m_origin[0][lane] + m_direction[0][lane] * lambda,
+			m_origin[1][lane] + m_direction[1][lane] * lambda,
+			m_origin[2][lane] + m_direction[2][lane] * lambda);
+		hit.m_hitNormalWorld = hitNormalWorld;
+		m_lambdaMax[lane] = lambda;
+	}
+
+	void	rayTestBox(btCollisionObject* collisionObject, const btBoxShape* box, int laneMask);
+	void	rayTestSphere(btCollisionObject* collisionObject, const btSphereShape* sphere, int laneMask);
+	void	rayTestPlane(btCollisionObject* collisionObject, const btStaticPlaneShape* plane, int laneMask);
+	void	rayTestGeneric(btCollisionObject* collisionObject, int laneMask);
+
+	virtual void	process(const btBroadphaseProxy* proxy, int laneMask)
+	{
+		if (!(proxy->m_collisionFilterGroup & m_rays.m_collisionFilterMask) || !(m_rays.m_collisionFilterGroup & proxy->m_collisionFilterMask))
+		{
+			return;
+		}
+
+		btCollisionObject* collisionObject = (btCollisionObject*)proxy->m_clientObject;
+		const btCollisionShape* shape = collisionObject->getCollisionShape();
+		switch (shape->getShapeType())
+		{
+		case BOX_SHAPE_PROXYTYPE:
+			rayTestBox(collisionObject, (const btBoxShape*)shape, laneMask);
+			break;
+		case SPHERE_SHAPE_PROXYTYPE:
+			rayTestSphere(collisionObject, (const btSphereShape*)shape, laneMask);
+			break;
+		case STATIC_PLANE_PROXYTYPE:
+			rayTestPlane(collisionObject, (const btStaticPlaneShape*)shape, laneMask);
+			break;
+		default:
+			rayTestGeneric(collisionObject, laneMask);
+		}
+	}
+};
+
+void	btRayBatchPacketCallback::rayTestBox(btCollisionObject* collisionObject, const btBoxShape* box, int laneMask)
+{
+	const btMatrix3x3& basis = collisionObject->getWorldTransform().getBasis();
+	const btVector3& position = collisionObject->getWorldTransform().getOrigin();
+	btVector3 halfExtents = box->getHalfExtentsWithMargin();
+
+	btScalar tNear[BT_RAY_PACKET_SIZE];
+	btScalar tFar[BT_RAY_PACKET_SIZE];
+	btScalar normalSign[BT_RAY_PACKET_SIZE];
+	int entryAxis[BT_RAY_PACKET_SIZE];
+	int i;
+	for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		tNear[i] = -btScalar(BT_LARGE_FLOAT);
+		tFar[i] = m_lambdaMax[i];
+		normalSign[i] = btScalar(1.0);
+		entryAxis[i] = 0;
+	}
+
+	//slab test in the local frame of the box, basis column k is the box axis k in world space
+	for (int k = 0; k < 3; k++)
+	{
+		btScalar axisX = basis[0][k], axisY = basis[1][k], axisZ = basis[2][k];
+		for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+		{
+			btScalar localOrigin = axisX * (m_origin[0][i] - position[0]) + axisY * (m_origin[1][i] - position[1]) + axisZ * (m_origin[2][i] - position[2]);
+			btScalar localDirection = axisX * m_direction[0][i] + axisY * m_direction[1][i] + axisZ * m_direction[2][i];
+			btScalar inverse = localDirection == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / localDirection;
+			btScalar t0 = (-halfExtents[k] - localOrigin) * inverse;
+			btScalar t1 = (halfExtents[k] - localOrigin) * inverse;
+			btScalar tEnter = btMin(t0, t1);
+			bool entersHere = tEnter > tNear[i];
+			tNear[i] = entersHere ? tEnter : tNear[i];
+			entryAxis[i] = entersHere ? k : entryAxis[i];
+			normalSign[i] = entersHere ? (localDirection < btScalar(0.0) ? btScalar(1.0) : btScalar(-1.0)) : normalSign[i];
+			tFar[i] = btMin(tFar[i], btMax(t0, t1));
+		}
+	}
+
+	for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		if ((laneMask & (1 << i)) && tNear[i] >= btScalar(0.0) && tNear[i] <= tFar[i])
+		{
+			reportHit(i, collisionObject, tNear[i], basis.getColumn(entryAxis[i]) * normalSign[i]);
+		}
+	}
+}
+
+void	btRayBatchPacketCallback::rayTestSphere(btCollisionObject* collisionObject, const btSphereShape* sphere, int laneMask)
+{
+	const btVector3& center = collisionObject->getWorldTransform().getOrigin();
+	btScalar radius = sphere->getRadius();
+
+	btScalar tHit[BT_RAY_PACKET_SIZE];
+	int i;
+	for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		btScalar dx = m_origin[0][i] - center[0];
+		btScalar dy = m_origin[1][i] - center[1];
+		btScalar dz = m_origin[2][i] - center[2];
+		btScalar b = dx * m_direction[0][i] + dy * m_direction[1][i] + dz * m_direction[2][i];
+		btScalar c = dx * dx + dy * dy + dz * dz - radius * radius;
+		btScalar discriminant = b * b - c;
+		//origins inside the sphere (c < 0) and misses get a negative time
+		tHit[i] = (discriminant >= btScalar(0.0) && c >= btScalar(0.0)) ? -b - btSqrt(btMax(discriminant, btScalar(0.0))) : -btScalar(1.0);
+	}
+
+	for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		if ((laneMask & (1 << i)) && tHit[i] >= btScalar(0.0) && tHit[i] <= m_lambdaMax[i])
+		{
+			btVector3 hitPoint(m_origin[0][i] + m_direction[0][i] * tHit[i], m_origin[1][i] + m_direction[1][i] * tHit[i], m_origin[2][i] + m_direction[2][i] * tHit[i]);
+			btVector3 normal = hitPoint - center;
+			if (radius > btScalar(0.0))
+			{
+				normal /= radius;
+			}
+			reportHit(i, collisionObject, tHit[i], normal);
+		}
+	}
+}
+
+void	btRayBatchPacketCallback::rayTestPlane(btCollisionObject* collisionObject, const btStaticPlaneShape* plane, int laneMask)
+{
+	const btTransform& transform = collisionObject->getWorldTransform();
+	btVector3 normal = transform.getBasis() * plane->getPlaneNormal();
+	btScalar planeConstant = plane->getPlaneConstant() + normal.dot(transform.getOrigin());
+
+	btScalar tHit[BT_RAY_PACKET_SIZE];
+	btScalar normalSign[BT_RAY_PACKET_SIZE];
+	int i;
+	for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		btScalar distance = normal[0] * m_origin[0][i] + normal[1] * m_origin[1][i] + normal[2] * m_origin[2][i] - planeConstant;
+		btScalar approach = normal[0] * m_direction[0][i] + normal[1] * m_direction[1][i] + normal[2] * m_direction[2][i];
+		tHit[i] = approach != btScalar(0.0) ? -distance / approach : -btScalar(1.0);
+		//like the triangle ray test, both sides are hit and the normal faces the ray origin
+		normalSign[i] = distance >= btScalar(0.0) ? btScalar(1.0) : btScalar(-1.0);
+	}
+
+	for (i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		if ((laneMask & (1 << i)) && tHit[i] >= btScalar(0.0) && tHit[i] <= m_lambdaMax[i])
+		{
+			reportHit(i, collisionObject, tHit[i], normal * normalSign[i]);
+		}
+	}
+}
+
+void	btRayBatchPacketCallback::rayTestGeneric(btCollisionObject* collisionObject, int laneMask)
+{
+	for (int i = 0; i < BT_RAY_PACKET_SIZE; i++)
+	{
+		if (!(laneMask & (1 << i)))
+		{
+			continue;
+		}
+		btTransform rayFromTrans;
+		rayFromTrans.setIdentity();
+		rayFromTrans.setOrigin(btVector3(m_origin[0][i], m_origin[1][i], m_origin[2][i]));
+		btTransform rayToTrans;
+		rayToTrans.setIdentity();
+		rayToTrans.setOrigin(rayFromTrans.getOrigin() + btVector3(m_direction[0][i], m_direction[1][i], m_direction[2][i]) * m_lambdaMax[i]);
+
+		btCollisionWorld::ClosestRayResultCallback resultCallback(rayFromTrans.getOrigin(), rayToTrans.getOrigin());
+		resultCallback.m_collisionFilterGroup = m_rays.m_collisionFilterGroup;
+		resultCallback.m_collisionFilterMask = m_rays.m_collisionFilterMask;
+		btCollisionWorld::rayTestSingle(rayFromTrans, rayToTrans, collisionObject, collisionObject->getCollisionShape(),
+			collisionObject->getWorldTransform(), resultCallback);
+		if (resultCallback.hasHit())
+		{
+			reportHit(i, collisionObject, resultCallback.m_closestHitFraction * m_lambdaMax[i], resultCallback.m_hitNormalWorld);
+		}
+	}
+}
+
+void	btCollisionWorld::rayTestBatch(const RayBatch& rays, RayBatchHit* hits) const
+{
+	BT_PROFILE("rayTestBatch");
+	btRayBatchPacketCallback packetCallback(rays, hits);
+	for (int firstRay = 0; firstRay < rays.m_numRays; firstRay += BT_RAY_PACKET_SIZE)
+	{
+		packetCallback.loadRays(firstRay);
+		m_broadphasePairCache->rayTestPacket(packetCallback);
+	}
+}
+
 struct btSingleSweepCallback : public btBroadphaseRayCallback
 {
 
@@ -1038,6 +1292,222 @@ void	btCollisionWorld::convexSweepTest(const btConvexShape* castShape, const btT
 }
 
 
+///number of sweeps that share one broadphase query in convexSweepTestBatch
+#define BT_CONVEX_SWEEP_CLUSTER_SIZE 16
+
+struct btConvexSweepSortKey
+{
+	unsigned int	m_key;
+	int				m_sweep;
+};
+
+struct btConvexSweepSortPredicate
+{
+	bool operator() (const btConvexSweepSortKey& a, const btConvexSweepSortKey& b) const
+	{
+		return a.m_key < b.m_key || (a.m_key == b.m_key && a.m_sweep < b.m_sweep);
+	}
+};
+
+///spreads the lower 10 bits of x so that there are two zero bits between each of them
+static SIMD_FORCE_INLINE unsigned int	btMortonSpreadBits(unsigned int x)
+{
+	x &= 0x3ff;
+	x = (x | (x << 16)) & 0x030000ff;
+	x = (x | (x << 8)) & 0x0300f00f;
+	x = (x | (x << 4)) & 0x030c30c3;
+	x = (x | (x << 2)) & 0x09249249;
+	return x;
+}
+
+///the bounds of a single sweep: the cast shape AABB (including rotation) around the origin, and the AABB of the whole sweep
+struct btConvexSweepBounds
+{
+	btVector3	m_castShapeAabbMin;
+	btVector3	m_castShapeAabbMax;
+	btVector3	m_sweepAabbMin;
+	btVector3	m_sweepAabbMax;
+};
+
+///collects the broadphase proxies that overlap the AABB of a cluster of sweeps
+struct btConvexSweepCandidateCallback : public btBroadphaseAabbCallback
+{
+	btAlignedObjectArray<const btBroadphaseProxy*>&	m_candidates;
+	short int	m_collisionFilterGroup;
+	short int	m_collisionFilterMask;
+
+	btConvexSweepCandidateCallback(btAlignedObjectArray<const btBroadphaseProxy*>& candidates, short int collisionFilterGroup, short int collisionFilterMask)
+		:m_candidates(candidates),
+		m_collisionFilterGroup(collisionFilterGroup),
+		m_collisionFilterMask(collisionFilterMask)
+	{
+	}
+
+	virtual bool	process(const btBroadphaseProxy* proxy)
+	{
+		if ((proxy->m_collisionFilterGroup & m_collisionFilterMask) && (m_collisionFilterGroup & proxy->m_collisionFilterMask))
+		{
+			m_candidates.push_back(proxy);
+		}
+		return true;
+	}
+};
+
+struct btConvexSweepClusterBody : public btIParallelForBody
+{
+	const btCollisionWorld*	m_world;
+	btBroadphaseInterface*	m_broadphase;
+	const btCollisionWorld::ConvexSweepBatch&	m_sweeps;
+	btCollisionWorld::ConvexSweepBatchHit*	m_hits;
+	const btConvexSweepSortKey*	m_sortedSweeps;
+	const btConvexSweepBounds*	m_bounds;
+
+	btConvexSweepClusterBody(const btCollisionWorld* world, btBroadphaseInterface* broadphase, const btCollisionWorld::ConvexSweepBatch& sweeps, btCollisionWorld::ConvexSweepBatchHit* hits,
+		const btConvexSweepSortKey* sortedSweeps, const btConvexSweepBounds* bounds)
+		:m_world(world),
+		m_broadphase(broadphase),
+		m_sweeps(sweeps),
+		m_hits(hits),
+		m_sortedSweeps(sortedSweeps),
+		m_bounds(bounds)
+	{
+	}
+
+	void	sweepCluster(int firstSweep, int lastSweep, btAlignedObjectArray<const btBroadphaseProxy*>& candidates) const
+	{
+		btVector3 clusterAabbMin = m_bounds[m_sortedSweeps[firstSweep].m_sweep].m_sweepAabbMin;
+		btVector3 clusterAabbMax = m_bounds[m_sortedSweeps[firstSweep].m_sweep].m_sweepAabbMax;
+		int i;
+		for (i = firstSweep + 1; i < lastSweep; i++)
+		{
+			const btConvexSweepBounds& bounds = m_bounds[m_sortedSweeps[i].m_sweep];
+			clusterAabbMin.setMin(bounds.m_sweepAabbMin);
+			clusterAabbMax.setMax(bounds.m_sweepAabbMax);
+		}
+
+		candidates.resize(0);
+		btConvexSweepCandidateCallback candidateCallback(candidates, m_sweeps.m_collisionFilterGroup, m_sweeps.m_collisionFilterMask);
+		m_broadphase->aabbTest(clusterAabbMin, clusterAabbMax, candidateCallback);
+
+		for (i = firstSweep; i < lastSweep; i++)
+		{
+			int sweepIndex = m_sortedSweeps[i].m_sweep;
+			const btCollisionWorld::ConvexSweep& sweep = m_sweeps.m_sweeps[sweepIndex];
+			const btConvexSweepBounds& bounds = m_bounds[sweepIndex];
+
+			btCollisionWorld::ClosestConvexResultCallback resultCallback(sweep.m_from.getOrigin(), sweep.m_to.getOrigin());
+			resultCallback.m_collisionFilterGroup = m_sweeps.m_collisionFilterGroup;
+			resultCallback.m_collisionFilterMask = m_sweeps.m_collisionFilterMask;
+
+			for (int c = 0; c < candidates.size() && resultCallback.m_closestHitFraction > btScalar(0.); c++)
+			{
+				const btBroadphaseProxy* proxy = candidates[c];
+				//same culling as btSingleSweepCallback: the sweep ray against the object AABB grown by the cast shape
+				if (!TestAabbAgainstAabb2(proxy->m_aabbMin, proxy->m_aabbMax, bounds.m_sweepAabbMin, bounds.m_sweepAabbMax))
+				{
+					continue;
+				}
+				btVector3 aabbMin = proxy->m_aabbMin;
+				btVector3 aabbMax = proxy->m_aabbMax;
+				AabbExpand(aabbMin, aabbMax, bounds.m_castShapeAabbMin, bounds.m_castShapeAabbMax);
+				btScalar hitLambda = resultCallback.m_closestHitFraction;
+				btVector3 hitNormal;
+				if (!btRayAabb(sweep.m_from.getOrigin(), sweep.m_to.getOrigin(), aabbMin, aabbMax, hitLambda, hitNormal))
+				{
+					continue;
+				}
+
+				btCollisionObject* collisionObject = (btCollisionObject*)proxy->m_clientObject;
+				m_world->objectQuerySingle(sweep.m_castShape, sweep.m_from, sweep.m_to,
+					collisionObject,
+					collisionObject->getCollisionShape(),
+					collisionObject->getWorldTransform(),
+					resultCallback,
+					m_sweeps.m_allowedCcdPenetration);
+			}
+
+			btCollisionWorld::ConvexSweepBatchHit& hit = m_hits[sweepIndex];
+			hit.m_collisionObject = resultCallback.m_hitCollisionObject;
+			hit.m_hitFraction = resultCallback.m_closestHitFraction;
+			if (resultCallback.hasHit())
+			{
+				hit.m_hitPointWorld = resultCallback.m_hitPointWorld;
+				hit.m_hitNormalWorld = resultCallback.m_hitNormalWorld;
+			}
+		}
+	}
+
+	virtual void	forLoop(int iBegin, int iEnd) const
+	{
+		btAlignedObjectArray<const btBroadphaseProxy*> candidates;
+		for (int cluster = iBegin; cluster < iEnd; cluster++)
+		{
+			int firstSweep = cluster * BT_CONVEX_SWEEP_CLUSTER_SIZE;
+			int lastSweep = btMin(firstSweep + BT_CONVEX_SWEEP_CLUSTER_SIZE, m_sweeps.m_numSweeps);
+			sweepCluster(firstSweep, lastSweep, candidates);
+		}
+	}
+};
+
+void	btCollisionWorld::convexSweepTestBatch(const ConvexSweepBatch& sweeps, ConvexSweepBatchHit* hits) const
+{
+	BT_PROFILE("convexSweepTestBatch");
+	int numSweeps = sweeps.m_numSweeps;
+	if (!numSweeps)
+	{
+		return;
+	}
+
+	btAlignedObjectArray<btConvexSweepBounds> bounds;
+	bounds.resize(numSweeps);
+	btVector3 batchAabbMin(btScalar(BT_LARGE_FLOAT), btScalar(BT_LARGE_FLOAT), btScalar(BT_LARGE_FLOAT));
+	btVector3 batchAabbMax(-btScalar(BT_LARGE_FLOAT), -btScalar(BT_LARGE_FLOAT), -btScalar(BT_LARGE_FLOAT));
+	int i;
+	for (i = 0; i < numSweeps; i++)
+	{
+		const ConvexSweep& sweep = sweeps.m_sweeps[i];
+		btConvexSweepBounds& sweepBounds = bounds[i];
+
+		//same AABB as convexSweepTest, it encompasses the angular movement
+		btVector3 linVel, angVel;
+		btTransformUtil::calculateVelocity(sweep.m_from, sweep.m_to, 1.0, linVel, angVel);
+		btTransform R;
+		R.setIdentity();
+		R.setRotation(sweep.m_from.getRotation());
+		sweep.m_castShape->calculateTemporalAabb(R, btVector3(0, 0, 0), angVel, 1.0, sweepBounds.m_castShapeAabbMin, sweepBounds.m_castShapeAabbMax);
+
+		sweepBounds.m_sweepAabbMin = sweep.m_from.getOrigin();
+		sweepBounds.m_sweepAabbMin.setMin(sweep.m_to.getOrigin());
+		sweepBounds.m_sweepAabbMax = sweep.m_from.getOrigin();
+		sweepBounds.m_sweepAabbMax.setMax(sweep.m_to.getOrigin());
+		batchAabbMin.setMin(sweepBounds.m_sweepAabbMin);
+		batchAabbMax.setMax(sweepBounds.m_sweepAabbMax);
+		sweepBounds.m_sweepAabbMin += sweepBounds.m_castShapeAabbMin;
+		sweepBounds.m_sweepAabbMax += sweepBounds.m_castShapeAabbMax;
+	}
+
+	//sort the sweeps along a Morton curve through the centers of their paths, so neighbouring sweeps end up in the same cluster
+	btAlignedObjectArray<btConvexSweepSortKey> sortedSweeps;
+	sortedSweeps.resize(numSweeps);
+	btVector3 extent = batchAabbMax - batchAabbMin;
+	btVector3 quantization(extent[0] > SIMD_EPSILON ? btScalar(1023.) / extent[0] : btScalar(0.),
+		extent[1] > SIMD_EPSILON ? btScalar(1023.) / extent[1] : btScalar(0.),
+		extent[2] > SIMD_EPSILON ? btScalar(1023.) / extent[2] : btScalar(0.));
+	for (i = 0; i < numSweeps; i++)
+	{
+		btVector3 center = (sweeps.m_sweeps[i].m_from.getOrigin() + sweeps.m_sweeps[i].m_to.getOrigin()) * btScalar(0.5);
+		btVector3 q = (center - batchAabbMin) * quantization;
+		sortedSweeps[i].m_key = (btMortonSpreadBits((unsigned int)q[0]) << 2) | (btMortonSpreadBits((unsigned int)q[1]) << 1) | btMortonSpreadBits((unsigned int)q[2]);
+		sortedSweeps[i].m_sweep = i;
+	}
+	sortedSweeps.quickSort(btConvexSweepSortPredicate());
+
+	int numClusters = (numSweeps + BT_CONVEX_SWEEP_CLUSTER_SIZE - 1) / BT_CONVEX_SWEEP_CLUSTER_SIZE;
+	btConvexSweepClusterBody body(this, m_broadphasePairCache, sweeps, hits, &sortedSweeps[0], &bounds[0]);
+	btParallelFor(0, numClusters, 1, body);
+}
+
+
 
 struct btBridgedManifoldResult : public btManifoldResult
 {
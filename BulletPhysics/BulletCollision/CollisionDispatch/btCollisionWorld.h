@@ -303,6 +303,83 @@ public:
 		}
 	};
 
+	///RayBatch is the input of rayTestBatch, in structure of arrays layout.
+	///Ray i starts at (m_originX[i],m_originY[i],m_originZ[i]) and goes along the normalized direction
+	///(m_directionX[i],m_directionY[i],m_directionZ[i]) for m_length[i] units.
+	struct	RayBatch
+	{
+		const btScalar*	m_originX;
+		const btScalar*	m_originY;
+		const btScalar*	m_originZ;
+		const btScalar*	m_directionX;
+		const btScalar*	m_directionY;
+		const btScalar*	m_directionZ;
+		const btScalar*	m_length;
+		int			m_numRays;
+		short int	m_collisionFilterGroup;
+		short int	m_collisionFilterMask;
+
+		RayBatch()
+			:m_originX(0),
+			m_originY(0),
+			m_originZ(0),
+			m_directionX(0),
+			m_directionY(0),
+			m_directionZ(0),
+			m_length(0),
+			m_numRays(0),
+			m_collisionFilterGroup(btBroadphaseProxy::DefaultFilter),
+			m_collisionFilterMask(btBroadphaseProxy::AllFilter)
+		{
+		}
+	};
+
+	///closest hit of one ray of a RayBatch, m_collisionObject is 0 when the ray hit nothing
+	struct	RayBatchHit
+	{
+		btCollisionObject*	m_collisionObject;
+		///distance from the ray origin divided by the ray length, like RayResultCallback::m_closestHitFraction
+		btScalar	m_hitFraction;
+		btVector3	m_hitPointWorld;
+		btVector3	m_hitNormalWorld;
+	};
+
+	///one query of a ConvexSweepBatch, m_castShape is swept from m_from to m_to
+	struct	ConvexSweep
+	{
+		const btConvexShape*	m_castShape;
+		btTransform	m_from;
+		btTransform	m_to;
+	};
+
+	///ConvexSweepBatch is the input of convexSweepTestBatch
+	struct	ConvexSweepBatch
+	{
+		const ConvexSweep*	m_sweeps;
+		int			m_numSweeps;
+		short int	m_collisionFilterGroup;
+		short int	m_collisionFilterMask;
+		btScalar	m_allowedCcdPenetration;
+
+		ConvexSweepBatch()
+			:m_sweeps(0),
+			m_numSweeps(0),
+			m_collisionFilterGroup(btBroadphaseProxy::DefaultFilter),
+			m_collisionFilterMask(btBroadphaseProxy::AllFilter),
+			m_allowedCcdPenetration(btScalar(0.))
+		{
+		}
+	};
+
+	///closest hit of one sweep of a ConvexSweepBatch, m_collisionObject is 0 when the sweep hit nothing
+	struct	ConvexSweepBatchHit
+	{
+		btCollisionObject*	m_collisionObject;
+		btScalar	m_hitFraction;
+		btVector3	m_hitPointWorld;
+		btVector3	m_hitNormalWorld;
+	};
+
 
 	struct LocalConvexResult
 	{
@@ -435,10 +512,20 @@ public:
 	/// This allows for several queries: first hit, all hits, any hit, dependent on the value returned by the callback.
 	virtual void rayTest(const btVector3& rayFromWorld, const btVector3& rayToWorld, RayResultCallback& resultCallback) const; 
 
+	/// rayTestBatch finds the closest hit of many rays at once, hits must have room for rays.m_numRays results.
+	/// The rays go through the broadphase in packets of BT_RAY_PACKET_SIZE, and boxes, spheres and static planes are
+	/// tested with packet kernels, other shapes use rayTestSingle. Rays that start inside a box or sphere don't hit it.
+	void	rayTestBatch(const RayBatch& rays, RayBatchHit* hits) const;
+
 	/// convexTest performs a swept convex cast on all objects in the btCollisionWorld, and calls the resultCallback
 	/// This allows for several queries: first hit, all hits, any hit, dependent on the value return by the callback.
 	void    convexSweepTest (const btConvexShape* castShape, const btTransform& from, const btTransform& to, ConvexResultCallback& resultCallback,  btScalar allowedCcdPenetration = btScalar(0.)) const;
 
+	/// convexSweepTestBatch finds the closest hit of many convex sweeps at once, hits must have room for sweeps.m_numSweeps results.
+	/// The sweeps are sorted along a Morton curve and grouped into clusters of nearby sweeps that share one broadphase query,
+	/// the clusters run through btParallelFor. The collision shapes must not change during the call.
+	void	convexSweepTestBatch(const ConvexSweepBatch& sweeps, ConvexSweepBatchHit* hits) const;
+
 	///contactTest performs a discrete collision test between colObj against all objects in the btCollisionWorld, and calls the resultCallback.
 	///it reports one or more contact points for every overlapping object (including the one with deepest penetration)
 	void	contactTest(btCollisionObject* colObj, ContactResultCallback& resultCallback);
@@ -219,22 +219,21 @@ void btCompoundCollisionAlgorithm::processCollision (btCollisionObject* body0,bt
 	///so we should add a 'refreshManifolds' in the btCollisionAlgorithm
 	{
 		int i;
-		btManifoldArray manifoldArray;
 		for (i=0;i<m_childCollisionAlgorithms.size();i++)
 		{
 			if (m_childCollisionAlgorithms[i])
 			{
-				m_childCollisionAlgorithms[i]->getAllContactManifolds(manifoldArray);
-				for (int m=0;m<manifoldArray.size();m++)
+				m_childCollisionAlgorithms[i]->getAllContactManifolds(m_manifoldArray);
+				for (int m=0;m<m_manifoldArray.size();m++)
 				{
-					if (manifoldArray[m]->getNumContacts())
+					if (m_manifoldArray[m]->getNumContacts())
 					{
-						resultOut->setPersistentManifold(manifoldArray[m]);
+						resultOut->setPersistentManifold(m_manifoldArray[m]);
 						resultOut->refreshContactPoints();
 						resultOut->setPersistentManifold(0);//??necessary?
 					}
 				}
-				manifoldArray.resize(0);
+				m_manifoldArray.resize(0);
 			}
 		}
 	}
@@ -266,7 +265,6 @@ void btCompoundCollisionAlgorithm::processCollision (btCollisionObject* body0,bt
 				//iterate over all children, perform an AABB check inside ProcessChildShape
 		int numChildren = m_childCollisionAlgorithms.size();
 		int i;
-		btManifoldArray	manifoldArray;
         btCollisionShape* childShape = 0;
         btTransform	orgTrans;
         btTransform	orgInterpolationTrans;
@@ -38,6 +38,9 @@ class btCompoundCollisionAlgorithm  : public btActivatingCollisionAlgorithm
 	bool					m_ownsManifold;
 
 	int	m_compoundShapeRevision;//to keep track of changes, so that childAlgorithm array can be updated
+
+	///scratch array to refresh the child manifolds, kept as a member so it keeps its capacity between calls
+	btManifoldArray	m_manifoldArray;
 	
 	void	removeChildAlgorithms();
 	
@@ -203,7 +203,9 @@ m_sepDistance((static_cast<btConvexShape*>(body0->getCollisionShape()))->getAngu
 			  (static_cast<btConvexShape*>(body1->getCollisionShape()))->getAngularMotionDisc()),
 #endif
 m_numPerturbationIterations(numPerturbationIterations),
-m_minimumPointsPerturbationThreshold(minimumPointsPerturbationThreshold)
+m_minimumPointsPerturbationThreshold(minimumPointsPerturbationThreshold),
+m_supportVertexHintA(-1),
+m_supportVertexHintB(-1)
 {
 	(void)body0;
 	(void)body1;
@@ -354,6 +356,7 @@ void btConvexConvexAlgorithm ::processCollision (btCollisionObject* body0,btColl
 	//TODO: if (dispatchInfo.m_useContinuous)
 	gjkPairDetector.setMinkowskiA(min0);
 	gjkPairDetector.setMinkowskiB(min1);
+	gjkPairDetector.setSupportVertexHints(m_supportVertexHintA,m_supportVertexHintB);
 
 #ifdef USE_SEPDISTANCE_UTIL2
 	if (dispatchInfo.m_useConvexConservativeDistanceUtil)
@@ -543,6 +546,8 @@ void btConvexConvexAlgorithm ::processCollision (btCollisionObject* body0,btColl
 	}
 	
 	gjkPairDetector.getClosestPoints(input,*resultOut,dispatchInfo.m_debugDraw);
+	m_supportVertexHintA = gjkPairDetector.getSupportVertexHintA();
+	m_supportVertexHintB = gjkPairDetector.getSupportVertexHintB();
 
 	//now perform 'm_numPerturbationIterations' collision queries with the perturbated collision objects
 	
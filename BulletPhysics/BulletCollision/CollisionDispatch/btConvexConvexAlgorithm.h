@@ -53,6 +53,10 @@ class btConvexConvexAlgorithm : public btActivatingCollisionAlgorithm
 	int m_numPerturbationIterations;
 	int m_minimumPointsPerturbationThreshold;
 
+	///support vertices found by the last GJK query of this pair, they warm-start the next one (see btGjkPairDetector::setSupportVertexHints)
+	int m_supportVertexHintA;
+	int m_supportVertexHintB;
+
 
 	///cache separating vector to speedup collision detection
 	
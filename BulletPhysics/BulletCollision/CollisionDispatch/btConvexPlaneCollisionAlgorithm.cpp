@@ -78,7 +78,7 @@ void btConvexPlaneCollisionAlgorithm::collideSingleContact (const btQuaternion&
 	btVector3 vtxInPlaneProjected = vtxInPlane - distance*planeNormal;
 	btVector3 vtxInPlaneWorld = planeObj->getWorldTransform() * vtxInPlaneProjected;
 
-	hasCollision = distance < m_manifoldPtr->getContactBreakingThreshold();
+	hasCollision = distance < m_manifoldPtr->getContactBreakingThreshold() + m_manifoldPtr->getSpeculativeDistance();
 	resultOut->setPersistentManifold(m_manifoldPtr);
 	if (hasCollision)
 	{
@@ -92,10 +92,12 @@ void btConvexPlaneCollisionAlgorithm::collideSingleContact (const btQuaternion&
 
 void btConvexPlaneCollisionAlgorithm::processCollision (btCollisionObject* body0,btCollisionObject* body1,const btDispatcherInfo& dispatchInfo,btManifoldResult* resultOut)
 {
-	(void)dispatchInfo;
 	if (!m_manifoldPtr)
 		return;
 
+	resultOut->setPersistentManifold(m_manifoldPtr);
+	resultOut->updateSpeculativeDistance(dispatchInfo);
+
 	btCollisionObject* convexObj = m_isSwapped? body1 : body0;
 	btCollisionObject* planeObj = m_isSwapped? body0: body1;
 
@@ -117,8 +119,7 @@ void btConvexPlaneCollisionAlgorithm::processCollision (btCollisionObject* body0
 	btVector3 vtxInPlaneProjected = vtxInPlane - distance*planeNormal;
 	btVector3 vtxInPlaneWorld = planeObj->getWorldTransform() * vtxInPlaneProjected;
 
-	hasCollision = distance < m_manifoldPtr->getContactBreakingThreshold();
-	resultOut->setPersistentManifold(m_manifoldPtr);
+	hasCollision = distance < m_manifoldPtr->getContactBreakingThreshold() + m_manifoldPtr->getSpeculativeDistance();
 	if (hasCollision)
 	{
 		/// report a contact. internally this will be kept persistent, and contact reduction is done
@@ -25,6 +25,9 @@ struct	btDefaultCollisionConstructionInfo
 	btStackAlloc*		m_stackAlloc;
 	btPoolAllocator*	m_persistentManifoldPool;
 	btPoolAllocator*	m_collisionAlgorithmPool;
+	///the pool sizes are best taken from btPoolAllocator::getHighWaterMark of a typical run, with some slack:
+	///every thread that allocates may keep up to BT_POOL_MAGAZINE_SIZE free elements cached for itself.
+	///a non-zero btPoolAllocator::getOverflowCount means the pool was too small and the heap was used
 	int					m_defaultMaxPersistentManifoldPoolSize;
 	int					m_defaultMaxCollisionAlgorithmPoolSize;
 	int					m_customCollisionAlgorithmMaxElementSize;
@@ -0,0 +1,262 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2008 Erwin Coumans  http://bulletphysics.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btGhostTriggerSystem.h"
+#include "btManifoldResult.h"
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "LinearMath/btQuickprof.h"
+
+///flags of a registered trigger
+enum btGhostTriggerFlags
+{
+	BT_TRIGGER = 1,
+	BT_TRIGGER_AABB_ONLY = 2,
+	///set in the pair flags while the object touches the trigger
+	BT_TRIGGER_TOUCHING = 4
+};
+
+#define BT_TRIGGER_FLAG_BITS 3
+
+///the pair flags, kept in btBroadphasePair::m_internalTmpValue, hold the trigger flags of proxy0 in the low bits and those of proxy1 above them
+static SIMD_FORCE_INLINE int btTriggerSideFlags(int pairFlags, int side)
+{
+	return (pairFlags >> (side * BT_TRIGGER_FLAG_BITS)) & ((1 << BT_TRIGGER_FLAG_BITS) - 1);
+}
+
+static SIMD_FORCE_INLINE btCollisionObject* btTriggerSideObject(const btBroadphasePair& pair, int side)
+{
+	return (btCollisionObject*)(side ? pair.m_pProxy1 : pair.m_pProxy0)->m_clientObject;
+}
+
+struct btGhostTriggerPairSortPredicate
+{
+	bool operator() (const btGhostTriggerPair& a, const btGhostTriggerPair& b) const
+	{
+		return a.m_trigger < b.m_trigger;
+	}
+};
+
+btGhostTriggerSystem::btGhostTriggerSystem()
+{
+	m_pairCache = new (btAlignedAlloc(sizeof(btHashedOverlappingPairCache),16)) btHashedOverlappingPairCache();
+}
+
+btGhostTriggerSystem::~btGhostTriggerSystem()
+{
+	///the triggers should have been removed from the world, so no pairs are left
+	btAssert(!m_pairCache->getNumOverlappingPairs());
+	m_pairCache->~btHashedOverlappingPairCache();
+	btAlignedFree( m_pairCache );
+}
+
+int btGhostTriggerSystem::getTriggerFlags(const btCollisionObject* colObj) const
+{
+	if (!btGhostObject::upcast(colObj))
+		return 0;
+	const int* flags = m_triggers.find(btHashPtr(colObj));
+	return flags ? *flags : 0;
+}
+
+void btGhostTriggerSystem::addTrigger(btGhostObject* trigger, bool aabbOnly)
+{
+	btAssert(!trigger->getBroadphaseHandle());
+	m_triggers.insert(btHashPtr(trigger), aabbOnly ? BT_TRIGGER | BT_TRIGGER_AABB_ONLY : BT_TRIGGER);
+}
+
+void btGhostTriggerSystem::removeTrigger(btGhostObject* trigger)
+{
+	btAssert(!trigger->getBroadphaseHandle());
+	m_triggers.remove(btHashPtr(trigger));
+}
+
+btBroadphasePair* btGhostTriggerSystem::addOverlappingPair(btBroadphaseProxy* proxy0,btBroadphaseProxy* proxy1)
+{
+	btCollisionObject* colObj0 = (btCollisionObject*) proxy0->m_clientObject;
+	btCollisionObject* colObj1 = (btCollisionObject*) proxy1->m_clientObject;
+	int flags0 = getTriggerFlags(colObj0);
+	int flags1 = getTriggerFlags(colObj1);
+
+	//ghost objects that are not registered keep their own overlaps
+	btGhostObject* ghost0 = flags0 ? 0 : btGhostObject::upcast(colObj0);
+	btGhostObject* ghost1 = flags1 ? 0 : btGhostObject::upcast(colObj1);
+	if (ghost0)
+		ghost0->addOverlappingObjectInternal(proxy1, proxy0);
+	if (ghost1)
+		ghost1->addOverlappingObjectInternal(proxy0, proxy1);
+
+	if (flags0 || flags1)
+	{
+		btBroadphasePair* pair = m_pairCache->addOverlappingPair(proxy0, proxy1);
+		if (pair)
+		{
+			//the pair cache orders the proxies of a pair by their unique id
+			if (pair->m_pProxy0 != proxy0)
+				btSwap(flags0, flags1);
+			pair->m_internalTmpValue = flags0 | (flags1 << BT_TRIGGER_FLAG_BITS);
+		}
+	}
+	return 0;
+}
+
+void* btGhostTriggerSystem::removeOverlappingPair(btBroadphaseProxy* proxy0,btBroadphaseProxy* proxy1,btDispatcher* dispatcher)
+{
+	btCollisionObject* colObj0 = (btCollisionObject*) proxy0->m_clientObject;
+	btCollisionObject* colObj1 = (btCollisionObject*) proxy1->m_clientObject;
+	int flags0 = getTriggerFlags(colObj0);
+	int flags1 = getTriggerFlags(colObj1);
+
+	btGhostObject* ghost0 = flags0 ? 0 : btGhostObject::upcast(colObj0);
+	btGhostObject* ghost1 = flags1 ? 0 : btGhostObject::upcast(colObj1);
+	if (ghost0)
+		ghost0->removeOverlappingObjectInternal(proxy1,dispatcher,proxy0);
+	if (ghost1)
+		ghost1->removeOverlappingObjectInternal(proxy0,dispatcher,proxy1);
+
+	if (flags0 || flags1)
+	{
+		btBroadphasePair* pair = m_pairCache->findPair(proxy0, proxy1);
+		if (pair)
+		{
+			//the objects stop touching the triggers, reported by the next update
+			for (int side = 0; side < 2; side++)
+			{
+				if (btTriggerSideFlags(pair->m_internalTmpValue, side) & BT_TRIGGER_TOUCHING)
+				{
+					btGhostTriggerPair& event = m_removedPairExitEvents.expandNonInitializing();
+					event.m_trigger = (btGhostObject*)btTriggerSideObject(*pair, side);
+					event.m_object = btTriggerSideObject(*pair, 1 - side);
+				}
+			}
+			m_pairCache->removeOverlappingPair(proxy0, proxy1, dispatcher);
+		}
+	}
+	return 0;
+}
+
+void btGhostTriggerSystem::update(btCollisionWorld* collisionWorld)
+{
+	BT_PROFILE("btGhostTriggerSystem::update");
+
+	btDispatcher* dispatcher = collisionWorld->getDispatcher();
+	const btDispatcherInfo& dispatchInfo = collisionWorld->getDispatchInfo();
+
+	m_enterEvents.resize(0);
+	m_exitEvents.copyFromArray(m_removedPairExitEvents);
+	m_removedPairExitEvents.resize(0);
+	m_touchingPairs.resize(0);
+
+	int numPairs = m_pairCache->getNumOverlappingPairs();
+	btBroadphasePair* pairs = m_pairCache->getOverlappingPairArrayPtr();
+	for (int i = 0; i < numPairs; i++)
+	{
+		btBroadphasePair& pair = pairs[i];
+		int pairFlags = pair.m_internalTmpValue;
+		btCollisionObject* colObj0 = btTriggerSideObject(pair, 0);
+		btCollisionObject* colObj1 = btTriggerSideObject(pair, 1);
+
+		//narrowphase, only if a trigger of the pair is not aabb only
+		bool needsContact = false;
+		for (int side = 0; side < 2; side++)
+		{
+			int flags = btTriggerSideFlags(pairFlags, side);
+			if ((flags & BT_TRIGGER) && !(flags & BT_TRIGGER_AABB_ONLY))
+				needsContact = true;
+		}
+
+		bool hasContact = false;
+		if (needsContact && dispatcher->needsCollision(colObj0, colObj1))
+		{
+			//dispatcher will keep algorithms persistent in the collision pair
+			if (!pair.m_algorithm)
+			{
+				pair.m_algorithm = dispatcher->findAlgorithm(colObj0, colObj1);
+			}
+
+			if (pair.m_algorithm)
+			{
+				btManifoldResult contactPointResult(colObj0, colObj1);
+				pair.m_algorithm->processCollision(colObj0, colObj1, dispatchInfo, &contactPointResult);
+
+				m_manifoldArray.resize(0);
+				pair.m_algorithm->getAllContactManifolds(m_manifoldArray);
+				for (int j = 0; j < m_manifoldArray.size() && !hasContact; j++)
+				{
+					btPersistentManifold* manifold = m_manifoldArray[j];
+					for (int p = 0; p < manifold->getNumContacts(); p++)
+					{
+						if (manifold->getContactPoint(p).getDistance() < btScalar(0.))
+						{
+							hasContact = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		int newPairFlags = 0;
+		for (int side = 0; side < 2; side++)
+		{
+			int flags = btTriggerSideFlags(pairFlags, side);
+			if (flags & BT_TRIGGER)
+			{
+				bool wasTouching = (flags & BT_TRIGGER_TOUCHING) != 0;
+				bool touching = (flags & BT_TRIGGER_AABB_ONLY) || hasContact;
+
+				btGhostTriggerPair triggerPair;
+				triggerPair.m_trigger = (btGhostObject*)btTriggerSideObject(pair, side);
+				triggerPair.m_object = btTriggerSideObject(pair, 1 - side);
+				if (touching)
+				{
+					m_touchingPairs.push_back(triggerPair);
+					flags |= BT_TRIGGER_TOUCHING;
+					if (!wasTouching)
+						m_enterEvents.push_back(triggerPair);
+				} else
+				{
+					flags &= ~BT_TRIGGER_TOUCHING;
+					if (wasTouching)
+						m_exitEvents.push_back(triggerPair);
+				}
+			}
+			newPairFlags |= flags << (side * BT_TRIGGER_FLAG_BITS);
+		}
+		pair.m_internalTmpValue = newPairFlags;
+	}
+
+	m_touchingPairs.quickSort(btGhostTriggerPairSortPredicate());
+}
+
+int btGhostTriggerSystem::findTouchingPairs(const btGhostObject* trigger, int& first) const
+{
+	//binary search for the first pair of the trigger
+	int lo = 0;
+	int hi = m_touchingPairs.size();
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (m_touchingPairs[mid].m_trigger < trigger)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	first = lo;
+
+	int end = lo;
+	while (end < m_touchingPairs.size() && m_touchingPairs[end].m_trigger == trigger)
+		end++;
+	return end - first;
+}
@@ -0,0 +1,116 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2008 Erwin Coumans  http://bulletphysics.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_GHOST_TRIGGER_SYSTEM_H
+#define BT_GHOST_TRIGGER_SYSTEM_H
+
+#include "btGhostObject.h"
+#include "BulletCollision/BroadphaseCollision/btCollisionAlgorithm.h"
+#include "LinearMath/btHashMap.h"
+
+///a trigger and an object, for the touching pairs and the enter and exit events of btGhostTriggerSystem
+struct btGhostTriggerPair
+{
+	btGhostObject*		m_trigger;
+	btCollisionObject*	m_object;
+};
+
+///The btGhostTriggerSystem tracks the overlaps of many trigger volumes (sensors, scoring zones) in one shared pair table.
+///It replaces the btGhostPairCallback of the broadphase. The pairs of registered triggers go into its own btHashedOverlappingPairCache,
+///instead of a pair cache per btPairCachingGhostObject. The pairs of other ghost objects are forwarded to them as by btGhostPairCallback.
+///update, called once per step, runs the narrowphase of all trigger pairs at once and produces the enter and exit events of the step.
+///Triggers registered as aabb only touch every object whose aabb overlaps theirs, and no narrowphase is run for them.
+///The overlapping object lists of registered triggers are not filled, use findTouchingPairs instead.
+class btGhostTriggerSystem : public btGhostPairCallback
+{
+	btHashedOverlappingPairCache*	m_pairCache;
+
+	///flags of the registered triggers
+	btHashMap<btHashPtr,int>	m_triggers;
+
+	///touching pairs, sorted by trigger
+	btAlignedObjectArray<btGhostTriggerPair>	m_touchingPairs;
+
+	btAlignedObjectArray<btGhostTriggerPair>	m_enterEvents;
+	btAlignedObjectArray<btGhostTriggerPair>	m_exitEvents;
+
+	///exit events of the pairs removed since the last update
+	btAlignedObjectArray<btGhostTriggerPair>	m_removedPairExitEvents;
+
+	btManifoldArray	m_manifoldArray;
+
+	int	getTriggerFlags(const btCollisionObject* colObj) const;
+
+public:
+
+	btGhostTriggerSystem();
+
+	virtual ~btGhostTriggerSystem();
+
+	///registers a ghost object as a trigger. Call before adding it to the world.
+	void	addTrigger(btGhostObject* trigger, bool aabbOnly = false);
+
+	///unregisters a trigger. Call after removing it from the world.
+	void	removeTrigger(btGhostObject* trigger);
+
+	bool	isTrigger(const btCollisionObject* colObj) const
+	{
+		return getTriggerFlags(colObj) != 0;
+	}
+
+	int	getNumTriggers() const
+	{
+		return m_triggers.size();
+	}
+
+	///runs the narrowphase of the trigger pairs, updates the touching pairs and replaces the events by the ones of this step.
+	///Call once after each stepSimulation.
+	void	update(btCollisionWorld* collisionWorld);
+
+	const btAlignedObjectArray<btGhostTriggerPair>&	getTouchingPairs() const
+	{
+		return m_touchingPairs;
+	}
+
+	///returns the number of objects touching the trigger, they are in getTouchingPairs() from index first on
+	int	findTouchingPairs(const btGhostObject* trigger, int& first) const;
+
+	///objects that started touching a trigger during the last step
+	const btAlignedObjectArray<btGhostTriggerPair>&	getEnterEvents() const
+	{
+		return m_enterEvents;
+	}
+
+	///objects that stopped touching a trigger during the last step. This includes objects removed from the world,
+	///which may already have been deleted.
+	const btAlignedObjectArray<btGhostTriggerPair>&	getExitEvents() const
+	{
+		return m_exitEvents;
+	}
+
+	btHashedOverlappingPairCache*	getOverlappingPairCache()
+	{
+		return m_pairCache;
+	}
+
+	///btOverlappingPairCallback interface
+	virtual btBroadphasePair*	addOverlappingPair(btBroadphaseProxy* proxy0,btBroadphaseProxy* proxy1);
+
+	///btOverlappingPairCallback interface
+	virtual void*	removeOverlappingPair(btBroadphaseProxy* proxy0,btBroadphaseProxy* proxy1,btDispatcher* dispatcher);
+
+};
+
+#endif //BT_GHOST_TRIGGER_SYSTEM_H
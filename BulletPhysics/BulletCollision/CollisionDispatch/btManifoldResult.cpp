@@ -17,6 +17,7 @@ subject to the following restrictions:
 #include "btManifoldResult.h"
 #include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
 #include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
 
 
 ///This is to allow MaterialCombiner/Custom Friction/Restitution values
@@ -59,12 +60,35 @@ btManifoldResult::btManifoldResult(btCollisionObject* body0,btCollisionObject* b
 }
 
 
+///linear motion of an object over the current time step. predictUnconstraintMotion leaves the predicted transform
+///of dynamic bodies in the interpolation transform, kinematic bodies have moved already and only report their velocity
+static btVector3 btSpeculativeMotion(const btCollisionObject* colObj, btScalar timeStep)
+{
+	if (colObj->isStaticOrKinematicObject())
+		return colObj->getInterpolationLinearVelocity() * timeStep;
+	return colObj->getInterpolationWorldTransform().getOrigin() - colObj->getWorldTransform().getOrigin();
+}
+
+void btManifoldResult::updateSpeculativeDistance(const btDispatcherInfo& dispatchInfo)
+{
+	btAssert(m_manifoldPtr);
+
+	btScalar speculativeDistance = btScalar(0.);
+	if (dispatchInfo.m_useSpeculativeContacts)
+	{
+		//rotation is not included, the contact breaking threshold covers the usual small angular motion
+		btVector3 relativeMotion = btSpeculativeMotion(m_body0, dispatchInfo.m_timeStep) - btSpeculativeMotion(m_body1, dispatchInfo.m_timeStep);
+		speculativeDistance = relativeMotion.length();
+	}
+	m_manifoldPtr->setSpeculativeDistance(speculativeDistance);
+}
+
 void btManifoldResult::addContactPoint(const btVector3& normalOnBInWorld,const btVector3& pointInWorld,btScalar depth)
 {
 	btAssert(m_manifoldPtr);
 	//order in manifold needs to match
 
-	if (depth > m_manifoldPtr->getContactBreakingThreshold())
+	if (depth > m_manifoldPtr->getContactBreakingThreshold() + m_manifoldPtr->getSpeculativeDistance())
 //	if (depth > m_manifoldPtr->getContactProcessingThreshold())
 		return;
 
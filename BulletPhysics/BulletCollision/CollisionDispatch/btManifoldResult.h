@@ -20,6 +20,7 @@ subject to the following restrictions:
 class btCollisionObject;
 #include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
 class btManifoldPoint;
+struct btDispatcherInfo;
 
 #include "BulletCollision/NarrowPhaseCollision/btDiscreteCollisionDetectorInterface.h"
 
@@ -96,6 +97,10 @@ public:
 
 	virtual void addContactPoint(const btVector3& normalOnBInWorld,const btVector3& pointInWorld,btScalar depth);
 
+	///sets the speculative distance of the persistent manifold to the relative motion of the two objects over the time step,
+	///or to zero when dispatchInfo.m_useSpeculativeContacts is off. call after setPersistentManifold, before adding points
+	void	updateSpeculativeDistance(const btDispatcherInfo& dispatchInfo);
+
 	SIMD_FORCE_INLINE	void refreshContactPoints()
 	{
 		btAssert(m_manifoldPtr);
@@ -26,7 +26,11 @@ subject to the following restrictions:
 #include "LinearMath/btQuickprof.h"
 
 btSimulationIslandManager::btSimulationIslandManager():
-m_splitIslands(true)
+m_splitIslands(true),
+m_incrementalIslands(true),
+m_rebuildIslands(true),
+m_islandsChanged(true),
+m_currentEdges(0)
 {
 }
 
@@ -69,6 +73,253 @@ void btSimulationIslandManager::findUnions(btDispatcher* /* dispatcher */,btColl
 	}
 }
 
+///returns true for the objects that updateActivationState gives a union-find element
+static SIMD_FORCE_INLINE bool	isIslandElement(const btCollisionObject* collisionObject)
+{
+#ifdef STATIC_SIMULATION_ISLAND_OPTIMIZATION
+	return !collisionObject->isStaticOrKinematicObject();
+#else
+	(void)collisionObject;
+	return true;
+#endif //STATIC_SIMULATION_ISLAND_OPTIMIZATION
+}
+
+void	btSimulationIslandManager::updateIslandElements(btCollisionWorld* colWorld, int numElements)
+{
+	if (m_elementObjects.size() != numElements)
+	{
+		m_elementObjects.resize(numElements);
+		m_elementObjectIndices.resize(numElements);
+		m_rebuildIslands = true;
+	}
+
+	int element = 0;
+	for (int i=0;i<colWorld->getCollisionObjectArray().size();i++)
+	{
+		btCollisionObject* collisionObject = colWorld->getCollisionObjectArray()[i];
+		if (isIslandElement(collisionObject))
+		{
+			if (m_elementObjects[element] != collisionObject)
+			{
+				m_elementObjects[element] = collisionObject;
+				m_rebuildIslands = true;
+			}
+			if (m_elementObjectIndices[element] != i)
+			{
+				m_elementObjectIndices[element] = i;
+				m_islandsChanged = true;
+			}
+			element++;
+		}
+	}
+	btAssert(element == numElements);
+
+	if (m_rebuildIslands)
+	{
+		//element indices refer to other objects now, start from scratch
+		initUnionFind(numElements);
+		m_islandEdges[1 - m_currentEdges].resize(0);
+		m_islandsChanged = true;
+	}
+	m_islandEdges[m_currentEdges].resize(0);
+}
+
+void	btSimulationIslandManager::uniteIslandEdge(int elementA, int elementB)
+{
+	btIslandEdge edge;
+	edge.m_elementA = btMin(elementA, elementB);
+	edge.m_elementB = btMax(elementA, elementB);
+	m_islandEdges[m_currentEdges].push_back(edge);
+
+	if (m_unionFind.find(elementA) != m_unionFind.find(elementB))
+	{
+		m_unionFind.unite(elementA, elementB);
+		m_islandsChanged = true;
+	}
+}
+
+void	btSimulationIslandManager::findIncrementalUnions(btCollisionWorld* colWorld)
+{
+	btOverlappingPairCache* pairCachePtr = colWorld->getPairCache();
+	const int numOverlappingPairs = pairCachePtr->getNumOverlappingPairs();
+	if (numOverlappingPairs)
+	{
+		btBroadphasePair* pairPtr = pairCachePtr->getOverlappingPairArrayPtr();
+
+		for (int i=0;i<numOverlappingPairs;i++)
+		{
+			const btBroadphasePair& collisionPair = pairPtr[i];
+			btCollisionObject* colObj0 = (btCollisionObject*)collisionPair.m_pProxy0->m_clientObject;
+			btCollisionObject* colObj1 = (btCollisionObject*)collisionPair.m_pProxy1->m_clientObject;
+
+			if (((colObj0) && ((colObj0)->mergesSimulationIslands())) &&
+				((colObj1) && ((colObj1)->mergesSimulationIslands())))
+			{
+				uniteIslandEdge(colObj0->getIslandTag(), colObj1->getIslandTag());
+			}
+		}
+	}
+}
+
+void	btSimulationIslandManager::addIslandEdge(int islandTagA, int islandTagB)
+{
+	if (m_incrementalIslands)
+	{
+		uniteIslandEdge(islandTagA, islandTagB);
+	} else
+	{
+		m_unionFind.unite(islandTagA, islandTagB);
+	}
+}
+
+static SIMD_FORCE_INLINE unsigned int	getIslandEdgeHash(const btIslandEdge& edge)
+{
+	return (unsigned int)(edge.m_elementA * 73856093) ^ (unsigned int)(edge.m_elementB * 19349663);
+}
+
+static SIMD_FORCE_INLINE bool	equalIslandEdges(const btIslandEdge& edge0, const btIslandEdge& edge1)
+{
+	return edge0.m_elementA == edge1.m_elementA && edge0.m_elementB == edge1.m_elementB;
+}
+
+void	btSimulationIslandManager::splitIslandsWithRemovedEdges()
+{
+	if (m_rebuildIslands)
+	{
+		//the union-find was built from this step's edges only, there is nothing to split
+		m_rebuildIslands = false;
+		return;
+	}
+
+	const btAlignedObjectArray<btIslandEdge>& edges = m_islandEdges[m_currentEdges];
+	const btAlignedObjectArray<btIslandEdge>& previousEdges = m_islandEdges[1 - m_currentEdges];
+	int numEdges = edges.size();
+	int i;
+
+	//common case: a resting or steadily moving scene reports the same pairs in the same order
+	if (numEdges == previousEdges.size())
+	{
+		for (i=0;i<numEdges && equalIslandEdges(edges[i], previousEdges[i]);i++)
+		{
+		}
+		if (i == numEdges)
+		{
+			return;
+		}
+	}
+
+	//look up the previous edges in a hash set of the current edges, open addressing with linear probing
+	int hashSize = 16;
+	while (hashSize < 2 * numEdges)
+	{
+		hashSize *= 2;
+	}
+	int hashMask = hashSize - 1;
+	m_edgeHashTable.resize(hashSize);
+	for (i=0;i<hashSize;i++)
+	{
+		m_edgeHashTable[i] = -1;
+	}
+	for (i=0;i<numEdges;i++)
+	{
+		int slot = getIslandEdgeHash(edges[i]) & hashMask;
+		while (m_edgeHashTable[slot] >= 0)
+		{
+			slot = (slot + 1) & hashMask;
+		}
+		m_edgeHashTable[slot] = i;
+	}
+
+	int numElements = m_unionFind.getNumElements();
+	m_dirtyIslands.resize(numElements);
+	for (i=0;i<numElements;i++)
+	{
+		m_dirtyIslands[i] = 0;
+	}
+
+	bool edgesRemoved = false;
+	for (i=0;i<previousEdges.size();i++)
+	{
+		const btIslandEdge& edge = previousEdges[i];
+		int slot = getIslandEdgeHash(edge) & hashMask;
+		bool found = false;
+		while (m_edgeHashTable[slot] >= 0)
+		{
+			if (equalIslandEdges(edges[m_edgeHashTable[slot]], edge))
+			{
+				found = true;
+				break;
+			}
+			slot = (slot + 1) & hashMask;
+		}
+		if (!found)
+		{
+			m_dirtyIslands[m_unionFind.find(edge.m_elementA)] = 1;
+			edgesRemoved = true;
+		}
+	}
+
+	if (!edgesRemoved)
+	{
+		return;
+	}
+
+	//the islands that lost an edge may fall apart, rebuild only those from the current edges
+	m_elementRoots.resize(numElements);
+	for (i=0;i<numElements;i++)
+	{
+		m_elementRoots[i] = m_unionFind.find(i);
+	}
+	for (i=0;i<numElements;i++)
+	{
+		if (m_dirtyIslands[m_elementRoots[i]])
+		{
+			m_unionFind.getElement(i).m_id = i;
+			m_unionFind.getElement(i).m_sz = 1;
+		}
+	}
+	for (i=0;i<numEdges;i++)
+	{
+		const btIslandEdge& edge = edges[i];
+		if (m_dirtyIslands[m_elementRoots[edge.m_elementA]])
+		{
+			m_unionFind.unite(edge.m_elementA, edge.m_elementB);
+		}
+	}
+	m_islandsChanged = true;
+}
+
+void	btSimulationIslandManager::groupIslandElements()
+{
+	//counting sort of the elements by island id, the island ids are element indices
+	int numElements = m_unionFind.getNumElements();
+	int i;
+	m_elementRoots.resize(numElements);
+	m_islandCounts.resize(numElements + 1);
+	for (i=0;i<=numElements;i++)
+	{
+		m_islandCounts[i] = 0;
+	}
+	for (i=0;i<numElements;i++)
+	{
+		int root = m_unionFind.find(i);
+		m_elementRoots[i] = root;
+		m_islandCounts[root + 1]++;
+	}
+	for (i=0;i<numElements;i++)
+	{
+		m_islandCounts[i + 1] += m_islandCounts[i];
+	}
+	m_islandElements.resize(numElements);
+	for (i=0;i<numElements;i++)
+	{
+		btElement& element = m_islandElements[m_islandCounts[m_elementRoots[i]]++];
+		element.m_id = m_elementRoots[i];
+		element.m_sz = m_elementObjectIndices[i];
+	}
+	m_islandsChanged = false;
+}
+
 #ifdef STATIC_SIMULATION_ISLAND_OPTIMIZATION
 void   btSimulationIslandManager::updateActivationState(btCollisionWorld* colWorld,btDispatcher* dispatcher)
 {
@@ -92,6 +343,13 @@ void   btSimulationIslandManager::updateActivationState(btCollisionWorld* colWor
 	}
 	// do the union find
 
+	if (m_incrementalIslands)
+	{
+		updateIslandElements(colWorld, index);
+		findIncrementalUnions(colWorld);
+		return;
+	}
+
 	initUnionFind( index );
 
 	findUnions(dispatcher,colWorld);
@@ -99,6 +357,11 @@ void   btSimulationIslandManager::updateActivationState(btCollisionWorld* colWor
 
 void   btSimulationIslandManager::storeIslandActivationState(btCollisionWorld* colWorld)
 {
+	if (m_incrementalIslands)
+	{
+		splitIslandsWithRemovedEdges();
+	}
+
 	// put the islandId ('find' value) into m_tag   
 	{
 		int index = 0;
@@ -120,6 +383,15 @@ void   btSimulationIslandManager::storeIslandActivationState(btCollisionWorld* c
 			}
 		}
 	}
+
+	if (m_incrementalIslands)
+	{
+		if (m_islandsChanged)
+		{
+			groupIslandElements();
+		}
+		m_currentEdges = 1 - m_currentEdges;
+	}
 }
 
 
@@ -127,7 +399,10 @@ void   btSimulationIslandManager::storeIslandActivationState(btCollisionWorld* c
 void	btSimulationIslandManager::updateActivationState(btCollisionWorld* colWorld,btDispatcher* dispatcher)
 {
 
-	initUnionFind( int (colWorld->getCollisionObjectArray().size()));
+	if (!m_incrementalIslands)
+	{
+		initUnionFind( int (colWorld->getCollisionObjectArray().size()));
+	}
 
 	// put the index into m_controllers into m_tag	
 	{
@@ -146,11 +421,23 @@ void	btSimulationIslandManager::updateActivationState(btCollisionWorld* colWorld
 	}
 	// do the union find
 
+	if (m_incrementalIslands)
+	{
+		updateIslandElements(colWorld, index);
+		findIncrementalUnions(colWorld);
+		return;
+	}
+
 	findUnions(dispatcher,colWorld);
 }
 
 void	btSimulationIslandManager::storeIslandActivationState(btCollisionWorld* colWorld)
 {
+	if (m_incrementalIslands)
+	{
+		splitIslandsWithRemovedEdges();
+	}
+
 	// put the islandId ('find' value) into m_tag	
 	{
 
@@ -172,6 +459,15 @@ void	btSimulationIslandManager::storeIslandActivationState(btCollisionWorld* col
 			index++;
 		}
 	}
+
+	if (m_incrementalIslands)
+	{
+		if (m_islandsChanged)
+		{
+			groupIslandElements();
+		}
+		m_currentEdges = 1 - m_currentEdges;
+	}
 }
 
 #endif //STATIC_SIMULATION_ISLAND_OPTIMIZATION
@@ -212,8 +508,11 @@ void btSimulationIslandManager::buildIslands(btDispatcher* dispatcher,btCollisio
 	//we are going to sort the unionfind array, and store the element id in the size
 	//afterwards, we clean unionfind, to make sure no-one uses it anymore
 	
-	getUnionFind().sortIslands();
-	int numElem = getUnionFind().getNumElements();
+	if (!m_incrementalIslands)
+	{
+		getUnionFind().sortIslands();
+	}
+	int numElem = getNumIslandElements();
 
 	int endIslandIndex=1;
 	int startIslandIndex;
@@ -222,8 +521,8 @@ void btSimulationIslandManager::buildIslands(btDispatcher* dispatcher,btCollisio
 	//update the sleeping state for bodies, if all are sleeping
 	for ( startIslandIndex=0;startIslandIndex<numElem;startIslandIndex = endIslandIndex)
 	{
-		int islandId = getUnionFind().getElement(startIslandIndex).m_id;
-		for (endIslandIndex = startIslandIndex+1;(endIslandIndex<numElem) && (getUnionFind().getElement(endIslandIndex).m_id == islandId);endIslandIndex++)
+		int islandId = getIslandElement(startIslandIndex).m_id;
+		for (endIslandIndex = startIslandIndex+1;(endIslandIndex<numElem) && (getIslandElement(endIslandIndex).m_id == islandId);endIslandIndex++)
 		{
 		}
 
@@ -234,7 +533,7 @@ void btSimulationIslandManager::buildIslands(btDispatcher* dispatcher,btCollisio
 		int idx;
 		for (idx=startIslandIndex;idx<endIslandIndex;idx++)
 		{
-			int i = getUnionFind().getElement(idx).m_sz;
+			int i = getIslandElement(idx).m_sz;
 
 			btCollisionObject* colObj0 = collisionObjects[i];
 			if ((colObj0->getIslandTag() != islandId) && (colObj0->getIslandTag() != -1))
@@ -262,7 +561,7 @@ void btSimulationIslandManager::buildIslands(btDispatcher* dispatcher,btCollisio
 			int idx;
 			for (idx=startIslandIndex;idx<endIslandIndex;idx++)
 			{
-				int i = getUnionFind().getElement(idx).m_sz;
+				int i = getIslandElement(idx).m_sz;
 				btCollisionObject* colObj0 = collisionObjects[i];
 				if ((colObj0->getIslandTag() != islandId) && (colObj0->getIslandTag() != -1))
 				{
@@ -282,7 +581,7 @@ void btSimulationIslandManager::buildIslands(btDispatcher* dispatcher,btCollisio
 			int idx;
 			for (idx=startIslandIndex;idx<endIslandIndex;idx++)
 			{
-				int i = getUnionFind().getElement(idx).m_sz;
+				int i = getIslandElement(idx).m_sz;
 
 				btCollisionObject* colObj0 = collisionObjects[i];
 				if ((colObj0->getIslandTag() != islandId) && (colObj0->getIslandTag() != -1))
@@ -357,7 +656,7 @@ void btSimulationIslandManager::buildAndProcessIslands(btDispatcher* dispatcher,
 
 	int endIslandIndex=1;
 	int startIslandIndex;
-	int numElem = getUnionFind().getNumElements();
+	int numElem = getNumIslandElements();
 
 	BT_PROFILE("processIslands");
 
@@ -366,6 +665,7 @@ void btSimulationIslandManager::buildAndProcessIslands(btDispatcher* dispatcher,
 		btPersistentManifold** manifold = dispatcher->getInternalManifoldPointer();
 		int maxNumManifolds = dispatcher->getNumManifolds();
 		callback->ProcessIsland(&collisionObjects[0],collisionObjects.size(),manifold,maxNumManifolds, -1);
+		BT_PROFILE_COUNTER(BT_PROFILE_COUNTER_ISLANDS, 1);
 	}
 	else
 	{
@@ -375,13 +675,20 @@ void btSimulationIslandManager::buildAndProcessIslands(btDispatcher* dispatcher,
 
 		int numManifolds = int (m_islandmanifold.size());
 
-		//we should do radix sort, it it much faster (O(n) instead of O (n log2(n))
-		m_islandmanifold.quickSort(btPersistentManifoldSortPredicate());
+		//the incremental islands use a counting sort on the island id, it is O(n) and keeps the dispatcher order within an island
+		if (m_incrementalIslands)
+		{
+			sortIslandManifolds();
+		} else
+		{
+			m_islandmanifold.quickSort(btPersistentManifoldSortPredicate());
+		}
 
 		//now process all active islands (sets of manifolds for now)
 
 		int startManifoldIndex = 0;
 		int endManifoldIndex = 1;
+		int numProcessedIslands = 0;
 
 		//int islandId;
 
@@ -392,14 +699,14 @@ void btSimulationIslandManager::buildAndProcessIslands(btDispatcher* dispatcher,
 		//traverse the simulation islands, and call the solver, unless all objects are sleeping/deactivated
 		for ( startIslandIndex=0;startIslandIndex<numElem;startIslandIndex = endIslandIndex)
 		{
-			int islandId = getUnionFind().getElement(startIslandIndex).m_id;
+			int islandId = getIslandElement(startIslandIndex).m_id;
 
 
 			   bool islandSleeping = true;
 	                
-					for (endIslandIndex = startIslandIndex;(endIslandIndex<numElem) && (getUnionFind().getElement(endIslandIndex).m_id == islandId);endIslandIndex++)
+					for (endIslandIndex = startIslandIndex;(endIslandIndex<numElem) && (getIslandElement(endIslandIndex).m_id == islandId);endIslandIndex++)
 					{
-							int i = getUnionFind().getElement(endIslandIndex).m_sz;
+							int i = getIslandElement(endIslandIndex).m_sz;
 							btCollisionObject* colObj0 = collisionObjects[i];
 							m_islandBodies.push_back(colObj0);
 							if (colObj0->isActive())
@@ -431,6 +738,7 @@ void btSimulationIslandManager::buildAndProcessIslands(btDispatcher* dispatcher,
 			if (!islandSleeping)
 			{
 				callback->ProcessIsland(&m_islandBodies[0],m_islandBodies.size(),startManifold,numIslandManifolds, islandId);
+				numProcessedIslands++;
 	//			printf("Island callback of size:%d bodies, %d manifolds\n",islandBodies.size(),numIslandManifolds);
 			}
 			
@@ -441,6 +749,37 @@ void btSimulationIslandManager::buildAndProcessIslands(btDispatcher* dispatcher,
 
 			m_islandBodies.resize(0);
 		}
+		BT_PROFILE_COUNTER(BT_PROFILE_COUNTER_ISLANDS, numProcessedIslands);
 	} // else if(!splitIslands) 
 
 }
+
+void	btSimulationIslandManager::sortIslandManifolds()
+{
+	//island ids are in [-1, numElements), manifolds between static or kinematic objects go first like in the quick sort
+	int numElements = m_unionFind.getNumElements();
+	int numManifolds = m_islandmanifold.size();
+	int i;
+	m_islandCounts.resize(numElements + 2);
+	for (i=0;i<numElements+2;i++)
+	{
+		m_islandCounts[i] = 0;
+	}
+	for (i=0;i<numManifolds;i++)
+	{
+		m_islandCounts[getIslandId(m_islandmanifold[i]) + 2]++;
+	}
+	for (i=0;i<=numElements;i++)
+	{
+		m_islandCounts[i + 1] += m_islandCounts[i];
+	}
+	m_sortedIslandManifold.resize(numManifolds);
+	for (i=0;i<numManifolds;i++)
+	{
+		m_sortedIslandManifold[m_islandCounts[getIslandId(m_islandmanifold[i]) + 1]++] = m_islandmanifold[i];
+	}
+	for (i=0;i<numManifolds;i++)
+	{
+		m_islandmanifold[i] = m_sortedIslandManifold[i];
+	}
+}
@@ -27,7 +27,17 @@ class btDispatcher;
 class btPersistentManifold;
 
 
+///pair of union-find elements that belong to the same island, see btSimulationIslandManager::addIslandEdge
+struct	btIslandEdge
+{
+	int	m_elementA;
+	int	m_elementB;
+};
+
 ///SimulationIslandManager creates and handles simulation islands, using btUnionFind
+///By default the islands are maintained incrementally: the union-find is kept from one step to the next, new edges
+///(overlapping pairs and constraints) merge islands as they appear, and only the islands that lost an edge since the
+///previous step are split again. When nothing changed, no island is rebuilt and nothing is sorted.
 class btSimulationIslandManager
 {
 	btUnionFind m_unionFind;
@@ -36,6 +46,45 @@ class btSimulationIslandManager
 	btAlignedObjectArray<btCollisionObject* >  m_islandBodies;
 	
 	bool m_splitIslands;
+
+	bool m_incrementalIslands;
+	///the union-find has to be reset, because the island elements changed
+	bool m_rebuildIslands;
+	///the grouping of elements by island (m_islandElements) is out of date
+	bool m_islandsChanged;
+
+	///collision object (and its index in the world) of each union-find element
+	btAlignedObjectArray<btCollisionObject*>	m_elementObjects;
+	btAlignedObjectArray<int>	m_elementObjectIndices;
+	///edges of this step and of the previous step, the current one is m_islandEdges[m_currentEdges]
+	btAlignedObjectArray<btIslandEdge>	m_islandEdges[2];
+	int		m_currentEdges;
+	///elements sorted by island, m_id is the island id and m_sz the object index, like btUnionFind::sortIslands
+	btAlignedObjectArray<btElement>	m_islandElements;
+
+	//scratch memory for splitting and counting sorts
+	btAlignedObjectArray<int>	m_edgeHashTable;
+	btAlignedObjectArray<int>	m_elementRoots;
+	btAlignedObjectArray<unsigned char>	m_dirtyIslands;
+	btAlignedObjectArray<int>	m_islandCounts;
+	btAlignedObjectArray<btPersistentManifold*>	m_sortedIslandManifold;
+
+	void	updateIslandElements(btCollisionWorld* colWorld, int numElements);
+	void	findIncrementalUnions(btCollisionWorld* colWorld);
+	void	uniteIslandEdge(int elementA, int elementB);
+	void	splitIslandsWithRemovedEdges();
+	void	groupIslandElements();
+	void	sortIslandManifolds();
+
+	int		getNumIslandElements() const
+	{
+		return m_incrementalIslands ? m_islandElements.size() : m_unionFind.getNumElements();
+	}
+
+	const btElement&	getIslandElement(int index) const
+	{
+		return m_incrementalIslands ? m_islandElements[index] : m_unionFind.getElement(index);
+	}
 	
 public:
 	btSimulationIslandManager();
@@ -53,6 +102,11 @@ public:
 
 	void	findUnions(btDispatcher* dispatcher,btCollisionWorld* colWorld);
 
+	///joins the islands of two objects for this step, call it between updateActivationState and storeIslandActivationState
+	///with the island tags that updateActivationState assigned. btDiscreteDynamicsWorld uses it for constraints.
+	///uniting through getUnionFind() directly also works, but with incremental islands such a union is never split again
+	void	addIslandEdge(int islandTagA, int islandTagB);
+
 	
 
 	struct	IslandCallback
@@ -75,6 +129,17 @@ public:
 		m_splitIslands = doSplitIslands;
 	}
 
+	bool getIncrementalIslands() const
+	{
+		return m_incrementalIslands;
+	}
+	///switches between incremental island maintenance and a full union-find rebuild each step
+	void setIncrementalIslands(bool incrementalIslands)
+	{
+		m_incrementalIslands = incrementalIslands;
+		m_rebuildIslands = true;
+	}
+
 };
 
 #endif //BT_SIMULATION_ISLAND_MANAGER_H
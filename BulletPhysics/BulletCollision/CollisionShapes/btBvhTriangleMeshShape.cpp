@@ -73,6 +73,19 @@ void	btBvhTriangleMeshShape::partialRefitTree(const btVector3& aabbMin,const btV
 	m_localAabbMax.setMax(aabbMax);
 }
 
+void	btBvhTriangleMeshShape::refitDirtyTriangles()
+{
+	if (!m_dirtyTriangles.isInitialized())
+	{
+		return;
+	}
+	m_bvh->refitDirty(m_meshInterface,m_dirtyTriangles);
+
+	//the root node bounds the refitted tree, conservatively
+	const btQuantizedBvhNode& root = m_bvh->getQuantizedNodeArray()[0];
+	m_localAabbMin = m_bvh->unQuantize(&root.m_quantizedAabbMin[0]);
+	m_localAabbMax = m_bvh->unQuantize(&root.m_quantizedAabbMax[0]);
+}
 
 void	btBvhTriangleMeshShape::refitTree(const btVector3& aabbMin,const btVector3& aabbMax)
 {
@@ -350,6 +363,7 @@ void   btBvhTriangleMeshShape::buildOptimizedBvh()
 	//rebuild the bvh...
 	m_bvh->build(m_meshInterface,m_useQuantizedAabbCompression,m_localAabbMin,m_localAabbMax);
 	m_ownsBvh = true;
+	m_dirtyTriangles.reset();
 }
 
 void   btBvhTriangleMeshShape::setOptimizedBvh(btOptimizedBvh* bvh, const btVector3& scaling)
@@ -359,6 +373,7 @@ void   btBvhTriangleMeshShape::setOptimizedBvh(btOptimizedBvh* bvh, const btVect
 
    m_bvh = bvh;
    m_ownsBvh = false;
+   m_dirtyTriangles.reset();
    // update the scaling without rebuilding the bvh
    if ((getLocalScaling() -scaling).length2() > SIMD_EPSILON)
    {
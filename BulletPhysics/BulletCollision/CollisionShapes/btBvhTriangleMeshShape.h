@@ -35,6 +35,8 @@ ATTRIBUTE_ALIGNED16(class) btBvhTriangleMeshShape : public btTriangleMeshShape
 	bool m_ownsBvh;
 	bool m_pad[11];////need padding due to alignment
 
+	btBvhDirtyTriangleMask	m_dirtyTriangles;
+
 public:
 
 	BT_DECLARE_ALIGNED_ALLOCATOR();
@@ -64,6 +66,20 @@ public:
 	///for a fast incremental refit of parts of the tree. Note: the entire AABB of the tree will become more conservative, it never shrinks
 	void	partialRefitTree(const btVector3& aabbMin,const btVector3& aabbMax);
 
+	///marks a triangle whose vertices moved, for refitDirtyTriangles. Needs a quantized bvh
+	void	markTriangleDirty(int partId, int triangleIndex)
+	{
+		if (!m_dirtyTriangles.isInitialized())
+		{
+			m_bvh->initDirtyMask(m_dirtyTriangles);
+		}
+		m_dirtyTriangles.markTriangle(partId,triangleIndex);
+	}
+
+	///refits only the bvh subtrees that hold a marked triangle, in parallel, and clears the marks.
+	///As for partialRefitTree, the vertices must stay within the bvh aabb the tree was built with
+	void	refitDirtyTriangles();
+
 	//debugging
 	virtual const char*	getName()const {return "BVHTRIANGLEMESH";}
 
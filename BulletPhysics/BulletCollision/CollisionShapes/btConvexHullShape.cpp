@@ -18,6 +18,7 @@ subject to the following restrictions:
 
 #include "LinearMath/btQuaternion.h"
 #include "LinearMath/btSerializer.h"
+#include "LinearMath/btConvexHullComputer.h"
 
 btConvexHullShape ::btConvexHullShape (const btScalar* points,int numPoints,int stride) : btPolyhedralConvexAabbCachingShape ()
 {
@@ -48,31 +49,240 @@ void btConvexHullShape::setLocalScaling(const btVector3& scaling)
 void btConvexHullShape::addPoint(const btVector3& point)
 {
 	m_unscaledPoints.push_back(point);
+	clearSupportGraph();
 	recalcLocalAabb();
 
 }
 
-btVector3	btConvexHullShape::localGetSupportingVertexWithoutMargin(const btVector3& vec)const
+int	btConvexHullShape::getSupportingPointIndex(const btVector3& vec, const btVector3* points, int numPoints, const btVector3& localScaling)
 {
-	btVector3 supVec(btScalar(0.),btScalar(0.),btScalar(0.));
-	btScalar newDot,maxDot = btScalar(-BT_LARGE_FLOAT);
+	btScalar maxDot = btScalar(-BT_LARGE_FLOAT);
+	int ptIndex = -1;
+	int i = 0;
 
-	for (int i=0;i<m_unscaledPoints.size();i++)
+#ifdef BT_USE_SSE
+	if (numPoints >= 8)
 	{
-		btVector3 vtx = m_unscaledPoints[i] * m_localScaling;
+		//transpose four points into x, y and z lanes, the products and sums are rounded in the same order as in the scalar loop
+		const __m128 scaleX = _mm_set1_ps(localScaling.getX());
+		const __m128 scaleY = _mm_set1_ps(localScaling.getY());
+		const __m128 scaleZ = _mm_set1_ps(localScaling.getZ());
+		const __m128 dirX = _mm_set1_ps(vec.getX());
+		const __m128 dirY = _mm_set1_ps(vec.getY());
+		const __m128 dirZ = _mm_set1_ps(vec.getZ());
+		const __m128i four = _mm_set1_epi32(4);
+		__m128 maxDots = _mm_set1_ps(maxDot);
+		__m128i maxIndices = _mm_set1_epi32(-1);
+		__m128i indices = _mm_setr_epi32(0, 1, 2, 3);
+
+		for (; i + 4 <= numPoints; i += 4)
+		{
+			__m128 x = points[i].mVec128;
+			__m128 y = points[i+1].mVec128;
+			__m128 z = points[i+2].mVec128;
+			__m128 w = points[i+3].mVec128;
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			const __m128 dots = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, _mm_mul_ps(x, scaleX)), _mm_mul_ps(dirY, _mm_mul_ps(y, scaleY))), _mm_mul_ps(dirZ, _mm_mul_ps(z, scaleZ)));
+			const __m128 greater = _mm_cmpgt_ps(dots, maxDots);
+			maxDots = _mm_or_ps(_mm_and_ps(greater, dots), _mm_andnot_ps(greater, maxDots));
+			const __m128i greaterMask = _mm_castps_si128(greater);
+			maxIndices = _mm_or_si128(_mm_and_si128(greaterMask, indices), _mm_andnot_si128(greaterMask, maxIndices));
+			indices = _mm_add_epi32(indices, four);
+		}
+
+		//each lane kept its first maximum, so ties between lanes go to the lowest index
+		ATTRIBUTE_ALIGNED16(float laneDots[4]);
+		ATTRIBUTE_ALIGNED16(int laneIndices[4]);
+		_mm_store_ps(laneDots, maxDots);
+		_mm_store_si128((__m128i*)laneIndices, maxIndices);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if ((laneIndices[lane] >= 0) && ((laneDots[lane] > maxDot) || ((laneDots[lane] == maxDot) && (laneIndices[lane] < ptIndex))))
+			{
+				maxDot = laneDots[lane];
+				ptIndex = laneIndices[lane];
+			}
+		}
+	}
+#endif //BT_USE_SSE
 
-		newDot = vec.dot(vtx);
+	for (; i < numPoints; i++)
+	{
+		btVector3 vtx = points[i] * localScaling;
+
+		btScalar newDot = vec.dot(vtx);
 		if (newDot > maxDot)
 		{
 			maxDot = newDot;
-			supVec = vtx;
+			ptIndex = i;
+		}
+	}
+	return ptIndex;
+}
+
+btVector3	btConvexHullShape::localGetSupportingVertexWithoutMargin(const btVector3& vec)const
+{
+	if (hasSupportGraph())
+	{
+		return getScaledPoint(supportGraphClimb(vec * m_localScaling, -1));
+	}
+
+	int ptIndex = getSupportingPointIndex(vec, m_unscaledPoints.size() ? &m_unscaledPoints[0] : 0, m_unscaledPoints.size(), m_localScaling);
+	if (ptIndex < 0)
+	{
+		return btVector3(btScalar(0.),btScalar(0.),btScalar(0.));
+	}
+	return getScaledPoint(ptIndex);
+}
+
+btVector3	btConvexHullShape::localGetSupportingVertexWithoutMarginWarmStart(const btVector3& vec, int& vertexHint) const
+{
+	if (hasSupportGraph())
+	{
+		vertexHint = supportGraphClimb(vec * m_localScaling, vertexHint);
+		return getScaledPoint(vertexHint);
+	}
+
+	vertexHint = getSupportingPointIndex(vec, m_unscaledPoints.size() ? &m_unscaledPoints[0] : 0, m_unscaledPoints.size(), m_localScaling);
+	if (vertexHint < 0)
+	{
+		return btVector3(btScalar(0.),btScalar(0.),btScalar(0.));
+	}
+	return getScaledPoint(vertexHint);
+}
+
+void	btConvexHullShape::initializeSupportGraph()
+{
+	clearSupportGraph();
+
+	int numPoints = m_unscaledPoints.size();
+	if (numPoints < BT_CONVEX_HULL_SUPPORT_GRAPH_MIN_POINTS)
+	{
+		return;
+	}
+
+	btConvexHullComputer conv;
+	conv.compute(&m_unscaledPoints[0].getX(), sizeof(btVector3), numPoints, 0.f, 0.f);
+	int numVertices = conv.vertices.size();
+	if (numVertices == 0)
+	{
+		return;
+	}
+
+	//each directed hull edge adds its target to the neighbors of its source, in the numbering of m_unscaledPoints
+	m_supportGraphOffsets.resize(numPoints + 1, 0);
+	int numEdges = conv.edges.size();
+	for (int i = 0; i < numEdges; i++)
+	{
+		int source = conv.originalVertexIndices[conv.edges[i].getSourceVertex()];
+		m_supportGraphOffsets[source + 1]++;
+	}
+	for (int i = 0; i < numPoints; i++)
+	{
+		m_supportGraphOffsets[i + 1] += m_supportGraphOffsets[i];
+	}
+	btAlignedObjectArray<int> fill;
+	fill.resize(numPoints);
+	for (int i = 0; i < numPoints; i++)
+	{
+		fill[i] = m_supportGraphOffsets[i];
+	}
+	m_supportGraphNeighbors.resize(numEdges);
+	for (int i = 0; i < numEdges; i++)
+	{
+		int source = conv.originalVertexIndices[conv.edges[i].getSourceVertex()];
+		int target = conv.originalVertexIndices[conv.edges[i].getTargetVertex()];
+		m_supportGraphNeighbors[fill[source]++] = target;
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int minVertex = conv.originalVertexIndices[0];
+		int maxVertex = minVertex;
+		for (int i = 1; i < numVertices; i++)
+		{
+			int vertex = conv.originalVertexIndices[i];
+			if (m_unscaledPoints[vertex][axis] < m_unscaledPoints[minVertex][axis])
+			{
+				minVertex = vertex;
+			}
+			if (m_unscaledPoints[vertex][axis] > m_unscaledPoints[maxVertex][axis])
+			{
+				maxVertex = vertex;
+			}
+		}
+		m_supportGraphStarts[2 * axis] = minVertex;
+		m_supportGraphStarts[2 * axis + 1] = maxVertex;
+	}
+}
+
+void	btConvexHullShape::clearSupportGraph()
+{
+	m_supportGraphOffsets.clear();
+	m_supportGraphNeighbors.clear();
+}
+
+///steepest ascent along the hull edges. On a convex hull, a vertex without a better neighbor is a support vertex.
+int	btConvexHullShape::supportGraphClimb(const btVector3& scaledDir, int startVertex) const
+{
+	const btVector3* points = &m_unscaledPoints[0];
+	int current = startVertex;
+	if ((current < 0) || (current >= m_unscaledPoints.size()) || (m_supportGraphOffsets[current] == m_supportGraphOffsets[current + 1]))
+	{
+		current = m_supportGraphStarts[0];
+		btScalar startDot = scaledDir.dot(points[current]);
+		for (int i = 1; i < 6; i++)
+		{
+			btScalar dot = scaledDir.dot(points[m_supportGraphStarts[i]]);
+			if (dot > startDot)
+			{
+				startDot = dot;
+				current = m_supportGraphStarts[i];
+			}
 		}
 	}
-	return supVec;
+
+	btScalar maxDot = scaledDir.dot(points[current]);
+	for (;;)
+	{
+		int next = current;
+		int end = m_supportGraphOffsets[current + 1];
+		for (int k = m_supportGraphOffsets[current]; k < end; k++)
+		{
+			int neighbor = m_supportGraphNeighbors[k];
+			btScalar dot = scaledDir.dot(points[neighbor]);
+			if (dot > maxDot)
+			{
+				maxDot = dot;
+				next = neighbor;
+			}
+		}
+		if (next == current)
+		{
+			return current;
+		}
+		current = next;
+	}
 }
 
 void	btConvexHullShape::batchedUnitVectorGetSupportingVertexWithoutMargin(const btVector3* vectors,btVector3* supportVerticesOut,int numVectors) const
 {
+	if (hasSupportGraph())
+	{
+		//consecutive directions are usually close, so each climb starts at the previous support vertex
+		int vertexHint = -1;
+		for (int j=0;j<numVectors;j++)
+		{
+			vertexHint = supportGraphClimb(vectors[j] * m_localScaling, vertexHint);
+			btVector3 vtx = getScaledPoint(vertexHint);
+			btScalar dot = vectors[j].dot(vtx);
+			//WARNING: don't swap next lines, the w component would get overwritten!
+			supportVerticesOut[j] = vtx;
+			supportVerticesOut[j][3] = dot;
+		}
+		return;
+	}
+
 	btScalar newDot;
 	//use 'w' component of supportVerticesOut?
 	{
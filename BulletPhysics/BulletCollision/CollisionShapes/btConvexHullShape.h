@@ -20,6 +20,8 @@ subject to the following restrictions:
 #include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h" // for the types
 #include "LinearMath/btAlignedObjectArray.h"
 
+///initializeSupportGraph leaves hulls with fewer points to the linear scan, which is faster for them
+#define BT_CONVEX_HULL_SUPPORT_GRAPH_MIN_POINTS 64
 
 ///The btConvexHullShape implements an implicit convex hull of an array of vertices.
 ///Bullet provides a general and fast collision detector for convex shapes based on GJK and EPA using localGetSupportingVertex.
@@ -27,6 +29,15 @@ ATTRIBUTE_ALIGNED16(class) btConvexHullShape : public btPolyhedralConvexAabbCach
 {
 	btAlignedObjectArray<btVector3>	m_unscaledPoints;
 
+	///vertex adjacency of the hull, the neighbors of point i are m_supportGraphNeighbors[m_supportGraphOffsets[i]..m_supportGraphOffsets[i+1]-1]
+	///points that are not hull vertices have no neighbors. Both arrays are empty when there is no support graph.
+	btAlignedObjectArray<int>	m_supportGraphOffsets;
+	btAlignedObjectArray<int>	m_supportGraphNeighbors;
+	///hull vertices that are extreme along -x,+x,-y,+y,-z,+z, the hill climbing starts at the best of them when it has no hint
+	int		m_supportGraphStarts[6];
+
+	int		supportGraphClimb(const btVector3& scaledDir, int startVertex) const;
+
 public:
 	BT_DECLARE_ALIGNED_ALLOCATOR();
 
@@ -71,6 +82,29 @@ public:
 	virtual btVector3	localGetSupportingVertex(const btVector3& vec)const;
 	virtual btVector3	localGetSupportingVertexWithoutMargin(const btVector3& vec)const;
 	virtual void	batchedUnitVectorGetSupportingVertexWithoutMargin(const btVector3* vectors,btVector3* supportVerticesOut,int numVectors) const;
+
+	///initializeSupportGraph computes the convex hull of the points with btConvexHullComputer and keeps the vertex adjacency of the hull.
+	///Support queries then climb along hull edges towards the support direction instead of scanning all points.
+	///Hulls with fewer than BT_CONVEX_HULL_SUPPORT_GRAPH_MIN_POINTS points keep using the linear scan.
+	///The graph lives in the quantized space of btConvexHullComputer, so points within its precision (about 1e-4 of the extents)
+	///of the hull surface may be skipped. addPoint clears the graph, call initializeSupportGraph again after changing the points.
+	void	initializeSupportGraph();
+
+	void	clearSupportGraph();
+
+	bool	hasSupportGraph() const
+	{
+		return m_supportGraphOffsets.size() > 0;
+	}
+
+	///same as localGetSupportingVertexWithoutMargin, but the hill climbing starts at vertexHint and the index of the support point
+	///is stored back into it. Callers that keep one hint per shape and pair (see btGjkPairDetector) warm-start the next query
+	///along a similar direction. A hint of -1 starts from the axis extremes. Without support graph this is a linear scan.
+	btVector3	localGetSupportingVertexWithoutMarginWarmStart(const btVector3& vec, int& vertexHint) const;
+
+	///index of the first of the points that has the largest dot product with vec after scaling by localScaling, -1 if there is none.
+	///Scans four points at a time when BT_USE_SSE is defined, with the same result as the scalar loop.
+	static int	getSupportingPointIndex(const btVector3& vec, const btVector3* points, int numPoints, const btVector3& localScaling);
 	
 
 	virtual void project(const btTransform& trans, const btVector3& dir, float& min, float& max) const;
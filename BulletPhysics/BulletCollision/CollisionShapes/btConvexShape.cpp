@@ -109,19 +109,8 @@ static btVector3 convexHullSupport (const btVector3& localDirOrg, const btVector
 	return supVec;
 #else
 
-	btScalar newDot,maxDot = btScalar(-BT_LARGE_FLOAT);
-	int ptIndex = -1;
-
-	for (int i=0;i<numPoints;i++)
-	{
-
-		newDot = vec.dot(points[i]);
-		if (newDot > maxDot)
-		{
-			maxDot = newDot;
-			ptIndex = i;
-		}
-	}
+	//vec is scaled already, scaling the points by one leaves the dot products unchanged
+	int ptIndex = btConvexHullShape::getSupportingPointIndex(vec, points, numPoints, btVector3(btScalar(1.),btScalar(1.),btScalar(1.)));
 	btAssert(ptIndex >= 0);
 	btVector3 supVec = points[ptIndex] * localScaling;
 	return supVec;
@@ -279,6 +268,12 @@ btVector3 btConvexShape::localGetSupportVertexWithoutMarginNonVirtual (const btV
 	case CONVEX_HULL_SHAPE_PROXYTYPE:
 	{
 		btConvexHullShape* convexHullShape = (btConvexHullShape*)this;
+#ifndef __SPU__
+		if (convexHullShape->hasSupportGraph())
+		{
+			return convexHullShape->btConvexHullShape::localGetSupportingVertexWithoutMargin(localDir);
+		}
+#endif //__SPU__
 		btVector3* points = convexHullShape->getUnscaledPoints();
 		int numPoints = convexHullShape->getNumPoints ();
 		return convexHullSupport (localDir, points, numPoints,convexHullShape->getLocalScalingNV());
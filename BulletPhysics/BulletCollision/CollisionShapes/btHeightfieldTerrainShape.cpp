@@ -16,6 +16,7 @@ subject to the following restrictions:
 #include "btHeightfieldTerrainShape.h"
 
 #include "LinearMath/btTransformUtil.h"
+#include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
 
 
 
@@ -357,13 +358,36 @@ void	btHeightfieldTerrainShape::processAllTriangles(btTriangleCallback* callback
 	
   
 
+	if (hasAccelerator())
+	{
+		//only descend into the parts of the grid whose heights overlap the query
+		btScalar minHeight = btMin(localAabbMin[m_upAxis], localAabbMax[m_upAxis]);
+		btScalar maxHeight = btMax(localAabbMin[m_upAxis], localAabbMax[m_upAxis]);
+		int topLevel = m_quadtreeLevelOffsets.size() - 1;
+		for (int nodeJ = 0; nodeJ < m_quadtreeLevelLengths[topLevel]; nodeJ++)
+		{
+			for (int nodeX = 0; nodeX < m_quadtreeLevelWidths[topLevel]; nodeX++)
+			{
+				processNodeTriangles(callback, topLevel, nodeX, nodeJ, startX, startJ, endX, endJ, minHeight, maxHeight);
+			}
+		}
+		return;
+	}
+
 	for(int j=startJ; j<endJ; j++)
 	{
 		for(int x=startX; x<endX; x++)
 		{
-			btVector3 vertices[3];
-			if (m_flipQuadEdges || (m_useDiamondSubdivision && !((j+x) & 1)))
-			{
+			processCell(callback, x, j);
+		}
+	}
+}
+
+void	btHeightfieldTerrainShape::processCell(btTriangleCallback* callback, int x, int j) const
+{
+	btVector3 vertices[3];
+	if (m_flipQuadEdges || (m_useDiamondSubdivision && !((j+x) & 1)))
+	{
         //first triangle
         getVertex(x,j,vertices[0]);
         getVertex(x+1,j,vertices[1]);
@@ -374,8 +398,8 @@ void	btHeightfieldTerrainShape::processAllTriangles(btTriangleCallback* callback
         getVertex(x+1,j+1,vertices[1]);
         getVertex(x,j+1,vertices[2]);
         callback->processTriangle(vertices,x,j);				
-			} else
-			{
+	} else
+	{
         //first triangle
         getVertex(x,j,vertices[0]);
         getVertex(x,j+1,vertices[1]);
@@ -386,12 +410,7 @@ void	btHeightfieldTerrainShape::processAllTriangles(btTriangleCallback* callback
         getVertex(x,j+1,vertices[1]);
         getVertex(x+1,j+1,vertices[2]);
         callback->processTriangle(vertices,x,j);
-			}
-		}
 	}
-
-	
-
 }
 
 void	btHeightfieldTerrainShape::calculateLocalInertia(btScalar ,btVector3& inertia) const
@@ -409,3 +428,278 @@ const btVector3& btHeightfieldTerrainShape::getLocalScaling() const
 {
 	return m_localScaling;
 }
+
+///the raw coordinate axes along the grid x and j directions
+static inline void	getGridAxes(int upAxis, int& axisX, int& axisJ)
+{
+	axisX = upAxis == 0 ? 1 : 0;
+	axisJ = upAxis == 2 ? 1 : 2;
+}
+
+void	btHeightfieldTerrainShape::getCellHeightRange(int x, int j, btScalar& minHeight, btScalar& maxHeight) const
+{
+	btScalar h00 = getRawHeightFieldValue(x, j);
+	btScalar h10 = getRawHeightFieldValue(x + 1, j);
+	btScalar h01 = getRawHeightFieldValue(x, j + 1);
+	btScalar h11 = getRawHeightFieldValue(x + 1, j + 1);
+	minHeight = btMin(btMin(h00, h10), btMin(h01, h11));
+	maxHeight = btMax(btMax(h00, h10), btMax(h01, h11));
+}
+
+void	btHeightfieldTerrainShape::getNodeCellRange(int level, int nodeX, int nodeJ, int& startX, int& startJ, int& endX, int& endJ) const
+{
+	int nodeCells = BT_HEIGHTFIELD_CHUNK_SIZE << level;
+	startX = nodeX * nodeCells;
+	startJ = nodeJ * nodeCells;
+	endX = btMin(startX + nodeCells, m_heightStickWidth - 1);
+	endJ = btMin(startJ + nodeCells, m_heightStickLength - 1);
+}
+
+void	btHeightfieldTerrainShape::buildAccelerator()
+{
+	clearAccelerator();
+
+	//level 0, one node per chunk, including the vertices on the far edges of the chunk
+	int width = (m_heightStickWidth - 1 + BT_HEIGHTFIELD_CHUNK_SIZE - 1) / BT_HEIGHTFIELD_CHUNK_SIZE;
+	int length = (m_heightStickLength - 1 + BT_HEIGHTFIELD_CHUNK_SIZE - 1) / BT_HEIGHTFIELD_CHUNK_SIZE;
+	m_quadtreeLevelOffsets.push_back(0);
+	m_quadtreeLevelWidths.push_back(width);
+	m_quadtreeLevelLengths.push_back(length);
+	m_quadtreeNodes.resize(width * length);
+	int nodeX, nodeJ;
+	for (nodeJ = 0; nodeJ < length; nodeJ++)
+	{
+		for (nodeX = 0; nodeX < width; nodeX++)
+		{
+			int startX, startJ, endX, endJ;
+			getNodeCellRange(0, nodeX, nodeJ, startX, startJ, endX, endJ);
+			btHeightfieldNode& node = m_quadtreeNodes[nodeJ * width + nodeX];
+			node.m_minHeight = btScalar(BT_LARGE_FLOAT);
+			node.m_maxHeight = -btScalar(BT_LARGE_FLOAT);
+			for (int j = startJ; j <= endJ; j++)
+			{
+				for (int x = startX; x <= endX; x++)
+				{
+					btScalar height = getRawHeightFieldValue(x, j);
+					node.m_minHeight = btMin(node.m_minHeight, height);
+					node.m_maxHeight = btMax(node.m_maxHeight, height);
+				}
+			}
+		}
+	}
+
+	//every next level merges 2x2 nodes of the previous one, until a single root remains
+	while (width > 1 || length > 1)
+	{
+		int childLevel = m_quadtreeLevelOffsets.size() - 1;
+		int childOffset = m_quadtreeLevelOffsets[childLevel];
+		int childWidth = width;
+		int childLength = length;
+		width = (width + 1) / 2;
+		length = (length + 1) / 2;
+		int offset = m_quadtreeNodes.size();
+		m_quadtreeLevelOffsets.push_back(offset);
+		m_quadtreeLevelWidths.push_back(width);
+		m_quadtreeLevelLengths.push_back(length);
+		m_quadtreeNodes.resize(offset + width * length);
+		for (nodeJ = 0; nodeJ < length; nodeJ++)
+		{
+			for (nodeX = 0; nodeX < width; nodeX++)
+			{
+				btHeightfieldNode& node = m_quadtreeNodes[offset + nodeJ * width + nodeX];
+				node.m_minHeight = btScalar(BT_LARGE_FLOAT);
+				node.m_maxHeight = -btScalar(BT_LARGE_FLOAT);
+				for (int childJ = nodeJ * 2; childJ < btMin(nodeJ * 2 + 2, childLength); childJ++)
+				{
+					for (int childX = nodeX * 2; childX < btMin(nodeX * 2 + 2, childWidth); childX++)
+					{
+						const btHeightfieldNode& child = m_quadtreeNodes[childOffset + childJ * childWidth + childX];
+						node.m_minHeight = btMin(node.m_minHeight, child.m_minHeight);
+						node.m_maxHeight = btMax(node.m_maxHeight, child.m_maxHeight);
+					}
+				}
+			}
+		}
+	}
+}
+
+void	btHeightfieldTerrainShape::clearAccelerator()
+{
+	m_quadtreeNodes.clear();
+	m_quadtreeLevelOffsets.clear();
+	m_quadtreeLevelWidths.clear();
+	m_quadtreeLevelLengths.clear();
+}
+
+void	btHeightfieldTerrainShape::processNodeTriangles(btTriangleCallback* callback, int level, int nodeX, int nodeJ,
+	int startX, int startJ, int endX, int endJ, btScalar minHeight, btScalar maxHeight) const
+{
+	const btHeightfieldNode& node = getNode(level, nodeX, nodeJ);
+	if (node.m_maxHeight < minHeight || node.m_minHeight > maxHeight)
+	{
+		return;
+	}
+
+	int nodeStartX, nodeStartJ, nodeEndX, nodeEndJ;
+	getNodeCellRange(level, nodeX, nodeJ, nodeStartX, nodeStartJ, nodeEndX, nodeEndJ);
+	nodeStartX = btMax(nodeStartX, startX);
+	nodeStartJ = btMax(nodeStartJ, startJ);
+	nodeEndX = btMin(nodeEndX, endX);
+	nodeEndJ = btMin(nodeEndJ, endJ);
+	if (nodeStartX >= nodeEndX || nodeStartJ >= nodeEndJ)
+	{
+		return;
+	}
+
+	if (level == 0)
+	{
+		for (int j = nodeStartJ; j < nodeEndJ; j++)
+		{
+			for (int x = nodeStartX; x < nodeEndX; x++)
+			{
+				btScalar cellMinHeight, cellMaxHeight;
+				getCellHeightRange(x, j, cellMinHeight, cellMaxHeight);
+				if (cellMaxHeight >= minHeight && cellMinHeight <= maxHeight)
+				{
+					processCell(callback, x, j);
+				}
+			}
+		}
+		return;
+	}
+
+	int childLevel = level - 1;
+	for (int childJ = nodeJ * 2; childJ < btMin(nodeJ * 2 + 2, m_quadtreeLevelLengths[childLevel]); childJ++)
+	{
+		for (int childX = nodeX * 2; childX < btMin(nodeX * 2 + 2, m_quadtreeLevelWidths[childLevel]); childX++)
+		{
+			processNodeTriangles(callback, childLevel, childX, childJ, startX, startJ, endX, endJ, minHeight, maxHeight);
+		}
+	}
+}
+
+btScalar	btHeightfieldTerrainShape::rayGridBox(const btVector3& raySource, const btVector3& rayDirectionInverse, int startX, int startJ, int endX, int endJ, btScalar minHeight, btScalar maxHeight) const
+{
+	//grow the box a little, so rays along cell borders don't slip through
+	const btScalar padding = btScalar(0.001);
+	int axisX, axisJ;
+	getGridAxes(m_upAxis, axisX, axisJ);
+	btVector3 boxMin, boxMax;
+	boxMin[axisX] = btScalar(startX) - padding;
+	boxMax[axisX] = btScalar(endX) + padding;
+	boxMin[axisJ] = btScalar(startJ) - padding;
+	boxMax[axisJ] = btScalar(endJ) + padding;
+	boxMin[m_upAxis] = minHeight - padding;
+	boxMax[m_upAxis] = maxHeight + padding;
+
+	btScalar tNear = btScalar(0.);
+	btScalar tFar = btScalar(1.);
+	for (int i = 0; i < 3; i++)
+	{
+		btScalar t0 = (boxMin[i] - raySource[i]) * rayDirectionInverse[i];
+		btScalar t1 = (boxMax[i] - raySource[i]) * rayDirectionInverse[i];
+		tNear = btMax(tNear, btMin(t0, t1));
+		tFar = btMin(tFar, btMax(t0, t1));
+	}
+	return tNear <= tFar ? tNear : btScalar(2.);
+}
+
+void	btHeightfieldTerrainShape::raycastNode(btTriangleRaycastCallback* callback, int level, int nodeX, int nodeJ,
+	const btVector3& raySource, const btVector3& rayDirectionInverse) const
+{
+	if (level == 0)
+	{
+		int startX, startJ, endX, endJ;
+		getNodeCellRange(0, nodeX, nodeJ, startX, startJ, endX, endJ);
+		for (int j = startJ; j < endJ; j++)
+		{
+			for (int x = startX; x < endX; x++)
+			{
+				btScalar cellMinHeight, cellMaxHeight;
+				getCellHeightRange(x, j, cellMinHeight, cellMaxHeight);
+				if (rayGridBox(raySource, rayDirectionInverse, x, j, x + 1, j + 1, cellMinHeight, cellMaxHeight) <= callback->m_hitFraction)
+				{
+					processCell(callback, x, j);
+				}
+			}
+		}
+		return;
+	}
+
+	//visit the children that the ray enters, nearest first
+	int childLevel = level - 1;
+	int children[4][2];
+	btScalar entries[4];
+	int numChildren = 0;
+	for (int childJ = nodeJ * 2; childJ < btMin(nodeJ * 2 + 2, m_quadtreeLevelLengths[childLevel]); childJ++)
+	{
+		for (int childX = nodeX * 2; childX < btMin(nodeX * 2 + 2, m_quadtreeLevelWidths[childLevel]); childX++)
+		{
+			int startX, startJ, endX, endJ;
+			getNodeCellRange(childLevel, childX, childJ, startX, startJ, endX, endJ);
+			const btHeightfieldNode& child = getNode(childLevel, childX, childJ);
+			btScalar entry = rayGridBox(raySource, rayDirectionInverse, startX, startJ, endX, endJ, child.m_minHeight, child.m_maxHeight);
+			if (entry > callback->m_hitFraction)
+			{
+				continue;
+			}
+			int i = numChildren++;
+			for (; i > 0 && entries[i - 1] > entry; i--)
+			{
+				entries[i] = entries[i - 1];
+				children[i][0] = children[i - 1][0];
+				children[i][1] = children[i - 1][1];
+			}
+			entries[i] = entry;
+			children[i][0] = childX;
+			children[i][1] = childJ;
+		}
+	}
+
+	for (int i = 0; i < numChildren; i++)
+	{
+		//an earlier child may have found a closer hit
+		if (entries[i] <= callback->m_hitFraction)
+		{
+			raycastNode(callback, childLevel, children[i][0], children[i][1], raySource, rayDirectionInverse);
+		}
+	}
+}
+
+void	btHeightfieldTerrainShape::performRaycast(btTriangleRaycastCallback* callback, const btVector3& raySource, const btVector3& rayTarget) const
+{
+	if (!hasAccelerator())
+	{
+		btVector3 rayAabbMin = raySource;
+		rayAabbMin.setMin(rayTarget);
+		btVector3 rayAabbMax = raySource;
+		rayAabbMax.setMax(rayTarget);
+		processAllTriangles(callback, rayAabbMin, rayAabbMax);
+		return;
+	}
+
+	//traverse in raw heightfield coordinates, where the grid cells are unit squares. The mapping is affine,
+	//so the ray parameter is the same as in local space
+	btVector3 inverseScaling(btScalar(1.) / m_localScaling[0], btScalar(1.) / m_localScaling[1], btScalar(1.) / m_localScaling[2]);
+	btVector3 source = raySource * inverseScaling + m_localOrigin;
+	btVector3 direction = (rayTarget - raySource) * inverseScaling;
+	btVector3 directionInverse(
+		direction[0] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[0],
+		direction[1] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[1],
+		direction[2] == btScalar(0.0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1.0) / direction[2]);
+
+	int topLevel = m_quadtreeLevelOffsets.size() - 1;
+	for (int nodeJ = 0; nodeJ < m_quadtreeLevelLengths[topLevel]; nodeJ++)
+	{
+		for (int nodeX = 0; nodeX < m_quadtreeLevelWidths[topLevel]; nodeX++)
+		{
+			int startX, startJ, endX, endJ;
+			getNodeCellRange(topLevel, nodeX, nodeJ, startX, startJ, endX, endJ);
+			const btHeightfieldNode& node = getNode(topLevel, nodeX, nodeJ);
+			if (rayGridBox(source, directionInverse, startX, startJ, endX, endJ, node.m_minHeight, node.m_maxHeight) <= callback->m_hitFraction)
+			{
+				raycastNode(callback, topLevel, nodeX, nodeJ, source, directionInverse);
+			}
+		}
+	}
+}
@@ -17,6 +17,21 @@ subject to the following restrictions:
 #define BT_HEIGHTFIELD_TERRAIN_SHAPE_H
 
 #include "btConcaveShape.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btTriangleRaycastCallback;
+
+///number of grid cells along each side of a leaf of the btHeightfieldTerrainShape min/max quadtree
+#ifndef BT_HEIGHTFIELD_CHUNK_SIZE
+#define BT_HEIGHTFIELD_CHUNK_SIZE 8
+#endif
+
+///raw height range of a node of the btHeightfieldTerrainShape min/max quadtree
+struct btHeightfieldNode
+{
+	btScalar	m_minHeight;
+	btScalar	m_maxHeight;
+};
 
 ///btHeightfieldTerrainShape simulates a 2D heightfield terrain
 /**
@@ -61,6 +76,11 @@ subject to the following restrictions:
        point.  heightScale is ignored when using the float heightfield
        data type.
 
+  buildAccelerator() builds a min/max height quadtree over the heightfield. Once
+  it is built, processAllTriangles skips the parts of the grid that are entirely
+  above or below the query AABB, and performRaycast only visits the cells along
+  the ray. Call it again after changing the height data.
+
   Whatever the caller specifies as minHeight and maxHeight will be honored.
   The class will not inspect the heightfield to discover the actual minimum
   or maximum heights.  These values are used to determine the heightfield's
@@ -99,10 +119,34 @@ protected:
 	
 	btVector3	m_localScaling;
 
+	///min/max quadtree, level 0 has one node per chunk of BT_HEIGHTFIELD_CHUNK_SIZE x BT_HEIGHTFIELD_CHUNK_SIZE cells,
+	///each next level halves the resolution down to a single root node. Empty when there is no accelerator
+	btAlignedObjectArray<btHeightfieldNode>	m_quadtreeNodes;
+	btAlignedObjectArray<int>	m_quadtreeLevelOffsets;
+	btAlignedObjectArray<int>	m_quadtreeLevelWidths;
+	btAlignedObjectArray<int>	m_quadtreeLevelLengths;
+
 	virtual btScalar	getRawHeightFieldValue(int x,int y) const;
 	void		quantizeWithClamp(int* out, const btVector3& point,int isMax) const;
 	void		getVertex(int x,int y,btVector3& vertex) const;
 
+	///emits the two triangles of the grid cell at (x,j)
+	void		processCell(btTriangleCallback* callback, int x, int j) const;
+	///raw height range of the four corners of the grid cell at (x,j)
+	void		getCellHeightRange(int x, int j, btScalar& minHeight, btScalar& maxHeight) const;
+	///range of grid cells covered by a quadtree node, the end indices are exclusive
+	void		getNodeCellRange(int level, int nodeX, int nodeJ, int& startX, int& startJ, int& endX, int& endJ) const;
+	const btHeightfieldNode&	getNode(int level, int nodeX, int nodeJ) const
+	{
+		return m_quadtreeNodes[m_quadtreeLevelOffsets[level] + nodeJ * m_quadtreeLevelWidths[level] + nodeX];
+	}
+	void		processNodeTriangles(btTriangleCallback* callback, int level, int nodeX, int nodeJ,
+		int startX, int startJ, int endX, int endJ, btScalar minHeight, btScalar maxHeight) const;
+	void		raycastNode(btTriangleRaycastCallback* callback, int level, int nodeX, int nodeJ,
+		const btVector3& raySource, const btVector3& rayDirectionInverse) const;
+	///slab test of the ray against a box of the grid, in raw heightfield coordinates. Returns the entry parameter, or a value larger than 1 on a miss
+	btScalar	rayGridBox(const btVector3& raySource, const btVector3& rayDirectionInverse, int startX, int startJ, int endX, int endJ, btScalar minHeight, btScalar maxHeight) const;
+
 
 
 	/// protected initialization
@@ -147,6 +191,22 @@ public:
 
 	virtual void	processAllTriangles(btTriangleCallback* callback,const btVector3& aabbMin,const btVector3& aabbMax) const;
 
+	///reports the triangles along the ray from raySource to rayTarget (in local space) to the callback, nearest first.
+	///Subtrees that start beyond the callback's m_hitFraction are skipped. Without an accelerator this is
+	///processAllTriangles over the AABB of the ray
+	void	performRaycast(btTriangleRaycastCallback* callback, const btVector3& raySource, const btVector3& rayTarget) const;
+
+	///builds the min/max height quadtree from the height data, call it again whenever the heights change
+	void	buildAccelerator();
+
+	///releases the quadtree, queries go back to walking the grid
+	void	clearAccelerator();
+
+	bool	hasAccelerator() const
+	{
+		return m_quadtreeNodes.size() != 0;
+	}
+
 	virtual void	calculateLocalInertia(btScalar mass,btVector3& inertia) const;
 
 	virtual void	setLocalScaling(const btVector3& scaling);
@@ -18,6 +18,8 @@ subject to the following restrictions:
 #include "btStridingMeshInterface.h"
 #include "LinearMath/btAabbUtil2.h"
 #include "LinearMath/btIDebugDraw.h"
+#include "LinearMath/btThreads.h"
+#include "LinearMath/btQuickprof.h"
 
 
 btOptimizedBvh::btOptimizedBvh()
@@ -179,9 +181,15 @@ void btOptimizedBvh::build(btStridingMeshInterface* triangles, bool useQuantized
 		m_contiguousNodes.resize(2*numLeafNodes);
 	}
 
-	m_curNodeIndex = 0;
+	if (m_buildMode == BUILD_BINNED_SAH)
+	{
+		buildTreeBinnedSah(numLeafNodes);
+	} else
+	{
+		m_curNodeIndex = 0;
 
-	buildTree(0,numLeafNodes);
+		buildTree(0,numLeafNodes);
+	}
 
 	///if the entire tree is small then subtree size, we need to create a header info for the tree
 	if(m_useQuantization && !m_SubtreeHeaders.size())
@@ -269,6 +277,25 @@ void	btOptimizedBvh::refitPartial(btStridingMeshInterface* meshInterface,const b
 	
 }
 
+static SIMD_FORCE_INLINE void	mergeChildAabbs(btQuantizedBvhNode* nodes, int nodeIndex)
+{
+	btQuantizedBvhNode& curNode = nodes[nodeIndex];
+	btQuantizedBvhNode* leftChildNode = &nodes[nodeIndex+1];
+	btQuantizedBvhNode* rightChildNode = leftChildNode->isLeafNode() ? &nodes[nodeIndex+2] :
+		&nodes[nodeIndex+1+leftChildNode->getEscapeIndex()];
+
+	for (int i=0;i<3;i++)
+	{
+		curNode.m_quantizedAabbMin[i] = leftChildNode->m_quantizedAabbMin[i];
+		if (curNode.m_quantizedAabbMin[i]>rightChildNode->m_quantizedAabbMin[i])
+			curNode.m_quantizedAabbMin[i]=rightChildNode->m_quantizedAabbMin[i];
+
+		curNode.m_quantizedAabbMax[i] = leftChildNode->m_quantizedAabbMax[i];
+		if (curNode.m_quantizedAabbMax[i] < rightChildNode->m_quantizedAabbMax[i])
+			curNode.m_quantizedAabbMax[i] = rightChildNode->m_quantizedAabbMax[i];
+	}
+}
+
 void	btOptimizedBvh::updateBvhNodes(btStridingMeshInterface* meshInterface,int firstNode,int endNode,int index)
 {
 	(void)index;
@@ -353,24 +380,7 @@ void	btOptimizedBvh::updateBvhNodes(btStridingMeshInterface* meshInterface,int f
 			{
 				//combine aabb from both children
 
-				btQuantizedBvhNode* leftChildNode = &m_quantizedContiguousNodes[i+1];
-				
-				btQuantizedBvhNode* rightChildNode = leftChildNode->isLeafNode() ? &m_quantizedContiguousNodes[i+2] :
-					&m_quantizedContiguousNodes[i+1+leftChildNode->getEscapeIndex()];
-				
-
-				{
-					for (int i=0;i<3;i++)
-					{
-						curNode.m_quantizedAabbMin[i] = leftChildNode->m_quantizedAabbMin[i];
-						if (curNode.m_quantizedAabbMin[i]>rightChildNode->m_quantizedAabbMin[i])
-							curNode.m_quantizedAabbMin[i]=rightChildNode->m_quantizedAabbMin[i];
-
-						curNode.m_quantizedAabbMax[i] = leftChildNode->m_quantizedAabbMax[i];
-						if (curNode.m_quantizedAabbMax[i] < rightChildNode->m_quantizedAabbMax[i])
-							curNode.m_quantizedAabbMax[i] = rightChildNode->m_quantizedAabbMax[i];
-					}
-				}
+				mergeChildAabbs(&m_quantizedContiguousNodes[0],i);
 			}
 
 		}
@@ -381,6 +391,159 @@ void	btOptimizedBvh::updateBvhNodes(btStridingMeshInterface* meshInterface,int f
 		
 }
 
+void	btOptimizedBvh::initDirtyMask(btBvhDirtyTriangleMask& mask) const
+{
+	btAssert(m_useQuantization);
+	mask.reset();
+
+	//the triangles of each part are numbered from 0, find the highest index of each part
+	btAlignedObjectArray<int> partSizes;
+	int i;
+	for (i=0;i<m_curNodeIndex;i++)
+	{
+		const btQuantizedBvhNode& node = m_quantizedContiguousNodes[i];
+		if (node.isLeafNode())
+		{
+			int partId = node.getPartId();
+			while (partSizes.size() <= partId)
+			{
+				partSizes.push_back(0);
+			}
+			if (partSizes[partId] <= node.getTriangleIndex())
+			{
+				partSizes[partId] = node.getTriangleIndex()+1;
+			}
+		}
+	}
+	int numTriangles = 0;
+	mask.m_partOffsets.resize(partSizes.size());
+	for (i=0;i<partSizes.size();i++)
+	{
+		mask.m_partOffsets[i] = numTriangles;
+		numTriangles += partSizes[i];
+	}
+
+	mask.m_triangleSubtrees.resize(numTriangles);
+	for (i=0;i<numTriangles;i++)
+	{
+		mask.m_triangleSubtrees[i] = -1;
+	}
+	btAlignedObjectArray<unsigned char> covered;
+	covered.resize(m_curNodeIndex);
+	for (i=0;i<m_curNodeIndex;i++)
+	{
+		covered[i] = 0;
+	}
+	for (i=0;i<m_SubtreeHeaders.size();i++)
+	{
+		const btBvhSubtreeInfo& subtree = m_SubtreeHeaders[i];
+		for (int n=subtree.m_rootNodeIndex;n<subtree.m_rootNodeIndex+subtree.m_subtreeSize;n++)
+		{
+			covered[n] = 1;
+			const btQuantizedBvhNode& node = m_quantizedContiguousNodes[n];
+			if (node.isLeafNode())
+			{
+				mask.m_triangleSubtrees[mask.m_partOffsets[node.getPartId()]+node.getTriangleIndex()] = i;
+			}
+		}
+	}
+	for (i=m_curNodeIndex-1;i>=0;i--)
+	{
+		if (!covered[i])
+		{
+			mask.m_topNodes.push_back(i);
+		}
+	}
+
+	mask.m_bits.resize((numTriangles+31)/32);
+	for (i=0;i<mask.m_bits.size();i++)
+	{
+		mask.m_bits[i] = 0;
+	}
+	mask.m_subtreeFlags.resize(m_SubtreeHeaders.size());
+	for (i=0;i<m_SubtreeHeaders.size();i++)
+	{
+		mask.m_subtreeFlags[i] = 0;
+	}
+}
+
+struct btBvhRefitBody : public btIParallelForBody
+{
+	btOptimizedBvh*	m_bvh;
+	btStridingMeshInterface*	m_meshInterface;
+	const int*	m_subtrees;
+
+	btBvhRefitBody(btOptimizedBvh* bvh, btStridingMeshInterface* meshInterface, const int* subtrees)
+		:m_bvh(bvh),
+		m_meshInterface(meshInterface),
+		m_subtrees(subtrees)
+	{
+	}
+
+	void	forLoop(int iBegin, int iEnd) const
+	{
+		//the subtrees don't share nodes, each is written by one thread only
+		for (int i=iBegin;i<iEnd;i++)
+		{
+			btBvhSubtreeInfo& subtree = m_bvh->getSubtreeInfoArray()[m_subtrees[i]];
+			m_bvh->updateBvhNodes(m_meshInterface,subtree.m_rootNodeIndex,subtree.m_rootNodeIndex+subtree.m_subtreeSize,m_subtrees[i]);
+			subtree.setAabbFromQuantizeNode(m_bvh->getQuantizedNodeArray()[subtree.m_rootNodeIndex]);
+		}
+	}
+};
+
+void	btOptimizedBvh::refitDirty(btStridingMeshInterface* meshInterface, btBvhDirtyTriangleMask& mask)
+{
+	BT_PROFILE("btOptimizedBvh::refitDirty");
+	btAssert(m_useQuantization);
+	btAssert(mask.isInitialized());
+
+	mask.m_dirtySubtrees.resize(0);
+	int w;
+	for (w=0;w<mask.m_bits.size();w++)
+	{
+		unsigned int bits = mask.m_bits[w];
+		if (!bits)
+		{
+			continue;
+		}
+		mask.m_bits[w] = 0;
+		for (int b=0;bits;b++,bits>>=1)
+		{
+			if (bits & 1)
+			{
+				int subtreeIndex = mask.m_triangleSubtrees[w*32+b];
+				btAssert(subtreeIndex >= 0);
+				if (!mask.m_subtreeFlags[subtreeIndex])
+				{
+					mask.m_subtreeFlags[subtreeIndex] = 1;
+					mask.m_dirtySubtrees.push_back(subtreeIndex);
+				}
+			}
+		}
+	}
+
+	int numDirty = mask.m_dirtySubtrees.size();
+	if (!numDirty)
+	{
+		return;
+	}
+
+	btBvhRefitBody body(this,meshInterface,&mask.m_dirtySubtrees[0]);
+	btParallelFor(0,numDirty,4,body);
+
+	for (int i=0;i<numDirty;i++)
+	{
+		mask.m_subtreeFlags[mask.m_dirtySubtrees[i]] = 0;
+	}
+
+	//the nodes above the subtrees are few, one per subtree at most
+	for (int i=0;i<mask.m_topNodes.size();i++)
+	{
+		mergeChildAabbs(&m_quantizedContiguousNodes[0],mask.m_topNodes[i]);
+	}
+}
+
 ///deSerializeInPlace loads and initializes a BVH from a buffer in memory 'in place'
 btOptimizedBvh* btOptimizedBvh::deSerializeInPlace(void *i_alignedDataBuffer, unsigned int i_dataBufferSize, bool i_swapEndian)
 {
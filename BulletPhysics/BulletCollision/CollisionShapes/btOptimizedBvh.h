@@ -21,6 +21,51 @@ subject to the following restrictions:
 #include "BulletCollision/BroadphaseCollision/btQuantizedBvh.h"
 
 class btStridingMeshInterface;
+class btOptimizedBvh;
+
+///btBvhDirtyTriangleMask marks the triangles of a btOptimizedBvh whose vertices moved, one bit per triangle.
+///It is set up by btOptimizedBvh::initDirtyMask and consumed by btOptimizedBvh::refitDirty, which only refits the subtrees
+///that hold a marked triangle. The mask lives outside the bvh, because a bvh can be deserialized in place.
+class btBvhDirtyTriangleMask
+{
+	///index of the first bit of each mesh part
+	btAlignedObjectArray<int>	m_partOffsets;
+	btAlignedObjectArray<unsigned int>	m_bits;
+	///subtree header index of each triangle
+	btAlignedObjectArray<int>	m_triangleSubtrees;
+	///nodes above the subtrees, in descending order so children come before their parents
+	btAlignedObjectArray<int>	m_topNodes;
+	btAlignedObjectArray<int>	m_dirtySubtrees;
+	btAlignedObjectArray<unsigned char>	m_subtreeFlags;
+
+	friend class btOptimizedBvh;
+
+public:
+
+	bool	isInitialized() const
+	{
+		return m_partOffsets.size() != 0;
+	}
+
+	///releases the mapping, the mask has to be initialized again before use
+	void	reset()
+	{
+		m_partOffsets.clear();
+		m_bits.clear();
+		m_triangleSubtrees.clear();
+		m_topNodes.clear();
+		m_dirtySubtrees.clear();
+		m_subtreeFlags.clear();
+	}
+
+	void	markTriangle(int partId, int triangleIndex)
+	{
+		btAssert(partId >= 0 && partId < m_partOffsets.size());
+		int bit = m_partOffsets[partId] + triangleIndex;
+		btAssert(bit < m_triangleSubtrees.size());
+		m_bits[bit >> 5] |= 1u << (bit & 31);
+	}
+};
 
 
 ///The btOptimizedBvh extends the btQuantizedBvh to create AABB tree for triangle meshes, through the btStridingMeshInterface.
@@ -46,6 +91,14 @@ public:
 
 	void	updateBvhNodes(btStridingMeshInterface* meshInterface,int firstNode,int endNode,int index);
 
+	///maps the triangles of this bvh to their subtrees and clears the mask. Only for quantized trees
+	void	initDirtyMask(btBvhDirtyTriangleMask& mask) const;
+
+	///refits the subtrees that hold a marked triangle, distributed over the threads with btParallelFor, then the nodes above
+	///the subtrees, and clears the marks. The moved vertices must stay within the quantization aabb, as for refitPartial.
+	///The read-only locking of the mesh interface must be thread safe, as it is for btTriangleIndexVertexArray.
+	void	refitDirty(btStridingMeshInterface* meshInterface, btBvhDirtyTriangleMask& mask);
+
 	/// Data buffer MUST be 16 byte aligned
 	virtual bool serializeInPlace(void *o_alignedDataBuffer, unsigned i_dataBufferSize, bool i_swapEndian) const
 	{
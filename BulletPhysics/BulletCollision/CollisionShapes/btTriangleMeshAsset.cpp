@@ -0,0 +1,307 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "btTriangleMeshAsset.h"
+#include "btBvhTriangleMeshShape.h"
+#include "btOptimizedBvh.h"
+#include "btTriangleIndexVertexArray.h"
+#include "LinearMath/btAlignedAllocator.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char sAssetMagic[8] = {'B','T','M','E','S','H','B','V'};
+
+///the file starts with the header, followed by the part table, the vertex and index blocks of each part and the BVH, all 16 byte aligned
+struct btTriangleMeshAssetHeader
+{
+	char			m_magic[8];
+	int				m_version;
+	int				m_bulletVersion;
+	unsigned int	m_endianMarker;
+	int				m_scalarSize;
+	int				m_pointerSize;
+	int				m_numParts;
+	int				m_useQuantizedAabbCompression;
+	unsigned int	m_fileSize;
+	unsigned int	m_partTableOffset;
+	unsigned int	m_bvhOffset;
+	unsigned int	m_bvhSize;
+	btScalar		m_aabbMin[4];
+	btScalar		m_aabbMax[4];
+	btScalar		m_meshScaling[4];
+};
+
+struct btTriangleMeshAssetPart
+{
+	int				m_numTriangles;
+	int				m_triangleIndexStride;
+	int				m_indexType;
+	int				m_numVertices;
+	int				m_vertexStride;
+	int				m_vertexType;
+	unsigned int	m_indexOffset;
+	unsigned int	m_indexSize;
+	unsigned int	m_vertexOffset;
+	unsigned int	m_vertexSize;
+};
+
+static SIMD_FORCE_INLINE unsigned int	alignOffset(unsigned int offset)
+{
+	return (offset + 15) & ~15u;
+}
+
+static int	getIndexSize(int indexType)
+{
+	switch (indexType)
+	{
+	case PHY_INTEGER:
+		return 3 * sizeof(int);
+	case PHY_SHORT:
+		return 3 * sizeof(short);
+	case PHY_UCHAR:
+		return 3 * sizeof(unsigned char);
+	default:
+		return 0;
+	}
+}
+
+static int	getVertexSize(int vertexType)
+{
+	switch (vertexType)
+	{
+	case PHY_FLOAT:
+		return 3 * sizeof(float);
+	case PHY_DOUBLE:
+		return 3 * sizeof(double);
+	default:
+		return 0;
+	}
+}
+
+///the last element is only stored up to its own size, the stride may cover data that isn't part of the mesh
+static unsigned int	getBlockSize(int count, int stride, int elementSize)
+{
+	return count ? (unsigned int)((count - 1) * stride + elementSize) : 0;
+}
+
+static void	storeVector(btScalar* dst, const btVector3& v)
+{
+	dst[0] = v.getX();
+	dst[1] = v.getY();
+	dst[2] = v.getZ();
+	dst[3] = btScalar(0.);
+}
+
+static btVector3	loadVector(const btScalar* src)
+{
+	return btVector3(src[0], src[1], src[2]);
+}
+
+btTriangleMeshAsset::btTriangleMeshAsset()
+:m_meshInterface(0),
+m_shape(0)
+{
+}
+
+btTriangleMeshAsset::~btTriangleMeshAsset()
+{
+	unload();
+}
+
+bool	btTriangleMeshAsset::write(const char* fileName, btBvhTriangleMeshShape* shape)
+{
+	btOptimizedBvh* bvh = shape->getOptimizedBvh();
+	if (!bvh)
+	{
+		return false;
+	}
+	const btStridingMeshInterface* meshInterface = shape->getMeshInterface();
+	int numParts = meshInterface->getNumSubParts();
+
+	btTriangleMeshAssetHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.m_magic, sAssetMagic, sizeof(sAssetMagic));
+	header.m_version = BT_TRIANGLE_MESH_ASSET_VERSION;
+	header.m_bulletVersion = BT_BULLET_VERSION;
+	header.m_endianMarker = 0x01020304;
+	header.m_scalarSize = sizeof(btScalar);
+	header.m_pointerSize = sizeof(void*);
+	header.m_numParts = numParts;
+	header.m_useQuantizedAabbCompression = shape->usesQuantizedAabbCompression() ? 1 : 0;
+	storeVector(header.m_aabbMin, shape->getLocalAabbMin());
+	storeVector(header.m_aabbMax, shape->getLocalAabbMax());
+	storeVector(header.m_meshScaling, meshInterface->getScaling());
+
+	//lay out the blocks
+	btAlignedObjectArray<btTriangleMeshAssetPart> parts;
+	parts.resize(numParts);
+	unsigned int offset = alignOffset(sizeof(header));
+	header.m_partTableOffset = offset;
+	offset = alignOffset(offset + numParts * sizeof(btTriangleMeshAssetPart));
+	for (int i = 0; i < numParts; i++)
+	{
+		const unsigned char* vertexBase;
+		const unsigned char* indexBase;
+		int numVertices, vertexStride, indexStride, numTriangles;
+		PHY_ScalarType vertexType, indexType;
+		meshInterface->getLockedReadOnlyVertexIndexBase(&vertexBase, numVertices, vertexType, vertexStride, &indexBase, indexStride, numTriangles, indexType, i);
+		meshInterface->unLockReadOnlyVertexBase(i);
+
+		btTriangleMeshAssetPart& part = parts[i];
+		part.m_numTriangles = numTriangles;
+		part.m_triangleIndexStride = indexStride;
+		part.m_indexType = indexType;
+		part.m_numVertices = numVertices;
+		part.m_vertexStride = vertexStride;
+		part.m_vertexType = vertexType;
+		part.m_indexSize = getBlockSize(numTriangles, indexStride, getIndexSize(indexType));
+		part.m_vertexSize = getBlockSize(numVertices, vertexStride, getVertexSize(vertexType));
+		part.m_indexOffset = offset;
+		offset = alignOffset(offset + part.m_indexSize);
+		part.m_vertexOffset = offset;
+		offset = alignOffset(offset + part.m_vertexSize);
+	}
+	header.m_bvhOffset = offset;
+	header.m_bvhSize = bvh->calculateSerializeBufferSize();
+	header.m_fileSize = offset + header.m_bvhSize;
+
+	unsigned char* buffer = (unsigned char*)btAlignedAlloc(header.m_fileSize, 16);
+	memset(buffer, 0, header.m_fileSize);
+	memcpy(buffer, &header, sizeof(header));
+	if (numParts)
+	{
+		memcpy(buffer + header.m_partTableOffset, &parts[0], numParts * sizeof(btTriangleMeshAssetPart));
+	}
+	for (int i = 0; i < numParts; i++)
+	{
+		const unsigned char* vertexBase;
+		const unsigned char* indexBase;
+		int numVertices, vertexStride, indexStride, numTriangles;
+		PHY_ScalarType vertexType, indexType;
+		meshInterface->getLockedReadOnlyVertexIndexBase(&vertexBase, numVertices, vertexType, vertexStride, &indexBase, indexStride, numTriangles, indexType, i);
+		memcpy(buffer + parts[i].m_indexOffset, indexBase, parts[i].m_indexSize);
+		memcpy(buffer + parts[i].m_vertexOffset, vertexBase, parts[i].m_vertexSize);
+		meshInterface->unLockReadOnlyVertexBase(i);
+	}
+	bool ok = bvh->serializeInPlace(buffer + header.m_bvhOffset, header.m_bvhSize, false);
+
+	if (ok)
+	{
+		FILE* file = fopen(fileName, "wb");
+		ok = file != 0;
+		if (file)
+		{
+			ok = fwrite(buffer, 1, header.m_fileSize, file) == header.m_fileSize;
+			ok = (fclose(file) == 0) && ok;
+		}
+	}
+	btAlignedFree(buffer);
+	return ok;
+}
+
+bool	btTriangleMeshAsset::load(const char* fileName)
+{
+	unload();
+	if (!m_file.open(fileName))
+	{
+		return false;
+	}
+
+	unsigned char* data = m_file.getData();
+	unsigned int size = m_file.getSize();
+	if (size < sizeof(btTriangleMeshAssetHeader))
+	{
+		unload();
+		return false;
+	}
+	const btTriangleMeshAssetHeader& header = *(const btTriangleMeshAssetHeader*)data;
+	bool valid = !memcmp(header.m_magic, sAssetMagic, sizeof(sAssetMagic)) &&
+		header.m_version == BT_TRIANGLE_MESH_ASSET_VERSION &&
+		header.m_bulletVersion == BT_BULLET_VERSION &&
+		header.m_endianMarker == 0x01020304 &&
+		header.m_scalarSize == sizeof(btScalar) &&
+		header.m_pointerSize == sizeof(void*) &&
+		header.m_fileSize == size &&
+		header.m_numParts >= 0 &&
+		header.m_partTableOffset <= size &&
+		(unsigned int)header.m_numParts <= (size - header.m_partTableOffset) / sizeof(btTriangleMeshAssetPart) &&
+		!(header.m_bvhOffset & 15) &&
+		header.m_bvhOffset <= size &&
+		header.m_bvhSize <= size - header.m_bvhOffset;
+
+	const btTriangleMeshAssetPart* parts = (const btTriangleMeshAssetPart*)(data + header.m_partTableOffset);
+	for (int i = 0; valid && i < header.m_numParts; i++)
+	{
+		const btTriangleMeshAssetPart& part = parts[i];
+		int indexSize = getIndexSize(part.m_indexType);
+		int vertexSize = getVertexSize(part.m_vertexType);
+		valid = indexSize && vertexSize &&
+			part.m_numTriangles >= 0 && part.m_numVertices >= 0 &&
+			part.m_triangleIndexStride >= indexSize && part.m_vertexStride >= vertexSize &&
+			part.m_indexSize == getBlockSize(part.m_numTriangles, part.m_triangleIndexStride, indexSize) &&
+			part.m_vertexSize == getBlockSize(part.m_numVertices, part.m_vertexStride, vertexSize) &&
+			part.m_indexOffset <= size && part.m_indexSize <= size - part.m_indexOffset &&
+			part.m_vertexOffset <= size && part.m_vertexSize <= size - part.m_vertexOffset;
+	}
+	if (!valid)
+	{
+		unload();
+		return false;
+	}
+
+	//the mesh points into the mapping, nothing is copied
+	m_meshInterface = new btTriangleIndexVertexArray();
+	for (int i = 0; i < header.m_numParts; i++)
+	{
+		const btTriangleMeshAssetPart& part = parts[i];
+		btIndexedMesh mesh;
+		mesh.m_numTriangles = part.m_numTriangles;
+		mesh.m_triangleIndexBase = data + part.m_indexOffset;
+		mesh.m_triangleIndexStride = part.m_triangleIndexStride;
+		mesh.m_numVertices = part.m_numVertices;
+		mesh.m_vertexBase = data + part.m_vertexOffset;
+		mesh.m_vertexStride = part.m_vertexStride;
+		mesh.m_vertexType = (PHY_ScalarType)part.m_vertexType;
+		m_meshInterface->addIndexedMesh(mesh, (PHY_ScalarType)part.m_indexType);
+	}
+	btVector3 aabbMin = loadVector(header.m_aabbMin);
+	btVector3 aabbMax = loadVector(header.m_aabbMax);
+	m_meshInterface->setScaling(loadVector(header.m_meshScaling));
+	//with a premade aabb the shape doesn't visit the vertices on construction
+	m_meshInterface->setPremadeAabb(aabbMin, aabbMax);
+
+	btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(data + header.m_bvhOffset, header.m_bvhSize, false);
+	if (!bvh)
+	{
+		unload();
+		return false;
+	}
+
+	bool useQuantizedAabbCompression = header.m_useQuantizedAabbCompression != 0;
+	m_shape = new btBvhTriangleMeshShape(m_meshInterface, useQuantizedAabbCompression, aabbMin, aabbMax, false);
+	m_shape->setOptimizedBvh(bvh, loadVector(header.m_meshScaling));
+	return true;
+}
+
+void	btTriangleMeshAsset::unload()
+{
+	//the BVH lives in the mapping, the shape doesn't own it
+	delete m_shape;
+	m_shape = 0;
+	delete m_meshInterface;
+	m_meshInterface = 0;
+	m_file.close();
+}
@@ -0,0 +1,66 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef BT_TRIANGLE_MESH_ASSET_H
+#define BT_TRIANGLE_MESH_ASSET_H
+
+#include "LinearMath/btMappedFile.h"
+#include "LinearMath/btVector3.h"
+
+class btBvhTriangleMeshShape;
+class btTriangleIndexVertexArray;
+
+#define BT_TRIANGLE_MESH_ASSET_VERSION 1
+
+///btTriangleMeshAsset stores a btBvhTriangleMeshShape (vertices, indices and the prebuilt BVH) in a file that loads without parsing.
+///The file is memory mapped and the btTriangleIndexVertexArray and the BVH point straight into the mapped pages; only the page that
+///holds the BVH header is copied, when deSerializeInPlace fixes up its pointers. The mesh pages are read in on first access.
+///The format is the in-memory layout of the writing build, load fails on a different endianness, pointer size, btScalar precision
+///or Bullet version.
+class btTriangleMeshAsset
+{
+	btMappedFile	m_file;
+	btTriangleIndexVertexArray*	m_meshInterface;
+	btBvhTriangleMeshShape*	m_shape;
+
+public:
+
+	btTriangleMeshAsset();
+
+	~btTriangleMeshAsset();
+
+	///writes the mesh and the BVH of the shape, the shape must have a BVH. Returns false if the file can't be written
+	static bool	write(const char* fileName, btBvhTriangleMeshShape* shape);
+
+	///maps the file and creates the mesh interface and the shape on top of it, returns false if the file is missing or doesn't match this build
+	bool	load(const char* fileName);
+
+	///deletes the shape and the mesh interface and unmaps the file
+	void	unload();
+
+	///the shape stays valid until unload, it doesn't own its BVH or its mesh interface
+	btBvhTriangleMeshShape*	getShape()
+	{
+		return m_shape;
+	}
+
+	btTriangleIndexVertexArray*	getMeshInterface()
+	{
+		return m_meshInterface;
+	}
+};
+
+#endif //BT_TRIANGLE_MESH_ASSET_H
@@ -30,6 +30,7 @@ Concave-Concave Collision
 #include "btGImpactCollisionAlgorithm.h"
 #include "btContactProcessing.h"
 #include "LinearMath/btQuickprof.h"
+#include "LinearMath/btThreads.h"
 
 
 //! Class for accessing the plane equation
@@ -193,16 +194,180 @@ float btGImpactCollisionAlgorithm::getAverageTriangleCollisionTime()
 
 
 
+#define BT_GIMPACT_PAIR_CHUNK_SIZE 64
+#define BT_GIMPACT_TRIANGLE_GRAIN 64
+
+struct btGImpactTrianglePairBuffers
+{
+	//! triangle index to slot, -1 when unused
+	btAlignedObjectArray<int> m_slots0;
+	btAlignedObjectArray<int> m_slots1;
+	//! triangle index of each slot
+	btAlignedObjectArray<int> m_indices0;
+	btAlignedObjectArray<int> m_indices1;
+	btAlignedObjectArray<btPrimitiveTriangle> m_triangles0;
+	btAlignedObjectArray<btPrimitiveTriangle> m_triangles1;
+	//! pairs of indices into m_triangles0 and m_triangles1
+	btAlignedObjectArray<int> m_slotPairs;
+	btAlignedObjectArray<btContactArray> m_chunkContacts;
+};
+
+//! gives each distinct triangle index of one side of the pairs a slot, in order of first use
+/*!
+slots maps triangle indices to slots, it must hold -1 for all triangles and is restored before returning.
+*/
+static void bt_assign_triangle_slots(const int * pairs, int pair_count, int side,
+	btAlignedObjectArray<int> & slots, btAlignedObjectArray<int> & indices, int * slot_pairs)
+{
+	indices.resize(0);
+	int i;
+	for (i=0;i<pair_count;i++)
+	{
+		int index = pairs[i*2+side];
+		if (slots[index] < 0)
+		{
+			slots[index] = indices.size();
+			indices.push_back(index);
+		}
+		slot_pairs[i*2+side] = slots[index];
+	}
+	for (i=0;i<indices.size();i++)
+	{
+		slots[indices[i]] = -1;
+	}
+}
+
+//! grows the slot table to the triangle count, new entries are free
+static void bt_reserve_triangle_slots(btAlignedObjectArray<int> & slots, int triangle_count)
+{
+	int old_size = slots.size();
+	if (old_size < triangle_count)
+	{
+		slots.resize(triangle_count);
+		for (int i=old_size;i<triangle_count;i++)
+		{
+			slots[i] = -1;
+		}
+	}
+}
+
+struct btGImpactTransformTrianglesBody : public btIParallelForBody
+{
+	const btGImpactMeshShapePart * m_shape;
+	btTransform m_trans;
+	const int * m_indices;
+	btPrimitiveTriangle * m_triangles;
+
+	btGImpactTransformTrianglesBody(const btGImpactMeshShapePart * shape, const btTransform & trans, const int * indices, btPrimitiveTriangle * triangles)
+		:m_shape(shape),
+		m_trans(trans),
+		m_indices(indices),
+		m_triangles(triangles)
+	{
+	}
+
+	void forLoop(int iBegin, int iEnd) const
+	{
+		for (int i=iBegin;i<iEnd;i++)
+		{
+			btPrimitiveTriangle & triangle = m_triangles[i];
+			m_shape->getPrimitiveTriangle(m_indices[i],triangle);
+			triangle.applyTransform(m_trans);
+			triangle.buildTriPlane();
+		}
+	}
+};
+
+//! tests the triangle pairs of a range of chunks, four pairs at a time, and clips the ones that could collide
+struct btGImpactTrianglePairBody : public btIParallelForBody
+{
+	const btPrimitiveTriangle * m_triangles0;
+	const btPrimitiveTriangle * m_triangles1;
+	const int * m_slotPairs;
+	const int * m_pairs;
+	int m_pairCount;
+	btContactArray * m_chunkContacts;
+
+	btGImpactTrianglePairBody(const btPrimitiveTriangle * triangles0, const btPrimitiveTriangle * triangles1,
+		const int * slotPairs, const int * pairs, int pairCount, btContactArray * chunkContacts)
+		:m_triangles0(triangles0),
+		m_triangles1(triangles1),
+		m_slotPairs(slotPairs),
+		m_pairs(pairs),
+		m_pairCount(pairCount),
+		m_chunkContacts(chunkContacts)
+	{
+	}
+
+	void forLoop(int iBegin, int iEnd) const
+	{
+		GIM_TRIANGLE_CONTACT contact_data;
+		for (int c=iBegin;c<iEnd;c++)
+		{
+			btContactArray & contacts = m_chunkContacts[c];
+			contacts.resize(0);
+			int begin = c*BT_GIMPACT_PAIR_CHUNK_SIZE;
+			int end = btMin(begin + BT_GIMPACT_PAIR_CHUNK_SIZE, m_pairCount);
+
+			for (int p=begin;p<end;p+=4)
+			{
+				int lane_count = btMin(4, end - p);
+				const btPrimitiveTriangle * tris0[4];
+				const btPrimitiveTriangle * tris1[4];
+				int lane;
+				for (lane=0;lane<4;lane++)
+				{
+					//unused lanes repeat the first pair
+					int pair = p + (lane < lane_count ? lane : 0);
+					tris0[lane] = &m_triangles0[m_slotPairs[pair*2]];
+					tris1[lane] = &m_triangles1[m_slotPairs[pair*2+1]];
+				}
+
+				int overlap_mask = btPrimitiveTriangle::overlap_test_conservative4(tris0,tris1);
+
+				for (lane=0;lane<lane_count;lane++)
+				{
+					if (!(overlap_mask & (1<<lane)))
+					{
+						continue;
+					}
+					btPrimitiveTriangle ptri0 = *tris0[lane];
+					btPrimitiveTriangle ptri1 = *tris1[lane];
+					if(ptri0.find_triangle_collision_clip_method(ptri1,contact_data))
+					{
+						int pair = p + lane;
+						int j = contact_data.m_point_count;
+						while(j--)
+						{
+							contacts.push_contact(contact_data.m_points[j],
+								contact_data.m_separating_normal,
+								contact_data.m_penetration_depth,
+								m_pairs[pair*2],m_pairs[pair*2+1]);
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+
 btGImpactCollisionAlgorithm::btGImpactCollisionAlgorithm( const btCollisionAlgorithmConstructionInfo& ci, btCollisionObject* body0,btCollisionObject* body1)
 : btActivatingCollisionAlgorithm(ci,body0,body1)
 {
 	m_manifoldPtr = NULL;
 	m_convex_algorithm = NULL;
+	m_pairBuffers = NULL;
 }
 
 btGImpactCollisionAlgorithm::~btGImpactCollisionAlgorithm()
 {
 	clearCache();
+	if(m_pairBuffers)
+	{
+		m_pairBuffers->~btGImpactTrianglePairBuffers();
+		btAlignedFree(m_pairBuffers);
+	}
 }
 
 
@@ -404,70 +569,72 @@ void btGImpactCollisionAlgorithm::collide_sat_triangles(btCollisionObject * body
 					  btGImpactMeshShapePart * shape1,
 					  const int * pairs, int pair_count)
 {
+	BT_PROFILE("collide_sat_triangles");
 	btTransform orgtrans0 = body0->getWorldTransform();
 	btTransform orgtrans1 = body1->getWorldTransform();
 
-	btPrimitiveTriangle ptri0;
-	btPrimitiveTriangle ptri1;
-	GIM_TRIANGLE_CONTACT contact_data;
-
-	shape0->lockChildShapes();
-	shape1->lockChildShapes();
-
-	const int * pair_pointer = pairs;
-
-	while(pair_count--)
+	if(!m_pairBuffers)
 	{
+		void * mem = btAlignedAlloc(sizeof(btGImpactTrianglePairBuffers),16);
+		m_pairBuffers = new(mem) btGImpactTrianglePairBuffers;
+	}
+	btGImpactTrianglePairBuffers & buffers = *m_pairBuffers;
 
-		m_triface0 = *(pair_pointer);
-		m_triface1 = *(pair_pointer+1);
-		pair_pointer+=2;
-
-
-		shape0->getPrimitiveTriangle(m_triface0,ptri0);
-		shape1->getPrimitiveTriangle(m_triface1,ptri1);
+	#ifdef TRI_COLLISION_PROFILING
+	bt_begin_gim02_tri_time();
+	#endif
 
-		#ifdef TRI_COLLISION_PROFILING
-		bt_begin_gim02_tri_time();
-		#endif
+	shape0->lockChildShapes();
+	shape1->lockChildShapes();
 
-		ptri0.applyTransform(orgtrans0);
-		ptri1.applyTransform(orgtrans1);
+	//a triangle is usually part of several pairs, transform each one only once
+	bt_reserve_triangle_slots(buffers.m_slots0,shape0->getNumChildShapes());
+	bt_reserve_triangle_slots(buffers.m_slots1,shape1->getNumChildShapes());
+	buffers.m_slotPairs.resize(pair_count*2);
+	bt_assign_triangle_slots(pairs,pair_count,0,buffers.m_slots0,buffers.m_indices0,&buffers.m_slotPairs[0]);
+	bt_assign_triangle_slots(pairs,pair_count,1,buffers.m_slots1,buffers.m_indices1,&buffers.m_slotPairs[0]);
+	buffers.m_triangles0.resize(buffers.m_indices0.size());
+	buffers.m_triangles1.resize(buffers.m_indices1.size());
 
+	btGImpactTransformTrianglesBody transform0(shape0,orgtrans0,&buffers.m_indices0[0],&buffers.m_triangles0[0]);
+	btParallelFor(0,buffers.m_indices0.size(),BT_GIMPACT_TRIANGLE_GRAIN,transform0);
+	btGImpactTransformTrianglesBody transform1(shape1,orgtrans1,&buffers.m_indices1[0],&buffers.m_triangles1[0]);
+	btParallelFor(0,buffers.m_indices1.size(),BT_GIMPACT_TRIANGLE_GRAIN,transform1);
 
-		//build planes
-		ptri0.buildTriPlane();
-		ptri1.buildTriPlane();
-		// test conservative
+	shape0->unlockChildShapes();
+	shape1->unlockChildShapes();
 
+	//test the pairs in chunks, each chunk keeps its own contacts
+	int chunk_count = (pair_count + BT_GIMPACT_PAIR_CHUNK_SIZE - 1)/BT_GIMPACT_PAIR_CHUNK_SIZE;
+	if (buffers.m_chunkContacts.size() < chunk_count)
+	{
+		buffers.m_chunkContacts.resize(chunk_count);
+	}
+	btGImpactTrianglePairBody pairBody(&buffers.m_triangles0[0],&buffers.m_triangles1[0],
+		&buffers.m_slotPairs[0],pairs,pair_count,&buffers.m_chunkContacts[0]);
+	btParallelFor(0,chunk_count,1,pairBody);
 
+	#ifdef TRI_COLLISION_PROFILING
+	bt_end_gim02_tri_time();
+	#endif
 
-		if(ptri0.overlap_test_conservative(ptri1))
+	//add the contacts in pair order, the manifold sees the same sequence as with a serial loop
+	for (int c=0;c<chunk_count;c++)
+	{
+		const btContactArray & contacts = buffers.m_chunkContacts[c];
+		for (int i=0;i<contacts.size();i++)
 		{
-			if(ptri0.find_triangle_collision_clip_method(ptri1,contact_data))
-			{
-
-				int j = contact_data.m_point_count;
-				while(j--)
-				{
-
-					addContactPoint(body0, body1,
-								contact_data.m_points[j],
-								contact_data.m_separating_normal,
-								-contact_data.m_penetration_depth);
-				}
-			}
+			const GIM_CONTACT & contact = contacts[i];
+			m_triface0 = contact.m_feature1;
+			m_triface1 = contact.m_feature2;
+			addContactPoint(body0, body1,
+						contact.m_point,
+						contact.m_normal,
+						-contact.m_depth);
 		}
-
-		#ifdef TRI_COLLISION_PROFILING
-		bt_end_gim02_tri_time();
-		#endif
-
 	}
-
-	shape0->unlockChildShapes();
-	shape1->unlockChildShapes();
-
+	m_triface0 = pairs[pair_count*2-2];
+	m_triface1 = pairs[pair_count*2-1];
 }
 
 
@@ -29,6 +29,7 @@ subject to the following restrictions:
 #include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
 #include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
 class btDispatcher;
+struct btGImpactTrianglePairBuffers;
 #include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
 #include "BulletCollision/CollisionDispatch/btCollisionCreateFunc.h"
 #include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
@@ -62,6 +63,8 @@ protected:
 	int m_part0;
 	int m_triface1;
 	int m_part1;
+	//! scratch buffers of collide_sat_triangles, allocated on first use
+	btGImpactTrianglePairBuffers * m_pairBuffers;
 
 
 	//! Creates a new contact point
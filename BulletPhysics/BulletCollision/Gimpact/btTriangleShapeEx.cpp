@@ -86,6 +86,46 @@ bool btPrimitiveTriangle::overlap_test_conservative(const btPrimitiveTriangle& o
     return true;
 }
 
+//! classifies the vertices of the tris1 lanes against the planes of the tris0 lanes, returns the lanes with all vertices above
+static SIMD_FORCE_INLINE int bt_separated_lanes4(const btPrimitiveTriangle* const tris0[4], const btPrimitiveTriangle* const tris1[4])
+{
+	btScalar nx[4],ny[4],nz[4],nw[4],margin[4];
+	btScalar vx[3][4],vy[3][4],vz[3][4];
+	int lane,k;
+	for (lane=0;lane<4;lane++)
+	{
+		const btVector4 & plane = tris0[lane]->m_plane;
+		nx[lane] = plane[0];
+		ny[lane] = plane[1];
+		nz[lane] = plane[2];
+		nw[lane] = plane[3];
+		margin[lane] = tris0[lane]->m_margin + tris1[lane]->m_margin;
+		for (k=0;k<3;k++)
+		{
+			const btVector3 & v = tris1[lane]->m_vertices[k];
+			vx[k][lane] = v[0];
+			vy[k][lane] = v[1];
+			vz[k][lane] = v[2];
+		}
+	}
+
+	int separated[4];
+	for (lane=0;lane<4;lane++)
+	{
+		btScalar dis0 = (vx[0][lane]*nx[lane] + vy[0][lane]*ny[lane] + vz[0][lane]*nz[lane]) - nw[lane] - margin[lane];
+		btScalar dis1 = (vx[1][lane]*nx[lane] + vy[1][lane]*ny[lane] + vz[1][lane]*nz[lane]) - nw[lane] - margin[lane];
+		btScalar dis2 = (vx[2][lane]*nx[lane] + vy[2][lane]*ny[lane] + vz[2][lane]*nz[lane]) - nw[lane] - margin[lane];
+		separated[lane] = (dis0>0.0f) & (dis1>0.0f) & (dis2>0.0f);
+	}
+	return separated[0] | (separated[1]<<1) | (separated[2]<<2) | (separated[3]<<3);
+}
+
+int btPrimitiveTriangle::overlap_test_conservative4(const btPrimitiveTriangle* const tris0[4], const btPrimitiveTriangle* const tris1[4])
+{
+	int separated = bt_separated_lanes4(tris0,tris1) | bt_separated_lanes4(tris1,tris0);
+	return ~separated & 15;
+}
+
 int btPrimitiveTriangle::clip_triangle(btPrimitiveTriangle & other, btVector3 * clipped_points )
 {
     // edge 0
@@ -94,6 +94,15 @@ public:
 	//! Test if triangles could collide
 	bool overlap_test_conservative(const btPrimitiveTriangle& other);
 
+	//! Test four triangle pairs at once
+	/*!
+	Lane i tests tris0[i] against tris1[i] and gives the same result as overlap_test_conservative.
+	The lanes are laid out as structure of arrays, so the compiler can vectorize them.
+	\pre the triangles must have their planes calculated.
+	\return a mask with bit i set if pair i could collide
+	*/
+	static int overlap_test_conservative4(const btPrimitiveTriangle* const tris0[4], const btPrimitiveTriangle* const tris1[4]);
+
 	//! Calcs the plane which is paralele to the edge and perpendicular to the triangle plane
 	/*!
 	\pre this triangle must have its plane calculated.
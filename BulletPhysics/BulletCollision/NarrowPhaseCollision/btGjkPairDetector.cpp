@@ -15,6 +15,7 @@ subject to the following restrictions:
 
 #include "btGjkPairDetector.h"
 #include "BulletCollision/CollisionShapes/btConvexShape.h"
+#include "BulletCollision/CollisionShapes/btConvexHullShape.h"
 #include "BulletCollision/NarrowPhaseCollision/btSimplexSolverInterface.h"
 #include "BulletCollision/NarrowPhaseCollision/btConvexPenetrationDepthSolver.h"
 
@@ -37,6 +38,22 @@ subject to the following restrictions:
 int gNumDeepPenetrationChecks = 0;
 int gNumGjkChecks = 0;
 
+///convex hulls with a support graph start climbing at the previous support vertex, other shapes use the non-virtual support
+static SIMD_FORCE_INLINE btVector3	btGjkSupportVertexWithoutMargin(const btConvexShape* shape, const btVector3& dir, int& vertexHint)
+{
+#ifndef __SPU__
+	if (shape->getShapeType() == CONVEX_HULL_SHAPE_PROXYTYPE)
+	{
+		const btConvexHullShape* hullShape = static_cast<const btConvexHullShape*>(shape);
+		if (hullShape->hasSupportGraph())
+		{
+			return hullShape->localGetSupportingVertexWithoutMarginWarmStart(dir, vertexHint);
+		}
+	}
+#endif //__SPU__
+	return shape->localGetSupportVertexWithoutMarginNonVirtual(dir);
+}
+
 
 btGjkPairDetector::btGjkPairDetector(const btConvexShape* objectA,const btConvexShape* objectB,btSimplexSolverInterface* simplexSolver,btConvexPenetrationDepthSolver*	penetrationDepthSolver)
 :m_cachedSeparatingAxis(btScalar(0.),btScalar(1.),btScalar(0.)),
@@ -49,6 +66,8 @@ m_shapeTypeB(objectB->getShapeType()),
 m_marginA(objectA->getMargin()),
 m_marginB(objectB->getMargin()),
 m_ignoreMargin(false),
+m_supportVertexHintA(-1),
+m_supportVertexHintB(-1),
 m_lastUsedMethod(-1),
 m_catchDegeneracies(1)
 {
@@ -64,6 +83,8 @@ m_shapeTypeB(shapeTypeB),
 m_marginA(marginA),
 m_marginB(marginB),
 m_ignoreMargin(false),
+m_supportVertexHintA(-1),
+m_supportVertexHintB(-1),
 m_lastUsedMethod(-1),
 m_catchDegeneracies(1)
 {
@@ -143,8 +164,8 @@ void btGjkPairDetector::getClosestPointsNonVirtual(const ClosestPointInput& inpu
 
 #if 1
 
-			btVector3 pInA = m_minkowskiA->localGetSupportVertexWithoutMarginNonVirtual(seperatingAxisInA);
-			btVector3 qInB = m_minkowskiB->localGetSupportVertexWithoutMarginNonVirtual(seperatingAxisInB);
+			btVector3 pInA = btGjkSupportVertexWithoutMargin(m_minkowskiA, seperatingAxisInA, m_supportVertexHintA);
+			btVector3 qInB = btGjkSupportVertexWithoutMargin(m_minkowskiB, seperatingAxisInB, m_supportVertexHintB);
 
 //			btVector3 pInA  = localGetSupportingVertexWithoutMargin(m_shapeTypeA, m_minkowskiA, seperatingAxisInA,input.m_convexVertexData[0]);//, &featureIndexA);
 //			btVector3 qInB  = localGetSupportingVertexWithoutMargin(m_shapeTypeB, m_minkowskiB, seperatingAxisInB,input.m_convexVertexData[1]);//, &featureIndexB);
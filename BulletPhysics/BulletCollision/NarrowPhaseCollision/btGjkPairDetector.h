@@ -43,6 +43,10 @@ class btGjkPairDetector : public btDiscreteCollisionDetectorInterface
 
 	bool		m_ignoreMargin;
 	btScalar	m_cachedSeparatingDistance;
+
+	///last support vertices of convex hulls with a support graph, see btConvexHullShape::initializeSupportGraph
+	int			m_supportVertexHintA;
+	int			m_supportVertexHintB;
 	
 
 public:
@@ -91,6 +95,24 @@ public:
 		m_penetrationDepthSolver = penetrationDepthSolver;
 	}
 
+	///the hints warm-start the support queries of convex hulls with a support graph. Collision algorithms that persist per pair
+	///can keep them across calls, -1 (the default) starts from scratch.
+	void	setSupportVertexHints(int hintA, int hintB)
+	{
+		m_supportVertexHintA = hintA;
+		m_supportVertexHintB = hintB;
+	}
+
+	int		getSupportVertexHintA() const
+	{
+		return m_supportVertexHintA;
+	}
+
+	int		getSupportVertexHintB() const
+	{
+		return m_supportVertexHintB;
+	}
+
 	///don't use setIgnoreMargin, it's for Bullet's internal use
 	void	setIgnoreMargin(bool ignoreMargin)
 	{
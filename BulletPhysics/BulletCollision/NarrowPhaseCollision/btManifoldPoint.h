@@ -39,71 +39,64 @@ typedef sce::PhysicsEffects::PfxConstraintRow btConstraintRow;
 
 /// ManifoldContactPoint collects and maintains persistent contactpoints.
 /// used to improve stability and performance of rigidbody dynamics response.
+/// The members are ordered hot to cold: everything the constraint solver reads and writes back
+/// (btSequentialImpulseConstraintSolver::convertContact, setupContactConstraint, writeback) sits in the first 128 bytes,
+/// the local points used by the manifold refresh and the contact triangle ids follow.
+/// The per-point constraint rows of the parallel solver are kept by btPersistentManifold, see btPersistentManifold::getConstraintRows.
 class btManifoldPoint
 	{
 		public:
 			btManifoldPoint()
-				:m_userPersistentData(0),
-				m_appliedImpulse(0.f),
-				m_lateralFrictionInitialized(false),
+				:m_appliedImpulse(0.f),
 				m_appliedImpulseLateral1(0.f),
 				m_appliedImpulseLateral2(0.f),
 				m_contactMotion1(0.f),
 				m_contactMotion2(0.f),
 				m_contactCFM1(0.f),
 				m_contactCFM2(0.f),
-				m_lifeTime(0)
+				m_lifeTime(0),
+				m_lateralFrictionInitialized(false),
+				m_userPersistentData(0)
 			{
 			}
 
 			btManifoldPoint( const btVector3 &pointA, const btVector3 &pointB, 
 					const btVector3 &normal, 
 					btScalar distance ) :
-					m_localPointA( pointA ), 
-					m_localPointB( pointB ), 
 					m_normalWorldOnB( normal ), 
 					m_distance1( distance ),
 					m_combinedFriction(btScalar(0.)),
 					m_combinedRestitution(btScalar(0.)),
-					m_userPersistentData(0),
 					m_appliedImpulse(0.f),
-					m_lateralFrictionInitialized(false),
 					m_appliedImpulseLateral1(0.f),
 					m_appliedImpulseLateral2(0.f),
 					m_contactMotion1(0.f),
 					m_contactMotion2(0.f),
 					m_contactCFM1(0.f),
 					m_contactCFM2(0.f),
-					m_lifeTime(0)
+					m_lifeTime(0),
+					m_lateralFrictionInitialized(false),
+					m_localPointA( pointA ), 
+					m_localPointB( pointB ), 
+					m_userPersistentData(0)
 			{
-				mConstraintRow[0].m_accumImpulse = 0.f;
-				mConstraintRow[1].m_accumImpulse = 0.f;
-				mConstraintRow[2].m_accumImpulse = 0.f;
 			}
 
-			
+			//hot data, read by the solver setup and written back after solving
 
-			btVector3 m_localPointA;			
-			btVector3 m_localPointB;			
 			btVector3	m_positionWorldOnB;
 			///m_positionWorldOnA is redundant information, see getPositionWorldOnA(), but for clarity
 			btVector3	m_positionWorldOnA;
 			btVector3 m_normalWorldOnB;
-		
+
+			btVector3		m_lateralFrictionDir1;
+			btVector3		m_lateralFrictionDir2;
+
 			btScalar	m_distance1;
 			btScalar	m_combinedFriction;
 			btScalar	m_combinedRestitution;
 
-         //BP mod, store contact triangles.
-         int	   m_partId0;
-         int      m_partId1;
-         int      m_index0;
-         int      m_index1;
-				
-			mutable void*	m_userPersistentData;
 			btScalar		m_appliedImpulse;
-
-			bool			m_lateralFrictionInitialized;
 			btScalar		m_appliedImpulseLateral1;
 			btScalar		m_appliedImpulseLateral2;
 			btScalar		m_contactMotion1;
@@ -112,13 +105,20 @@ class btManifoldPoint
 			btScalar		m_contactCFM2;
 
 			int				m_lifeTime;//lifetime of the contactpoint in frames
-			
-			btVector3		m_lateralFrictionDir1;
-			btVector3		m_lateralFrictionDir2;
+			bool			m_lateralFrictionInitialized;
 
+			//cold data, used by the manifold refresh, the contact callbacks and user code
 
+			btVector3 m_localPointA;			
+			btVector3 m_localPointB;			
 
-			btConstraintRow mConstraintRow[3];
+			mutable void*	m_userPersistentData;
+
+         //BP mod, store contact triangles.
+         int	   m_partId0;
+         int      m_partId1;
+         int      m_index0;
+         int      m_index1;
 
 
 			btScalar getDistance() const
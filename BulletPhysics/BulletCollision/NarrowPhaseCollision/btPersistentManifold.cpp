@@ -29,6 +29,7 @@ btPersistentManifold::btPersistentManifold()
 m_body0(0),
 m_body1(0),
 m_cachedPoints (0),
+m_speculativeDistance(btScalar(0.)),
 m_index1a(0)
 {
 }
@@ -189,6 +190,7 @@ int btPersistentManifold::addManifoldPoint(const btManifoldPoint& newPoint)
 
 	btAssert(m_pointCache[insertIndex].m_userPersistentData==0);
 	m_pointCache[insertIndex] = newPoint;
+	clearConstraintRows(insertIndex);
 	return insertIndex;
 }
 
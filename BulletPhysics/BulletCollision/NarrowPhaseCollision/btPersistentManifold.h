@@ -65,7 +65,18 @@ ATTRIBUTE_ALIGNED128( class) btPersistentManifold : public btTypedObject
 
 	btScalar	m_contactBreakingThreshold;
 	btScalar	m_contactProcessingThreshold;
+	///extra distance up to which separated contacts are kept, see btDispatcherInfo::m_useSpeculativeContacts
+	btScalar	m_speculativeDistance;
 
+	///constraint rows (normal and two friction directions) of each cached point, only used by the parallel solver
+	btConstraintRow	m_constraintRows[MANIFOLD_CACHE_SIZE][3];
+
+	void	clearConstraintRows(int index)
+	{
+		m_constraintRows[index][0].m_accumImpulse = 0.f;
+		m_constraintRows[index][1].m_accumImpulse = 0.f;
+		m_constraintRows[index][2].m_accumImpulse = 0.f;
+	}
 	
 	/// sort cached points so most isolated points come first
 	int	sortCachedPoints(const btManifoldPoint& pt);
@@ -87,7 +98,8 @@ public:
 		: btTypedObject(BT_PERSISTENT_MANIFOLD_TYPE),
 	m_body0(body0),m_body1(body1),m_cachedPoints(0),
 		m_contactBreakingThreshold(contactBreakingThreshold),
-		m_contactProcessingThreshold(contactProcessingThreshold)
+		m_contactProcessingThreshold(contactProcessingThreshold),
+		m_speculativeDistance(btScalar(0.))
 	{
 	}
 
@@ -123,6 +135,18 @@ public:
 		return m_pointCache[index];
 	}
 
+	SIMD_FORCE_INLINE const btConstraintRow* getConstraintRows(int index) const
+	{
+		btAssert(index < m_cachedPoints);
+		return m_constraintRows[index];
+	}
+
+	SIMD_FORCE_INLINE btConstraintRow* getConstraintRows(int index)
+	{
+		btAssert(index < m_cachedPoints);
+		return m_constraintRows[index];
+	}
+
 	///@todo: get this margin from the current physics / collision environment
 	btScalar	getContactBreakingThreshold() const;
 
@@ -130,6 +154,16 @@ public:
 	{
 		return m_contactProcessingThreshold;
 	}
+
+	btScalar	getSpeculativeDistance() const
+	{
+		return m_speculativeDistance;
+	}
+
+	void	setSpeculativeDistance(btScalar speculativeDistance)
+	{
+		m_speculativeDistance = speculativeDistance;
+	}
 	
 	int getCacheEntry(const btManifoldPoint& newPoint) const;
 
@@ -144,11 +178,12 @@ public:
 		if(index != lastUsedIndex) 
 		{
 			m_pointCache[index] = m_pointCache[lastUsedIndex]; 
+			m_constraintRows[index][0] = m_constraintRows[lastUsedIndex][0];
+			m_constraintRows[index][1] = m_constraintRows[lastUsedIndex][1];
+			m_constraintRows[index][2] = m_constraintRows[lastUsedIndex][2];
 			//get rid of duplicated userPersistentData pointer
 			m_pointCache[lastUsedIndex].m_userPersistentData = 0;
-			m_pointCache[lastUsedIndex].mConstraintRow[0].m_accumImpulse = 0.f;
-			m_pointCache[lastUsedIndex].mConstraintRow[1].m_accumImpulse = 0.f;
-			m_pointCache[lastUsedIndex].mConstraintRow[2].m_accumImpulse = 0.f;
+			clearConstraintRows(lastUsedIndex);
 
 			m_pointCache[lastUsedIndex].m_appliedImpulse = 0.f;
 			m_pointCache[lastUsedIndex].m_lateralFrictionInitialized = false;
@@ -167,9 +202,9 @@ public:
 #define MAINTAIN_PERSISTENCY 1
 #ifdef MAINTAIN_PERSISTENCY
 		int	lifeTime = m_pointCache[insertIndex].getLifeTime();
-		btScalar	appliedImpulse = m_pointCache[insertIndex].mConstraintRow[0].m_accumImpulse;
-		btScalar	appliedLateralImpulse1 = m_pointCache[insertIndex].mConstraintRow[1].m_accumImpulse;
-		btScalar	appliedLateralImpulse2 = m_pointCache[insertIndex].mConstraintRow[2].m_accumImpulse;
+		btScalar	appliedImpulse = m_constraintRows[insertIndex][0].m_accumImpulse;
+		btScalar	appliedLateralImpulse1 = m_constraintRows[insertIndex][1].m_accumImpulse;
+		btScalar	appliedLateralImpulse2 = m_constraintRows[insertIndex][2].m_accumImpulse;
 //		bool isLateralFrictionInitialized = m_pointCache[insertIndex].m_lateralFrictionInitialized;
 		
 		
@@ -184,15 +219,16 @@ public:
 		m_pointCache[insertIndex].m_appliedImpulseLateral1 = appliedLateralImpulse1;
 		m_pointCache[insertIndex].m_appliedImpulseLateral2 = appliedLateralImpulse2;
 		
-		m_pointCache[insertIndex].mConstraintRow[0].m_accumImpulse =  appliedImpulse;
-		m_pointCache[insertIndex].mConstraintRow[1].m_accumImpulse = appliedLateralImpulse1;
-		m_pointCache[insertIndex].mConstraintRow[2].m_accumImpulse = appliedLateralImpulse2;
+		m_constraintRows[insertIndex][0].m_accumImpulse =  appliedImpulse;
+		m_constraintRows[insertIndex][1].m_accumImpulse = appliedLateralImpulse1;
+		m_constraintRows[insertIndex][2].m_accumImpulse = appliedLateralImpulse2;
 
 
 		m_pointCache[insertIndex].m_lifeTime = lifeTime;
 #else
 		clearUserCache(m_pointCache[insertIndex]);
 		m_pointCache[insertIndex] = newPoint;
+		clearConstraintRows(insertIndex);
 	
 #endif
 	}
@@ -200,7 +236,7 @@ public:
 	
 	bool validContactDistance(const btManifoldPoint& pt) const
 	{
-		return pt.m_distance1 <= getContactBreakingThreshold();
+		return pt.m_distance1 <= getContactBreakingThreshold() + m_speculativeDistance;
 	}
 	/// calculated new worldspace coordinates and depth, and reject points that exceed the collision margin
 	void	refreshContactPoints(  const btTransform& trA,const btTransform& trB);
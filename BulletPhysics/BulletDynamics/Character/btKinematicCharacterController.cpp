@@ -21,6 +21,9 @@ subject to the following restrictions:
 #include "BulletCollision/BroadphaseCollision/btCollisionAlgorithm.h"
 #include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
 #include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btAabbUtil2.h"
+#include "LinearMath/btTransformUtil.h"
+#include "LinearMath/btQuickprof.h"
 #include "btKinematicCharacterController.h"
 
 
@@ -100,6 +103,27 @@ protected:
 	btScalar m_minSlopeDot;
 };
 
+///collects the objects whose broadphase aabb overlaps the region the character can reach during a tick
+struct btKinematicSweepCandidateCallback : public btBroadphaseAabbCallback
+{
+	btCollisionObject* m_me;
+	btAlignedObjectArray<btCollisionObject*>& m_candidates;
+
+	btKinematicSweepCandidateCallback (btCollisionObject* me, btAlignedObjectArray<btCollisionObject*>& candidates)
+	: m_me(me)
+	, m_candidates(candidates)
+	{
+	}
+
+	virtual bool process (const btBroadphaseProxy* proxy)
+	{
+		btCollisionObject* collisionObject = (btCollisionObject*)proxy->m_clientObject;
+		if (collisionObject != m_me)
+			m_candidates.push_back(collisionObject);
+		return true;
+	}
+};
+
 /*
  * Returns the reflection direction of a ray going 'direction' hitting a surface with normal 'normal'
  *
@@ -146,6 +170,7 @@ btKinematicCharacterController::btKinematicCharacterController (btPairCachingGho
 	m_jumpSpeed = 10.0; // ?
 	m_wasOnGround = false;
 	m_wasJumping = false;
+	m_hasRecoveryState = false;
 	setMaxSlope(btRadians(45.0));
 }
 
@@ -213,6 +238,115 @@ bool btKinematicCharacterController::recoverFromPenetration ( btCollisionWorld*
 	return penetration;
 }
 
+void btKinematicCharacterController::saveRecoveryStart ()
+{
+	btOverlappingPairCache* pairCache = m_ghostObject->getOverlappingPairCache();
+	int numPairs = pairCache->getNumOverlappingPairs();
+
+	m_recoveryStartTransform = m_ghostObject->getWorldTransform();
+	m_recoveryPairObjects.resize(numPairs);
+	m_recoveryPairTransforms.resize(numPairs, btTransform::getIdentity());
+	for (int i = 0; i < numPairs; i++)
+	{
+		const btBroadphasePair& pair = pairCache->getOverlappingPairArray()[i];
+		const btCollisionObject* other = (const btCollisionObject*)pair.m_pProxy0->m_clientObject;
+		if (other == m_ghostObject)
+			other = (const btCollisionObject*)pair.m_pProxy1->m_clientObject;
+		m_recoveryPairObjects[i] = other;
+		m_recoveryPairTransforms[i] = other->getWorldTransform();
+	}
+}
+
+bool btKinematicCharacterController::isRecoveryStateUnchanged () const
+{
+	if (!m_hasRecoveryState)
+		return false;
+
+	btOverlappingPairCache* pairCache = m_ghostObject->getOverlappingPairCache();
+	int numPairs = pairCache->getNumOverlappingPairs();
+	if (numPairs != m_recoveryPairObjects.size() || !(m_ghostObject->getWorldTransform() == m_recoveryStartTransform))
+		return false;
+
+	for (int i = 0; i < numPairs; i++)
+	{
+		const btBroadphasePair& pair = pairCache->getOverlappingPairArray()[i];
+		const btCollisionObject* other = (const btCollisionObject*)pair.m_pProxy0->m_clientObject;
+		if (other == m_ghostObject)
+			other = (const btCollisionObject*)pair.m_pProxy1->m_clientObject;
+		if (other != m_recoveryPairObjects[i] || !(other->getWorldTransform() == m_recoveryPairTransforms[i]))
+			return false;
+	}
+	return true;
+}
+
+void btKinematicCharacterController::gatherSweepCandidates (btCollisionWorld* collisionWorld, const btVector3& walkMove, btScalar dt)
+{
+	BT_PROFILE("gatherSweepCandidates");
+
+	// stepUp rises at most m_stepHeight plus the vertical offset and stepDown ends at most as far below the start,
+	// the forward sweeps move at most walkMove with the margin grown by m_addedMargin
+	btScalar reach = walkMove.length() + btScalar(2.0) * m_stepHeight + btFabs(m_verticalVelocity * dt)
+		+ m_convexShape->getMargin() + btScalar(2.0) * m_addedMargin;
+
+	btTransform xform = m_ghostObject->getWorldTransform();
+	xform.setOrigin(m_currentPosition);
+	btVector3 aabbMin, aabbMax;
+	m_convexShape->getAabb(xform, aabbMin, aabbMax);
+	aabbMin -= btVector3(reach, reach, reach);
+	aabbMax += btVector3(reach, reach, reach);
+
+	m_sweepCandidates.resize(0);
+	btKinematicSweepCandidateCallback callback(m_ghostObject, m_sweepCandidates);
+	collisionWorld->getBroadphase()->aabbTest(aabbMin, aabbMax, callback);
+}
+
+void btKinematicCharacterController::convexSweepTest (btCollisionWorld* collisionWorld, const btTransform& start, const btTransform& end, btCollisionWorld::ConvexResultCallback& callback, btScalar allowedCcdPenetration)
+{
+	if (m_useGhostObjectSweepTest)
+	{
+		m_ghostObject->convexSweepTest (m_convexShape, start, end, callback, allowedCcdPenetration);
+		return;
+	}
+
+	// same as btCollisionWorld::convexSweepTest, but only over the candidates gathered for this tick
+	btTransform convexFromTrans, convexToTrans;
+	convexFromTrans = start;
+	convexToTrans = end;
+	btVector3 castShapeAabbMin, castShapeAabbMax;
+	/* Compute AABB that encompasses angular movement */
+	{
+		btVector3 linVel, angVel;
+		btTransformUtil::calculateVelocity (convexFromTrans, convexToTrans, 1.0, linVel, angVel);
+		btTransform R;
+		R.setIdentity ();
+		R.setRotation (convexFromTrans.getRotation());
+		m_convexShape->calculateTemporalAabb (R, linVel, angVel, 1.0, castShapeAabbMin, castShapeAabbMax);
+	}
+
+	for (int i = 0; i < m_sweepCandidates.size(); i++)
+	{
+		btCollisionObject* collisionObject = m_sweepCandidates[i];
+		//only perform raycast if filterMask matches
+		if (callback.needsCollision(collisionObject->getBroadphaseHandle()))
+		{
+			btVector3 collisionObjectAabbMin = collisionObject->getBroadphaseHandle()->m_aabbMin;
+			btVector3 collisionObjectAabbMax = collisionObject->getBroadphaseHandle()->m_aabbMax;
+			AabbExpand (collisionObjectAabbMin, collisionObjectAabbMax, castShapeAabbMin, castShapeAabbMax);
+			btScalar hitLambda = btScalar(1.); //could use resultCallback.m_closestHitFraction, but needs testing
+			btVector3 hitNormal;
+			if (btRayAabb(convexFromTrans.getOrigin(), convexToTrans.getOrigin(), collisionObjectAabbMin, collisionObjectAabbMax, hitLambda, hitNormal))
+			{
+				btCollisionWorld::objectQuerySingle(m_convexShape, convexFromTrans, convexToTrans,
+					collisionObject,
+					collisionObject->getCollisionShape(),
+					collisionObject->getWorldTransform(),
+					callback,
+					allowedCcdPenetration);
+			}
+		}
+	}
+}
+
 void btKinematicCharacterController::stepUp ( btCollisionWorld* world)
 {
 	// phase 1: up
@@ -230,14 +364,7 @@ void btKinematicCharacterController::stepUp ( btCollisionWorld* world)
 	callback.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 	callback.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
 	
-	if (m_useGhostObjectSweepTest)
-	{
-		m_ghostObject->convexSweepTest (m_convexShape, start, end, callback, world->getDispatchInfo().m_allowedCcdPenetration);
-	}
-	else
-	{
-		world->convexSweepTest (m_convexShape, start, end, callback);
-	}
+	convexSweepTest (world, start, end, callback, m_useGhostObjectSweepTest ? world->getDispatchInfo().m_allowedCcdPenetration : btScalar(0.0));
 	
 	if (callback.hasHit())
 	{
@@ -332,13 +459,7 @@ void btKinematicCharacterController::stepForwardAndStrafe ( btCollisionWorld* co
 		m_convexShape->setMargin(margin + m_addedMargin);
 
 
-		if (m_useGhostObjectSweepTest)
-		{
-			m_ghostObject->convexSweepTest (m_convexShape, start, end, callback, collisionWorld->getDispatchInfo().m_allowedCcdPenetration);
-		} else
-		{
-			collisionWorld->convexSweepTest (m_convexShape, start, end, callback, collisionWorld->getDispatchInfo().m_allowedCcdPenetration);
-		}
+		convexSweepTest (collisionWorld, start, end, callback, collisionWorld->getDispatchInfo().m_allowedCcdPenetration);
 		
 		m_convexShape->setMargin(margin);
 
@@ -412,13 +533,7 @@ void btKinematicCharacterController::stepDown ( btCollisionWorld* collisionWorld
 	callback.m_collisionFilterGroup = getGhostObject()->getBroadphaseHandle()->m_collisionFilterGroup;
 	callback.m_collisionFilterMask = getGhostObject()->getBroadphaseHandle()->m_collisionFilterMask;
 	
-	if (m_useGhostObjectSweepTest)
-	{
-		m_ghostObject->convexSweepTest (m_convexShape, start, end, callback, collisionWorld->getDispatchInfo().m_allowedCcdPenetration);
-	} else
-	{
-		collisionWorld->convexSweepTest (m_convexShape, start, end, callback, collisionWorld->getDispatchInfo().m_allowedCcdPenetration);
-	}
+	convexSweepTest (collisionWorld, start, end, callback, collisionWorld->getDispatchInfo().m_allowedCcdPenetration);
 
 	if (callback.hasHit())
 	{
@@ -477,23 +592,41 @@ void btKinematicCharacterController::warp (const btVector3& origin)
 	xform.setIdentity();
 	xform.setOrigin (origin);
 	m_ghostObject->setWorldTransform (xform);
+	m_hasRecoveryState = false;
 }
 
 
 void btKinematicCharacterController::preStep (  btCollisionWorld* collisionWorld)
 {
 	
-	int numPenetrationLoops = 0;
-	m_touchingContact = false;
-	while (recoverFromPenetration (collisionWorld))
+	if (isRecoveryStateUnchanged())
 	{
-		numPenetrationLoops++;
-		m_touchingContact = true;
-		if (numPenetrationLoops > 4)
+		// nothing the last recovery started from has moved, it would end up in the same place again
+		m_ghostObject->setWorldTransform (m_recoveryEndTransform);
+		m_touchingContact = m_recoveryTouchingContact;
+		m_touchingNormal = m_recoveryTouchingNormal;
+	}
+	else
+	{
+		saveRecoveryStart ();
+
+		int numPenetrationLoops = 0;
+		m_touchingContact = false;
+		while (recoverFromPenetration (collisionWorld))
 		{
-			//printf("character could not recover from penetration = %d\n", numPenetrationLoops);
-			break;
+			numPenetrationLoops++;
+			m_touchingContact = true;
+			if (numPenetrationLoops > 4)
+			{
+				//printf("character could not recover from penetration = %d\n", numPenetrationLoops);
+				break;
+			}
 		}
+
+		m_recoveryEndTransform = m_ghostObject->getWorldTransform();
+		m_recoveryTouchingContact = m_touchingContact;
+		m_recoveryTouchingNormal = m_touchingNormal;
+		m_hasRecoveryState = true;
 	}
 
 	m_currentPosition = m_ghostObject->getWorldTransform().getOrigin();
@@ -537,9 +670,9 @@ void btKinematicCharacterController::playerStep (  btCollisionWorld* collisionWo
 //	printf("walkDirection(%f,%f,%f)\n",walkDirection[0],walkDirection[1],walkDirection[2]);
 //	printf("walkSpeed=%f\n",walkSpeed);
 
-	stepUp (collisionWorld);
+	btVector3 walkMove;
 	if (m_useWalkDirection) {
-		stepForwardAndStrafe (collisionWorld, m_walkDirection);
+		walkMove = m_walkDirection;
 	} else {
 		//printf("  time: %f", m_velocityTimeInterval);
 		// still have some time left for moving!
@@ -548,13 +681,17 @@ void btKinematicCharacterController::playerStep (  btCollisionWorld* collisionWo
 		m_velocityTimeInterval -= dt;
 
 		// how far will we move while we are moving?
-		btVector3 move = m_walkDirection * dtMoving;
+		walkMove = m_walkDirection * dtMoving;
 
 		//printf("  dtMoving: %f", dtMoving);
-
-		// okay, step
-		stepForwardAndStrafe(collisionWorld, move);
 	}
+
+	if (!m_useGhostObjectSweepTest)
+		gatherSweepCandidates (collisionWorld, walkMove, dt);
+
+	stepUp (collisionWorld);
+	// okay, step
+	stepForwardAndStrafe (collisionWorld, walkMove);
 	stepDown (collisionWorld, dt);
 
 	// printf("\n");
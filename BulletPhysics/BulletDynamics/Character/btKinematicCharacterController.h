@@ -22,6 +22,7 @@ subject to the following restrictions:
 #include "btCharacterControllerInterface.h"
 
 #include "BulletCollision/BroadphaseCollision/btCollisionAlgorithm.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
 
 
 class btCollisionShape;
@@ -79,6 +80,21 @@ protected:
 	btScalar	m_velocityTimeInterval;
 	int m_upAxis;
 
+	///the objects the sweeps of a tick can hit, gathered from the broadphase once per playerStep when not using the ghost object sweep test
+	btAlignedObjectArray<btCollisionObject*>	m_sweepCandidates;
+
+	///what the last penetration recovery started from: the ghost transform and, per overlapping pair, the other object and its transform.
+	///While none of it changes, recovery would come to the same result again, so preStep reuses that result instead of running it.
+	///The ghost contact manifolds are not refreshed on the skipped ticks.
+	bool	m_hasRecoveryState;
+	btTransform	m_recoveryStartTransform;
+	btAlignedObjectArray<const btCollisionObject*>	m_recoveryPairObjects;
+	btAlignedObjectArray<btTransform>	m_recoveryPairTransforms;
+	///the result of the last penetration recovery
+	btTransform	m_recoveryEndTransform;
+	bool	m_recoveryTouchingContact;
+	btVector3	m_recoveryTouchingNormal;
+
 	static btVector3* getUpAxisDirections();
 
 	btVector3 computeReflectionDirection (const btVector3& direction, const btVector3& normal);
@@ -86,6 +102,10 @@ protected:
 	btVector3 perpindicularComponent (const btVector3& direction, const btVector3& normal);
 
 	bool recoverFromPenetration ( btCollisionWorld* collisionWorld);
+	void saveRecoveryStart ();
+	bool isRecoveryStateUnchanged () const;
+	void gatherSweepCandidates (btCollisionWorld* collisionWorld, const btVector3& walkMove, btScalar dt);
+	void convexSweepTest (btCollisionWorld* collisionWorld, const btTransform& start, const btTransform& end, btCollisionWorld::ConvexResultCallback& callback, btScalar allowedCcdPenetration);
 	void stepUp (btCollisionWorld* collisionWorld);
 	void updateTargetPositionBasedOnCollision (const btVector3& hit_normal, btScalar tangentMag = btScalar(0.0), btScalar normalMag = btScalar(1.0));
 	void stepForwardAndStrafe (btCollisionWorld* collisionWorld, const btVector3& walkMove);
@@ -456,7 +456,7 @@ void btSequentialImpulseConstraintSolver::setupContactConstraint(btSolverConstra
 																 btCollisionObject* colObj0, btCollisionObject* colObj1,
 																 btManifoldPoint& cp, const btContactSolverInfo& infoGlobal,
 																 btVector3& vel, btScalar& rel_vel, btScalar& relaxation,
-																 btVector3& rel_pos1, btVector3& rel_pos2)
+																 btVector3& rel_pos1, btVector3& rel_pos2, bool speculative)
 {
 			btRigidBody* rb0 = btRigidBody::upcast(colObj0);
 			btRigidBody* rb1 = btRigidBody::upcast(colObj1);
@@ -519,7 +519,9 @@ void btSequentialImpulseConstraintSolver::setupContactConstraint(btSolverConstra
 
 				btScalar restitution = 0.f;
 				
-				if (cp.m_lifeTime>infoGlobal.m_restingContactRestitutionThreshold)
+				///a speculative contact only closes the gap within the step, it must not bounce
+				///or start from the impulse of an earlier step
+				if (speculative || cp.m_lifeTime>infoGlobal.m_restingContactRestitutionThreshold)
 				{
 					restitution = 0.f;
 				} else
@@ -533,7 +535,7 @@ void btSequentialImpulseConstraintSolver::setupContactConstraint(btSolverConstra
 
 
 				///warm starting (or zero if disabled)
-				if (infoGlobal.m_solverMode & SOLVER_USE_WARMSTARTING)
+				if ((infoGlobal.m_solverMode & SOLVER_USE_WARMSTARTING) && !speculative)
 				{
 					solverConstraint.m_appliedImpulse = cp.m_appliedImpulse * infoGlobal.m_warmstartingFactor;
 					if (rb0)
@@ -595,9 +597,10 @@ void btSequentialImpulseConstraintSolver::setupContactConstraint(btSolverConstra
 
 void btSequentialImpulseConstraintSolver::setFrictionConstraintImpulse( btSolverConstraint& solverConstraint, 
 																		btRigidBody* rb0, btRigidBody* rb1, 
-																 btManifoldPoint& cp, const btContactSolverInfo& infoGlobal)
+																 btManifoldPoint& cp, const btContactSolverInfo& infoGlobal, bool speculative)
 {
-					if (infoGlobal.m_solverMode & SOLVER_USE_FRICTION_WARMSTARTING)
+					//speculative contacts start without impulse, as in setupContactConstraint
+					if ((infoGlobal.m_solverMode & SOLVER_USE_FRICTION_WARMSTARTING) && !speculative)
 					{
 						{
 							btSolverConstraint& frictionConstraint1 = m_tmpSolverContactFrictionConstraintPool[solverConstraint.m_frictionIndex];
@@ -672,6 +675,10 @@ void	btSequentialImpulseConstraintSolver::convertContact(btPersistentManifold* m
 			btScalar rel_vel;
 			btVector3 vel;
 
+			///contacts beyond the breaking threshold are only kept for the speculative distance of the manifold,
+			///see btDispatcherInfo::m_useSpeculativeContacts
+			bool speculative = manifold->getSpeculativeDistance() > btScalar(0.) && cp.getDistance() > manifold->getContactBreakingThreshold();
+
 			int frictionIndex = m_tmpSolverContactConstraintPool.size();
 			btSolverConstraint& solverConstraint = m_tmpSolverContactConstraintPool.expandNonInitializing();
 			btRigidBody* rb0 = btRigidBody::upcast(colObj0);
@@ -680,7 +687,7 @@ void	btSequentialImpulseConstraintSolver::convertContact(btPersistentManifold* m
 			solverConstraint.m_solverBodyB = rb1? rb1 : &getFixedBody();
 			solverConstraint.m_originalContactPoint = &cp;
 
-			setupContactConstraint(solverConstraint, colObj0, colObj1, cp, infoGlobal, vel, rel_vel, relaxation, rel_pos1, rel_pos2);
+			setupContactConstraint(solverConstraint, colObj0, colObj1, cp, infoGlobal, vel, rel_vel, relaxation, rel_pos1, rel_pos2, speculative);
 
 //			const btVector3& pos1 = cp.getPositionWorldOnA();
 //			const btVector3& pos2 = cp.getPositionWorldOnB();
@@ -734,7 +741,7 @@ void	btSequentialImpulseConstraintSolver::convertContact(btPersistentManifold* m
 					addFrictionConstraint(cp.m_lateralFrictionDir2,solverBodyA,solverBodyB,frictionIndex,cp,rel_pos1,rel_pos2,colObj0,colObj1, relaxation, cp.m_contactMotion2, cp.m_contactCFM2);
 			}
 			
-			setFrictionConstraintImpulse( solverConstraint, rb0, rb1, cp, infoGlobal);
+			setFrictionConstraintImpulse( solverConstraint, rb0, rb1, cp, infoGlobal, speculative);
 
 		}
 	}
@@ -960,6 +967,7 @@ btScalar btSequentialImpulseConstraintSolver::solveGroupCacheFriendlySetup(btCol
 
 	int numConstraintPool = m_tmpSolverContactConstraintPool.size();
 	int numFrictionPool = m_tmpSolverContactFrictionConstraintPool.size();
+	BT_PROFILE_COUNTER(BT_PROFILE_COUNTER_SOLVER_ROWS, numConstraintPool + numFrictionPool + m_tmpSolverNonContactConstraintPool.size());
 
 	///@todo: use stack allocator for such temporarily memory, same for solver bodies/constraints
 	m_orderTmpConstraintPool.resize(numConstraintPool);
@@ -45,10 +45,10 @@ protected:
 	
 	void setupContactConstraint(btSolverConstraint& solverConstraint, btCollisionObject* colObj0, btCollisionObject* colObj1, btManifoldPoint& cp, 
 								const btContactSolverInfo& infoGlobal, btVector3& vel, btScalar& rel_vel, btScalar& relaxation, 
-								btVector3& rel_pos1, btVector3& rel_pos2);
+								btVector3& rel_pos1, btVector3& rel_pos2, bool speculative);
 
 	void setFrictionConstraintImpulse( btSolverConstraint& solverConstraint, btRigidBody* rb0, btRigidBody* rb1, 
-										 btManifoldPoint& cp, const btContactSolverInfo& infoGlobal);
+										 btManifoldPoint& cp, const btContactSolverInfo& infoGlobal, bool speculative);
 
 	///m_btSeed2 is used for re-arranging the constraint rows. improves convergence/quality of friction
 	unsigned long	m_btSeed2;
@@ -24,6 +24,7 @@ subject to the following restrictions:
 #include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
 #include "LinearMath/btTransformUtil.h"
 #include "LinearMath/btQuickprof.h"
+#include "LinearMath/btThreads.h"
 
 //rigidbody & constraints
 #include "BulletDynamics/Dynamics/btRigidBody.h"
@@ -310,11 +311,15 @@ void	btDiscreteDynamicsWorld::internalSingleStepSimulation(btScalar timeStep)
 	
 	BT_PROFILE("internalSingleStepSimulation");
 
+	///scratch memory of the previous step is released, the stage counters now describe this step
+	m_frameArena.reset();
+
 	if(0 != m_internalPreTickCallback) {
 		(*m_internalPreTickCallback)(this, timeStep);
 	}	
 
 	///apply gravity, predict motion
+	m_frameArena.setStage(BT_FRAME_STAGE_PREDICT_MOTION);
 	predictUnconstraintMotion(timeStep);
 
 	btDispatcherInfo& dispatchInfo = getDispatchInfo();
@@ -325,9 +330,11 @@ void	btDiscreteDynamicsWorld::internalSingleStepSimulation(btScalar timeStep)
 
 
 	///perform collision detection
+	m_frameArena.setStage(BT_FRAME_STAGE_OTHER);
 	performDiscreteCollisionDetection();
 
 
+	m_frameArena.setStage(BT_FRAME_STAGE_ISLANDS);
 	calculateSimulationIslands();
 
 	
@@ -336,11 +343,13 @@ void	btDiscreteDynamicsWorld::internalSingleStepSimulation(btScalar timeStep)
 
 
 	///solve contact and other joint constraints
+	m_frameArena.setStage(BT_FRAME_STAGE_SOLVER);
 	solveConstraints(getSolverInfo());
 	
 	///CallbackTriggers();
 
 	///integrate transforms
+	m_frameArena.setStage(BT_FRAME_STAGE_INTEGRATE);
 	integrateTransforms(timeStep);
 
 	///update vehicle simulation
@@ -348,6 +357,12 @@ void	btDiscreteDynamicsWorld::internalSingleStepSimulation(btScalar timeStep)
 	
 	updateActivationState( timeStep );
 
+	m_frameArena.setStage(BT_FRAME_STAGE_OTHER);
+
+#ifndef BT_NO_PROFILE
+	btProfiler::flushCounters();
+#endif //BT_NO_PROFILE
+
 	if(0 != m_internalTickCallback) {
 		(*m_internalTickCallback)(this, timeStep);
 	}	
@@ -577,9 +592,13 @@ void	btDiscreteDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
 		btStackAlloc*			m_stackAlloc;
 		btDispatcher*			m_dispatcher;
 		
-		btAlignedObjectArray<btCollisionObject*> m_bodies;
-		btAlignedObjectArray<btPersistentManifold*> m_manifolds;
-		btAlignedObjectArray<btTypedConstraint*> m_constraints;
+		///batches of small islands, the buffers come from the frame arena and can hold every body/manifold/constraint
+		btCollisionObject**		m_bodies;
+		btPersistentManifold**	m_manifolds;
+		btTypedConstraint**		m_constraints;
+		int						m_numBodies;
+		int						m_numManifolds;
+		int						m_numBatchedConstraints;
 
 
 		InplaceSolverIslandCallback(
@@ -589,16 +608,29 @@ void	btDiscreteDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
 			int	numConstraints,
 			btIDebugDraw*	debugDrawer,
 			btStackAlloc*			stackAlloc,
-			btDispatcher* dispatcher)
+			btDispatcher* dispatcher,
+			btFrameArena& frameArena,
+			int maxBodies)
 			:m_solverInfo(solverInfo),
 			m_solver(solver),
 			m_sortedConstraints(sortedConstraints),
 			m_numConstraints(numConstraints),
 			m_debugDrawer(debugDrawer),
 			m_stackAlloc(stackAlloc),
-			m_dispatcher(dispatcher)
+			m_dispatcher(dispatcher),
+			m_bodies(0),
+			m_manifolds(0),
+			m_constraints(0),
+			m_numBodies(0),
+			m_numManifolds(0),
+			m_numBatchedConstraints(0)
 		{
-
+			if (m_solverInfo.m_minimumSolverBatchSize>1)
+			{
+				m_bodies = frameArena.allocateArray<btCollisionObject*>(maxBodies);
+				m_manifolds = frameArena.allocateArray<btPersistentManifold*>(dispatcher->getNumManifolds());
+				m_constraints = frameArena.allocateArray<btTypedConstraint*>(numConstraints);
+			}
 		}
 
 
@@ -653,12 +685,12 @@ void	btDiscreteDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
 				{
 					
 					for (i=0;i<numBodies;i++)
-						m_bodies.push_back(bodies[i]);
+						m_bodies[m_numBodies++] = bodies[i];
 					for (i=0;i<numManifolds;i++)
-						m_manifolds.push_back(manifolds[i]);
+						m_manifolds[m_numManifolds++] = manifolds[i];
 					for (i=0;i<numCurConstraints;i++)
-						m_constraints.push_back(startConstraint[i]);
-					if ((m_constraints.size()+m_manifolds.size())>m_solverInfo.m_minimumSolverBatchSize)
+						m_constraints[m_numBatchedConstraints++] = startConstraint[i];
+					if ((m_numBatchedConstraints+m_numManifolds)>m_solverInfo.m_minimumSolverBatchSize)
 					{
 						processConstraints();
 					} else
@@ -670,18 +702,13 @@ void	btDiscreteDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
 		}
 		void	processConstraints()
 		{
-			if (m_manifolds.size() + m_constraints.size()>0)
+			if (m_numManifolds + m_numBatchedConstraints>0)
 			{
-
-				btCollisionObject** bodies = m_bodies.size()? &m_bodies[0]:0;
-				btPersistentManifold** manifold = m_manifolds.size()?&m_manifolds[0]:0;
-				btTypedConstraint** constraints = m_constraints.size()?&m_constraints[0]:0;
-				
-				m_solver->solveGroup( bodies,m_bodies.size(),manifold, m_manifolds.size(),constraints, m_constraints.size() ,m_solverInfo,m_debugDrawer,m_stackAlloc,m_dispatcher);
+				m_solver->solveGroup( m_bodies,m_numBodies,m_manifolds, m_numManifolds,m_constraints, m_numBatchedConstraints ,m_solverInfo,m_debugDrawer,m_stackAlloc,m_dispatcher);
 			}
-			m_bodies.resize(0);
-			m_manifolds.resize(0);
-			m_constraints.resize(0);
+			m_numBodies = 0;
+			m_numManifolds = 0;
+			m_numBatchedConstraints = 0;
 
 		}
 
@@ -690,23 +717,22 @@ void	btDiscreteDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
 	
 
 	//sorted version of all btTypedConstraint, based on islandId
-	btAlignedObjectArray<btTypedConstraint*>	sortedConstraints;
-	sortedConstraints.resize( m_constraints.size());
+	m_sortedConstraints.resize( m_constraints.size());
 	int i; 
 	for (i=0;i<getNumConstraints();i++)
 	{
-		sortedConstraints[i] = m_constraints[i];
+		m_sortedConstraints[i] = m_constraints[i];
 	}
 
 //	btAssert(0);
 		
 	
 
-	sortedConstraints.quickSort(btSortConstraintOnIslandPredicate());
+	m_sortedConstraints.quickSort(btSortConstraintOnIslandPredicate());
 	
-	btTypedConstraint** constraintsPtr = getNumConstraints() ? &sortedConstraints[0] : 0;
+	btTypedConstraint** constraintsPtr = getNumConstraints() ? &m_sortedConstraints[0] : 0;
 	
-	InplaceSolverIslandCallback	solverCallback(	solverInfo,	m_constraintSolver, constraintsPtr,sortedConstraints.size(),	m_debugDrawer,m_stackAlloc,m_dispatcher1);
+	InplaceSolverIslandCallback	solverCallback(	solverInfo,	m_constraintSolver, constraintsPtr,m_sortedConstraints.size(),	m_debugDrawer,m_stackAlloc,m_dispatcher1,m_frameArena,getCollisionWorld()->getNumCollisionObjects());
 	
 	m_constraintSolver->prepareSolve(getCollisionWorld()->getNumCollisionObjects(), getCollisionWorld()->getDispatcher()->getNumManifolds());
 	
@@ -743,7 +769,7 @@ void	btDiscreteDynamicsWorld::calculateSimulationIslands()
 				if (colObj0->isActive() || colObj1->isActive())
 				{
 
-					getSimulationIslandManager()->getUnionFind().unite((colObj0)->getIslandTag(),
+					getSimulationIslandManager()->addIslandEdge((colObj0)->getIslandTag(),
 						(colObj1)->getIslandTag());
 				}
 			}
@@ -842,110 +868,255 @@ public:
 
 };
 
+#ifdef USE_STATIC_ONLY
+class btStaticOnlyNotMeConvexResultCallback : public btClosestNotMeConvexResultCallback
+{
+public:
+
+	btStaticOnlyNotMeConvexResultCallback (btCollisionObject* me,const btVector3& fromA,const btVector3& toA,btOverlappingPairCache* pairCache,btDispatcher* dispatcher) : 
+	  btClosestNotMeConvexResultCallback(me,fromA,toA,pairCache,dispatcher)
+	{
+	}
+
+	virtual bool needsCollision(btBroadphaseProxy* proxy0) const
+	{
+		btCollisionObject* otherObj = (btCollisionObject*) proxy0->m_clientObject;
+		if (!otherObj->isStaticOrKinematicObject())
+			return false;
+		return btClosestNotMeConvexResultCallback::needsCollision(proxy0);
+	}
+};
+#endif //USE_STATIC_ONLY
+
 ///internal debugging variable. this value shouldn't be too high
 int gNumClampedCcdMotions=0;
 
-void	btDiscreteDynamicsWorld::integrateTransforms(btScalar timeStep)
+///number of bodies per task when predicting and applying the integrated transforms
+#define BT_INTEGRATE_TRANSFORMS_GRAIN_SIZE 64
+
+///what integrateTransforms does with a body after predicting its transform
+enum btIntegrateAction
 {
-	BT_PROFILE("integrateTransforms");
-	btTransform predictedTrans;
-	for ( int i=0;i<m_nonStaticRigidBodies.size();i++)
-	{
-		btRigidBody* body = m_nonStaticRigidBodies[i];
-		body->setHitFraction(1.f);
+	BT_INTEGRATE_SKIP = 0,
+	BT_INTEGRATE_PROCEED,
+	BT_INTEGRATE_SWEEP,
+	BT_INTEGRATE_CLAMP
+};
 
-		if (body->isActive() && (!body->isStaticOrKinematicObject()))
-		{
+///a body that moves further than its CCD motion threshold, and the closest hit of its swept sphere
+struct btCcdMotion
+{
+	int					m_bodyIndex;
+	btCollisionObject*	m_hitObject;
+	btScalar			m_hitFraction;
+	btVector3			m_hitPointWorld;
+	btVector3			m_hitNormalWorld;
+};
 
-			body->predictIntegratedTransform(timeStep, predictedTrans);
-			
-			btScalar squareMotion = (predictedTrans.getOrigin()-body->getWorldTransform().getOrigin()).length2();
+///predicts the transforms of the active bodies and flags the ones that need a CCD sweep
+struct btPredictTransformsBody : public btIParallelForBody
+{
+	btRigidBody* const*	m_bodies;
+	btTransform*	m_predictedTransforms;
+	int*			m_actions;
+	btScalar		m_timeStep;
+	bool			m_useContinuous;
+
+	btPredictTransformsBody(btRigidBody* const* bodies, btTransform* predictedTransforms, int* actions, btScalar timeStep, bool useContinuous)
+		:m_bodies(bodies),
+		m_predictedTransforms(predictedTransforms),
+		m_actions(actions),
+		m_timeStep(timeStep),
+		m_useContinuous(useContinuous)
+	{
+	}
 
-			
+	virtual void	forLoop(int iBegin, int iEnd) const
+	{
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			btRigidBody* body = m_bodies[i];
+			body->setHitFraction(1.f);
+			m_actions[i] = BT_INTEGRATE_SKIP;
 
-			if (getDispatchInfo().m_useContinuous && body->getCcdSquareMotionThreshold() && body->getCcdSquareMotionThreshold() < squareMotion)
+			if (body->isActive() && (!body->isStaticOrKinematicObject()))
 			{
-				BT_PROFILE("CCD motion clamping");
-				if (body->getCollisionShape()->isConvex())
+				btTransform& predictedTrans = m_predictedTransforms[i];
+				body->predictIntegratedTransform(m_timeStep, predictedTrans);
+				m_actions[i] = BT_INTEGRATE_PROCEED;
+
+				btScalar squareMotion = (predictedTrans.getOrigin()-body->getWorldTransform().getOrigin()).length2();
+				if (m_useContinuous && body->getCcdSquareMotionThreshold() && body->getCcdSquareMotionThreshold() < squareMotion)
 				{
-					gNumClampedCcdMotions++;
-#ifdef USE_STATIC_ONLY
-					class StaticOnlyCallback : public btClosestNotMeConvexResultCallback
+					if (body->getCollisionShape()->isConvex())
 					{
-					public:
-
-						StaticOnlyCallback (btCollisionObject* me,const btVector3& fromA,const btVector3& toA,btOverlappingPairCache* pairCache,btDispatcher* dispatcher) : 
-						  btClosestNotMeConvexResultCallback(me,fromA,toA,pairCache,dispatcher)
-						{
-						}
-
-					  	virtual bool needsCollision(btBroadphaseProxy* proxy0) const
-						{
-							btCollisionObject* otherObj = (btCollisionObject*) proxy0->m_clientObject;
-							if (!otherObj->isStaticOrKinematicObject())
-								return false;
-							return btClosestNotMeConvexResultCallback::needsCollision(proxy0);
-						}
-					};
-
-					StaticOnlyCallback sweepResults(body,body->getWorldTransform().getOrigin(),predictedTrans.getOrigin(),getBroadphase()->getOverlappingPairCache(),getDispatcher());
+						m_actions[i] = BT_INTEGRATE_SWEEP;
+					}
+				}
+			}
+		}
+	}
+};
+
+///sweeps the CCD spheres of the fast bodies. All sweeps see the world as it was before any body moved,
+///so they only read shared state and can run concurrently
+struct btCcdSweepBody : public btIParallelForBody
+{
+	const btCollisionWorld*	m_world;
+	btOverlappingPairCache*	m_pairCache;
+	btDispatcher*	m_dispatcher;
+	btRigidBody* const*	m_bodies;
+	const btTransform*	m_predictedTransforms;
+	btCcdMotion*	m_motions;
+	btScalar		m_allowedCcdPenetration;
+
+	btCcdSweepBody(const btCollisionWorld* world, btOverlappingPairCache* pairCache, btDispatcher* dispatcher, btRigidBody* const* bodies,
+		const btTransform* predictedTransforms, btCcdMotion* motions, btScalar allowedCcdPenetration)
+		:m_world(world),
+		m_pairCache(pairCache),
+		m_dispatcher(dispatcher),
+		m_bodies(bodies),
+		m_predictedTransforms(predictedTransforms),
+		m_motions(motions),
+		m_allowedCcdPenetration(allowedCcdPenetration)
+	{
+	}
+
+	virtual void	forLoop(int iBegin, int iEnd) const
+	{
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			btCcdMotion& motion = m_motions[i];
+			btRigidBody* body = m_bodies[motion.m_bodyIndex];
+			const btTransform& predictedTrans = m_predictedTransforms[motion.m_bodyIndex];
+
+#ifdef USE_STATIC_ONLY
+			btStaticOnlyNotMeConvexResultCallback sweepResults(body,body->getWorldTransform().getOrigin(),predictedTrans.getOrigin(),m_pairCache,m_dispatcher);
 #else
-					btClosestNotMeConvexResultCallback sweepResults(body,body->getWorldTransform().getOrigin(),predictedTrans.getOrigin(),getBroadphase()->getOverlappingPairCache(),getDispatcher());
+			btClosestNotMeConvexResultCallback sweepResults(body,body->getWorldTransform().getOrigin(),predictedTrans.getOrigin(),m_pairCache,m_dispatcher);
 #endif
-					//btConvexShape* convexShape = static_cast<btConvexShape*>(body->getCollisionShape());
-					btSphereShape tmpSphere(body->getCcdSweptSphereRadius());//btConvexShape* convexShape = static_cast<btConvexShape*>(body->getCollisionShape());
-					sweepResults.m_allowedPenetration=getDispatchInfo().m_allowedCcdPenetration;
+			btSphereShape tmpSphere(body->getCcdSweptSphereRadius());
+			sweepResults.m_allowedPenetration=m_allowedCcdPenetration;
 
-					sweepResults.m_collisionFilterGroup = body->getBroadphaseProxy()->m_collisionFilterGroup;
-					sweepResults.m_collisionFilterMask  = body->getBroadphaseProxy()->m_collisionFilterMask;
-					btTransform modifiedPredictedTrans = predictedTrans;
-					modifiedPredictedTrans.setBasis(body->getWorldTransform().getBasis());
+			sweepResults.m_collisionFilterGroup = body->getBroadphaseProxy()->m_collisionFilterGroup;
+			sweepResults.m_collisionFilterMask  = body->getBroadphaseProxy()->m_collisionFilterMask;
+			btTransform modifiedPredictedTrans = predictedTrans;
+			modifiedPredictedTrans.setBasis(body->getWorldTransform().getBasis());
 
-					convexSweepTest(&tmpSphere,body->getWorldTransform(),modifiedPredictedTrans,sweepResults);
-					if (sweepResults.hasHit() && (sweepResults.m_closestHitFraction < 1.f))
-					{
-						
-						//printf("clamped integration to hit fraction = %f\n",fraction);
-						body->setHitFraction(sweepResults.m_closestHitFraction);
-						body->predictIntegratedTransform(timeStep*body->getHitFraction(), predictedTrans);
-						body->setHitFraction(0.f);
-						body->proceedToTransform( predictedTrans);
+			m_world->convexSweepTest(&tmpSphere,body->getWorldTransform(),modifiedPredictedTrans,sweepResults);
 
-#if 0
-						btVector3 linVel = body->getLinearVelocity();
-
-						btScalar maxSpeed = body->getCcdMotionThreshold()/getSolverInfo().m_timeStep;
-						btScalar maxSpeedSqr = maxSpeed*maxSpeed;
-						if (linVel.length2()>maxSpeedSqr)
-						{
-							linVel.normalize();
-							linVel*= maxSpeed;
-							body->setLinearVelocity(linVel);
-							btScalar ms2 = body->getLinearVelocity().length2();
-							body->predictIntegratedTransform(timeStep, predictedTrans);
-
-							btScalar sm2 = (predictedTrans.getOrigin()-body->getWorldTransform().getOrigin()).length2();
-							btScalar smt = body->getCcdSquareMotionThreshold();
-							printf("sm2=%f\n",sm2);
-						}
-#else
-						//response  between two dynamic objects without friction, assuming 0 penetration depth
-						btScalar appliedImpulse = 0.f;
-						btScalar depth = 0.f;
-						appliedImpulse = resolveSingleCollision(body,sweepResults.m_hitCollisionObject,sweepResults.m_hitPointWorld,sweepResults.m_hitNormalWorld,getSolverInfo(), depth);
-						
+			motion.m_hitObject = 0;
+			motion.m_hitFraction = btScalar(1.);
+			if (sweepResults.hasHit() && (sweepResults.m_closestHitFraction < 1.f))
+			{
+				motion.m_hitObject = sweepResults.m_hitCollisionObject;
+				motion.m_hitFraction = sweepResults.m_closestHitFraction;
+				motion.m_hitPointWorld = sweepResults.m_hitPointWorld;
+				motion.m_hitNormalWorld = sweepResults.m_hitNormalWorld;
+			}
+		}
+	}
+};
 
-#endif
+///moves the bodies whose motion was not clamped to their predicted transforms
+struct btProceedToTransformsBody : public btIParallelForBody
+{
+	btRigidBody* const*	m_bodies;
+	const btTransform*	m_predictedTransforms;
+	const int*		m_actions;
+
+	btProceedToTransformsBody(btRigidBody* const* bodies, const btTransform* predictedTransforms, const int* actions)
+		:m_bodies(bodies),
+		m_predictedTransforms(predictedTransforms),
+		m_actions(actions)
+	{
+	}
 
-        				continue;
-					}
-				}
+	virtual void	forLoop(int iBegin, int iEnd) const
+	{
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			if (m_actions[i] == BT_INTEGRATE_PROCEED || m_actions[i] == BT_INTEGRATE_SWEEP)
+			{
+				m_bodies[i]->proceedToTransform(m_predictedTransforms[i]);
 			}
-			
+		}
+	}
+};
 
-			body->proceedToTransform( predictedTrans);
+void	btDiscreteDynamicsWorld::integrateTransforms(btScalar timeStep)
+{
+	BT_PROFILE("integrateTransforms");
+	int numBodies = m_nonStaticRigidBodies.size();
+	if (!numBodies)
+		return;
+
+	btRigidBody* const* bodies = &m_nonStaticRigidBodies[0];
+	btTransform* predictedTransforms = m_frameArena.allocateArray<btTransform>(numBodies);
+	int* actions = m_frameArena.allocateArray<int>(numBodies);
+
+	{
+		btPredictTransformsBody predictBody(bodies, predictedTransforms, actions, timeStep, getDispatchInfo().m_useContinuous);
+		btParallelFor(0, numBodies, BT_INTEGRATE_TRANSFORMS_GRAIN_SIZE, predictBody);
+	}
+
+	///CCD is a separate stage: collect the fast movers, sweep them all against the world before anything moves, then clamp
+	int numMotions = 0;
+	int i;
+	for (i=0;i<numBodies;i++)
+	{
+		if (actions[i] == BT_INTEGRATE_SWEEP)
+			numMotions++;
+	}
+
+	btCcdMotion* motions = 0;
+	if (numMotions)
+	{
+		BT_PROFILE("CCD motion clamping");
+		gNumClampedCcdMotions += numMotions;
+		motions = m_frameArena.allocateArray<btCcdMotion>(numMotions);
+		int m = 0;
+		for (i=0;i<numBodies;i++)
+		{
+			if (actions[i] == BT_INTEGRATE_SWEEP)
+				motions[m++].m_bodyIndex = i;
+		}
+
+		btCcdSweepBody sweepBody(this, getBroadphase()->getOverlappingPairCache(), getDispatcher(), bodies, predictedTransforms, motions, getDispatchInfo().m_allowedCcdPenetration);
+		btParallelFor(0, numMotions, 1, sweepBody);
+
+		for (m=0;m<numMotions;m++)
+		{
+			if (motions[m].m_hitObject)
+				actions[motions[m].m_bodyIndex] = BT_INTEGRATE_CLAMP;
 		}
 	}
+
+	{
+		btProceedToTransformsBody proceedBody(bodies, predictedTransforms, actions);
+		btParallelFor(0, numBodies, BT_INTEGRATE_TRANSFORMS_GRAIN_SIZE, proceedBody);
+	}
+
+	///the clamped bodies apply an impulse to what they hit, so they are resolved one after the other
+	for (int m=0;m<numMotions;m++)
+	{
+		const btCcdMotion& motion = motions[m];
+		if (!motion.m_hitObject)
+			continue;
+
+		btRigidBody* body = bodies[motion.m_bodyIndex];
+		btTransform predictedTrans;
+
+		//printf("clamped integration to hit fraction = %f\n",fraction);
+		body->setHitFraction(motion.m_hitFraction);
+		body->predictIntegratedTransform(timeStep*body->getHitFraction(), predictedTrans);
+		body->setHitFraction(0.f);
+		body->proceedToTransform( predictedTrans);
+
+		//response  between two dynamic objects without friction, assuming 0 penetration depth
+		btScalar depth = 0.f;
+		resolveSingleCollision(body,motion.m_hitObject,motion.m_hitPointWorld,motion.m_hitNormalWorld,getSolverInfo(), depth);
+	}
 }
 
 
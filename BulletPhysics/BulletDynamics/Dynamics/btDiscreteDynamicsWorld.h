@@ -28,6 +28,7 @@ class btActionInterface;
 
 class btIDebugDraw;
 #include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btFrameArena.h"
 
 
 ///btDiscreteDynamicsWorld provides discrete rigid body simulation
@@ -42,8 +43,15 @@ protected:
 
 	btAlignedObjectArray<btTypedConstraint*> m_constraints;
 
+	///constraints sorted on island id, kept as a member so its capacity is reused every step
+	btAlignedObjectArray<btTypedConstraint*> m_sortedConstraints;
+
 	btAlignedObjectArray<btRigidBody*> m_nonStaticRigidBodies;
 
+	///per-step scratch memory of the dynamics stages, reset at the start of each internal step.
+	///the collision pipeline doesn't use it, its scratch arrays are persistent members that keep their capacity
+	btFrameArena	m_frameArena;
+
 	btVector3	m_gravity;
 
 	//for variable timesteps
@@ -60,6 +68,8 @@ protected:
 
 	virtual void	predictUnconstraintMotion(btScalar timeStep);
 	
+	///moves the active bodies to their predicted transforms. Bodies that move further than their CCD motion threshold are
+	///swept against the world first, all sweeps run through btParallelFor before any body moves, and are clamped to the hit
 	virtual void	integrateTransforms(btScalar timeStep);
 		
 	virtual void	calculateSimulationIslands();
@@ -104,6 +114,16 @@ public:
 
 	virtual void	removeAction(btActionInterface*);
 	
+	btFrameArena&	getFrameArena()
+	{
+		return m_frameArena;
+	}
+
+	const btFrameArena&	getFrameArena() const
+	{
+		return m_frameArena;
+	}
+
 	btSimulationIslandManager*	getSimulationIslandManager()
 	{
 		return m_islandManager;
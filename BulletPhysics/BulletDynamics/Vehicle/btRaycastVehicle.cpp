@@ -21,6 +21,8 @@
 #include "LinearMath/btMinMax.h"
 #include "LinearMath/btIDebugDraw.h"
 #include "BulletDynamics/ConstraintSolver/btContactConstraint.h"
+#include "LinearMath/btThreads.h"
+#include "LinearMath/btQuickprof.h"
 
 #define ROLLING_INFLUENCE_FIX
 
@@ -165,26 +167,38 @@ void	btRaycastVehicle::updateWheelTransformsWS(btWheelInfo& wheel , bool interpo
 }
 
 btScalar btRaycastVehicle::rayCast(btWheelInfo& wheel)
+{
+	btVector3 source, target;
+	calculateWheelRay(wheel, source, target);
+
+	btVehicleRaycaster::btVehicleRaycasterResult	rayResults;
+
+	btAssert(m_vehicleRaycaster);
+
+	void* object = m_vehicleRaycaster->castRay(source,target,rayResults);
+
+	return processWheelRayResult(wheel, object, rayResults);
+}
+
+void btRaycastVehicle::calculateWheelRay(btWheelInfo& wheel, btVector3& rayFrom, btVector3& rayTo)
 {
 	updateWheelTransformsWS( wheel,false);
 
-	
-	btScalar depth = -1;
-	
 	btScalar raylen = wheel.getSuspensionRestLength()+wheel.m_wheelsRadius;
 
 	btVector3 rayvector = wheel.m_raycastInfo.m_wheelDirectionWS * (raylen);
-	const btVector3& source = wheel.m_raycastInfo.m_hardPointWS;
-	wheel.m_raycastInfo.m_contactPointWS = source + rayvector;
-	const btVector3& target = wheel.m_raycastInfo.m_contactPointWS;
+	rayFrom = wheel.m_raycastInfo.m_hardPointWS;
+	wheel.m_raycastInfo.m_contactPointWS = rayFrom + rayvector;
+	rayTo = wheel.m_raycastInfo.m_contactPointWS;
+}
 
-	btScalar param = btScalar(0.);
+btScalar btRaycastVehicle::processWheelRayResult(btWheelInfo& wheel, void* object, const btVehicleRaycaster::btVehicleRaycasterResult& rayResults)
+{
+	btScalar depth = -1;
 	
-	btVehicleRaycaster::btVehicleRaycasterResult	rayResults;
-
-	btAssert(m_vehicleRaycaster);
+	btScalar raylen = wheel.getSuspensionRestLength()+wheel.m_wheelsRadius;
 
-	void* object = m_vehicleRaycaster->castRay(source,target,rayResults);
+	btScalar param = btScalar(0.);
 
 	wheel.m_raycastInfo.m_groundObject = 0;
 
@@ -266,6 +280,24 @@ const btTransform& btRaycastVehicle::getChassisWorldTransform() const
 
 
 void btRaycastVehicle::updateVehicle( btScalar step )
+{
+	beginVehicleUpdate();
+
+	//
+	// simulate suspension
+	//
+	
+	int i=0;
+	for (i=0;i<m_wheelInfo.size();i++)
+	{
+		btScalar depth; 
+		depth = rayCast( m_wheelInfo[i]);
+	}
+
+	endVehicleUpdate(step);
+}
+
+void btRaycastVehicle::beginVehicleUpdate()
 {
 	{
 		for (int i=0;i<getNumWheels();i++)
@@ -288,17 +320,11 @@ void btRaycastVehicle::updateVehicle( btScalar step )
 	{
 		m_currentVehicleSpeedKmHour *= btScalar(-1.);
 	}
+}
 
-	//
-	// simulate suspension
-	//
-	
+void btRaycastVehicle::endVehicleUpdate( btScalar step )
+{
 	int i=0;
-	for (i=0;i<m_wheelInfo.size();i++)
-	{
-		btScalar depth; 
-		depth = rayCast( m_wheelInfo[i]);
-	}
 
 	updateSuspension(step);
 
@@ -769,3 +795,133 @@ void* btDefaultVehicleRaycaster::castRay(const btVector3& from,const btVector3&
 	return 0;
 }
 
+
+///rays per btParallelFor chunk, a few packets of BT_RAY_PACKET_SIZE
+#define BT_VEHICLE_RAYS_GRAIN_SIZE 64
+
+struct btVehicleRayBatchBody : public btIParallelForBody
+{
+	const btCollisionWorld*	m_world;
+	const btCollisionWorld::RayBatch&	m_rays;
+	btCollisionWorld::RayBatchHit*	m_hits;
+
+	btVehicleRayBatchBody(const btCollisionWorld* world, const btCollisionWorld::RayBatch& rays, btCollisionWorld::RayBatchHit* hits)
+		:m_world(world),
+		m_rays(rays),
+		m_hits(hits)
+	{
+	}
+
+	virtual void	forLoop(int iBegin, int iEnd) const
+	{
+		btCollisionWorld::RayBatch rays = m_rays;
+		rays.m_originX += iBegin;
+		rays.m_originY += iBegin;
+		rays.m_originZ += iBegin;
+		rays.m_directionX += iBegin;
+		rays.m_directionY += iBegin;
+		rays.m_directionZ += iBegin;
+		rays.m_length += iBegin;
+		rays.m_numRays = iEnd - iBegin;
+		m_world->rayTestBatch(rays, m_hits + iBegin);
+	}
+};
+
+void	btRaycastVehicleManager::addVehicle(btRaycastVehicle* vehicle)
+{
+	m_vehicles.push_back(vehicle);
+}
+
+void	btRaycastVehicleManager::removeVehicle(btRaycastVehicle* vehicle)
+{
+	m_vehicles.remove(vehicle);
+}
+
+void	btRaycastVehicleManager::updateAction( btCollisionWorld* collisionWorld, btScalar step)
+{
+	BT_PROFILE("updateVehicles");
+
+	int numRays = 0;
+	int v;
+	for (v=0;v<m_vehicles.size();v++)
+	{
+		m_vehicles[v]->beginVehicleUpdate();
+		numRays += m_vehicles[v]->getNumWheels();
+	}
+
+	m_rayOriginX.resize(numRays);
+	m_rayOriginY.resize(numRays);
+	m_rayOriginZ.resize(numRays);
+	m_rayDirectionX.resize(numRays);
+	m_rayDirectionY.resize(numRays);
+	m_rayDirectionZ.resize(numRays);
+	m_rayLength.resize(numRays);
+	m_rayHits.resize(numRays);
+
+	int ray = 0;
+	for (v=0;v<m_vehicles.size();v++)
+	{
+		btRaycastVehicle* vehicle = m_vehicles[v];
+		for (int i=0;i<vehicle->getNumWheels();i++,ray++)
+		{
+			btVector3 source, target;
+			vehicle->calculateWheelRay(vehicle->m_wheelInfo[i], source, target);
+			btVector3 rayvector = target - source;
+			btScalar raylen = rayvector.length();
+			btVector3 direction = raylen > SIMD_EPSILON ? rayvector / raylen : btVector3(btScalar(0.), btScalar(0.), btScalar(0.));
+			m_rayOriginX[ray] = source.getX();
+			m_rayOriginY[ray] = source.getY();
+			m_rayOriginZ[ray] = source.getZ();
+			m_rayDirectionX[ray] = direction.getX();
+			m_rayDirectionY[ray] = direction.getY();
+			m_rayDirectionZ[ray] = direction.getZ();
+			m_rayLength[ray] = raylen;
+		}
+	}
+
+	if (numRays)
+	{
+		btCollisionWorld::RayBatch rays;
+		rays.m_originX = &m_rayOriginX[0];
+		rays.m_originY = &m_rayOriginY[0];
+		rays.m_originZ = &m_rayOriginZ[0];
+		rays.m_directionX = &m_rayDirectionX[0];
+		rays.m_directionY = &m_rayDirectionY[0];
+		rays.m_directionZ = &m_rayDirectionZ[0];
+		rays.m_length = &m_rayLength[0];
+		rays.m_numRays = numRays;
+		btVehicleRayBatchBody rayBatchBody(collisionWorld, rays, &m_rayHits[0]);
+		btParallelFor(0, numRays, BT_VEHICLE_RAYS_GRAIN_SIZE, rayBatchBody);
+	}
+
+	ray = 0;
+	for (v=0;v<m_vehicles.size();v++)
+	{
+		btRaycastVehicle* vehicle = m_vehicles[v];
+		for (int i=0;i<vehicle->getNumWheels();i++,ray++)
+		{
+			const btCollisionWorld::RayBatchHit& hit = m_rayHits[ray];
+			btVehicleRaycaster::btVehicleRaycasterResult rayResults;
+			btRigidBody* body = hit.m_collisionObject ? btRigidBody::upcast(hit.m_collisionObject) : 0;
+			void* object = 0;
+			if (body && body->hasContactResponse())
+			{
+				rayResults.m_hitPointInWorld = hit.m_hitPointWorld;
+				rayResults.m_hitNormalInWorld = hit.m_hitNormalWorld;
+				rayResults.m_hitNormalInWorld.normalize();
+				rayResults.m_distFraction = hit.m_hitFraction;
+				object = body;
+			}
+			vehicle->processWheelRayResult(vehicle->m_wheelInfo[i], object, rayResults);
+		}
+		vehicle->endVehicleUpdate(step);
+	}
+}
+
+void	btRaycastVehicleManager::debugDraw(btIDebugDraw* debugDrawer)
+{
+	for (int v=0;v<m_vehicles.size();v++)
+	{
+		m_vehicles[v]->debugDraw(debugDrawer);
+	}
+}
@@ -18,6 +18,7 @@ class btDynamicsWorld;
 #include "LinearMath/btAlignedObjectArray.h"
 #include "btWheelInfo.h"
 #include "BulletDynamics/Dynamics/btActionInterface.h"
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
 
 class btVehicleTuning;
 
@@ -96,7 +97,20 @@ public:
 	
 	btScalar rayCast(btWheelInfo& wheel);
 
+	///computes the suspension ray of a wheel, the first half of rayCast
+	void	calculateWheelRay(btWheelInfo& wheel, btVector3& rayFrom, btVector3& rayTo);
+
+	///updates the contact and suspension state of a wheel from the result of its ray, object is 0 when the ray found no ground.
+	///the second half of rayCast
+	btScalar	processWheelRayResult(btWheelInfo& wheel, void* object, const btVehicleRaycaster::btVehicleRaycasterResult& rayResults);
+
+	///updateVehicle is beginVehicleUpdate, rayCast of each wheel and endVehicleUpdate.
+	///btRaycastVehicleManager calls the parts directly, so it can cast the rays of many vehicles together
 	virtual void updateVehicle(btScalar step);
+
+	void	beginVehicleUpdate();
+
+	void	endVehicleUpdate(btScalar step);
 	
 	
 	void resetSuspension();
@@ -231,6 +245,49 @@ public:
 
 };
 
+///btRaycastVehicleManager updates many vehicles as a single action. The suspension rays of all wheels of all its vehicles
+///are cast together with btCollisionWorld::rayTestBatch, split over the threads of btParallelFor, instead of one rayTest per
+///wheel. Add the vehicles to the manager instead of adding them to the world as actions; their btVehicleRaycaster is not used.
+///As with btDefaultVehicleRaycaster, a wheel touches the closest object on its ray if that is a rigid body with contact response.
+class btRaycastVehicleManager : public btActionInterface
+{
+	btAlignedObjectArray<btRaycastVehicle*>	m_vehicles;
+
+	///wheel rays of the current step, in the structure of arrays layout of btCollisionWorld::RayBatch
+	btAlignedObjectArray<btScalar>	m_rayOriginX;
+	btAlignedObjectArray<btScalar>	m_rayOriginY;
+	btAlignedObjectArray<btScalar>	m_rayOriginZ;
+	btAlignedObjectArray<btScalar>	m_rayDirectionX;
+	btAlignedObjectArray<btScalar>	m_rayDirectionY;
+	btAlignedObjectArray<btScalar>	m_rayDirectionZ;
+	btAlignedObjectArray<btScalar>	m_rayLength;
+	btAlignedObjectArray<btCollisionWorld::RayBatchHit>	m_rayHits;
+
+public:
+
+	virtual ~btRaycastVehicleManager() {}
+
+	void	addVehicle(btRaycastVehicle* vehicle);
+
+	void	removeVehicle(btRaycastVehicle* vehicle);
+
+	int		getNumVehicles() const
+	{
+		return m_vehicles.size();
+	}
+
+	btRaycastVehicle*	getVehicle(int index)
+	{
+		return m_vehicles[index];
+	}
+
+	///btActionInterface interface
+	virtual void updateAction( btCollisionWorld* collisionWorld, btScalar step);
+
+	///btActionInterface interface
+	virtual void	debugDraw(btIDebugDraw* debugDrawer);
+};
+
 
 #endif //BT_RAYCASTVEHICLE_H
 
@@ -21,6 +21,38 @@ subject to the following restrictions:
 #include "BulletMultiThreaded/GpuSoftBodySolvers/CPU/btSoftBodySolver_CPU.h"
 #include "BulletSoftBody/btSoftBody.h"
 #include "BulletCollision/CollisionShapes/btCapsuleShape.h"
+#include "LinearMath/btThreads.h"
+
+// Number of vertices and links handed to a thread at a time
+#define BT_CPU_SOFTBODY_VERTEX_GRAIN 256
+#define BT_CPU_SOFTBODY_LINK_GRAIN 128
+
+// Stiffness scale used by the link solvers
+static const float kst = 1.f;
+
+/**
+ * Runs one of the solver kernels over the sub-ranges btParallelFor hands out.
+ */
+struct btCPUSoftBodyKernelBody : public btIParallelForBody
+{
+	typedef void (btCPUSoftBodySolver::*Kernel)( int, int, float );
+
+	btCPUSoftBodySolver *m_solver;
+	Kernel m_kernel;
+	float m_solverdt;
+
+	btCPUSoftBodyKernelBody( btCPUSoftBodySolver *solver, Kernel kernel, float solverdt ) :
+		m_solver( solver ),
+		m_kernel( kernel ),
+		m_solverdt( solverdt )
+	{
+	}
+
+	void forLoop( int iBegin, int iEnd ) const
+	{
+		(m_solver->*m_kernel)( iBegin, iEnd, m_solverdt );
+	}
+};
 
 
 btCPUSoftBodySolver::btCPUSoftBodySolver()
@@ -189,7 +221,6 @@ void btCPUSoftBodySolver::optimize( btAlignedObjectArray< btSoftBody * > &softBo
 
 			int firstLink = getLinkData().getNumLinks();
 			int numLinks = softBody->m_links.size();
-			int maxLinks = numLinks;
 			
 			// Allocate space for the links
 			getLinkData().createLinks( numLinks );
@@ -215,12 +246,81 @@ void btCPUSoftBodySolver::optimize( btAlignedObjectArray< btSoftBody * > &softBo
 			newSoftBody->setNumLinks( numLinks );
 		}
 
+		generateLinkBatches();
 
-
+		// The link data was rebuilt so the constants have to be recomputed
+		m_updateSolverConstants = true;
 		updateConstants(0.f);
 	}
 }
 
+/**
+ * Greedy graph colouring of the links, after which the link arrays are sorted by colour.
+ * Each colour is a batch of links that share no vertex.
+ * Within a batch the links keep their original order, so the result doesn't depend on the number of threads.
+ */
+void btCPUSoftBodySolver::generateLinkBatches()
+{
+	const int numLinks = m_linkData.getNumLinks();
+	const int numVertices = m_vertexData.getNumVertices();
+
+	// Colours already used by the links of each vertex
+	btAlignedObjectArray< btAlignedObjectArray< int > > vertexColours;
+	vertexColours.resize( numVertices );
+
+	btAlignedObjectArray< int > linkColours;
+	linkColours.resize( numLinks );
+	btAlignedObjectArray< int > batchCounts;
+
+	for( int linkIndex = 0; linkIndex < numLinks; ++linkIndex )
+	{
+		const btSoftBodyLinkData::LinkNodePair &vertices( m_linkData.getVertexPair(linkIndex) );
+		btAlignedObjectArray< int > &colours0( vertexColours[vertices.vertex0] );
+		btAlignedObjectArray< int > &colours1( vertexColours[vertices.vertex1] );
+
+		// Lowest colour that neither vertex is linked with yet
+		int colour = 0;
+		while( colours0.findLinearSearch(colour) != colours0.size() || colours1.findLinearSearch(colour) != colours1.size() )
+			++colour;
+
+		colours0.push_back( colour );
+		colours1.push_back( colour );
+		linkColours[linkIndex] = colour;
+
+		if( colour >= batchCounts.size() )
+			batchCounts.push_back( 0 );
+		++batchCounts[colour];
+	}
+
+	m_linkBatchStarts.resize( batchCounts.size() + 1 );
+	int sum = 0;
+	for( int batch = 0; batch < batchCounts.size(); ++batch )
+	{
+		m_linkBatchStarts[batch] = sum;
+		sum += batchCounts[batch];
+	}
+	m_linkBatchStarts[batchCounts.size()] = sum;
+
+	// Only the input values need to move, the rest is computed by updateConstants and solveConstraints
+	for( int batch = 0; batch < batchCounts.size(); ++batch )
+		batchCounts[batch] = 0;
+	btAlignedObjectArray< btSoftBodyLinkData::LinkDescription > sortedLinks;
+	sortedLinks.resize( numLinks );
+	for( int linkIndex = 0; linkIndex < numLinks; ++linkIndex )
+	{
+		const btSoftBodyLinkData::LinkNodePair &vertices( m_linkData.getVertexPair(linkIndex) );
+		int colour = linkColours[linkIndex];
+		btSoftBodyLinkData::LinkDescription &link( sortedLinks[m_linkBatchStarts[colour] + (batchCounts[colour]++)] );
+		link = btSoftBodyLinkData::LinkDescription( vertices.vertex0, vertices.vertex1, m_linkData.getLinearStiffnessCoefficient(linkIndex) );
+		link.setLinkStrength( m_linkData.getStrength(linkIndex) );
+	}
+
+	for( int linkIndex = 0; linkIndex < numLinks; ++linkIndex )
+	{
+		m_linkData.setLinkAt( sortedLinks[linkIndex], linkIndex );
+	}
+} // btCPUSoftBodySolver::generateLinkBatches
+
 
 
 
@@ -305,67 +405,72 @@ bool btCPUSoftBodySolver::checkInitialized()
 }
 
 void btCPUSoftBodySolver::applyForces( float solverdt )
+{
+	btCPUSoftBodyKernelBody body( this, &btCPUSoftBodySolver::applyForcesToVertices, solverdt );
+	btParallelFor( 0, m_vertexData.getNumVertices(), BT_CPU_SOFTBODY_VERTEX_GRAIN, body );
+} // btCPUSoftBodySolver::applyForces
+
+void btCPUSoftBodySolver::applyForcesToVertices( int startVertex, int endVertex, float solverdt )
 {		
 	using namespace Vectormath::Aos;
 
-	int numVertices = m_vertexData.getNumVertices();			
-	for( int clothIndex = 0; clothIndex < m_softBodySet.size(); ++clothIndex )
+	for( int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex )
 	{
-		btAcceleratedSoftBodyInterface *currentCloth = m_softBodySet[clothIndex];
-		const int startVertex = currentCloth->getFirstVertex();
-		const int numVertices = currentCloth->getNumVertices();
-
+		const int clothIndex = m_vertexData.getClothIdentifier( vertexIndex );
 		Vector3 velocityChange = m_perClothAcceleration[clothIndex]*solverdt;
-		for( int vertexIndex = startVertex; vertexIndex < (startVertex + numVertices); ++vertexIndex )
-		{
-			float inverseMass = m_vertexData.getInverseMass( vertexIndex );
-			Vector3 &vertexVelocity( m_vertexData.getVelocity( vertexIndex ) );
 
-			// First apply the global acceleration to all vertices
-			if( inverseMass > 0 )
-				vertexVelocity += velocityChange;
+		float inverseMass = m_vertexData.getInverseMass( vertexIndex );
+		Vector3 &vertexVelocity( m_vertexData.getVelocity( vertexIndex ) );
 
-			// If it's a non-static vertex
-			if( m_vertexData.getInverseMass(vertexIndex) > 0 )
+		// First apply the global acceleration to all vertices
+		if( inverseMass > 0 )
+			vertexVelocity += velocityChange;
+
+		// If it's a non-static vertex
+		if( m_vertexData.getInverseMass(vertexIndex) > 0 )
+		{
+			// Wind effects on a wind-per-cloth basis
+			float liftFactor = m_perClothLiftFactor[clothIndex];
+			float dragFactor = m_perClothDragFactor[clothIndex];
+			if( (liftFactor > 0.f) || (dragFactor > 0.f) )
 			{
-				// Wind effects on a wind-per-cloth basis
-				float liftFactor = m_perClothLiftFactor[clothIndex];
-				float dragFactor = m_perClothDragFactor[clothIndex];
-				if( (liftFactor > 0.f) || (dragFactor > 0.f) )
+				Vector3 normal = m_vertexData.getNormal(vertexIndex);
+				Vector3 relativeWindVelocity = m_vertexData.getVelocity(vertexIndex) - m_perClothWindVelocity[clothIndex];
+				float relativeSpeedSquared = lengthSqr(relativeWindVelocity);
+				if( relativeSpeedSquared > FLT_EPSILON )
 				{
-					Vector3 normal = m_vertexData.getNormal(vertexIndex);
-					Vector3 relativeWindVelocity = m_vertexData.getVelocity(vertexIndex) - m_perClothWindVelocity[clothIndex];
-					float relativeSpeedSquared = lengthSqr(relativeWindVelocity);
-					if( relativeSpeedSquared > FLT_EPSILON )
+					normal = normal * (dot(normal, relativeWindVelocity) < 0 ? -1.f : +1.f);
+					float dvNormal = dot(normal, relativeWindVelocity);
+					if( dvNormal > 0 )
 					{
-						normal = normal * (dot(normal, relativeWindVelocity) < 0 ? -1.f : +1.f);
-						float dvNormal = dot(normal, relativeWindVelocity);
-						if( dvNormal > 0 )
-						{
-							Vector3 force( 0.f, 0.f, 0.f );
-							float c0 = m_vertexData.getArea(vertexIndex) * dvNormal * relativeSpeedSquared / 2;
-							float c1 = c0 * m_perClothMediumDensity[clothIndex];
-							force += normal * (-c1 * liftFactor);
-							force += normalize(relativeWindVelocity)*(-c1 * dragFactor);
-
-							Vectormath::Aos::Vector3 &vertexForce( m_vertexData.getForceAccumulator(vertexIndex) );
-							ApplyClampedForce( solverdt, force, vertexVelocity, inverseMass, vertexForce );
-						}
+						Vector3 force( 0.f, 0.f, 0.f );
+						float c0 = m_vertexData.getArea(vertexIndex) * dvNormal * relativeSpeedSquared / 2;
+						float c1 = c0 * m_perClothMediumDensity[clothIndex];
+						force += normal * (-c1 * liftFactor);
+						force += normalize(relativeWindVelocity)*(-c1 * dragFactor);
+
+						Vectormath::Aos::Vector3 &vertexForce( m_vertexData.getForceAccumulator(vertexIndex) );
+						ApplyClampedForce( solverdt, force, vertexVelocity, inverseMass, vertexForce );
 					}
 				}
 			}
 		}
 	}
-} // btCPUSoftBodySolver::applyForces
+} // btCPUSoftBodySolver::applyForcesToVertices
 
 /**
  * Integrate motion on the solver.
  */
 void btCPUSoftBodySolver::integrate( float solverdt )
+{
+	btCPUSoftBodyKernelBody body( this, &btCPUSoftBodySolver::integrateVertices, solverdt );
+	btParallelFor( 0, m_vertexData.getNumVertices(), BT_CPU_SOFTBODY_VERTEX_GRAIN, body );
+} // btCPUSoftBodySolver::integrate
+
+void btCPUSoftBodySolver::integrateVertices( int startVertex, int endVertex, float solverdt )
 {
 	using namespace Vectormath::Aos;
-	int numVertices = m_vertexData.getNumVertices();
-	for( int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex )
+	for( int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex )
 	{
 		Point3 &position( m_vertexData.getPosition(vertexIndex) );
 		Point3 &previousPosition( m_vertexData.getPreviousPosition(vertexIndex) );
@@ -378,7 +483,7 @@ void btCPUSoftBodySolver::integrate( float solverdt )
 		position += velocity * solverdt;
 		forceAccumulator = Vector3(0.f, 0.f, 0.f);
 	}	
-} // btCPUSoftBodySolver::integrate
+} // btCPUSoftBodySolver::integrateVertices
 
 float btCPUSoftBodySolver::computeTriangleArea( 
 	const Vectormath::Aos::Point3 &vertex0,
@@ -510,20 +615,21 @@ void btCPUSoftBodySolver::prepareCollisionConstraints()
 } // prepareCollisionConstraints
 
 
-void btCPUSoftBodySolver::solveConstraints( float solverdt )
+void btCPUSoftBodySolver::solveLinkBatches( void (btCPUSoftBodySolver::*kernel)( int, int, float ), float solverdt )
+{
+	btCPUSoftBodyKernelBody body( this, kernel, solverdt );
+	for( int batch = 0; batch < m_linkBatchStarts.size() - 1; ++batch )
+	{
+		btParallelFor( m_linkBatchStarts[batch], m_linkBatchStarts[batch+1], BT_CPU_SOFTBODY_LINK_GRAIN, body );
+	}
+}
+
+void btCPUSoftBodySolver::prepareLinks( int startLink, int endLink, float /*solverdt*/ )
 {
 	using Vectormath::Aos::Vector3;
-	using Vectormath::Aos::Point3;
 	using Vectormath::Aos::lengthSqr;
-	using Vectormath::Aos::dot;
-
-	// Prepare links
-	int numLinks = m_linkData.getNumLinks();
-	int numVertices = m_vertexData.getNumVertices();
-
-	float kst = 1.f;
 
-	for( int linkIndex = 0; linkIndex < numLinks; ++linkIndex )
+	for( int linkIndex = startLink; linkIndex < endLink; ++linkIndex )
 	{			
 		btSoftBodyLinkData::LinkNodePair &nodePair( m_linkData.getVertexPair(linkIndex) );
 		Vector3 currentLength = m_vertexData.getPreviousPosition( nodePair.vertex1 ) - m_vertexData.getPreviousPosition( nodePair.vertex0 );
@@ -535,292 +641,336 @@ void btCPUSoftBodySolver::solveConstraints( float solverdt )
 		if( m_linkData.getMassLSC(linkIndex) > 0 )
 			linkLengthRatio = 1.f/(lengthSqr(currentLength) * m_linkData.getMassLSC(linkIndex));
 		m_linkData.getLinkLengthRatio(linkIndex) = linkLengthRatio;
-
 	}
+} // btCPUSoftBodySolver::prepareLinks
 
-
-	prepareCollisionConstraints();
-
-
-	for( int iteration = 0; iteration < m_numberOfVelocityIterations ; ++iteration )
+/**
+ * Velocity solve for links of a single batch, four links at a time.
+ * The links of a batch share no vertex, so the lanes are gathered, solved and scattered independently.
+ * Unused lanes are zero filled, which gives a zero impulse.
+ */
+void btCPUSoftBodySolver::solveLinksForVelocity( int startLink, int endLink, float /*solverdt*/ )
+{
+	for( int firstLink = startLink; firstLink < endLink; firstLink += 4 )
 	{
-		// Solve velocity
-		for(int linkIndex = 0; linkIndex < numLinks; ++linkIndex)
-		{				
+		const int numLanes = btMin( 4, endLink - firstLink );
 
-			int vertexIndex0 = m_linkData.getVertexPair(linkIndex).vertex0;
-			int vertexIndex1 = m_linkData.getVertexPair(linkIndex).vertex1;
+		int vertexIndex0[4], vertexIndex1[4];
+		float lengthX[4], lengthY[4], lengthZ[4];
+		float velocityX[4], velocityY[4], velocityZ[4];
+		float lengthRatio[4], inverseMass0[4], inverseMass1[4];
 
-			float j = -dot(m_linkData.getCurrentLength(linkIndex), m_vertexData.getVelocity(vertexIndex0) - m_vertexData.getVelocity(vertexIndex1)) * m_linkData.getLinkLengthRatio(linkIndex)*kst;
-			
-			// If both ends of the link have no mass then this will be zero. Catch that case.
-			// TODO: Should really catch the /0 in the link setup, too
-			//if(psb->m_linksc0[i]>0)
+		for( int lane = 0; lane < 4; ++lane )
+		{
+			if( lane < numLanes )
 			{
-				m_vertexData.getVelocity(vertexIndex0) = m_vertexData.getVelocity(vertexIndex0) + m_linkData.getCurrentLength(linkIndex)*j*m_vertexData.getInverseMass(vertexIndex0);
-				m_vertexData.getVelocity(vertexIndex1) = m_vertexData.getVelocity(vertexIndex1) - m_linkData.getCurrentLength(linkIndex)*j*m_vertexData.getInverseMass(vertexIndex1);
+				const int linkIndex = firstLink + lane;
+				const int v0 = m_linkData.getVertexPair(linkIndex).vertex0;
+				const int v1 = m_linkData.getVertexPair(linkIndex).vertex1;
+				const Vectormath::Aos::Vector3 &currentLength( m_linkData.getCurrentLength(linkIndex) );
+				const Vectormath::Aos::Vector3 &velocity0( m_vertexData.getVelocity(v0) );
+				const Vectormath::Aos::Vector3 &velocity1( m_vertexData.getVelocity(v1) );
+				vertexIndex0[lane] = v0;
+				vertexIndex1[lane] = v1;
+				lengthX[lane] = currentLength.getX();
+				lengthY[lane] = currentLength.getY();
+				lengthZ[lane] = currentLength.getZ();
+				velocityX[lane] = velocity0.getX() - velocity1.getX();
+				velocityY[lane] = velocity0.getY() - velocity1.getY();
+				velocityZ[lane] = velocity0.getZ() - velocity1.getZ();
+				lengthRatio[lane] = m_linkData.getLinkLengthRatio(linkIndex);
+				inverseMass0[lane] = m_vertexData.getInverseMass(v0);
+				inverseMass1[lane] = m_vertexData.getInverseMass(v1);
+			} else {
+				lengthX[lane] = lengthY[lane] = lengthZ[lane] = 0.f;
+				velocityX[lane] = velocityY[lane] = velocityZ[lane] = 0.f;
+				lengthRatio[lane] = inverseMass0[lane] = inverseMass1[lane] = 0.f;
 			}
 		}
-	}
 
-	// Compute new positions from velocity
-	// Also update the previous position so that our position computation is now based on the new position from the velocity solution
-	// rather than based directly on the original positions
-	if( m_numberOfVelocityIterations > 0 )
-	{
-		for(int vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
-		{				
-			m_vertexData.getPosition(vertexIndex) = m_vertexData.getPreviousPosition(vertexIndex) + m_vertexData.getVelocity(vertexIndex) * solverdt;
-			m_vertexData.getPreviousPosition(vertexIndex) = m_vertexData.getPosition(vertexIndex);
+		float impulse0[4], impulse1[4];
+		for( int lane = 0; lane < 4; ++lane )
+		{
+			float j = -(lengthX[lane]*velocityX[lane] + lengthY[lane]*velocityY[lane] + lengthZ[lane]*velocityZ[lane]) * lengthRatio[lane]*kst;
+			impulse0[lane] = j*inverseMass0[lane];
+			impulse1[lane] = j*inverseMass1[lane];
 		}
-	}
 
-	// Solve drift
-	for( int iteration = 0; iteration < m_numberOfPositionIterations ; ++iteration )
-	{
-		for( int clothIndex = 0; clothIndex < m_softBodySet.size(); ++clothIndex )
+		for( int lane = 0; lane < numLanes; ++lane )
 		{
-			btAcceleratedSoftBodyInterface *currentCloth = m_softBodySet[clothIndex];
-
-			const int startLink = currentCloth->getFirstLink();
-			const int numLinks = currentCloth->getNumLinks();
+			Vectormath::Aos::Vector3 currentLength( lengthX[lane], lengthY[lane], lengthZ[lane] );
+			m_vertexData.getVelocity(vertexIndex0[lane]) += currentLength*impulse0[lane];
+			m_vertexData.getVelocity(vertexIndex1[lane]) -= currentLength*impulse1[lane];
+		}
+	}
+} // btCPUSoftBodySolver::solveLinksForVelocity
 
-			int endLink = startLink + numLinks;
-			for(int linkIndex = startLink; linkIndex < endLink; ++linkIndex)
-			{			
-				int vertexIndex0 = m_linkData.getVertexPair(linkIndex).vertex0;
-				int vertexIndex1 = m_linkData.getVertexPair(linkIndex).vertex1;
+void btCPUSoftBodySolver::updatePositionsFromVelocity( int startVertex, int endVertex, float solverdt )
+{
+	for(int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex)
+	{				
+		m_vertexData.getPosition(vertexIndex) = m_vertexData.getPreviousPosition(vertexIndex) + m_vertexData.getVelocity(vertexIndex) * solverdt;
+		m_vertexData.getPreviousPosition(vertexIndex) = m_vertexData.getPosition(vertexIndex);
+	}
+} // btCPUSoftBodySolver::updatePositionsFromVelocity
 
-				float massLSC = m_linkData.getMassLSC(linkIndex);
-				if( massLSC > 0.f )
-				{
-					Point3 &vertexPosition0( m_vertexData.getPosition( vertexIndex0 ) );
-					Point3 &vertexPosition1( m_vertexData.getPosition( vertexIndex1 ) );
+/**
+ * Position (drift) solve for links of a single batch, four links at a time like solveLinksForVelocity.
+ * Links without mass and unused lanes get a zero correction.
+ */
+void btCPUSoftBodySolver::solveLinksForPosition( int startLink, int endLink, float /*solverdt*/ )
+{
+	for( int firstLink = startLink; firstLink < endLink; firstLink += 4 )
+	{
+		const int numLanes = btMin( 4, endLink - firstLink );
 
-					Vector3 del = vertexPosition1 - vertexPosition0;
-					float len = lengthSqr(del);
-					float restLength2 = m_linkData.getRestLengthSquared(linkIndex);
-					float k = ((restLength2 - len) / (massLSC * (restLength2 + len) ) )*kst;
+		int vertexIndex0[4], vertexIndex1[4];
+		float deltaX[4], deltaY[4], deltaZ[4];
+		float massLSC[4], restLengthSquared[4], inverseMass0[4], inverseMass1[4];
 
-					vertexPosition0 -= del*(k*m_vertexData.getInverseMass(vertexIndex0));
-					vertexPosition1 += del*(k*m_vertexData.getInverseMass(vertexIndex1));
-				}
+		for( int lane = 0; lane < 4; ++lane )
+		{
+			if( lane < numLanes )
+			{
+				const int linkIndex = firstLink + lane;
+				const int v0 = m_linkData.getVertexPair(linkIndex).vertex0;
+				const int v1 = m_linkData.getVertexPair(linkIndex).vertex1;
+				const Vectormath::Aos::Point3 &position0( m_vertexData.getPosition(v0) );
+				const Vectormath::Aos::Point3 &position1( m_vertexData.getPosition(v1) );
+				vertexIndex0[lane] = v0;
+				vertexIndex1[lane] = v1;
+				deltaX[lane] = position1.getX() - position0.getX();
+				deltaY[lane] = position1.getY() - position0.getY();
+				deltaZ[lane] = position1.getZ() - position0.getZ();
+				massLSC[lane] = m_linkData.getMassLSC(linkIndex);
+				restLengthSquared[lane] = m_linkData.getRestLengthSquared(linkIndex);
+				inverseMass0[lane] = m_vertexData.getInverseMass(v0);
+				inverseMass1[lane] = m_vertexData.getInverseMass(v1);
+			} else {
+				deltaX[lane] = deltaY[lane] = deltaZ[lane] = 0.f;
+				massLSC[lane] = restLengthSquared[lane] = inverseMass0[lane] = inverseMass1[lane] = 0.f;
 			}
 		}
-	}
 
-	// Clear forces so that friction is applied correctly
-	for( int clothIndex = 0; clothIndex < m_softBodySet.size(); ++clothIndex )
-	{
-		btAcceleratedSoftBodyInterface *currentCloth = m_softBodySet[clothIndex];
-
-		const int startLink = currentCloth->getFirstLink();
-		const int numLinks = currentCloth->getNumLinks();
-		const int startVertex = currentCloth->getFirstVertex();
-		const int numVertices = currentCloth->getNumVertices();
-		const int lastVertex = startVertex + numVertices;
-		// Update the velocities based on the change in position
-		// TODO: Damping should only be applied to the action of link constraints so the cloth still falls but then moves stiffly once it hits something
-		float velocityCoefficient = (1.f - m_perClothDampingFactor[clothIndex]);
-		float velocityCorrectionCoefficient = m_perClothVelocityCorrectionCoefficient[clothIndex];
-		float isolverDt = 1.f/solverdt;
+		float correction0[4], correction1[4];
+		for( int lane = 0; lane < 4; ++lane )
+		{
+			float len = deltaX[lane]*deltaX[lane] + deltaY[lane]*deltaY[lane] + deltaZ[lane]*deltaZ[lane];
+			float restLength2 = restLengthSquared[lane];
+			float k = massLSC[lane] > 0.f ? ((restLength2 - len) / (massLSC[lane] * (restLength2 + len) ) )*kst : 0.f;
+			correction0[lane] = k*inverseMass0[lane];
+			correction1[lane] = k*inverseMass1[lane];
+		}
 
-		for(int vertexIndex = startVertex; vertexIndex < lastVertex; ++vertexIndex)
+		for( int lane = 0; lane < numLanes; ++lane )
 		{
-			m_vertexData.getForceAccumulator( vertexIndex ) = Vector3(0.f, 0.f, 0.f);
+			Vectormath::Aos::Vector3 del( deltaX[lane], deltaY[lane], deltaZ[lane] );
+			m_vertexData.getPosition(vertexIndex0[lane]) -= del*correction0[lane];
+			m_vertexData.getPosition(vertexIndex1[lane]) += del*correction1[lane];
 		}
 	}
-	 
+} // btCPUSoftBodySolver::solveLinksForPosition
 
-	
+/**
+ * Clear forces, push vertices out of the collision shapes of their cloth and recompute velocities from the
+ * position change, with friction from the colliders.
+ */
+void btCPUSoftBodySolver::solveCollisionsAndUpdateVelocities( int startVertex, int endVertex, float solverdt )
+{
+	using namespace Vectormath::Aos;
 
-	// Solve collision constraints
-	// Very simple solver that pushes the vertex out of collision imposters for now
-	// to test integration with the broad phase code.
-	// May also want to put this into position solver loop every n iterations depending on
-	// how it behaves
-	for( int clothIndex = 0; clothIndex < m_softBodySet.size(); ++clothIndex )
+	float isolverDt = 1.f/solverdt;
+
+	for( int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex )
 	{
+		const int clothIndex = m_vertexData.getClothIdentifier( vertexIndex );
 		btAcceleratedSoftBodyInterface *currentCloth = m_softBodySet[clothIndex];
-		
-		float clothFriction = currentCloth->getSoftBody()->getFriction();
 
-		const int startVertex = currentCloth->getFirstVertex();
-		const int numVertices = currentCloth->getNumVertices();
-		int endVertex = startVertex + numVertices;		
+		float clothFriction = currentCloth->getSoftBody()->getFriction();
 
+		// Update the velocities based on the change in position
+		// TODO: Damping should only be applied to the action of link constraints so the cloth still falls but then moves stiffly once it hits something
 		float velocityCoefficient = (1.f - m_perClothDampingFactor[clothIndex]);
-		float velocityCorrectionCoefficient = m_perClothVelocityCorrectionCoefficient[clothIndex];
-		float isolverDt = 1.f/solverdt;
 
 		int startObject = m_perClothCollisionObjects[clothIndex].firstObject;
 		int endObject = m_perClothCollisionObjects[clothIndex].endObject;
 
+		// Clear forces so that friction is applied correctly
+		m_vertexData.getForceAccumulator( vertexIndex ) = Vector3(0.f, 0.f, 0.f);
+
 		if( endObject == startObject )
 		{
-			// No collisions so just do the force update
-			for(int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex)
+			// No collisions so just recompute velocity based on updated position inclusive of drift
+			m_vertexData.getVelocity(vertexIndex) = (m_vertexData.getPosition(vertexIndex) - m_vertexData.getPreviousPosition(vertexIndex)) * velocityCoefficient * isolverDt;
+			continue;
+		}
+
+		for( int collisionObject = startObject; collisionObject < endObject; ++collisionObject )
+		{
+			btCPUCollisionShapeDescription &shapeDescription( m_collisionObjectDetails[collisionObject] );
+
+			float colliderFriction = shapeDescription.friction;
+
+			if( shapeDescription.collisionShapeType == CAPSULE_SHAPE_PROXYTYPE )
 			{
+				float capsuleHalfHeight = shapeDescription.shapeInformation.capsule.halfHeight;
+				float capsuleRadius = shapeDescription.shapeInformation.capsule.radius;
+				int capsuleUpAxis = shapeDescription.shapeInformation.capsule.upAxis;
+				float capsuleMargin = shapeDescription.margin;
+				
+				Transform3 worldTransform = shapeDescription.shapeTransform;
+
+				// Clear force for vertex first
 				m_vertexData.getForceAccumulator( vertexIndex ) = Vector3(0.f, 0.f, 0.f);
-			}
 
-			// Recompute velocity based on updated position inclusive of drift
-			for(int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex)
-			{
-				m_vertexData.getVelocity(vertexIndex) = (m_vertexData.getPosition(vertexIndex) - m_vertexData.getPreviousPosition(vertexIndex)) * velocityCoefficient * isolverDt;
-			}
-		} else {
+				Point3 vertex( m_vertexData.getPosition( vertexIndex ) );
+
+				// Correctly define the centerline depending on the upAxis
+				Point3 c1(0.f, 0.f, 0.f); 
+				Point3 c2(0.f, 0.f, 0.f);
+				if( capsuleUpAxis == 0 ) {
+					c1.setX(-capsuleHalfHeight);
+					c2.setX(capsuleHalfHeight);
+				} else if( capsuleUpAxis == 1 ) {							
+					c1.setY(-capsuleHalfHeight);
+					c2.setY(capsuleHalfHeight);
+				} else {
+					c1.setZ(-capsuleHalfHeight);
+					c2.setZ(capsuleHalfHeight);						
+				}
 
-			for( int collisionObject = startObject; collisionObject < endObject; ++collisionObject )
-			{
-				btCPUCollisionShapeDescription &shapeDescription( m_collisionObjectDetails[collisionObject] );
+				Point3 worldC1 = worldTransform * c1;
+				Point3 worldC2 = worldTransform * c2;
+				Vector3 segment = worldC2 - worldC1;
 
-				float colliderFriction = shapeDescription.friction;
+				// compute distance of tangent to vertex along line segment in capsule
+				float distanceAlongSegment = -( dot( worldC1 - vertex, segment ) / lengthSqr(segment) );
 
-				if( shapeDescription.collisionShapeType == CAPSULE_SHAPE_PROXYTYPE )
+				Point3 closestPoint = (worldC1 + segment * distanceAlongSegment);
+				float distanceFromLine = length(vertex - closestPoint);
+				float distanceFromC1 = length(worldC1 - vertex);
+				float distanceFromC2 = length(worldC2 - vertex);
+			
+				// Final distance from collision, point to push from, direction to push in
+				// for impulse force
+				float distance;
+				Point3 sourcePoint;
+				Vector3 normalVector;
+				if( distanceAlongSegment < 0 )
 				{
-					using namespace Vectormath::Aos;
+					distance = distanceFromC1;
+					sourcePoint = worldC1;
+					normalVector = normalize(vertex - worldC1);
+				} else if( distanceAlongSegment > 1.f ) {
+					distance = distanceFromC2;
+					sourcePoint = worldC2;
+					normalVector = normalize(vertex - worldC2);	
+				} else {
+					distance = distanceFromLine;
+					sourcePoint = closestPoint;
+					normalVector = normalize(vertex - closestPoint);
+				}
+				
+				Vector3 colliderLinearVelocity( shapeDescription.linearVelocity );
+				Vector3 colliderAngularVelocity( shapeDescription.angularVelocity );
+				Vector3 velocityOfSurfacePoint = colliderLinearVelocity + cross(colliderAngularVelocity, Vector3(vertex) - worldTransform.getTranslation());
 
-					float capsuleHalfHeight = shapeDescription.shapeInformation.capsule.halfHeight;
-					float capsuleRadius = shapeDescription.shapeInformation.capsule.radius;
-					int capsuleUpAxis = shapeDescription.shapeInformation.capsule.upAxis;
-					float capsuleMargin = shapeDescription.margin;
-					
-					Transform3 worldTransform = shapeDescription.shapeTransform;
-
-					// As this is a GPU comparison solver just iterate over the vertices
-					for( int vertexIndex = startVertex; vertexIndex < endVertex; ++vertexIndex )
-					{		
-						// Clear force for vertex first
-						m_vertexData.getForceAccumulator( vertexIndex ) = Vector3(0.f, 0.f, 0.f);
-
-						Point3 vertex( m_vertexData.getPosition( vertexIndex ) );
-
-						// Correctly define the centerline depending on the upAxis
-						Point3 c1(0.f, 0.f, 0.f); 
-						Point3 c2(0.f, 0.f, 0.f);
-						if( capsuleUpAxis == 0 ) {
-							c1.setX(-capsuleHalfHeight);
-							c2.setX(capsuleHalfHeight);
-						} else if( capsuleUpAxis == 1 ) {							
-							c1.setY(-capsuleHalfHeight);
-							c2.setY(capsuleHalfHeight);
-						} else {
-							c1.setZ(-capsuleHalfHeight);
-							c2.setZ(capsuleHalfHeight);						
-						}
-
-						Point3 worldC1 = worldTransform * c1;
-						Point3 worldC2 = worldTransform * c2;
-						Vector3 segment = worldC2 - worldC1;
-
-						// compute distance of tangent to vertex along line segment in capsule
-						float distanceAlongSegment = -( dot( worldC1 - vertex, segment ) / lengthSqr(segment) );
-
-						Point3 closestPoint = (worldC1 + segment * distanceAlongSegment);
-						float distanceFromLine = length(vertex - closestPoint);
-						float distanceFromC1 = length(worldC1 - vertex);
-						float distanceFromC2 = length(worldC2 - vertex);
-					
-						// Final distance from collision, point to push from, direction to push in
-						// for impulse force
-						float distance;
-						Point3 sourcePoint;
-						Vector3 normalVector;
-						if( distanceAlongSegment < 0 )
-						{
-							distance = distanceFromC1;
-							sourcePoint = worldC1;
-							normalVector = normalize(vertex - worldC1);
-						} else if( distanceAlongSegment > 1.f ) {
-							distance = distanceFromC2;
-							sourcePoint = worldC2;
-							normalVector = normalize(vertex - worldC2);	
-						} else {
-							distance = distanceFromLine;
-							sourcePoint = closestPoint;
-							normalVector = normalize(vertex - closestPoint);
-						}
-						
-						Vector3 colliderLinearVelocity( shapeDescription.linearVelocity );
-						Vector3 colliderAngularVelocity( shapeDescription.angularVelocity );
-						Vector3 velocityOfSurfacePoint = colliderLinearVelocity + cross(colliderAngularVelocity, Vector3(vertex) - worldTransform.getTranslation());
-
-						float minDistance = capsuleRadius + capsuleMargin;
-						bool collided = false;
-
-						if( distance < minDistance )
-						{
-							// Project back to surface along normal
-							Vectormath::Aos::Point3 sourcePos = m_vertexData.getPosition( vertexIndex );
-							Vectormath::Aos::Vector3 posChange = (minDistance - distance)*normalVector*0.9;
-							//if( length(posChange) > 1 )
-							//	std::cerr << "Poschange: " << length(posChange) << "\n";
-							
-							Vectormath::Aos::Point3 newPos = sourcePos + posChange;
-							m_vertexData.getPosition( vertexIndex ) = newPos;
-							//m_vertexData.getPosition( vertexIndex ) = m_vertexData.getPosition( vertexIndex )  + (minDistance - distance)*normalVector*0.9;
-
-							// Experiment with moving back along source vector.
-							// Removes all ability to slide because it projects back along the vector length so it would undo lateral movement.
-							// TODO: This isn't quite right because we should take the movement of the collider into account as well
-							/*Vector3 incomingMoveVector( normalize(m_vertexData.getPreviousPosition(vertexIndex) - m_vertexData.getPosition(vertexIndex)) );
-							Vector3 normalDirectionMoveOut( (minDistance - distance)*normalVector*0.9 );
-							float distanceOnIncomingVector = dot(normalDirectionMoveOut, incomingMoveVector);
-							Vector3 vectorCorrection( distanceOnIncomingVector*incomingMoveVector );
-							m_vertexData.getPosition( vertexIndex ) = m_vertexData.getPosition( vertexIndex ) + vectorCorrection;*/
-
-
-							collided = true;
-						}
-
-						// Update velocity of vertex based on position
-						m_vertexData.getVelocity(vertexIndex) = (m_vertexData.getPosition(vertexIndex) - m_vertexData.getPreviousPosition(vertexIndex)) * velocityCoefficient * isolverDt;
-
-						// If we collided before we are on the surface so have friction
-						if( collided )
-						{
-							// Compute friction
-
-							// TODO: Just vertex velocity not enough, really we need the velocity 
-							// relative to closest point on the surface of the collider
-							Vector3 vertexVelocity( m_vertexData.getVelocity(vertexIndex) );
-							Vector3 relativeVelocity( vertexVelocity - velocityOfSurfacePoint );
-
-
-							// First compute vectors for plane perpendicular to normal vector
-							// Cross any vector with normal vector first then cross the normal with it again
-							Vector3 p1(normalize(cross(normalVector, segment)));
-							Vector3 p2(normalize(cross(p1, normalVector)));
-							// Full friction is sum of velocities in each direction of plane.
-							Vector3 frictionVector(p1*dot(relativeVelocity, p1) + p2*dot(relativeVelocity, p2));
-
-							// Real friction is peak friction corrected by friction coefficients.
-							frictionVector = frictionVector*(colliderFriction*clothFriction);
-
-							float approachSpeed = dot( relativeVelocity, normalVector );						
-		
-							// For now just update vertex position by moving to radius distance along the push vector
-							// Could use this as the basis for simple vector distance constraint for the point later, possibly?
-							// That way in the main solver loop all shape types could be the same... though when
-							// we need to apply bi-directionally it becomes more complicated
+				float minDistance = capsuleRadius + capsuleMargin;
+				bool collided = false;
+
+				if( distance < minDistance )
+				{
+					// Project back to surface along normal
+					Vectormath::Aos::Point3 sourcePos = m_vertexData.getPosition( vertexIndex );
+					Vectormath::Aos::Vector3 posChange = (minDistance - distance)*normalVector*0.9;
 					
-							// Add friction vector to the force accumulator
-							Vector3 &currentForce( m_vertexData.getForceAccumulator( vertexIndex ) );
-						
-							// Only apply if the vertex is moving towards the object to reduce jitter error
-							if( approachSpeed <= 0.0 )
-								currentForce -= frictionVector;
-						}
-					}
+					Vectormath::Aos::Point3 newPos = sourcePos + posChange;
+					m_vertexData.getPosition( vertexIndex ) = newPos;
+
+					collided = true;
+				}
+
+				// Update velocity of vertex based on position
+				m_vertexData.getVelocity(vertexIndex) = (m_vertexData.getPosition(vertexIndex) - m_vertexData.getPreviousPosition(vertexIndex)) * velocityCoefficient * isolverDt;
+
+				// If we collided before we are on the surface so have friction
+				if( collided )
+				{
+					// Compute friction
+
+					// TODO: Just vertex velocity not enough, really we need the velocity 
+					// relative to closest point on the surface of the collider
+					Vector3 vertexVelocity( m_vertexData.getVelocity(vertexIndex) );
+					Vector3 relativeVelocity( vertexVelocity - velocityOfSurfacePoint );
+
+
+					// First compute vectors for plane perpendicular to normal vector
+					// Cross any vector with normal vector first then cross the normal with it again
+					Vector3 p1(normalize(cross(normalVector, segment)));
+					Vector3 p2(normalize(cross(p1, normalVector)));
+					// Full friction is sum of velocities in each direction of plane.
+					Vector3 frictionVector(p1*dot(relativeVelocity, p1) + p2*dot(relativeVelocity, p2));
+
+					// Real friction is peak friction corrected by friction coefficients.
+					frictionVector = frictionVector*(colliderFriction*clothFriction);
+
+					float approachSpeed = dot( relativeVelocity, normalVector );						
+
+					// Add friction vector to the force accumulator
+					Vector3 &currentForce( m_vertexData.getForceAccumulator( vertexIndex ) );
+				
+					// Only apply if the vertex is moving towards the object to reduce jitter error
+					if( approachSpeed <= 0.0 )
+						currentForce -= frictionVector;
 				}
-			} // for( int collisionObject = startObject; collisionObject < endObject; ++collisionObject )
-		} // if( endObject == startObject )
+			}
+		} // for( int collisionObject = startObject; collisionObject < endObject; ++collisionObject )
 	}
+} // btCPUSoftBodySolver::solveCollisionsAndUpdateVelocities
 
-			
+void btCPUSoftBodySolver::solveConstraints( float solverdt )
+{
+	int numLinks = m_linkData.getNumLinks();
+	int numVertices = m_vertexData.getNumVertices();
 
+	// Prepare links
+	{
+		btCPUSoftBodyKernelBody body( this, &btCPUSoftBodySolver::prepareLinks, solverdt );
+		btParallelFor( 0, numLinks, BT_CPU_SOFTBODY_LINK_GRAIN, body );
+	}
 
+	prepareCollisionConstraints();
+
+	// Solve velocity, batch by batch
+	for( int iteration = 0; iteration < m_numberOfVelocityIterations ; ++iteration )
+	{
+		solveLinkBatches( &btCPUSoftBodySolver::solveLinksForVelocity, solverdt );
+	}
+
+	// Compute new positions from velocity
+	// Also update the previous position so that our position computation is now based on the new position from the velocity solution
+	// rather than based directly on the original positions
+	if( m_numberOfVelocityIterations > 0 )
+	{
+		btCPUSoftBodyKernelBody body( this, &btCPUSoftBodySolver::updatePositionsFromVelocity, solverdt );
+		btParallelFor( 0, numVertices, BT_CPU_SOFTBODY_VERTEX_GRAIN, body );
+	}
+
+	// Solve drift
+	for( int iteration = 0; iteration < m_numberOfPositionIterations ; ++iteration )
+	{
+		solveLinkBatches( &btCPUSoftBodySolver::solveLinksForPosition, solverdt );
+	}
+
+	// Solve collision constraints
+	// Very simple solver that pushes the vertex out of collision imposters for now
+	// to test integration with the broad phase code.
+	// May also want to put this into position solver loop every n iterations depending on
+	// how it behaves
+	{
+		btCPUSoftBodyKernelBody body( this, &btCPUSoftBodySolver::solveCollisionsAndUpdateVelocities, solverdt );
+		btParallelFor( 0, numVertices, BT_CPU_SOFTBODY_VERTEX_GRAIN, body );
+	}
 } // btCPUSoftBodySolver::solveConstraints
 
 
@@ -98,7 +98,10 @@ public:
 		int m_firstVertex;
 		/** Index of first triangle in the world allocated to this cloth */
 		int m_firstTriangle;
-		/** Index of first link in the world allocated to this cloth */
+		/**
+		 * Index of first link in the world allocated to this cloth.
+		 * The solver sorts the links of all cloths into batches, so this is the position before batching.
+		 */
 		int m_firstLink;
 		/** Maximum number of links allocated to this cloth */
 		int m_maxLinks;
@@ -285,9 +288,33 @@ protected:
 	 */
 	btAlignedObjectArray< btCPUCollisionShapeDescription > m_collisionObjectDetails;
 
+	/**
+	 * Start of each link batch in the link arrays, followed by the number of links.
+	 * No two links within a batch share a vertex, so a batch is solved in parallel.
+	 */
+	btAlignedObjectArray< int > m_linkBatchStarts;
+
+
+	/** Colour the links and sort the link arrays by batch, filling m_linkBatchStarts */
+	void generateLinkBatches();
 
 	void prepareCollisionConstraints();
 
+	/**
+	 * Kernels over a range of vertices or of links within one batch.
+	 * They are run through btParallelFor, so they only write to the vertices and links in their range.
+	 */
+	void applyForcesToVertices( int startVertex, int endVertex, float solverdt );
+	void integrateVertices( int startVertex, int endVertex, float solverdt );
+	void prepareLinks( int startLink, int endLink, float solverdt );
+	void solveLinksForVelocity( int startLink, int endLink, float solverdt );
+	void updatePositionsFromVelocity( int startVertex, int endVertex, float solverdt );
+	void solveLinksForPosition( int startLink, int endLink, float solverdt );
+	void solveCollisionsAndUpdateVelocities( int startVertex, int endVertex, float solverdt );
+
+	/** Run a kernel over all link batches in order, each batch in parallel */
+	void solveLinkBatches( void (btCPUSoftBodySolver::*kernel)( int, int, float ), float solverdt );
+
 	Vectormath::Aos::Vector3 ProjectOnAxis( const Vectormath::Aos::Vector3 &v, const Vectormath::Aos::Vector3 &a );
 
 	void ApplyClampedForce( float solverdt, const Vectormath::Aos::Vector3 &force, const Vectormath::Aos::Vector3 &vertexVelocity, float inverseMass, Vectormath::Aos::Vector3 &vertexForce );
@@ -15,26 +15,71 @@ subject to the following restrictions:
 
 #include <MiniCL/cl_MiniCL_Defs.h>
 
+// Every kernel file gets its own namespace, they define helper functions with the same names
+
 #define MSTRINGIFY(A) A
+
+namespace ApplyForces
+{
 #include "../OpenCLC10/ApplyForces.cl"
+MINICL_REGISTER(ApplyForcesKernel)
+}
+
+namespace Integrate
+{
 #include "../OpenCLC10/Integrate.cl"
-#include "../OpenCLC10/PrepareLinks.cl"
-#include "../OpenCLC10/SolvePositions.cl"
-#include "../OpenCLC10/UpdateNodes.cl"
-#include "../OpenCLC10/UpdateNormals.cl"
-#include "../OpenCLC10/UpdatePositions.cl"
-#include "../OpenCLC10/UpdatePositionsFromVelocities.cl"
-//#include "../OpenCLC10/VSolveLinks.cl"
+MINICL_REGISTER(IntegrateKernel)
+}
 
+namespace PrepareLinks
+{
+#include "../OpenCLC10/PrepareLinks.cl"
 MINICL_REGISTER(PrepareLinksKernel)
-MINICL_REGISTER(UpdatePositionsFromVelocitiesKernel)
+}
+
+namespace SolvePositions
+{
+#include "../OpenCLC10/SolvePositions.cl"
 MINICL_REGISTER(SolvePositionsFromLinksKernel)
+}
+
+namespace UpdateNodes
+{
+#include "../OpenCLC10/UpdateNodes.cl"
 MINICL_REGISTER(updateVelocitiesFromPositionsWithVelocitiesKernel)
-MINICL_REGISTER(updateVelocitiesFromPositionsWithoutVelocitiesKernel)
-MINICL_REGISTER(IntegrateKernel)
-MINICL_REGISTER(ApplyForcesKernel)
+}
+
+namespace UpdateNormals
+{
+#include "../OpenCLC10/UpdateNormals.cl"
 MINICL_REGISTER(ResetNormalsAndAreasKernel)
 MINICL_REGISTER(NormalizeNormalsAndAreasKernel)
 MINICL_REGISTER(UpdateSoftBodiesKernel)
+}
+
+namespace UpdatePositions
+{
+#include "../OpenCLC10/UpdatePositions.cl"
+MINICL_REGISTER(updateVelocitiesFromPositionsWithoutVelocitiesKernel)
+}
+
+namespace UpdatePositionsFromVelocities
+{
+#include "../OpenCLC10/UpdatePositionsFromVelocities.cl"
+MINICL_REGISTER(UpdatePositionsFromVelocitiesKernel)
+}
+
+namespace VSolveLinks
+{
+#include "../OpenCLC10/VSolveLinks.cl"
+MINICL_REGISTER(VSolveLinksKernel)
+}
 
+namespace SolveCollisionsAndUpdateVelocities
+{
+#include "../OpenCLC10/SolveCollisionsAndUpdateVelocities.cl"
+MINICL_REGISTER(SolveCollisionsAndUpdateVelocitiesKernel)
+}
 
+// Referenced by btOpenCLSoftBodySolver::buildShaders
+int gMiniCLSoftBodyKernelsRegistered = 1;
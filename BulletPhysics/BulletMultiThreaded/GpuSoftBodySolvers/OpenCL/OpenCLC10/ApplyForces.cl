@@ -63,7 +63,7 @@ ApplyForcesKernel(
 				float dvNormal = dot(normal, relativeWindVelocity);
 				if( dvNormal > 0 )
 				{
-					float4 force = (float4)(0.f, 0.f, 0.f, 0.f);
+					float4 force = (float4)(0.f);
 					float c0 = area * dvNormal * relativeSpeedSquared / 2.f;
 					float c1 = c0 * mediumDensity;
 					force += normal * (-c1 * liftFactor);
@@ -26,7 +26,7 @@ IntegrateKernel(
 		velocity += force * inverseMass * solverdt;
 		position += velocity * solverdt;
 		
-		g_vertexForceAccumulator[nodeID] = (float4)(0.f, 0.f, 0.f, 0.0f);
+		g_vertexForceAccumulator[nodeID] = (float4)(0.f);
 		g_vertexPositions[nodeID]        = position;
 		g_vertexVelocity[nodeID]         = velocity;	
 	}
@@ -1,7 +1,5 @@
 MSTRINGIFY(
 
-#pragma OPENCL EXTENSION cl_amd_printf : enable\n
-
 float mydot3(float4 a, float4 b)
 {
    return a.x*b.x + a.y*b.y + a.z*b.z;
@@ -43,15 +41,9 @@ __constant int CAPSULE_SHAPE_PROXYTYPE = 10;
 // Multiply column-major matrix against vector
 float4 matrixVectorMul( float4 matrix[4], float4 vector )
 {
-	float4 returnVector;
-	float4 row0 = (float4)(matrix[0].x, matrix[1].x, matrix[2].x, matrix[3].x);
-	float4 row1 = (float4)(matrix[0].y, matrix[1].y, matrix[2].y, matrix[3].y);
-	float4 row2 = (float4)(matrix[0].z, matrix[1].z, matrix[2].z, matrix[3].z);
-	float4 row3 = (float4)(matrix[0].w, matrix[1].w, matrix[2].w, matrix[3].w);
-	returnVector.x = dot(row0, vector);
-	returnVector.y = dot(row1, vector);
-	returnVector.z = dot(row2, vector);
-	returnVector.w = dot(row3, vector);
+	// The columns come from a Transform3, their w is padding, so keep the w of the vector
+	float4 returnVector = matrix[0]*vector.x + matrix[1]*vector.y + matrix[2]*vector.z + matrix[3]*vector.w;
+	returnVector.w = vector.w;
 	return returnVector;
 }
 
@@ -67,10 +59,10 @@ SolveCollisionsAndUpdateVelocitiesKernel(
 	__global CollisionShapeDescription * g_collisionObjectDetails,
 	__global float4 * g_vertexForces,
 	__global float4 *g_vertexVelocities,
-	__global float4 *g_vertexPositions)
+	__global float4 *g_vertexPositions GUID_ARG)
 {
 	int nodeID = get_global_id(0);
-	float4 forceOnVertex = (float4)(0.f, 0.f, 0.f, 0.f);
+	float4 forceOnVertex = (float4)(0.f);
 	
 	if( get_global_id(0) < numNodes )
 	{	
@@ -119,14 +111,16 @@ SolveCollisionsAndUpdateVelocitiesKernel(
 					worldTransform[3] = shapeDescription.shapeTransform[3];
 
 					// Correctly define capsule centerline vector 
-					float4 c1 = (float4)(0.f, 0.f, 0.f, 1.f); 
-					float4 c2 = (float4)(0.f, 0.f, 0.f, 1.f);
+					float4 c1 = (float4)(0.f); 
+					float4 c2 = (float4)(0.f);
 					c1.x = select( 0.f, -capsuleHalfHeight, capsuleupAxis == 0 );
 					c1.y = select( 0.f, -capsuleHalfHeight, capsuleupAxis == 1 );
 					c1.z = select( 0.f, -capsuleHalfHeight, capsuleupAxis == 2 );
+					c1.w = 1.f;
 					c2.x = -c1.x;
 					c2.y = -c1.y;
 					c2.z = -c1.z;
+					c2.w = 1.f;
 
 
 					float4 worldC1 = matrixVectorMul(worldTransform, c1);
@@ -159,7 +153,7 @@ SolveCollisionsAndUpdateVelocitiesKernel(
 						
 					float4 colliderLinearVelocity = shapeDescription.linearVelocity;
 					float4 colliderAngularVelocity = shapeDescription.angularVelocity;
-					float4 velocityOfSurfacePoint = colliderLinearVelocity + cross(colliderAngularVelocity, position - (float4)(worldTransform[0].w, worldTransform[1].w, worldTransform[2].w, 0.f));
+					float4 velocityOfSurfacePoint = colliderLinearVelocity + cross(colliderAngularVelocity, position - (float4)(worldTransform[3].xyz, 0.f));
 
 					float minDistance = capsuleRadius + capsuleMargin;
 					
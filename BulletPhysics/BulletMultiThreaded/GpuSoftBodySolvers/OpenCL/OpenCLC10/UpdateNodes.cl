@@ -32,7 +32,7 @@ updateVelocitiesFromPositionsWithVelocitiesKernel(
 		velocity *= velocityCoefficient;
 		
 		g_vertexVelocities[nodeID] = velocity;
-		g_vertexForces[nodeID] = (float4)(0.f, 0.f, 0.f, 0.f);								
+		g_vertexForces[nodeID] = (float4)(0.f);								
 	}
 }
 
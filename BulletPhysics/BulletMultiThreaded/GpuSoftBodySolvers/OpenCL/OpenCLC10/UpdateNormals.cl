@@ -14,13 +14,13 @@ float4 normalize3(float4 a)
 
 __kernel void 
 ResetNormalsAndAreasKernel(
-	const unsigned int numNodes,
+	const int numNodes,
 	__global float4 * g_vertexNormals,
 	__global float * g_vertexArea GUID_ARG)
 {
 	if( get_global_id(0) < numNodes )
 	{
-		g_vertexNormals[get_global_id(0)] = (float4)(0.0f, 0.0f, 0.0f, 0.0f);
+		g_vertexNormals[get_global_id(0)] = (float4)(0.0f);
 		g_vertexArea[get_global_id(0)]    = 0.0f;
 	}
 }
@@ -28,8 +28,8 @@ ResetNormalsAndAreasKernel(
 
 __kernel void 
 UpdateSoftBodiesKernel(
-	const unsigned int startFace,
-	const unsigned int numFaces,
+	const int startFace,
+	const int numFaces,
 	__global int4 * g_triangleVertexIndexSet,
 	__global float4 * g_vertexPositions,
 	__global float4 * g_vertexNormals,
@@ -81,7 +81,7 @@ UpdateSoftBodiesKernel(
 
 __kernel void 
 NormalizeNormalsAndAreasKernel( 
-	const unsigned int numNodes,
+	const int numNodes,
 	__global int * g_vertexTriangleCount,
 	__global float4 * g_vertexNormals,
 	__global float * g_vertexArea GUID_ARG)
@@ -92,8 +92,6 @@ NormalizeNormalsAndAreasKernel(
 		float area = g_vertexArea[get_global_id(0)];
 		int numTriangles = g_vertexTriangleCount[get_global_id(0)];
 		
-		float vectorLength = length3(normal);
-		
 		g_vertexNormals[get_global_id(0)] = normalize3(normal);
 		g_vertexArea[get_global_id(0)] = area/(float)(numTriangles);
 	}
@@ -27,7 +27,7 @@ updateVelocitiesFromPositionsWithoutVelocitiesKernel(
 		velocity = difference*velocityCoefficient*isolverdt;		
 		
 		g_vertexVelocities[nodeID] = velocity;
-		g_vertexForces[nodeID] = (float4)(0.f, 0.f, 0.f, 0.f);								
+		g_vertexForces[nodeID] = (float4)(0.f);								
 	}
 }
 
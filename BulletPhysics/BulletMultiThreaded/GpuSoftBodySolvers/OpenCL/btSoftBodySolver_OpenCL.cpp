@@ -38,6 +38,10 @@ subject to the following restrictions:
 
 #define BT_DEFAULT_WORKGROUPSIZE 128
 
+#ifdef USE_MINICL
+extern int gMiniCLSoftBodyKernelsRegistered;
+#endif //USE_MINICL
+
 
 
 #define RELEASE_CL_KERNEL(kernelName) {if( kernelName ){ clReleaseKernel( kernelName ); kernelName = 0; }}
@@ -58,8 +62,6 @@ static const char* UpdateNodesCLString =
 #include "OpenCLC/UpdateNodes.cl"
 static const char* UpdatePositionsCLString = 
 #include "OpenCLC/UpdatePositions.cl"
-static const char* UpdateConstantsCLString = 
-#include "OpenCLC/UpdateConstants.cl"
 static const char* IntegrateCLString = 
 #include "OpenCLC/Integrate.cl"
 static const char* ApplyForcesCLString = 
@@ -83,8 +85,6 @@ static const char* UpdateNodesCLString =
 #include "OpenCLC10/UpdateNodes.cl"
 static const char* UpdatePositionsCLString = 
 #include "OpenCLC10/UpdatePositions.cl"
-static const char* UpdateConstantsCLString = 
-#include "OpenCLC10/UpdateConstants.cl"
 static const char* IntegrateCLString = 
 #include "OpenCLC10/Integrate.cl"
 static const char* ApplyForcesCLString = 
@@ -781,7 +781,6 @@ void btOpenCLSoftBodySolver::optimize( btAlignedObjectArray< btSoftBody * > &sof
 
 			int firstLink = getLinkData().getNumLinks();
 			int numLinks = softBody->m_links.size();
-			int maxLinks = numLinks;
 			
 			// Allocate space for the links
 			getLinkData().createLinks( numLinks );
@@ -908,7 +907,6 @@ void btOpenCLSoftBodySolver::updateSoftBodies()
 
 
 	int numVertices = m_vertexData.getNumVertices();
-	int numTriangles = m_triangleData.getNumTriangles();
 
 	// Ensure data is on accelerator
 	m_vertexData.moveToAccelerator();
@@ -1143,9 +1141,6 @@ void btOpenCLSoftBodySolver::solveConstraints( float solverdt )
 	using Vectormath::Aos::dot;
 
 	// Prepare links
-	int numLinks = m_linkData.getNumLinks();
-	int numVertices = m_vertexData.getNumVertices();
-
 	float kst = 1.f;
 	float ti = 0.f;
 
@@ -1692,6 +1687,12 @@ bool btOpenCLSoftBodySolver::buildShaders()
 	
 	if( m_shadersInitialized )
 		return true;
+
+#ifdef USE_MINICL
+	// MiniCLTaskWrap.cpp registers the kernels, referencing it keeps a static link from dropping it
+	if( !gMiniCLSoftBodyKernelsRegistered )
+		return false;
+#endif //USE_MINICL
 	
 	m_clFunctions.clearKernelCompilationFailures();
 
@@ -52,8 +52,8 @@ static sem_t* mainSemaphore=0;
 
 static sem_t* createSem(const char* baseName)
 {
-	static int semCount = 0;
 #ifdef NAMED_SEMAPHORES
+	static int semCount = 0;
         /// Named semaphore begin
         char name[32];
         snprintf(name, 32, "/%s-%d-%4.4d", baseName, getpid(), semCount++); 
@@ -317,7 +317,7 @@ public:
 	{
 		int result = pthread_barrier_init(&m_barr, NULL, numThreads);
 		m_numThreads = numThreads;
-		btAssert(result==0);
+		checkPThreadFunction(result);
 	}
 	virtual int  getMaxCount()
 	{
@@ -22,6 +22,7 @@ subject to the following restrictions:
 
 #include "LinearMath/btAlignedAllocator.h"
 #include "LinearMath/btQuickprof.h"
+#include "LinearMath/btAabbUtil2.h"
 #include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
 
 
@@ -393,9 +394,9 @@ void btGpu3DGridBroadphase::addLarge2LargePairsToCache(btDispatcher* dispatcher)
 
 
 
-void btGpu3DGridBroadphase::rayTest(const btVector3& rayFrom,const btVector3& rayTo, btBroadphaseRayCallback& rayCallback)
+void btGpu3DGridBroadphase::rayTest(const btVector3& rayFrom,const btVector3& rayTo, btBroadphaseRayCallback& rayCallback, const btVector3& aabbMin,const btVector3& aabbMax)
 {
-	btSimpleBroadphase::rayTest(rayFrom, rayTo, rayCallback);
+	btSimpleBroadphase::rayTest(rayFrom, rayTo, rayCallback, aabbMin, aabbMax);
 	for (int i=0; i <= m_LastLargeHandleIndex; i++)
 	{
 		btSimpleBroadphaseProxy* proxy = &m_pLargeHandles[i];
@@ -409,6 +410,25 @@ void btGpu3DGridBroadphase::rayTest(const btVector3& rayFrom,const btVector3& ra
 
 
 
+void btGpu3DGridBroadphase::aabbTest(const btVector3& aabbMin, const btVector3& aabbMax, btBroadphaseAabbCallback& callback)
+{
+	btSimpleBroadphase::aabbTest(aabbMin, aabbMax, callback);
+	for (int i=0; i <= m_LastLargeHandleIndex; i++)
+	{
+		btSimpleBroadphaseProxy* proxy = &m_pLargeHandles[i];
+		if(!proxy->m_clientObject)
+		{
+			continue;
+		}
+		if (TestAabbAgainstAabb2(aabbMin,aabbMax,proxy->m_aabbMin,proxy->m_aabbMax))
+		{
+			callback.process(proxy);
+		}
+	}
+}
+
+
+
 //
 // overrides for CPU version
 //
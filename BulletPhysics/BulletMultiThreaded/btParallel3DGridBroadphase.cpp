@@ -0,0 +1,725 @@
+/*
+Bullet Continuous Collision Detection and Physics Library, http://bulletphysics.org
+Copyright (C) 2006, 2009 Sony Computer Entertainment Inc.
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btParallel3DGridBroadphase.h"
+
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btThreads.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+
+#include <string.h> //for memset, memcpy
+
+//----------------------------------------------------------------------------------------
+
+///number of bodies per parallel task, fixed so that the per-task pair buffers (and the order in which
+///pairs enter the pair cache) are the same regardless of the number of threads
+#define BT_3DGRID_CHUNK_SIZE 256
+
+#define BT_3DGRID_RADIX_BITS 8
+#define BT_3DGRID_RADIX_SIZE (1 << BT_3DGRID_RADIX_BITS)
+#define BT_3DGRID_RADIX_MASK (BT_3DGRID_RADIX_SIZE - 1)
+
+#define BT_3DGRID_EMPTY_CELL 0xffffffff
+
+///sorted (cell hash, body index) key, same layout as the uint2 used by the GPU kernels
+struct bt3DGridHashKey
+{
+	unsigned int	m_hash;
+	unsigned int	m_index;
+};
+
+//----------------------------------------------------------------------------------------
+
+static inline int bt3DGridCalcGridCoord(float p, float origin, float cellSize)
+{
+	return (int)floorf((p - origin) / cellSize);
+}
+
+static inline unsigned int bt3DGridCalcGridHash(int x, int y, int z, const bt3DGridBroadphaseParams& params)
+{
+	// clamp to edges
+	x = btMax(0, btMin(x, (int)params.m_gridSizeX - 1));
+	y = btMax(0, btMin(y, (int)params.m_gridSizeY - 1));
+	z = btMax(0, btMin(z, (int)params.m_gridSizeZ - 1));
+	return (z * params.m_gridSizeY + y) * params.m_gridSizeX + x;
+}
+
+static inline bool bt3DGridTestAABBOverlap(const bt3DGrid3F1U& min0, const bt3DGrid3F1U& max0, const bt3DGrid3F1U& min1, const bt3DGrid3F1U& max1)
+{
+	return	(min0.fx <= max1.fx)&& (min1.fx <= max0.fx) &&
+			(min0.fy <= max1.fy)&& (min1.fy <= max0.fy) &&
+			(min0.fz <= max1.fz)&& (min1.fz <= max0.fz);
+}
+
+///adds handleIndex2 to the pair buffer of a body, or marks it as found when it is already there
+///returns false when the buffer of the body is full
+static inline bool bt3DGridAddOrFindPair(unsigned int* pPairBuff, unsigned int start, unsigned int& curr, unsigned int curr_max, unsigned int handleIndex2)
+{
+	for(unsigned int k = 0; k < curr; k++)
+	{
+		unsigned int old_pair = pPairBuff[start+k] & (~BT_3DGRID_PAIR_ANY_FLG);
+		if(old_pair == handleIndex2)
+		{
+			pPairBuff[start+k] |= BT_3DGRID_PAIR_FOUND_FLG;
+			return true;
+		}
+	}
+	if(curr >= curr_max)
+	{ // not a good solution, but let's avoid crash
+		return false;
+	}
+	pPairBuff[start+curr] = handleIndex2 | BT_3DGRID_PAIR_NEW_FLG;
+	curr++;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------
+//               P A R A L L E L   K E R N E L S
+//----------------------------------------------------------------------------------------
+
+struct bt3DGridCalcHashBody : public btIParallelForBody
+{
+	const bt3DGrid3F1U*	m_pAABB;
+	bt3DGridHashKey*	m_pHash;
+	bt3DGridBroadphaseParams	m_params;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int index = iBegin; index < iEnd; index++)
+		{
+			const bt3DGrid3F1U& bbMin = m_pAABB[index*2];
+			const bt3DGrid3F1U& bbMax = m_pAABB[index*2 + 1];
+			int x = bt3DGridCalcGridCoord((bbMin.fx + bbMax.fx) * 0.5f, m_params.m_worldOriginX, m_params.m_cellSizeX);
+			int y = bt3DGridCalcGridCoord((bbMin.fy + bbMax.fy) * 0.5f, m_params.m_worldOriginY, m_params.m_cellSizeY);
+			int z = bt3DGridCalcGridCoord((bbMin.fz + bbMax.fz) * 0.5f, m_params.m_worldOriginZ, m_params.m_cellSizeZ);
+			m_pHash[index].m_hash = bt3DGridCalcGridHash(x, y, z, m_params);
+			m_pHash[index].m_index = index;
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+
+///counts the radix digits of every chunk, the loop runs over chunk indices
+struct bt3DGridRadixHistogramBody : public btIParallelForBody
+{
+	const bt3DGridHashKey*	m_pSrc;
+	unsigned int*	m_pHistogram;
+	unsigned int	m_numBodies;
+	unsigned int	m_shift;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int chunk = iBegin; chunk < iEnd; chunk++)
+		{
+			unsigned int* pHist = m_pHistogram + chunk * BT_3DGRID_RADIX_SIZE;
+			memset(pHist, 0, BT_3DGRID_RADIX_SIZE * sizeof(unsigned int));
+			unsigned int begin = chunk * BT_3DGRID_CHUNK_SIZE;
+			unsigned int end = btMin(begin + BT_3DGRID_CHUNK_SIZE, m_numBodies);
+			for(unsigned int i = begin; i < end; i++)
+			{
+				pHist[(m_pSrc[i].m_hash >> m_shift) & BT_3DGRID_RADIX_MASK]++;
+			}
+		}
+	}
+};
+
+///stable scatter of every chunk to the offsets computed from the histograms
+struct bt3DGridRadixScatterBody : public btIParallelForBody
+{
+	const bt3DGridHashKey*	m_pSrc;
+	bt3DGridHashKey*	m_pDst;
+	unsigned int*	m_pOffsets;
+	unsigned int	m_numBodies;
+	unsigned int	m_shift;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int chunk = iBegin; chunk < iEnd; chunk++)
+		{
+			unsigned int* pOffs = m_pOffsets + chunk * BT_3DGRID_RADIX_SIZE;
+			unsigned int begin = chunk * BT_3DGRID_CHUNK_SIZE;
+			unsigned int end = btMin(begin + BT_3DGRID_CHUNK_SIZE, m_numBodies);
+			for(unsigned int i = begin; i < end; i++)
+			{
+				unsigned int digit = (m_pSrc[i].m_hash >> m_shift) & BT_3DGRID_RADIX_MASK;
+				m_pDst[pOffs[digit]++] = m_pSrc[i];
+			}
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+
+struct bt3DGridFindCellStartBody : public btIParallelForBody
+{
+	const bt3DGridHashKey*	m_pHash;
+	unsigned int*	m_pCellStart;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int index = iBegin; index < iEnd; index++)
+		{
+			unsigned int hash = m_pHash[index].m_hash;
+			if((index == 0) || (hash != m_pHash[index-1].m_hash))
+			{
+				m_pCellStart[hash] = index;
+			}
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+
+///small/small pairs: every body looks at the 27 surrounding cells and only pairs up with bodies of lower index,
+///so each pair is written exactly once, into the pair buffer of the body that owns the loop iteration
+struct bt3DGridFindOverlappingPairsBody : public btIParallelForBody
+{
+	const bt3DGrid3F1U*	m_pAABB;
+	const bt3DGridHashKey*	m_pHash;
+	const unsigned int*	m_pCellStart;
+	unsigned int*	m_pPairBuff;
+	unsigned int*	m_pPairBuffStartCurr;
+	unsigned int	m_numBodies;
+	bt3DGridBroadphaseParams	m_params;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int index = iBegin; index < iEnd; index++)
+		{
+			unsigned int unsorted_indx = m_pHash[index].m_index;
+			const bt3DGrid3F1U& min0 = m_pAABB[unsorted_indx*2];
+			const bt3DGrid3F1U& max0 = m_pAABB[unsorted_indx*2 + 1];
+			int gx = bt3DGridCalcGridCoord((min0.fx + max0.fx) * 0.5f, m_params.m_worldOriginX, m_params.m_cellSizeX);
+			int gy = bt3DGridCalcGridCoord((min0.fy + max0.fy) * 0.5f, m_params.m_worldOriginY, m_params.m_cellSizeY);
+			int gz = bt3DGridCalcGridCoord((min0.fz + max0.fz) * 0.5f, m_params.m_worldOriginZ, m_params.m_cellSizeZ);
+			// positions outside of the grid are clamped to the border cells, do the same for the neighbourhood
+			gx = btMax(0, btMin(gx, (int)m_params.m_gridSizeX - 1));
+			gy = btMax(0, btMin(gy, (int)m_params.m_gridSizeY - 1));
+			gz = btMax(0, btMin(gz, (int)m_params.m_gridSizeZ - 1));
+
+			unsigned int handleIndex = min0.uw;
+			unsigned int start = m_pPairBuffStartCurr[handleIndex * 2];
+			unsigned int curr = m_pPairBuffStartCurr[handleIndex * 2 + 1];
+			unsigned int curr_max = m_pPairBuffStartCurr[(handleIndex + 1) * 2] - start - 1;
+			bool full = false;
+
+			for(int z = gz - 1; (z <= gz + 1) && !full; z++)
+			{
+				if((z < 0) || (z >= (int)m_params.m_gridSizeZ))
+					continue;
+				for(int y = gy - 1; (y <= gy + 1) && !full; y++)
+				{
+					if((y < 0) || (y >= (int)m_params.m_gridSizeY))
+						continue;
+					for(int x = gx - 1; (x <= gx + 1) && !full; x++)
+					{
+						if((x < 0) || (x >= (int)m_params.m_gridSizeX))
+							continue;
+						unsigned int gridHash = (z * m_params.m_gridSizeY + y) * m_params.m_gridSizeX + x;
+						unsigned int bucketStart = m_pCellStart[gridHash];
+						if(bucketStart == BT_3DGRID_EMPTY_CELL)
+							continue;
+						unsigned int bucketEnd = btMin(bucketStart + m_params.m_maxBodiesPerCell, m_numBodies);
+						for(unsigned int index2 = bucketStart; index2 < bucketEnd; index2++)
+						{
+							if(m_pHash[index2].m_hash != gridHash)
+								break; // no longer in same bucket
+							unsigned int unsorted_indx2 = m_pHash[index2].m_index;
+							if(unsorted_indx2 >= unsorted_indx)
+								continue;
+							const bt3DGrid3F1U& min1 = m_pAABB[unsorted_indx2*2];
+							const bt3DGrid3F1U& max1 = m_pAABB[unsorted_indx2*2 + 1];
+							if(bt3DGridTestAABBOverlap(min0, max0, min1, max1))
+							{
+								if(!bt3DGridAddOrFindPair(m_pPairBuff, start, curr, curr_max, min1.uw))
+								{
+									full = true;
+									break;
+								}
+							}
+						}
+					}
+				}
+			}
+			m_pPairBuffStartCurr[handleIndex * 2 + 1] = curr;
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+
+struct bt3DGridFindPairsLargeBody : public btIParallelForBody
+{
+	const bt3DGrid3F1U*	m_pAABB;
+	unsigned int*	m_pPairBuff;
+	unsigned int*	m_pPairBuffStartCurr;
+	unsigned int	m_numBodies;
+	unsigned int	m_numLarge;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int index = iBegin; index < iEnd; index++)
+		{
+			const bt3DGrid3F1U& min0 = m_pAABB[index*2];
+			const bt3DGrid3F1U& max0 = m_pAABB[index*2 + 1];
+			unsigned int handleIndex = min0.uw;
+			unsigned int start = m_pPairBuffStartCurr[handleIndex * 2];
+			unsigned int curr = m_pPairBuffStartCurr[handleIndex * 2 + 1];
+			unsigned int curr_max = m_pPairBuffStartCurr[(handleIndex + 1) * 2] - start - 1;
+			for(unsigned int i = 0; i < m_numLarge; i++)
+			{
+				unsigned int indx2 = m_numBodies + i;
+				const bt3DGrid3F1U& min1 = m_pAABB[indx2*2];
+				const bt3DGrid3F1U& max1 = m_pAABB[indx2*2 + 1];
+				if(bt3DGridTestAABBOverlap(min0, max0, min1, max1))
+				{
+					if(!bt3DGridAddOrFindPair(m_pPairBuff, start, curr, curr_max, min1.uw))
+					{
+						break;
+					}
+				}
+			}
+			m_pPairBuffStartCurr[handleIndex * 2 + 1] = curr;
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+
+///collects the pairs that appeared (NEW flag) or disappeared (no flag) into the buffer of the chunk,
+///and squeezes the pair buffer of every body down to the pairs that still overlap, the loop runs over chunk indices
+struct bt3DGridEmitPairChangesBody : public btIParallelForBody
+{
+	const bt3DGrid3F1U*	m_pAABB;
+	unsigned int*	m_pPairBuff;
+	unsigned int*	m_pPairBuffStartCurr;
+	unsigned int	m_numBodies;
+	btAlignedObjectArray<unsigned int>*	m_pPairChanges;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int chunk = iBegin; chunk < iEnd; chunk++)
+		{
+			btAlignedObjectArray<unsigned int>& changes = m_pPairChanges[chunk];
+			changes.resize(0);
+			unsigned int begin = chunk * BT_3DGRID_CHUNK_SIZE;
+			unsigned int end = btMin(begin + BT_3DGRID_CHUNK_SIZE, m_numBodies);
+			for(unsigned int index = begin; index < end; index++)
+			{
+				unsigned int handleIndex = m_pAABB[index * 2].uw;
+				unsigned int start = m_pPairBuffStartCurr[handleIndex * 2];
+				unsigned int curr = m_pPairBuffStartCurr[handleIndex * 2 + 1];
+				unsigned int* pInp = m_pPairBuff + start;
+				unsigned int* pOut = pInp;
+				unsigned int num = 0;
+				for(unsigned int k = 0; k < curr; k++, pInp++)
+				{
+					unsigned int entry = *pInp;
+					if(!(entry & BT_3DGRID_PAIR_FOUND_FLG))
+					{
+						changes.push_back(handleIndex);
+						changes.push_back(entry);
+					}
+					if(entry & BT_3DGRID_PAIR_ANY_FLG)
+					{
+						*pOut = entry & (~BT_3DGRID_PAIR_ANY_FLG);
+						pOut++;
+						num++;
+					}
+				}
+				m_pPairBuffStartCurr[handleIndex * 2 + 1] = num;
+			}
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+
+///removes the entries that refer to destroyed proxies from the pair buffers, the loop runs over handle indices
+struct bt3DGridPurgeStalePairsBody : public btIParallelForBody
+{
+	unsigned int*	m_pPairBuff;
+	unsigned int*	m_pPairBuffStartCurr;
+	const unsigned char*	m_pStaleHandle;
+
+	virtual void forLoop(int iBegin, int iEnd) const
+	{
+		for(int handleIndex = iBegin; handleIndex < iEnd; handleIndex++)
+		{
+			unsigned int start = m_pPairBuffStartCurr[handleIndex * 2];
+			unsigned int curr = m_pPairBuffStartCurr[handleIndex * 2 + 1];
+			unsigned int num = 0;
+			for(unsigned int k = 0; k < curr; k++)
+			{
+				unsigned int entry = m_pPairBuff[start + k];
+				if(!m_pStaleHandle[entry & (~BT_3DGRID_PAIR_ANY_FLG)])
+				{
+					m_pPairBuff[start + num] = entry;
+					num++;
+				}
+			}
+			m_pPairBuffStartCurr[handleIndex * 2 + 1] = num;
+		}
+	}
+};
+
+//----------------------------------------------------------------------------------------
+//               E N D   O F   P A R A L L E L   K E R N E L S
+//----------------------------------------------------------------------------------------
+
+
+
+btParallel3DGridBroadphase::btParallel3DGridBroadphase(	const btVector3& worldAabbMin,const btVector3& worldAabbMax,
+										int gridSizeX, int gridSizeY, int gridSizeZ,
+										int maxSmallProxies, int maxLargeProxies, int maxPairsPerBody,
+										int maxBodiesPerCell,
+										btScalar cellFactorAABB) :
+	btGpu3DGridBroadphase(worldAabbMin, worldAabbMax, gridSizeX, gridSizeY, gridSizeZ,
+						  maxSmallProxies, maxLargeProxies, maxPairsPerBody,
+						  maxBodiesPerCell, cellFactorAABB)
+{
+	_initializeParallel();
+}
+
+
+
+btParallel3DGridBroadphase::btParallel3DGridBroadphase(	btOverlappingPairCache* overlappingPairCache,
+										const btVector3& worldAabbMin,const btVector3& worldAabbMax,
+										int gridSizeX, int gridSizeY, int gridSizeZ,
+										int maxSmallProxies, int maxLargeProxies, int maxPairsPerBody,
+										int maxBodiesPerCell,
+										btScalar cellFactorAABB) :
+	btGpu3DGridBroadphase(overlappingPairCache, worldAabbMin, worldAabbMax, gridSizeX, gridSizeY, gridSizeZ,
+						  maxSmallProxies, maxLargeProxies, maxPairsPerBody,
+						  maxBodiesPerCell, cellFactorAABB)
+{
+	_initializeParallel();
+}
+
+
+
+btParallel3DGridBroadphase::~btParallel3DGridBroadphase()
+{
+	delete [] m_hBodiesHashTmp;
+}
+
+
+
+void btParallel3DGridBroadphase::_initializeParallel()
+{
+	m_hBodiesHashTmp = new unsigned int[m_maxHandles * 2];
+
+	// the number of 8-bit digits needed to sort the cell hashes
+	int numBits = 0;
+	while(((m_params.m_numCells - 1) >> numBits) && (numBits < 32))
+	{
+		numBits++;
+	}
+	m_numRadixPasses = (numBits + BT_3DGRID_RADIX_BITS - 1) / BT_3DGRID_RADIX_BITS;
+
+	// cells are cleared lazily, only the ones touched by the previous update
+	memset(m_hCellStart, 0xff, m_params.m_numCells * sizeof(unsigned int));
+	m_numPrevHashed = 0;
+
+	m_staleHandle.resize(m_maxHandles + m_maxLargeHandles, 0);
+}
+
+
+
+int btParallel3DGridBroadphase::getNumChunks() const
+{
+	return (m_numHandles + BT_3DGRID_CHUNK_SIZE - 1) / BT_3DGRID_CHUNK_SIZE;
+}
+
+
+
+void btParallel3DGridBroadphase::calculateOverlappingPairs(btDispatcher* dispatcher)
+{
+	BT_PROFILE("btParallel3DGrid_calculateOverlappingPairs");
+	purgeStalePairs();
+	if(m_numHandles <= 0)
+	{
+		addLarge2LargePairsToCache(dispatcher);
+		return;
+	}
+	// prepare AABB array
+	prepareAABB();
+	// forget the cells of the previous update, then calculate the new hashes
+	clearCellStart();
+	calcHashAABB();
+	// sort bodies based on hash
+	sortHash();
+	// find start of each cell
+	findCellStart();
+	// findOverlappingPairs (small/small)
+	findOverlappingPairs();
+	// findOverlappingPairs (small/large)
+	findPairsLarge();
+	// add pairs to CPU cache
+	emitPairChanges();
+	applyPairChanges(dispatcher);
+	// find and add large/large pairs to CPU cache
+	addLarge2LargePairsToCache(dispatcher);
+}
+
+
+
+void btParallel3DGridBroadphase::destroyProxy(btBroadphaseProxy* proxy, btDispatcher* dispatcher)
+{
+	// the handle may be reused before the next update, so make sure neither its own pair buffer
+	// nor the buffers of other bodies keep referring to it
+	int index;
+	if(isLargeProxy(proxy))
+	{
+		index = m_maxHandles + int(static_cast<btSimpleBroadphaseProxy*>(proxy) - m_pLargeHandles);
+	}
+	else
+	{
+		index = int(static_cast<btSimpleBroadphaseProxy*>(proxy) - m_pHandles);
+		m_hPairBuffStartCurr[index * 2 + 1] = 0;
+	}
+	if(!m_staleHandle[index])
+	{
+		m_staleHandle[index] = 1;
+		m_staleHandleList.push_back(index);
+	}
+	btGpu3DGridBroadphase::destroyProxy(proxy, dispatcher);
+}
+
+
+
+void btParallel3DGridBroadphase::resetPool(btDispatcher* dispatcher)
+{
+	btGpu3DGridBroadphase::resetPool(dispatcher);
+	for(int i = 0; i < m_staleHandleList.size(); i++)
+	{
+		m_staleHandle[m_staleHandleList[i]] = 0;
+	}
+	m_staleHandleList.resize(0);
+}
+
+
+
+void btParallel3DGridBroadphase::purgeStalePairs()
+{
+	if(!m_staleHandleList.size())
+	{
+		return;
+	}
+	BT_PROFILE("btParallel3DGrid_purgeStalePairs");
+	bt3DGridPurgeStalePairsBody body;
+	body.m_pPairBuff = m_hPairBuff;
+	body.m_pPairBuffStartCurr = m_hPairBuffStartCurr;
+	body.m_pStaleHandle = &m_staleHandle[0];
+	btParallelFor(0, m_LastHandleIndex + 1, BT_3DGRID_CHUNK_SIZE, body);
+	for(int i = 0; i < m_staleHandleList.size(); i++)
+	{
+		m_staleHandle[m_staleHandleList[i]] = 0;
+	}
+	m_staleHandleList.resize(0);
+}
+
+
+
+void btParallel3DGridBroadphase::clearCellStart()
+{
+	bt3DGridHashKey* pHash = (bt3DGridHashKey*)m_hBodiesHash;
+	for(unsigned int i = 0; i < m_numPrevHashed; i++)
+	{
+		m_hCellStart[pHash[i].m_hash] = BT_3DGRID_EMPTY_CELL;
+	}
+	m_numPrevHashed = 0;
+}
+
+
+
+void btParallel3DGridBroadphase::calcHashAABB()
+{
+	BT_PROFILE("btParallel3DGrid_calcHashAABB");
+	bt3DGridCalcHashBody body;
+	body.m_pAABB = m_hAABB;
+	body.m_pHash = (bt3DGridHashKey*)m_hBodiesHash;
+	body.m_params = m_params;
+	btParallelFor(0, m_numHandles, BT_3DGRID_CHUNK_SIZE, body);
+	m_numPrevHashed = m_numHandles;
+}
+
+
+
+void btParallel3DGridBroadphase::sortHash()
+{
+	BT_PROFILE("btParallel3DGrid_sortHash");
+	int numChunks = getNumChunks();
+	m_radixHistogram.resize(numChunks * BT_3DGRID_RADIX_SIZE);
+	unsigned int* pHist = &m_radixHistogram[0];
+
+	bt3DGridHashKey* pSrc = (bt3DGridHashKey*)m_hBodiesHash;
+	bt3DGridHashKey* pDst = (bt3DGridHashKey*)m_hBodiesHashTmp;
+	for(int pass = 0; pass < m_numRadixPasses; pass++)
+	{
+		unsigned int shift = pass * BT_3DGRID_RADIX_BITS;
+
+		bt3DGridRadixHistogramBody histogramBody;
+		histogramBody.m_pSrc = pSrc;
+		histogramBody.m_pHistogram = pHist;
+		histogramBody.m_numBodies = m_numHandles;
+		histogramBody.m_shift = shift;
+		btParallelFor(0, numChunks, 1, histogramBody);
+
+		// turn the counts into scatter offsets: digit-major, chunk-minor keeps the sort stable
+		unsigned int sum = 0;
+		bool singleDigit = false;
+		for(int digit = 0; digit < BT_3DGRID_RADIX_SIZE; digit++)
+		{
+			unsigned int digitStart = sum;
+			for(int chunk = 0; chunk < numChunks; chunk++)
+			{
+				unsigned int count = pHist[chunk * BT_3DGRID_RADIX_SIZE + digit];
+				pHist[chunk * BT_3DGRID_RADIX_SIZE + digit] = sum;
+				sum += count;
+			}
+			if((sum - digitStart) == (unsigned int)m_numHandles)
+			{
+				singleDigit = true;
+			}
+		}
+		if(singleDigit)
+		{
+			// all keys share this digit, the pass would not change the order
+			continue;
+		}
+
+		bt3DGridRadixScatterBody scatterBody;
+		scatterBody.m_pSrc = pSrc;
+		scatterBody.m_pDst = pDst;
+		scatterBody.m_pOffsets = pHist;
+		scatterBody.m_numBodies = m_numHandles;
+		scatterBody.m_shift = shift;
+		btParallelFor(0, numChunks, 1, scatterBody);
+
+		btSwap(pSrc, pDst);
+	}
+	if(pSrc != (bt3DGridHashKey*)m_hBodiesHash)
+	{
+		memcpy(m_hBodiesHash, pSrc, m_numHandles * sizeof(bt3DGridHashKey));
+	}
+}
+
+
+
+void btParallel3DGridBroadphase::findCellStart()
+{
+	BT_PROFILE("btParallel3DGrid_findCellStart");
+	bt3DGridFindCellStartBody body;
+	body.m_pHash = (bt3DGridHashKey*)m_hBodiesHash;
+	body.m_pCellStart = m_hCellStart;
+	btParallelFor(0, m_numHandles, BT_3DGRID_CHUNK_SIZE, body);
+}
+
+
+
+void btParallel3DGridBroadphase::findOverlappingPairs()
+{
+	BT_PROFILE("btParallel3DGrid_findOverlappingPairs");
+	bt3DGridFindOverlappingPairsBody body;
+	body.m_pAABB = m_hAABB;
+	body.m_pHash = (bt3DGridHashKey*)m_hBodiesHash;
+	body.m_pCellStart = m_hCellStart;
+	body.m_pPairBuff = m_hPairBuff;
+	body.m_pPairBuffStartCurr = m_hPairBuffStartCurr;
+	body.m_numBodies = m_numHandles;
+	body.m_params = m_params;
+	btParallelFor(0, m_numHandles, BT_3DGRID_CHUNK_SIZE / 4, body);
+}
+
+
+
+void btParallel3DGridBroadphase::findPairsLarge()
+{
+	if(m_numLargeHandles <= 0)
+	{
+		return;
+	}
+	BT_PROFILE("btParallel3DGrid_findPairsLarge");
+	bt3DGridFindPairsLargeBody body;
+	body.m_pAABB = m_hAABB;
+	body.m_pPairBuff = m_hPairBuff;
+	body.m_pPairBuffStartCurr = m_hPairBuffStartCurr;
+	body.m_numBodies = m_numHandles;
+	body.m_numLarge = m_numLargeHandles;
+	btParallelFor(0, m_numHandles, BT_3DGRID_CHUNK_SIZE, body);
+}
+
+
+
+void btParallel3DGridBroadphase::emitPairChanges()
+{
+	BT_PROFILE("btParallel3DGrid_emitPairChanges");
+	int numChunks = getNumChunks();
+	if(m_pairChanges.size() < numChunks)
+	{
+		// never shrink, the buffers keep their capacity from one update to the next
+		m_pairChanges.resize(numChunks);
+	}
+	bt3DGridEmitPairChangesBody body;
+	body.m_pAABB = m_hAABB;
+	body.m_pPairBuff = m_hPairBuff;
+	body.m_pPairBuffStartCurr = m_hPairBuffStartCurr;
+	body.m_numBodies = m_numHandles;
+	body.m_pPairChanges = &m_pairChanges[0];
+	btParallelFor(0, numChunks, 1, body);
+}
+
+
+
+void btParallel3DGridBroadphase::applyPairChanges(btDispatcher* dispatcher)
+{
+	BT_PROFILE("btParallel3DGrid_applyPairChanges");
+	m_numPairsAdded = 0;
+	m_numPairsRemoved = 0;
+	int numChunks = getNumChunks();
+	for(int chunk = 0; chunk < numChunks; chunk++)
+	{
+		const btAlignedObjectArray<unsigned int>& changes = m_pairChanges[chunk];
+		for(int i = 0; i < changes.size(); i += 2)
+		{
+			btSimpleBroadphaseProxy* proxy0 = &m_pHandles[changes[i]];
+			unsigned int indx1_s = changes[i + 1];
+			unsigned int index1 = indx1_s & (~BT_3DGRID_PAIR_ANY_FLG);
+			btSimpleBroadphaseProxy* proxy1;
+			if(index1 < (unsigned int)m_maxHandles)
+			{
+				proxy1 = &m_pHandles[index1];
+			}
+			else
+			{
+				index1 -= m_maxHandles;
+				btAssert(index1 < (unsigned int)m_maxLargeHandles);
+				proxy1 = &m_pLargeHandles[index1];
+			}
+			if(indx1_s & BT_3DGRID_PAIR_NEW_FLG)
+			{
+				m_pairCache->addOverlappingPair(proxy0,proxy1);
+				m_numPairsAdded++;
+			}
+			else
+			{
+				m_pairCache->removeOverlappingPair(proxy0,proxy1,dispatcher);
+				m_numPairsRemoved++;
+			}
+		}
+	}
+}
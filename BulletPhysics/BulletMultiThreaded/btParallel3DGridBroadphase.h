@@ -0,0 +1,100 @@
+/*
+Bullet Continuous Collision Detection and Physics Library, http://bulletphysics.org
+Copyright (C) 2006, 2009 Sony Computer Entertainment Inc.
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+//----------------------------------------------------------------------------------------
+
+#ifndef BTPARALLEL3DGRIDBROADPHASE_H
+#define BTPARALLEL3DGRIDBROADPHASE_H
+
+//----------------------------------------------------------------------------------------
+
+#include "btGpu3DGridBroadphase.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+//----------------------------------------------------------------------------------------
+
+///The btParallel3DGridBroadphase is a multi-core CPU version of the btGpu3DGridBroadphase uniform grid.
+///Every stage of the calc-hash / sort / find-cell-start / find-pairs pipeline runs through btParallelFor,
+///the cell hashes are ordered with a parallel LSD radix sort, and pair cache changes are emitted into per-task buffers
+///that are merged in a fixed order, so the result does not depend on the number of threads.
+///Without a task scheduler (see btSetTaskScheduler) everything runs on the calling thread.
+///The grid works best when the objects are about the same size: choose cells at least as large as the largest object,
+///objects with a bounding sphere larger than half a cell are handled as 'large' proxies and tested against everything.
+class btParallel3DGridBroadphase : public btGpu3DGridBroadphase
+{
+protected:
+	// sorting
+	unsigned int*	m_hBodiesHashTmp;
+	int				m_numRadixPasses;
+	btAlignedObjectArray<unsigned int>	m_radixHistogram;
+	unsigned int	m_numPrevHashed;
+	// pair changes, one buffer per task so that emission needs no synchronisation
+	btAlignedObjectArray<btAlignedObjectArray<unsigned int> >	m_pairChanges;
+	// handles destroyed since the last update, their entries are purged from the pair buffers
+	btAlignedObjectArray<unsigned char>	m_staleHandle;
+	btAlignedObjectArray<int>	m_staleHandleList;
+
+	void _initializeParallel();
+	void purgeStalePairs();
+	void clearCellStart();
+	void emitPairChanges();
+	void applyPairChanges(btDispatcher* dispatcher);
+
+	int getNumChunks() const;
+
+public:
+	btParallel3DGridBroadphase(const btVector3& worldAabbMin,const btVector3& worldAabbMax,
+					   int gridSizeX, int gridSizeY, int gridSizeZ,
+					   int maxSmallProxies, int maxLargeProxies, int maxPairsPerBody,
+					   int maxBodiesPerCell = 8,
+					   btScalar cellFactorAABB = btScalar(1.0f));
+	btParallel3DGridBroadphase(	btOverlappingPairCache* overlappingPairCache,
+						const btVector3& worldAabbMin,const btVector3& worldAabbMax,
+						int gridSizeX, int gridSizeY, int gridSizeZ,
+						int maxSmallProxies, int maxLargeProxies, int maxPairsPerBody,
+						int maxBodiesPerCell = 8,
+						btScalar cellFactorAABB = btScalar(1.0f));
+	virtual ~btParallel3DGridBroadphase();
+
+	virtual void	calculateOverlappingPairs(btDispatcher* dispatcher);
+
+	virtual void	destroyProxy(btBroadphaseProxy* proxy,btDispatcher* dispatcher);
+	virtual void	resetPool(btDispatcher* dispatcher);
+
+	unsigned int	getNumPairsAdded() const
+	{
+		return m_numPairsAdded;
+	}
+	unsigned int	getNumPairsRemoved() const
+	{
+		return m_numPairsRemoved;
+	}
+
+protected:
+// parallel overrides of the CPU version
+	virtual void calcHashAABB();
+	virtual void sortHash();
+	virtual void findCellStart();
+	virtual void findOverlappingPairs();
+	virtual void findPairsLarge();
+};
+
+//----------------------------------------------------------------------------------------
+
+#endif //BTPARALLEL3DGRIDBROADPHASE_H
+
+//----------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------
@@ -230,14 +230,15 @@ void CustomSolveConstraintsTaskParallel(
 						
 						for(int j=0;j<contact.getNumContacts();j++) {
 							btManifoldPoint& cp = contact.getContactPoint(j);
+							btConstraintRow* rows = contact.getConstraintRows(j);
 							
 							if(k==0) {
 								vmVector3 rA = rotate(solverBodyA.mOrientation,btReadVector3(cp.m_localPointA));
 								vmVector3 rB = rotate(solverBodyB.mOrientation,btReadVector3(cp.m_localPointB));
 								
 								for(int k=0;k<3;k++) {
-									vmVector3 normal = btReadVector3(cp.mConstraintRow[k].m_normal);
-									float deltaImpulse = cp.mConstraintRow[k].m_accumImpulse;
+									vmVector3 normal = btReadVector3(rows[k].m_normal);
+									float deltaImpulse = rows[k].m_accumImpulse;
 									solverBodyA.mDeltaLinearVelocity += deltaImpulse * solverBodyA.mMassInv * normal;
 									solverBodyA.mDeltaAngularVelocity += deltaImpulse * solverBodyA.mInertiaInv * cross(rA,normal);
 									solverBodyB.mDeltaLinearVelocity -= deltaImpulse * solverBodyB.mMassInv * normal;
@@ -246,9 +247,9 @@ void CustomSolveConstraintsTaskParallel(
 							}
 							else {
 								btSolveContactConstraint(
-									cp.mConstraintRow[0],
-									cp.mConstraintRow[1],
-									cp.mConstraintRow[2],
+									rows[0],
+									rows[1],
+									rows[2],
 									btReadVector3(cp.m_localPointA),
 									btReadVector3(cp.m_localPointB),
 									solverBodyA,
@@ -439,11 +440,12 @@ void CustomSetupContactConstraintsTask(
 
 		for(int j=0;j<contact.getNumContacts();j++) {
 			btManifoldPoint& cp = contact.getContactPoint(j);
+			btConstraintRow* rows = contact.getConstraintRows(j);
 			
 			btSetupContactConstraint(
-				cp.mConstraintRow[0],
-				cp.mConstraintRow[1],
-				cp.mConstraintRow[2],
+				rows[0],
+				rows[1],
+				rows[2],
 				cp.getDistance(),
 				restitution,
 				friction,
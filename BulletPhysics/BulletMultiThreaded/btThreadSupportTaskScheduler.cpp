@@ -0,0 +1,109 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btThreadSupportTaskScheduler.h"
+#include "btThreadSupportInterface.h"
+
+
+static void	runParallelForChunks(const btParallelForTaskDesc& taskDesc)
+{
+	for (;;)
+	{
+		int chunk = btAtomicFetchAdd(taskDesc.m_nextChunk, 1);
+		int begin = taskDesc.m_begin + chunk * taskDesc.m_grainSize;
+		if (begin >= taskDesc.m_end)
+			break;
+		int end = btMin(begin + taskDesc.m_grainSize, taskDesc.m_end);
+		taskDesc.m_body->forLoop(begin, end);
+	}
+}
+
+void	processParallelForTask(void* userPtr, void* lsMemory)
+{
+	btParallelForTaskDesc* taskDescPtr = (btParallelForTaskDesc*)userPtr;
+	runParallelForChunks(*taskDescPtr);
+}
+
+void*	createParallelForLocalStoreMemory()
+{
+	//parallel for bodies work directly on main memory
+	return 0;
+}
+
+
+
+btThreadSupportTaskScheduler::btThreadSupportTaskScheduler(btThreadSupportInterface* threadSupport)
+:m_threadSupport(threadSupport),
+m_nextChunk(0),
+m_isBusy(0)
+{
+	m_taskDescs.resize(m_threadSupport->getNumTasks());
+	m_threadSupport->startSPU();
+}
+
+btThreadSupportTaskScheduler::~btThreadSupportTaskScheduler()
+{
+	//the thread support is owned by the caller, its destructor stops the threads
+}
+
+int		btThreadSupportTaskScheduler::getNumThreads() const
+{
+	return m_threadSupport->getNumTasks() + 1;
+}
+
+void	btThreadSupportTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body)
+{
+	btAssert(grainSize > 0);
+	int numChunks = (iEnd - iBegin + grainSize - 1) / grainSize;
+	if (numChunks <= 1 || !btAtomicCompareAndSwap(&m_isBusy, 0, 1))
+	{
+		body.forLoop(iBegin, iEnd);
+		return;
+	}
+
+	m_nextChunk = 0;
+
+	int numWorkers = btMin(m_taskDescs.size(), numChunks - 1);
+	for (int i = 0; i < numWorkers; i++)
+	{
+		btParallelForTaskDesc& taskDesc = m_taskDescs[i];
+		taskDesc.m_body = &body;
+		taskDesc.m_begin = iBegin;
+		taskDesc.m_end = iEnd;
+		taskDesc.m_grainSize = grainSize;
+		taskDesc.m_nextChunk = &m_nextChunk;
+		taskDesc.m_taskId = i;
+		m_threadSupport->sendRequest(CMD_PARALLEL_FOR, (ppu_address_t) &taskDesc, i);
+	}
+
+	//the calling thread takes chunks as well
+	btParallelForTaskDesc mainTaskDesc;
+	mainTaskDesc.m_body = &body;
+	mainTaskDesc.m_begin = iBegin;
+	mainTaskDesc.m_end = iEnd;
+	mainTaskDesc.m_grainSize = grainSize;
+	mainTaskDesc.m_nextChunk = &m_nextChunk;
+	mainTaskDesc.m_taskId = numWorkers;
+	runParallelForChunks(mainTaskDesc);
+
+	for (int i = 0; i < numWorkers; i++)
+	{
+		unsigned int taskId;
+		unsigned int status;
+		m_threadSupport->waitForResponse(&taskId, &status);
+	}
+
+	btAtomicCompareAndSwap(&m_isBusy, 1, 0);
+}
@@ -0,0 +1,80 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_THREAD_SUPPORT_TASK_SCHEDULER_H
+#define BT_THREAD_SUPPORT_TASK_SCHEDULER_H
+
+#include "PlatformDefinitions.h"
+#include "LinearMath/btThreads.h"
+#include "LinearMath/btAlignedObjectArray.h"
+
+class btThreadSupportInterface;
+
+///the thread supports hand any request with command 1 to their thread function, same as CMD_GATHER_AND_PROCESS_PAIRLIST
+#define CMD_PARALLEL_FOR 1
+
+ATTRIBUTE_ALIGNED16(struct) btParallelForTaskDesc
+{
+	BT_DECLARE_ALIGNED_ALLOCATOR();
+
+	const btIParallelForBody*	m_body;
+	int				m_begin;
+	int				m_end;
+	int				m_grainSize;
+	volatile int*	m_nextChunk;
+	uint32_t		m_taskId;
+};
+
+///thread function and local store setup for the thread support that drives a btThreadSupportTaskScheduler, for example
+///PosixThreadSupport::ThreadConstructionInfo("parallelFor", processParallelForTask, createParallelForLocalStoreMemory, numThreads)
+void	processParallelForTask(void* userPtr, void* lsMemory);
+void*	createParallelForLocalStoreMemory();
+
+///btThreadSupportTaskScheduler implements btITaskScheduler on top of a btThreadSupportInterface (PosixThreadSupport, Win32ThreadSupport, SequentialThreadSupport)
+///The calling thread works on the loop too, chunks are handed out dynamically so uneven work balances itself.
+///A parallelFor that is issued while another one is running (for example from inside a loop body) runs serially on the calling thread.
+class btThreadSupportTaskScheduler : public btITaskScheduler
+{
+	btThreadSupportInterface*	m_threadSupport;
+
+	btAlignedObjectArray<btParallelForTaskDesc>	m_taskDescs;
+
+	volatile int	m_nextChunk;
+
+	volatile int	m_isBusy;
+
+public:
+
+	///the thread support must be constructed with processParallelForTask as its thread function
+	btThreadSupportTaskScheduler(btThreadSupportInterface* threadSupport);
+
+	virtual ~btThreadSupportTaskScheduler();
+
+	virtual const char*	getName() const
+	{
+		return "ThreadSupport";
+	}
+
+	virtual int		getNumThreads() const;
+
+	virtual void	parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body);
+
+	btThreadSupportInterface*	getThreadSupport()
+	{
+		return m_threadSupport;
+	}
+};
+
+#endif //BT_THREAD_SUPPORT_TASK_SCHEDULER_H
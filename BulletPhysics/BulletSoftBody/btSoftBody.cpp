@@ -18,6 +18,11 @@ subject to the following restrictions:
 #include "BulletSoftBody/btSoftBodySolvers.h"
 #include "btSoftBodyData.h"
 #include "LinearMath/btSerializer.h"
+#include "LinearMath/btThreads.h"
+
+// Number of nodes and links handed to a thread at a time by the SoA solver
+#define BT_SOFTBODY_SOA_NODE_GRAIN	256
+#define BT_SOFTBODY_SOA_LINK_GRAIN	128
 
 
 //
@@ -88,6 +93,7 @@ void	btSoftBody::initDefaults()
 	m_cfg.diterations	=	0;
 	m_cfg.citerations	=	4;
 	m_cfg.collisions	=	fCollision::Default;
+	m_cfg.soaSolver		=	false;
 	m_pose.m_bvolume	=	false;
 	m_pose.m_bframe		=	false;
 	m_pose.m_volume		=	0;
@@ -1610,6 +1616,336 @@ void			btSoftBody::predictMotion(btScalar dt)
 	m_cdbvt.optimizeIncremental(1);
 }
 
+//
+// SoA solver
+//
+
+//
+void				btSoftBody::buildSoABatches()
+{
+	SoASolver&		soa=m_soa;
+	const Node*		nbase=&m_nodes[0];
+	const int		nn=m_nodes.size();
+	const int		nl=m_links.size();
+	/* Greedy colouring, each colour is a batch of links that share no node	*/ 
+	btAlignedObjectArray<btAlignedObjectArray<int> >	ncolors;
+	btAlignedObjectArray<int>							lcolors;
+	btAlignedObjectArray<int>							counts;
+	ncolors.resize(nn);
+	lcolors.resize(nl);
+	for(int i=0;i<nl;++i)
+	{
+		btAlignedObjectArray<int>&	c0=ncolors[int(m_links[i].m_n[0]-nbase)];
+		btAlignedObjectArray<int>&	c1=ncolors[int(m_links[i].m_n[1]-nbase)];
+		int							color=0;
+		while((c0.findLinearSearch(color)!=c0.size())||(c1.findLinearSearch(color)!=c1.size()))
+			++color;
+		c0.push_back(color);
+		c1.push_back(color);
+		lcolors[i]=color;
+		if(color>=counts.size()) counts.push_back(0);
+		++counts[color];
+	}
+	/* Sort by batch, links keep their order within a batch					*/ 
+	soa.m_batches.resize(counts.size()+1);
+	int	sum=0;
+	for(int i=0;i<counts.size();++i)
+	{
+		soa.m_batches[i]=sum;
+		sum+=counts[i];
+		counts[i]=0;
+	}
+	soa.m_batches[counts.size()]=sum;
+	soa.m_links.resize(nl);
+	soa.m_n[0].resize(nl);
+	soa.m_n[1].resize(nl);
+	for(int i=0;i<nl;++i)
+	{
+		const int	color=lcolors[i];
+		const int	slot=soa.m_batches[color]+(counts[color]++);
+		soa.m_links[slot]=i;
+		soa.m_n[0][slot]=int(m_links[i].m_n[0]-nbase);
+		soa.m_n[1][slot]=int(m_links[i].m_n[1]-nbase);
+	}
+	soa.m_c0.resize(nl);
+	soa.m_c1.resize(nl);
+	soa.m_c2.resize(nl);
+	soa.m_c3.resize(nl);
+	soa.m_x.resize(nn);
+	soa.m_q.resize(nn);
+	soa.m_v.resize(nn);
+	soa.m_im.resize(nn);
+}
+
+///Runs a SoA solver kernel over the sub-ranges btParallelFor hands out
+struct	btSoftBodySoAKernelBody : public btIParallelForBody
+{
+	typedef void	(*Kernel)(btSoftBody* psb,int begin,int end,btScalar k);
+	btSoftBody*		m_psb;
+	Kernel			m_kernel;
+	btScalar		m_k;
+	btSoftBodySoAKernelBody(btSoftBody* psb,Kernel kernel,btScalar k) : m_psb(psb),m_kernel(kernel),m_k(k) {}
+	virtual void	forLoop(int iBegin,int iEnd) const
+	{
+		m_kernel(m_psb,iBegin,iEnd,m_k);
+	}
+};
+
+//
+static void			SoAGatherNodes(btSoftBody* psb,int begin,int end,btScalar)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	for(int i=begin;i<end;++i)
+	{
+		const btSoftBody::Node&	n=psb->m_nodes[i];
+		soa.m_x[i]=n.m_x;
+		soa.m_q[i]=n.m_q;
+		soa.m_v[i]=n.m_v;
+		soa.m_im[i]=n.m_im;
+	}
+}
+
+//
+static void			SoAScatterNodes(btSoftBody* psb,int begin,int end,btScalar)
+{
+	const btSoftBody::SoASolver&	soa=psb->m_soa;
+	const bool						bpositions=psb->m_cfg.piterations>0;
+	const bool						bdrift=psb->m_cfg.diterations>0;
+	for(int i=begin;i<end;++i)
+	{
+		btSoftBody::Node&	n=psb->m_nodes[i];
+		n.m_x=soa.m_x[i];
+		n.m_v=soa.m_v[i];
+		if(bpositions) n.m_f=btVector3(0,0,0);
+		if(bdrift) n.m_q=soa.m_q[i];
+	}
+}
+
+//
+static void			SoAPrepareLinks(btSoftBody* psb,int begin,int end,btScalar)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	for(int i=begin;i<end;++i)
+	{
+		const btSoftBody::Link&	l=psb->m_links[soa.m_links[i]];
+		const btVector3			c3=soa.m_q[soa.m_n[1][i]]-soa.m_q[soa.m_n[0][i]];
+		soa.m_c0[i]=l.m_c0;
+		soa.m_c1[i]=l.m_c1;
+		soa.m_c2[i]=l.m_c0>0?1/(c3.length2()*l.m_c0):0;
+		soa.m_c3[i]=c3;
+	}
+}
+
+//
+static void			SoAUpdatePositions(btSoftBody* psb,int begin,int end,btScalar sdt)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	for(int i=begin;i<end;++i) soa.m_x[i]=soa.m_q[i]+soa.m_v[i]*sdt;
+}
+
+//
+static void			SoAUpdateVelocities(btSoftBody* psb,int begin,int end,btScalar vc)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	for(int i=begin;i<end;++i) soa.m_v[i]=(soa.m_x[i]-soa.m_q[i])*vc;
+}
+
+//
+static void			SoABeginDrift(btSoftBody* psb,int begin,int end,btScalar)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	for(int i=begin;i<end;++i) soa.m_q[i]=soa.m_x[i];
+}
+
+//
+static void			SoAEndDrift(btSoftBody* psb,int begin,int end,btScalar vcf)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	for(int i=begin;i<end;++i) soa.m_v[i]+=(soa.m_x[i]-soa.m_q[i])*vcf;
+}
+
+#ifdef BT_USE_SSE
+#define btSoAVecSplat(x, e) _mm_shuffle_ps(x, x, _MM_SHUFFLE(e,e,e,e))
+static inline btScalar	btSoADot3(__m128 a,__m128 b)
+{
+	const __m128	m=_mm_mul_ps(a,b);
+	return(_mm_cvtss_f32(_mm_add_ss(m,_mm_add_ss(btSoAVecSplat(m,1),btSoAVecSplat(m,2)))));
+}
+#endif //BT_USE_SSE
+
+///Position solve for the links of one batch, same as PSolve_Links.
+///The links of a batch share no node, so a batch can be split across threads.
+static void			SoAPSolveLinks(btSoftBody* psb,int begin,int end,btScalar kst)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	btVector3*				x=&soa.m_x[0];
+	const btScalar*			im=&soa.m_im[0];
+	const int*				n0=&soa.m_n[0][0];
+	const int*				n1=&soa.m_n[1][0];
+	const btScalar*			c0=&soa.m_c0[0];
+	const btScalar*			c1=&soa.m_c1[0];
+	for(int i=begin;i<end;++i)
+	{
+		if(c0[i]>0)
+		{
+			const int		a=n0[i];
+			const int		b=n1[i];
+#ifdef BT_USE_SSE
+			const __m128	del=_mm_sub_ps(x[b].mVec128,x[a].mVec128);
+			const btScalar	len=btSoADot3(del,del);
+			if (c1[i]+len > SIMD_EPSILON)
+			{
+				const btScalar	k=((c1[i]-len)/(c0[i]*(c1[i]+len)))*kst;
+				x[a].mVec128=_mm_sub_ps(x[a].mVec128,_mm_mul_ps(del,_mm_set1_ps(k*im[a])));
+				x[b].mVec128=_mm_add_ps(x[b].mVec128,_mm_mul_ps(del,_mm_set1_ps(k*im[b])));
+			}
+#else
+			const btVector3	del=x[b]-x[a];
+			const btScalar	len=del.length2();
+			if (c1[i]+len > SIMD_EPSILON)
+			{
+				const btScalar	k=((c1[i]-len)/(c0[i]*(c1[i]+len)))*kst;
+				x[a]-=del*(k*im[a]);
+				x[b]+=del*(k*im[b]);
+			}
+#endif //BT_USE_SSE
+		}
+	}
+}
+
+///Velocity solve for the links of one batch, same as VSolve_Links
+static void			SoAVSolveLinks(btSoftBody* psb,int begin,int end,btScalar kst)
+{
+	btSoftBody::SoASolver&	soa=psb->m_soa;
+	btVector3*				v=&soa.m_v[0];
+	const btScalar*			im=&soa.m_im[0];
+	const int*				n0=&soa.m_n[0][0];
+	const int*				n1=&soa.m_n[1][0];
+	const btScalar*			c2=&soa.m_c2[0];
+	const btVector3*		c3=&soa.m_c3[0];
+	for(int i=begin;i<end;++i)
+	{
+		const int		a=n0[i];
+		const int		b=n1[i];
+#ifdef BT_USE_SSE
+		const btScalar	j=-btSoADot3(c3[i].mVec128,_mm_sub_ps(v[a].mVec128,v[b].mVec128))*c2[i]*kst;
+		v[a].mVec128=_mm_add_ps(v[a].mVec128,_mm_mul_ps(c3[i].mVec128,_mm_set1_ps(j*im[a])));
+		v[b].mVec128=_mm_sub_ps(v[b].mVec128,_mm_mul_ps(c3[i].mVec128,_mm_set1_ps(j*im[b])));
+#else
+		const btScalar	j=-btDot(c3[i],v[a]-v[b])*c2[i]*kst;
+		v[a]+=c3[i]*(j*im[a]);
+		v[b]-=c3[i]*(j*im[b]);
+#endif //BT_USE_SSE
+	}
+}
+
+//
+void				btSoftBody::prepareSoA()
+{
+	BT_PROFILE("SoftBody prepareSoA");
+	SoASolver&		soa=m_soa;
+	const Node*		nbase=&m_nodes[0];
+	const int		nl=m_links.size();
+	/* Rebuild the batches when the links or nodes changed					*/ 
+	bool			rebuild=(soa.m_links.size()!=nl)||(soa.m_im.size()!=m_nodes.size());
+	for(int i=0;(i<nl)&&!rebuild;++i)
+	{
+		const Link&	l=m_links[soa.m_links[i]];
+		rebuild=(int(l.m_n[0]-nbase)!=soa.m_n[0][i])||(int(l.m_n[1]-nbase)!=soa.m_n[1][i]);
+	}
+	if(rebuild)
+	{
+		buildSoABatches();
+	}
+	/* Gather nodes and link constants											*/ 
+	{
+		btSoftBodySoAKernelBody	body(this,SoAGatherNodes,0);
+		btParallelFor(0,m_nodes.size(),BT_SOFTBODY_SOA_NODE_GRAIN,body);
+	}
+	{
+		btSoftBodySoAKernelBody	body(this,SoAPrepareLinks,0);
+		btParallelFor(0,nl,BT_SOFTBODY_SOA_LINK_GRAIN,body);
+	}
+	/* Nodes the other solvers work on										*/ 
+	soa.m_touched.resize(0);
+	for(int i=0;i<m_anchors.size();++i)
+		soa.m_touched.push_back(int(m_anchors[i].m_node-nbase));
+	for(int i=0;i<m_rcontacts.size();++i)
+		soa.m_touched.push_back(int(m_rcontacts[i].m_node-nbase));
+	for(int i=0;i<m_scontacts.size();++i)
+	{
+		const SContact&	c=m_scontacts[i];
+		soa.m_touched.push_back(int(c.m_node-nbase));
+		for(int j=0;j<3;++j)
+			soa.m_touched.push_back(int(c.m_face->m_n[j]-nbase));
+	}
+}
+
+//
+void				btSoftBody::syncSoANodes(bool tonodes)
+{
+	SoASolver&	soa=m_soa;
+	for(int i=0;i<soa.m_touched.size();++i)
+	{
+		const int	k=soa.m_touched[i];
+		Node&		n=m_nodes[k];
+		if(tonodes)
+		{
+			n.m_x=soa.m_x[k];
+			n.m_q=soa.m_q[k];
+		}
+		else
+		{
+			soa.m_x[k]=n.m_x;
+		}
+	}
+}
+
+//
+void				btSoftBody::scatterSoA()
+{
+	btSoftBodySoAKernelBody	body(this,SoAScatterNodes,0);
+	btParallelFor(0,m_nodes.size(),BT_SOFTBODY_SOA_NODE_GRAIN,body);
+}
+
+//
+void				btSoftBody::applySoASolver(ePSolver::_ solver,btScalar kst,btScalar ti)
+{
+	if(solver==ePSolver::Linear)
+	{
+		PSolve_LinksSoA(this,kst,ti);
+	}
+	else if(m_soa.m_touched.size()>0)
+	{
+		/* Anchors and contacts run on the nodes they touch					*/ 
+		syncSoANodes(true);
+		getSolver(solver)(this,kst,ti);
+		syncSoANodes(false);
+	}
+}
+
+//
+void				btSoftBody::PSolve_LinksSoA(btSoftBody* psb,btScalar kst,btScalar ti)
+{
+	const btAlignedObjectArray<int>&	batches=psb->m_soa.m_batches;
+	btSoftBodySoAKernelBody				body(psb,SoAPSolveLinks,kst);
+	for(int i=0;i<batches.size()-1;++i)
+	{
+		btParallelFor(batches[i],batches[i+1],BT_SOFTBODY_SOA_LINK_GRAIN,body);
+	}
+}
+
+//
+void				btSoftBody::VSolve_LinksSoA(btSoftBody* psb,btScalar kst)
+{
+	const btAlignedObjectArray<int>&	batches=psb->m_soa.m_batches;
+	btSoftBodySoAKernelBody				body(psb,SoAVSolveLinks,kst);
+	for(int i=0;i<batches.size()-1;++i)
+	{
+		btParallelFor(batches[i],batches[i+1],BT_SOFTBODY_SOA_LINK_GRAIN,body);
+	}
+}
+
 //
 void			btSoftBody::solveConstraints()
 {
@@ -1619,12 +1955,20 @@ void			btSoftBody::solveConstraints()
 	/* Prepare links		*/ 
 
 	int i,ni;
+	const bool	bsoa=m_cfg.soaSolver&&(m_links.size()>0);
 
-	for(i=0,ni=m_links.size();i<ni;++i)
+	if(bsoa)
 	{
-		Link&	l=m_links[i];
-		l.m_c3		=	l.m_n[1]->m_q-l.m_n[0]->m_q;
-		l.m_c2		=	1/(l.m_c3.length2()*l.m_c0);
+		prepareSoA();
+	}
+	else
+	{
+		for(i=0,ni=m_links.size();i<ni;++i)
+		{
+			Link&	l=m_links[i];
+			l.m_c3		=	l.m_n[1]->m_q-l.m_n[0]->m_q;
+			l.m_c2		=	1/(l.m_c3.length2()*l.m_c0);
+		}
 	}
 	/* Prepare anchors		*/ 
 	for(i=0,ni=m_anchors.size();i<ni;++i)
@@ -1648,14 +1992,25 @@ void			btSoftBody::solveConstraints()
 		{
 			for(int iseq=0;iseq<m_cfg.m_vsequence.size();++iseq)
 			{
-				getSolver(m_cfg.m_vsequence[iseq])(this,1);
+				if(bsoa&&(m_cfg.m_vsequence[iseq]==eVSolver::Linear))
+					VSolve_LinksSoA(this,1);
+				else
+					getSolver(m_cfg.m_vsequence[iseq])(this,1);
 			}
 		}
 		/* Update			*/ 
-		for(i=0,ni=m_nodes.size();i<ni;++i)
+		if(bsoa)
 		{
-			Node&	n=m_nodes[i];
-			n.m_x	=	n.m_q+n.m_v*m_sst.sdt;
+			btSoftBodySoAKernelBody	body(this,SoAUpdatePositions,m_sst.sdt);
+			btParallelFor(0,m_nodes.size(),BT_SOFTBODY_SOA_NODE_GRAIN,body);
+		}
+		else
+		{
+			for(i=0,ni=m_nodes.size();i<ni;++i)
+			{
+				Node&	n=m_nodes[i];
+				n.m_x	=	n.m_q+n.m_v*m_sst.sdt;
+			}
 		}
 	}
 	/* Solve positions		*/ 
@@ -1666,39 +2021,74 @@ void			btSoftBody::solveConstraints()
 			const btScalar ti=isolve/(btScalar)m_cfg.piterations;
 			for(int iseq=0;iseq<m_cfg.m_psequence.size();++iseq)
 			{
-				getSolver(m_cfg.m_psequence[iseq])(this,1,ti);
+				if(bsoa)
+					applySoASolver(m_cfg.m_psequence[iseq],1,ti);
+				else
+					getSolver(m_cfg.m_psequence[iseq])(this,1,ti);
 			}
 		}
 		const btScalar	vc=m_sst.isdt*(1-m_cfg.kDP);
-		for(i=0,ni=m_nodes.size();i<ni;++i)
+		if(bsoa)
 		{
-			Node&	n=m_nodes[i];
-			n.m_v	=	(n.m_x-n.m_q)*vc;
-			n.m_f	=	btVector3(0,0,0);		
+			btSoftBodySoAKernelBody	body(this,SoAUpdateVelocities,vc);
+			btParallelFor(0,m_nodes.size(),BT_SOFTBODY_SOA_NODE_GRAIN,body);
+		}
+		else
+		{
+			for(i=0,ni=m_nodes.size();i<ni;++i)
+			{
+				Node&	n=m_nodes[i];
+				n.m_v	=	(n.m_x-n.m_q)*vc;
+				n.m_f	=	btVector3(0,0,0);		
+			}
 		}
 	}
 	/* Solve drift			*/ 
 	if(m_cfg.diterations>0)
 	{
 		const btScalar	vcf=m_cfg.kVCF*m_sst.isdt;
-		for(i=0,ni=m_nodes.size();i<ni;++i)
+		if(bsoa)
 		{
-			Node&	n=m_nodes[i];
-			n.m_q	=	n.m_x;
+			btSoftBodySoAKernelBody	body(this,SoABeginDrift,0);
+			btParallelFor(0,m_nodes.size(),BT_SOFTBODY_SOA_NODE_GRAIN,body);
+		}
+		else
+		{
+			for(i=0,ni=m_nodes.size();i<ni;++i)
+			{
+				Node&	n=m_nodes[i];
+				n.m_q	=	n.m_x;
+			}
 		}
 		for(int idrift=0;idrift<m_cfg.diterations;++idrift)
 		{
 			for(int iseq=0;iseq<m_cfg.m_dsequence.size();++iseq)
 			{
-				getSolver(m_cfg.m_dsequence[iseq])(this,1,0);
+				if(bsoa)
+					applySoASolver(m_cfg.m_dsequence[iseq],1,0);
+				else
+					getSolver(m_cfg.m_dsequence[iseq])(this,1,0);
 			}
 		}
-		for(int i=0,ni=m_nodes.size();i<ni;++i)
+		if(bsoa)
 		{
-			Node&	n=m_nodes[i];
-			n.m_v	+=	(n.m_x-n.m_q)*vcf;
+			btSoftBodySoAKernelBody	body(this,SoAEndDrift,vcf);
+			btParallelFor(0,m_nodes.size(),BT_SOFTBODY_SOA_NODE_GRAIN,body);
+		}
+		else
+		{
+			for(int i=0,ni=m_nodes.size();i<ni;++i)
+			{
+				Node&	n=m_nodes[i];
+				n.m_v	+=	(n.m_x-n.m_q)*vcf;
+			}
 		}
 	}
+	/* Write back nodes		*/ 
+	if(bsoa)
+	{
+		scatterSoA();
+	}
 	/* Apply clusters		*/ 
 	dampClusters();
 	applyClusters(true);
@@ -585,6 +585,7 @@ public:
 		int						diterations;	// Drift solver iterations
 		int						citerations;	// Cluster solver iterations
 		int						collisions;		// Collisions flags
+		bool					soaSolver;		// Solve links on SoA node and link arrays, in batches (default: false)
 		tVSolverArray			m_vsequence;	// Velocity solvers sequence
 		tPSolverArray			m_psequence;	// Position solvers sequence
 		tPSolverArray			m_dsequence;	// Drift solvers sequence
@@ -598,6 +599,25 @@ public:
 		btScalar				radmrg;			// radial margin
 		btScalar				updmrg;			// Update margin
 	};	
+	/* SoASolver	*/ 
+	///Node and link data of the SoA solver path, see Config::soaSolver.
+	///Node state lives in contiguous arrays and links are node index pairs, coloured into batches
+	///of links that share no node. Each batch is split across threads with btParallelFor.
+	struct	SoASolver
+	{
+		btAlignedObjectArray<btVector3>	m_x;			// Positions
+		btAlignedObjectArray<btVector3>	m_q;			// Previous step positions
+		btAlignedObjectArray<btVector3>	m_v;			// Velocities
+		btAlignedObjectArray<btScalar>	m_im;			// 1/mass
+		btAlignedObjectArray<int>		m_links;		// Index in m_links, sorted by batch
+		btAlignedObjectArray<int>		m_n[2];			// Node indices
+		btAlignedObjectArray<btScalar>	m_c0;			// (ima+imb)*kLST
+		btAlignedObjectArray<btScalar>	m_c1;			// rl^2
+		btAlignedObjectArray<btScalar>	m_c2;			// |gradient|^2/c0
+		btAlignedObjectArray<btVector3>	m_c3;			// gradient
+		btAlignedObjectArray<int>		m_batches;		// First link of each batch, followed by the number of links
+		btAlignedObjectArray<int>		m_touched;		// Nodes used by anchors and contacts
+	};
 	/// RayFromToCaster takes a ray from, ray to (instead of direction!)
 	struct	RayFromToCaster : btDbvt::ICollide
 	{
@@ -645,6 +665,7 @@ public:
 
 	Config					m_cfg;			// Configuration
 	SolverState				m_sst;			// Solver state
+	SoASolver				m_soa;			// SoA solver data
 	Pose					m_pose;			// Pose
 	void*					m_tag;			// User data
 	btSoftBodyWorldInfo*	m_worldInfo;	// World info
@@ -956,11 +977,18 @@ public:
 	void				applyClusters(bool drift);
 	void				dampClusters();
 	void				applyForces();	
+	void				buildSoABatches();
+	void				prepareSoA();
+	void				syncSoANodes(bool tonodes);
+	void				scatterSoA();
+	void				applySoASolver(ePSolver::_ solver,btScalar kst,btScalar ti);
 	static void			PSolve_Anchors(btSoftBody* psb,btScalar kst,btScalar ti);
 	static void			PSolve_RContacts(btSoftBody* psb,btScalar kst,btScalar ti);
 	static void			PSolve_SContacts(btSoftBody* psb,btScalar,btScalar ti);
 	static void			PSolve_Links(btSoftBody* psb,btScalar kst,btScalar ti);
 	static void			VSolve_Links(btSoftBody* psb,btScalar kst);
+	static void			PSolve_LinksSoA(btSoftBody* psb,btScalar kst,btScalar ti);
+	static void			VSolve_LinksSoA(btSoftBody* psb,btScalar kst);
 	static psolver_t	getSolver(ePSolver::_ solver);
 	static vsolver_t	getSolver(eVSolver::_ solver);
 
@@ -105,6 +105,9 @@ void	btSoftRigidDynamicsWorld::internalSingleStepSimulation( btScalar timeStep )
 
 	///update soft bodies
 	m_softBodySolver->updateSoftBodies( );
+
+	///drop distance field cells that were not used for a while, and the cells evicted during this step
+	m_sbi.m_sparsesdf.GarbageCollect();
 	
 	// End solver-wise simulation step
 	// ///////////////////////////////
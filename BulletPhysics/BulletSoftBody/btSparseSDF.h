@@ -19,6 +19,7 @@ subject to the following restrictions:
 
 #include "BulletCollision/CollisionDispatch/btCollisionObject.h"
 #include "BulletCollision/NarrowPhaseCollision/btGjkEpa2.h"
+#include "LinearMath/btThreads.h"
 
 // Modified Paul Hsieh hash
 template <const int DWORDLEN>
@@ -40,6 +41,13 @@ unsigned int HsiehHash(const void* pdata)
 	return(hash);
 }
 
+///btSparseSdf caches signed distance samples of convex shapes in cells of CELLSIZE^3 voxels.
+///Evaluate can be called from several threads at once: lookups walk the bucket chains without locking,
+///a miss builds its cell outside of any lock and inserts it under the lock of the bucket's shard.
+///The number of live cells is bounded by the clampCells argument of Initialize (0 for no bound), split evenly
+///between the shards. Each shard evicts its least recently used cells (clock approximation) to stay within
+///its share. Evicted cells stay readable until the next GarbageCollect, which frees them. Reset, GarbageCollect and RemoveReferences must not run
+///concurrently with Evaluate.
 template <const int CELLSIZE>
 struct	btSparseSdf
 {
@@ -56,31 +64,62 @@ struct	btSparseSdf
 	{
 		btScalar			d[CELLSIZE+1][CELLSIZE+1][CELLSIZE+1];
 		int					c[3];
-		int					puid;
+		volatile int		puid;		// Last step the cell was used in
+		volatile int		used;		// Used since the last eviction scan
 		unsigned			hash;
 		btCollisionShape*	pclient;
-		Cell*				next;
+		Cell*				next;		// Bucket chain, read without locking
+		Cell*				lruprev;	// Shard use list, newest first
+		Cell*				lrunext;
 	};
+	struct	Shard
+	{
+		btSpinMutex					lock;		// Inserts and evictions
+		Cell*						lruhead;
+		Cell*						lrutail;
+		int							ncells;
+		int							nevictions;
+		btAlignedObjectArray<Cell*>	retired;	// Evicted cells, freed by GarbageCollect
+	};
+	struct	ThreadCounters
+	{
+		int					nqueries;
+		int					nprobes;
+		int					nmisses;
+		int					pad[13];	// One cache line per thread
+	};
+	struct	Stats
+	{
+		int					ncells;		// Live cells
+		int					nqueries;	// Evaluate calls since Reset
+		int					nhits;		// Queries that found their cell
+		int					nmisses;	// Queries that built their cell
+		int					nprobes;	// Chain entries visited
+		int					nevictions;	// Cells evicted to stay within clampcells
+	};
+	enum { NSHARDS=16 };
 	//
 	// Fields
 	//
 
 	btAlignedObjectArray<Cell*>		cells;	
+	Shard							shards[NSHARDS];
+	ThreadCounters					counters[BT_MAX_THREAD_COUNT];
 	btScalar						voxelsz;
 	int								puid;
-	int								ncells;
-	int								nprobes;
-	int								nqueries;	
+	volatile int					ncells;
+	int								clampcells;
 
 	//
 	// Methods
 	//
 
 	//
-	void					Initialize(int hashsize=2383)
+	void					Initialize(int hashsize=2383,int clampCells=256*1024)
 	{
+		Reset();
 		cells.resize(hashsize,0);
-		Reset();		
+		clampcells	=clampCells;
 	}
 	//
 	void					Reset()
@@ -96,16 +135,31 @@ struct	btSparseSdf
 				pc=pn;
 			}
 		}
+		FreeRetired();
+		for(int i=0;i<NSHARDS;++i)
+		{
+			Shard&	s=shards[i];
+			s.lruhead		=0;
+			s.lrutail		=0;
+			s.ncells		=0;
+			s.nevictions	=0;
+		}
+		for(int i=0;i<BT_MAX_THREAD_COUNT;++i)
+		{
+			ThreadCounters&	tc=counters[i];
+			tc.nqueries		=0;
+			tc.nprobes		=0;
+			tc.nmisses		=0;
+		}
 		voxelsz		=0.25;
 		puid		=0;
 		ncells		=0;
-		nprobes		=1;
-		nqueries	=1;
 	}
 	//
 	void					GarbageCollect(int lifetime=256)
 	{
 		const int life=puid-lifetime;
+		FreeRetired();
 		for(int i=0;i<cells.size();++i)
 		{
 			Cell*&	root=cells[i];
@@ -117,16 +171,16 @@ struct	btSparseSdf
 				if(pc->puid<life)
 				{
 					if(pp) pp->next=pn; else root=pn;
+					Shard&	s=shards[i%NSHARDS];
+					UnlinkUse(s,pc);
+					--s.ncells;
 					delete pc;pc=pp;--ncells;
 				}
 				pp=pc;pc=pn;
 			}
 		}
-		//printf("GC[%d]: %d cells, PpQ: %f\r\n",puid,ncells,nprobes/(btScalar)nqueries);
-		nqueries=1;
-		nprobes=1;
+		//const Stats st=GetStats();printf("GC[%d]: %d cells, PpQ: %f\r\n",puid,st.ncells,st.nprobes/(btScalar)st.nqueries);
 		++puid;	///@todo: Reset puid's when int range limit is reached	*/ 
-		/* else setup a priority list...						*/ 
 	}
 	//
 	int						RemoveReferences(btCollisionShape* pcs)
@@ -143,7 +197,10 @@ struct	btSparseSdf
 				if(pc->pclient==pcs)
 				{
 					if(pp) pp->next=pn; else root=pn;
-					delete pc;pc=pp;++refcount;
+					Shard&	s=shards[i%NSHARDS];
+					UnlinkUse(s,pc);
+					--s.ncells;
+					delete pc;pc=pp;++refcount;--ncells;
 				}
 				pp=pc;pc=pn;
 			}
@@ -151,6 +208,28 @@ struct	btSparseSdf
 		return(refcount);
 	}
 	//
+	Stats					GetStats() const
+	{
+		Stats	st;
+		st.ncells		=ncells;
+		st.nqueries		=0;
+		st.nmisses		=0;
+		st.nprobes		=0;
+		st.nevictions	=0;
+		for(int i=0;i<BT_MAX_THREAD_COUNT;++i)
+		{
+			st.nqueries		+=counters[i].nqueries;
+			st.nmisses		+=counters[i].nmisses;
+			st.nprobes		+=counters[i].nprobes;
+		}
+		for(int i=0;i<NSHARDS;++i)
+		{
+			st.nevictions	+=shards[i].nevictions;
+		}
+		st.nhits		=st.nqueries-st.nmisses;
+		return(st);
+	}
+	//
 	btScalar				Evaluate(	const btVector3& x,
 		btCollisionShape* shape,
 		btVector3& normal,
@@ -162,33 +241,22 @@ struct	btSparseSdf
 		const IntFrac	iy=Decompose(scx.y());
 		const IntFrac	iz=Decompose(scx.z());
 		const unsigned	h=Hash(ix.b,iy.b,iz.b,shape);
-		Cell*&			root=cells[static_cast<int>(h%cells.size())];
-		Cell*			c=root;
-		++nqueries;
-		while(c)
-		{
-			++nprobes;
-			if(	(c->hash==h)	&&
-				(c->c[0]==ix.b)	&&
-				(c->c[1]==iy.b)	&&
-				(c->c[2]==iz.b)	&&
-				(c->pclient==shape))
-			{ break; }
-			else
-			{ c=c->next; }
-		}
-		if(!c)
+		const int		ibucket=static_cast<int>(h%cells.size());
+		const unsigned	threadindex=btGetCurrentThreadIndex();
+		Cell*			c;
 		{
-			++nprobes;		
-			++ncells;
-			c=new Cell();
-			c->next=root;root=c;
-			c->pclient=shape;
-			c->hash=h;
-			c->c[0]=ix.b;c->c[1]=iy.b;c->c[2]=iz.b;
-			BuildCell(*c);
+			btSharedThreadIndexLock	sharedlock(threadindex);
+			ThreadCounters&	tc=counters[threadindex];
+			++tc.nqueries;
+			c=Find(ibucket,h,ix.b,iy.b,iz.b,shape,tc.nprobes);
+			if(!c)
+			{
+				c=Insert(ibucket,h,ix.b,iy.b,iz.b,shape,tc);
+			}
 		}
-		c->puid=puid;
+		/* Only write when it changes, cells are shared between threads	*/ 
+		if(c->puid!=puid) c->puid=puid;
+		if(!c->used) c->used=1;
 		/* Extract infos		*/ 
 		const int		o[]={	ix.i,iy.i,iz.i};
 		const btScalar	d[]={	c->d[o[0]+0][o[1]+0][o[2]+0],
@@ -225,6 +293,115 @@ struct	btSparseSdf
 		return(Lerp(d0,d1,iz.f)-margin);
 	}
 	//
+	Cell*					Find(int ibucket,unsigned h,int x,int y,int z,btCollisionShape* shape,int& nprobes) const
+	{
+		Cell*	c=static_cast<Cell*>(btAtomicLoadPtr((void* const volatile*)&cells[ibucket]));
+		while(c)
+		{
+			++nprobes;
+			if(	(c->hash==h)	&&
+				(c->c[0]==x)	&&
+				(c->c[1]==y)	&&
+				(c->c[2]==z)	&&
+				(c->pclient==shape))
+			{ return(c); }
+			c=static_cast<Cell*>(btAtomicLoadPtr((void* const volatile*)&c->next));
+		}
+		return(0);
+	}
+	//
+	Cell*					Insert(int ibucket,unsigned h,int x,int y,int z,btCollisionShape* shape,ThreadCounters& tc)
+	{
+		/* Build outside of the lock, another thread may insert the same cell meanwhile	*/ 
+		Cell*	nc=new Cell();
+		nc->pclient=shape;
+		nc->hash=h;
+		nc->c[0]=x;nc->c[1]=y;nc->c[2]=z;
+		nc->puid=puid;
+		nc->used=1;
+		nc->next=0;
+		nc->lruprev=nc->lrunext=0;
+		BuildCell(*nc);
+		Shard&	s=shards[ibucket%NSHARDS];
+		s.lock.lock();
+		Cell*	c=Find(ibucket,h,x,y,z,shape,tc.nprobes);
+		if(c)
+		{
+			s.lock.unlock();
+			delete nc;
+			return(c);
+		}
+		++tc.nmisses;
+		if(clampcells>0)
+		{
+			const int	budget=(clampcells+NSHARDS-1)/NSHARDS;
+			while(s.ncells>=budget) Evict(s);
+		}
+		nc->next=cells[ibucket];
+		btAtomicStorePtr((void* volatile*)&cells[ibucket],nc);
+		LinkUse(s,nc);
+		++s.ncells;
+		btAtomicFetchAdd(&ncells,1);
+		s.lock.unlock();
+		return(nc);
+	}
+	//
+	void					Evict(Shard& s)
+	{
+		/* Oldest cell not used since the last scan, used ones get a second chance	*/ 
+		for(int i=0;;++i)
+		{
+			Cell*	c=s.lrutail;
+			UnlinkUse(s,c);
+			if(c->used&&(i<s.ncells))
+			{
+				c->used=0;
+				LinkUse(s,c);
+				continue;
+			}
+			/* Readers may still hold it, so it is only freed by GarbageCollect	*/ 
+			const int	ibucket=static_cast<int>(c->hash%cells.size());
+			Cell*		pp=0;
+			Cell*		pc=cells[ibucket];
+			while(pc!=c) { pp=pc;pc=pc->next; }
+			if(pp)	btAtomicStorePtr((void* volatile*)&pp->next,c->next);
+			else	btAtomicStorePtr((void* volatile*)&cells[ibucket],c->next);
+			s.retired.push_back(c);
+			--s.ncells;
+			++s.nevictions;
+			btAtomicFetchAdd(&ncells,-1);
+			return;
+		}
+	}
+	//
+	static void				LinkUse(Shard& s,Cell* c)
+	{
+		c->lruprev=0;
+		c->lrunext=s.lruhead;
+		if(s.lruhead) s.lruhead->lruprev=c; else s.lrutail=c;
+		s.lruhead=c;
+	}
+	//
+	static void				UnlinkUse(Shard& s,Cell* c)
+	{
+		if(c->lruprev) c->lruprev->lrunext=c->lrunext; else s.lruhead=c->lrunext;
+		if(c->lrunext) c->lrunext->lruprev=c->lruprev; else s.lrutail=c->lruprev;
+		c->lruprev=c->lrunext=0;
+	}
+	//
+	void					FreeRetired()
+	{
+		for(int i=0;i<NSHARDS;++i)
+		{
+			btAlignedObjectArray<Cell*>&	retired=shards[i].retired;
+			for(int j=0;j<retired.size();++j)
+			{
+				delete retired[j];
+			}
+			retired.resize(0);
+		}
+	}
+	//
 	void					BuildCell(Cell& c)
 	{
 		const btVector3	org=btVector3(	(btScalar)c.c[0],
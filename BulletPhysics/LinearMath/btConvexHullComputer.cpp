@@ -18,6 +18,7 @@ subject to the following restrictions:
 #include "btAlignedObjectArray.h"
 #include "btMinMax.h"
 #include "btVector3.h"
+#include "btThreads.h"
 
 #ifdef __GNUC__
 	#include <stdint.h>
@@ -813,6 +814,16 @@ class btConvexHullInternal
 		}
 		
 		void computeInternal(int start, int end, IntermediateHull& result);
+
+		void splitRange(int start, int end, int& split0, int& split1);
+
+		void computeParallel(int count, IntermediateHull& result);
+
+		class ParallelLeafBody;
+		class ParallelMergeBody;
+
+		// helpers of computeParallel, each hulls one leaf range of the recursion and does the merges above it
+		btAlignedObjectArray<btConvexHullInternal*> workers;
 		
 		bool mergeProjection(IntermediateHull& h0, IntermediateHull& h1, Vertex*& c0, Vertex*& c1);
 		
@@ -827,7 +838,9 @@ class btConvexHullInternal
 	public:
 		Vertex* vertexList;
 
-		void compute(const void* coords, bool doubleCoords, int stride, int count);
+		~btConvexHullInternal();
+
+		void compute(const void* coords, bool doubleCoords, int stride, int count, bool parallel);
 
 		btVector3 getCoordinates(const Vertex* v);
 
@@ -1295,13 +1308,9 @@ void btConvexHullInternal::computeInternal(int start, int end, IntermediateHull&
 		}
 	}
 
-	int split0 = start + n / 2;
-	Point32 p = originalVertices[split0-1]->point;
-	int split1 = split0;
-	while ((split1 < end) && (originalVertices[split1]->point == p))
-	{
-		split1++;
-	}
+	int split0;
+	int split1;
+	splitRange(start, end, split0, split1);
 	computeInternal(start, split0, result);
 	IntermediateHull hull1;
 	computeInternal(split1, end, hull1);
@@ -1317,6 +1326,164 @@ void btConvexHullInternal::computeInternal(int start, int end, IntermediateHull&
 #endif
 }
 
+void btConvexHullInternal::splitRange(int start, int end, int& split0, int& split1)
+{
+	split0 = start + (end - start) / 2;
+	Point32 p = originalVertices[split0-1]->point;
+	split1 = split0;
+	while ((split1 < end) && (originalVertices[split1]->point == p))
+	{
+		split1++;
+	}
+}
+
+// minimum number of points per leaf of the parallel recursion, smaller ranges are not worth a task
+#define BT_CONVEX_HULL_MIN_TASK_POINTS 2048
+// at most 2^BT_CONVEX_HULL_MAX_PARALLEL_LEVELS leaves
+#define BT_CONVEX_HULL_MAX_PARALLEL_LEVELS 4
+
+class btConvexHullInternal::ParallelLeafBody : public btIParallelForBody
+{
+	public:
+		btAlignedObjectArray<btConvexHullInternal*>& workers;
+		btAlignedObjectArray<IntermediateHull>& hulls;
+
+		ParallelLeafBody(btAlignedObjectArray<btConvexHullInternal*>& workers, btAlignedObjectArray<IntermediateHull>& hulls): workers(workers), hulls(hulls)
+		{
+		}
+
+		void forLoop(int iBegin, int iEnd) const
+		{
+			for (int i = iBegin; i < iEnd; i++)
+			{
+				btConvexHullInternal* worker = workers[i];
+				worker->computeInternal(0, worker->originalVertices.size(), hulls[i]);
+			}
+		}
+};
+
+class btConvexHullInternal::ParallelMergeBody : public btIParallelForBody
+{
+	public:
+		btAlignedObjectArray<btConvexHullInternal*>& workers;
+		btAlignedObjectArray<IntermediateHull>& hulls;
+		int step;
+
+		ParallelMergeBody(btAlignedObjectArray<btConvexHullInternal*>& workers, btAlignedObjectArray<IntermediateHull>& hulls, int step): workers(workers), hulls(hulls), step(step)
+		{
+		}
+
+		void forLoop(int iBegin, int iEnd) const
+		{
+			for (int i = iBegin; i < iEnd; i++)
+			{
+				int left = i * step;
+				workers[left]->merge(hulls[left], hulls[left + step / 2]);
+			}
+		}
+};
+
+// Same as computeInternal(0, count, result), but the top levels of the recursion run in parallel. Each leaf range
+// is hulled by its own worker, which owns the edges it creates. The merges of a level run in parallel as well, by
+// the worker of their leftmost leaf. Merges only compare edge stamps against their own stamp, so it is enough to
+// give each merge a distinct stamp below all stamps used in its subtrees to get the sequential result.
+void btConvexHullInternal::computeParallel(int count, IntermediateHull& result)
+{
+	int numThreads = btGetTaskSchedulerNumThreads();
+	int levels = 0;
+	while ((levels < BT_CONVEX_HULL_MAX_PARALLEL_LEVELS) && ((1 << levels) < 2 * numThreads) && ((count >> (levels + 1)) >= BT_CONVEX_HULL_MIN_TASK_POINTS))
+	{
+		levels++;
+	}
+	if ((numThreads <= 1) || (levels == 0))
+	{
+		computeInternal(0, count, result);
+		return;
+	}
+
+	// split like computeInternal does, leaf i covers the range from ranges[2 * i] to ranges[2 * i + 1]
+	int numLeaves = 1 << levels;
+	btAlignedObjectArray<int> ranges;
+	ranges.resize(2 * numLeaves);
+	ranges[0] = 0;
+	ranges[1] = count;
+	for (int level = 0; level < levels; level++)
+	{
+		int step = numLeaves >> level;
+		for (int left = 0; left < numLeaves; left += step)
+		{
+			int start = ranges[2 * left];
+			int end = ranges[2 * left + 1];
+			int right = left + step / 2;
+			if (end - start <= 2)
+			{
+				// computeInternal does not split such ranges, leave the right subtree empty
+				ranges[2 * right] = end;
+				ranges[2 * right + 1] = end;
+			}
+			else
+			{
+				int split0;
+				int split1;
+				splitRange(start, end, split0, split1);
+				ranges[2 * left + 1] = split0;
+				ranges[2 * right] = split1;
+				ranges[2 * right + 1] = end;
+			}
+		}
+	}
+
+	// the stamps of leaf i stay within (-3 - end, -3 - start], the stamps of the merges above the leaves start at -4 - count
+	btAlignedObjectArray<IntermediateHull> hulls;
+	hulls.resize(numLeaves);
+	workers.resize(numLeaves);
+	for (int i = 0; i < numLeaves; i++)
+	{
+		int start = ranges[2 * i];
+		int n = ranges[2 * i + 1] - start;
+		btConvexHullInternal* worker = new(btAlignedAlloc(sizeof(btConvexHullInternal), 16)) btConvexHullInternal();
+		worker->originalVertices.resize(n);
+		for (int j = 0; j < n; j++)
+		{
+			worker->originalVertices[j] = originalVertices[start + j];
+		}
+		worker->edgePool.setArraySize(btMax(6 * n, 256));
+		worker->usedEdgePairs = 0;
+		worker->maxUsedEdgePairs = 0;
+		worker->mergeStamp = -3 - start;
+		workers[i] = worker;
+	}
+
+	ParallelLeafBody leafBody(workers, hulls);
+	btParallelFor(0, numLeaves, 1, leafBody);
+
+	int stamp = -4 - count;
+	for (int level = levels - 1; level >= 0; level--)
+	{
+		int step = numLeaves >> level;
+		for (int left = 0; left < numLeaves; left += step)
+		{
+			// merge decrements the stamp before using it
+			workers[left]->mergeStamp = stamp + 1;
+			stamp--;
+		}
+		ParallelMergeBody mergeBody(workers, hulls, step);
+		btParallelFor(0, 1 << level, 1, mergeBody);
+	}
+
+	result = hulls[0];
+	mergeStamp = stamp;
+}
+
+btConvexHullInternal::~btConvexHullInternal()
+{
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->~btConvexHullInternal();
+		btAlignedFree(workers[i]);
+	}
+}
+
 #ifdef DEBUG_CONVEX_HULL
 void btConvexHullInternal::IntermediateHull::print()
 {
@@ -1937,7 +2104,7 @@ static bool pointCmp(const btConvexHullInternal::Point32& p, const btConvexHullI
 	return (p.y < q.y) || ((p.y == q.y) && ((p.x < q.x) || ((p.x == q.x) && (p.z < q.z))));
 }
 
-void btConvexHullInternal::compute(const void* coords, bool doubleCoords, int stride, int count)
+void btConvexHullInternal::compute(const void* coords, bool doubleCoords, int stride, int count, bool parallel)
 {
 	btVector3 min(btScalar(1e30), btScalar(1e30), btScalar(1e30)), max(btScalar(-1e30), btScalar(-1e30), btScalar(-1e30));
 	const char* ptr = (const char*) coords;
@@ -2051,7 +2218,14 @@ void btConvexHullInternal::compute(const void* coords, bool doubleCoords, int st
 	mergeStamp = -3;
 
 	IntermediateHull hull;
-	computeInternal(0, count, hull);
+	if (parallel)
+	{
+		computeParallel(count, hull);
+	}
+	else
+	{
+		computeInternal(0, count, hull);
+	}
 	vertexList = hull.minXy;
 #ifdef DEBUG_CONVEX_HULL
 	printf("max. edges %d (3v = %d)", maxUsedEdgePairs, 3 * count);
@@ -2638,29 +2812,32 @@ static int getVertexCopy(btConvexHullInternal::Vertex* vertex, btAlignedObjectAr
 	return index;
 }
 
-btScalar btConvexHullComputer::compute(const void* coords, bool doubleCoords, int stride, int count, btScalar shrink, btScalar shrinkClamp)
+btScalar btConvexHullComputer::compute(const void* coords, bool doubleCoords, int stride, int count, btScalar shrink, btScalar shrinkClamp, bool parallel)
 {
 	if (count <= 0)
 	{
 		vertices.clear();
+		originalVertexIndices.clear();
 		edges.clear();
 		faces.clear();
 		return 0;
 	}
 
 	btConvexHullInternal hull;
-	hull.compute(coords, doubleCoords, stride, count);
+	hull.compute(coords, doubleCoords, stride, count, parallel);
 
 	btScalar shift = 0;
 	if ((shrink > 0) && ((shift = hull.shrink(shrink, shrinkClamp)) < 0))
 	{
 		vertices.clear();
+		originalVertexIndices.clear();
 		edges.clear();
 		faces.clear();
 		return shift;
 	}
 
 	vertices.resize(0);
+	originalVertexIndices.resize(0);
 	edges.resize(0);
 	faces.resize(0);
 
@@ -2671,6 +2848,7 @@ btScalar btConvexHullComputer::compute(const void* coords, bool doubleCoords, in
 	{
 		btConvexHullInternal::Vertex* v = oldVertices[copied];
 		vertices.push_back(hull.getCoordinates(v));
+		originalVertexIndices.push_back(v->point.index);
 		btConvexHullInternal::Edge* firstEdge = v->edges;
 		if (firstEdge)
 		{
@@ -2749,3 +2927,180 @@ btScalar btConvexHullComputer::compute(const void* coords, bool doubleCoords, in
 
 
 
+
+class btConvexHullBatchBody : public btIParallelForBody
+{
+	public:
+		btConvexHullComputer** hulls;
+		const void* const* coords;
+		bool doubleCoords;
+		int stride;
+		const int* counts;
+		btScalar shrink;
+		btScalar shrinkClamp;
+		btScalar* shifts;
+		// the recursion of a single set may run in parallel, batches are parallelized over the sets instead
+		bool parallel;
+
+		void forLoop(int iBegin, int iEnd) const
+		{
+			for (int i = iBegin; i < iEnd; i++)
+			{
+				btScalar shift = hulls[i]->compute(coords[i], doubleCoords, stride, counts[i], shrink, shrinkClamp, parallel);
+				if (shifts)
+				{
+					shifts[i] = shift;
+				}
+			}
+		}
+};
+
+void btConvexHullComputer::computeBatch(btConvexHullComputer* hulls, const void* const* coords, bool doubleCoords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts)
+{
+	if (numSets <= 0)
+	{
+		return;
+	}
+
+	btAlignedObjectArray<btConvexHullComputer*> hullPtrs;
+	hullPtrs.resize(numSets);
+	for (int i = 0; i < numSets; i++)
+	{
+		hullPtrs[i] = &hulls[i];
+	}
+
+	btConvexHullBatchBody body;
+	body.hulls = &hullPtrs[0];
+	body.coords = coords;
+	body.doubleCoords = doubleCoords;
+	body.stride = stride;
+	body.counts = counts;
+	body.shrink = shrink;
+	body.shrinkClamp = shrinkClamp;
+	body.shifts = shifts;
+	body.parallel = (numSets == 1);
+	btParallelFor(0, numSets, 1, body);
+}
+
+bool btConvexHullCache::Key::equals(const Key& other) const
+{
+	return (hash == other.hash) && (size == other.size) && (memcmp(data, other.data, size) == 0);
+}
+
+btConvexHullCache::~btConvexHullCache()
+{
+	clear();
+}
+
+void btConvexHullCache::clear()
+{
+	for (int i = 0; i < entryList.size(); i++)
+	{
+		entryList[i]->~Entry();
+		btAlignedFree(entryList[i]);
+	}
+	entryList.clear();
+	entries.clear();
+	scratch.clear();
+}
+
+void btConvexHullCache::computeBatch(const btConvexHullComputer** hulls, const void* const* coords, bool doubleCoords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts)
+{
+	if (numSets <= 0)
+	{
+		return;
+	}
+
+	btAlignedObjectArray<Entry*> setEntries;
+	setEntries.resize(numSets);
+	btAlignedObjectArray<const void*> missCoords;
+	btAlignedObjectArray<int> missCounts;
+	btAlignedObjectArray<btConvexHullComputer*> missHulls;
+	btAlignedObjectArray<btScalar> missShifts;
+	btAlignedObjectArray<Entry*> missEntries;
+
+	for (int i = 0; i < numSets; i++)
+	{
+		// the key is the packed input: precision, shrink parameters and the xyz of each vertex, without the stride padding
+		int count = btMax(counts[i], 0);
+		int vertexSize = doubleCoords ? 3 * sizeof(double) : 3 * sizeof(float);
+		int size = sizeof(int) + 2 * sizeof(btScalar) + count * vertexSize;
+		scratch.resize(size);
+		char* data = &scratch[0];
+		int precision = doubleCoords ? 1 : 0;
+		memcpy(data, &precision, sizeof(int));
+		memcpy(data + sizeof(int), &shrink, sizeof(btScalar));
+		memcpy(data + sizeof(int) + sizeof(btScalar), &shrinkClamp, sizeof(btScalar));
+		char* dst = data + sizeof(int) + 2 * sizeof(btScalar);
+		const char* src = (const char*) coords[i];
+		for (int j = 0; j < count; j++, src += stride, dst += vertexSize)
+		{
+			memcpy(dst, src, vertexSize);
+		}
+
+		/* Fowler / Noll / Vo (FNV) Hash */
+		unsigned int hash = 2166136261u;
+		for (int j = 0; j < size; j++)
+		{
+			hash = (hash ^ (unsigned char) data[j]) * 16777619u;
+		}
+
+		Key key;
+		key.data = data;
+		key.size = size;
+		key.hash = hash;
+		Entry** found = entries.find(key);
+		if (found)
+		{
+			setEntries[i] = *found;
+			numHits++;
+			continue;
+		}
+
+		// add the entry right away, so duplicates later in the batch find it
+		Entry* entry = new(btAlignedAlloc(sizeof(Entry), 16)) Entry();
+		entry->input.resize(size);
+		memcpy(&entry->input[0], data, size);
+		entry->shift = 0;
+		key.data = &entry->input[0];
+		entries.insert(key, entry);
+		entryList.push_back(entry);
+		setEntries[i] = entry;
+		numMisses++;
+
+		missCoords.push_back(coords[i]);
+		missCounts.push_back(count);
+		missHulls.push_back(&entry->hull);
+		missEntries.push_back(entry);
+	}
+
+	int numMissed = missEntries.size();
+	if (numMissed > 0)
+	{
+		missShifts.resize(numMissed);
+		btConvexHullBatchBody body;
+		body.hulls = &missHulls[0];
+		body.coords = &missCoords[0];
+		body.doubleCoords = doubleCoords;
+		body.stride = stride;
+		body.counts = &missCounts[0];
+		body.shrink = shrink;
+		body.shrinkClamp = shrinkClamp;
+		body.shifts = &missShifts[0];
+		body.parallel = (numMissed == 1);
+		btParallelFor(0, numMissed, 1, body);
+		for (int i = 0; i < numMissed; i++)
+		{
+			missEntries[i]->shift = missShifts[i];
+		}
+	}
+
+	for (int i = 0; i < numSets; i++)
+	{
+		hulls[i] = &setEntries[i]->hull;
+		if (shifts)
+		{
+			shifts[i] = setEntries[i]->shift;
+		}
+	}
+}
@@ -17,6 +17,7 @@ subject to the following restrictions:
 
 #include "btVector3.h"
 #include "btAlignedObjectArray.h"
+#include "btHashMap.h"
 
 /// Convex hull implementation based on Preparata and Hong
 /// See http://code.google.com/p/bullet/issues/detail?id=275
@@ -24,7 +25,11 @@ subject to the following restrictions:
 class btConvexHullComputer
 {
 	private:
-		btScalar compute(const void* coords, bool doubleCoords, int stride, int count, btScalar shrink, btScalar shrinkClamp);
+		btScalar compute(const void* coords, bool doubleCoords, int stride, int count, btScalar shrink, btScalar shrinkClamp, bool parallel = true);
+
+		static void computeBatch(btConvexHullComputer* hulls, const void* const* coords, bool doubleCoords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts);
+
+		friend class btConvexHullBatchBody;
 
 	public:
 
@@ -68,6 +73,9 @@ class btConvexHullComputer
 		// Vertices of the output hull
 		btAlignedObjectArray<btVector3> vertices;
 
+		// Index of the input vertex each output vertex was created from, -1 for vertices created by shrinking
+		btAlignedObjectArray<int> originalVertexIndices;
+
 		// Edges of the output hull
 		btAlignedObjectArray<Edge> edges;
 
@@ -85,6 +93,10 @@ class btConvexHullComputer
 		that the resulting convex hull is empty.
 
 		The output convex hull can be found in the member variables "vertices", "edges", "faces".
+
+		When a task scheduler with more than one thread is installed (see btThreads.h), the top levels of the
+		divide-and-conquer recursion of large inputs are hulled and merged in parallel. The result is the same as
+		on a single thread.
 		*/
 		btScalar compute(const float* coords, int stride, int count, btScalar shrink, btScalar shrinkClamp)
 		{
@@ -96,6 +108,125 @@ class btConvexHullComputer
 		{
 			return compute(coords, true, stride, count, shrink, shrinkClamp);
 		}
+
+		/*
+		Compute the convex hulls of "numSets" point sets at once, the sets are distributed over the threads of the
+		task scheduler. Set i has "counts[i]" vertices stored in "coords[i]", all sets use the same "stride", "shrink"
+		and "shrinkClamp". Its hull is written to "hulls[i]" and, if "shifts" is not NULL, the value compute would
+		have returned to "shifts[i]".
+		*/
+		static void computeBatch(btConvexHullComputer* hulls, const float* const* coords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts = NULL)
+		{
+			computeBatch(hulls, (const void* const*) coords, false, stride, counts, numSets, shrink, shrinkClamp, shifts);
+		}
+
+		// same as above, but double precision
+		static void computeBatch(btConvexHullComputer* hulls, const double* const* coords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts = NULL)
+		{
+			computeBatch(hulls, (const void* const*) coords, true, stride, counts, numSets, shrink, shrinkClamp, shifts);
+		}
+};
+
+
+/*
+Cache of convex hulls, keyed by the content of their input. Computing the hull of a point set that is identical
+to an earlier input (same coordinates in the same order, same precision, "shrink" and "shrinkClamp") returns the
+shared result of the earlier computation instead of hulling the points again. Hits are confirmed by comparing the
+whole input, so hash collisions never return a wrong hull.
+
+The returned hulls are owned by the cache and stay valid until clear() is called or the cache is destroyed.
+The cache itself is not thread-safe, but computeBatch hulls the missing sets in parallel.
+*/
+class btConvexHullCache
+{
+	private:
+		struct Entry
+		{
+			btAlignedObjectArray<char> input;
+			btConvexHullComputer hull;
+			btScalar shift;
+		};
+
+		class Key
+		{
+			public:
+				const char* data;
+				int size;
+				unsigned int hash;
+
+				unsigned int getHash() const
+				{
+					return hash;
+				}
+
+				bool equals(const Key& other) const;
+		};
+
+		btHashMap<Key, Entry*> entries;
+		btAlignedObjectArray<Entry*> entryList;
+		btAlignedObjectArray<char> scratch;
+		int numHits;
+		int numMisses;
+
+		void computeBatch(const btConvexHullComputer** hulls, const void* const* coords, bool doubleCoords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts);
+
+	public:
+		btConvexHullCache(): numHits(0), numMisses(0)
+		{
+		}
+
+		~btConvexHullCache();
+
+		// Same as btConvexHullComputer::compute, but returns the (possibly shared) hull owned by the cache
+		const btConvexHullComputer* compute(const float* coords, int stride, int count, btScalar shrink, btScalar shrinkClamp, btScalar* shift = NULL)
+		{
+			const btConvexHullComputer* hull;
+			const void* c = coords;
+			computeBatch(&hull, &c, false, stride, &count, 1, shrink, shrinkClamp, shift);
+			return hull;
+		}
+
+		// same as above, but double precision
+		const btConvexHullComputer* compute(const double* coords, int stride, int count, btScalar shrink, btScalar shrinkClamp, btScalar* shift = NULL)
+		{
+			const btConvexHullComputer* hull;
+			const void* c = coords;
+			computeBatch(&hull, &c, true, stride, &count, 1, shrink, shrinkClamp, shift);
+			return hull;
+		}
+
+		// Same as btConvexHullComputer::computeBatch. Duplicates within the batch are hulled once, and only the sets
+		// that miss the cache are computed
+		void computeBatch(const btConvexHullComputer** hulls, const float* const* coords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts = NULL)
+		{
+			computeBatch(hulls, (const void* const*) coords, false, stride, counts, numSets, shrink, shrinkClamp, shifts);
+		}
+
+		// same as above, but double precision
+		void computeBatch(const btConvexHullComputer** hulls, const double* const* coords, int stride, const int* counts, int numSets, btScalar shrink, btScalar shrinkClamp, btScalar* shifts = NULL)
+		{
+			computeBatch(hulls, (const void* const*) coords, true, stride, counts, numSets, shrink, shrinkClamp, shifts);
+		}
+
+		// Delete all cached hulls. Pointers returned earlier become invalid
+		void clear();
+
+		int getNumHulls() const
+		{
+			return entryList.size();
+		}
+
+		// Number of requests answered from the cache, including duplicates within a batch
+		int getNumHits() const
+		{
+			return numHits;
+		}
+
+		// Number of requests that had to compute a hull
+		int getNumMisses() const
+		{
+			return numMisses;
+		}
 };
 
 
@@ -0,0 +1,106 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btFrameArena.h"
+#include "btAlignedAllocator.h"
+
+btFrameArena::btFrameArena(unsigned int initialSize)
+:m_data(0),
+m_capacity(0),
+m_usedSize(0),
+m_highWaterMark(0),
+m_overflowSize(0),
+m_stage(BT_FRAME_STAGE_OTHER)
+{
+	if (initialSize)
+	{
+		m_data = (unsigned char*)btAlignedAlloc(initialSize, 16);
+		m_capacity = initialSize;
+	}
+	clearCounters();
+}
+
+btFrameArena::~btFrameArena()
+{
+	reset();
+	if (m_data)
+	{
+		btAlignedFree(m_data);
+	}
+}
+
+void	btFrameArena::clearCounters()
+{
+	for (int i = 0; i < BT_FRAME_STAGE_COUNT; i++)
+	{
+		m_counters[i].m_numAllocations = 0;
+		m_counters[i].m_numBytes = 0;
+		m_counters[i].m_numOverflows = 0;
+	}
+}
+
+void*	btFrameArena::allocate(unsigned int size, unsigned int alignment)
+{
+	btAssert(alignment && alignment <= 16 && !(alignment & (alignment - 1)));
+	btFrameArenaCounters& counters = m_counters[m_stage];
+	counters.m_numAllocations++;
+	counters.m_numBytes += size;
+
+	unsigned int start = (m_usedSize + alignment - 1) & ~(alignment - 1);
+	if (start + size <= m_capacity)
+	{
+		m_usedSize = start + size;
+		return m_data + start;
+	}
+
+	//doesn't fit, serve it from the heap until the next reset grows the arena
+	counters.m_numOverflows++;
+	void* mem = btAlignedAlloc(size, 16);
+	m_overflowBlocks.push_back(mem);
+	m_overflowSize += (size + 15) & ~15u;
+	return mem;
+}
+
+void	btFrameArena::reset()
+{
+	unsigned int usedSize = getUsedSize();
+	if (usedSize > m_highWaterMark)
+	{
+		m_highWaterMark = usedSize;
+	}
+
+	if (m_overflowBlocks.size())
+	{
+		for (int i = 0; i < m_overflowBlocks.size(); i++)
+		{
+			btAlignedFree(m_overflowBlocks[i]);
+		}
+		m_overflowBlocks.resize(0);
+
+		//grow with some slack, so a slowly growing scene doesn't reallocate every step
+		unsigned int newCapacity = m_highWaterMark + m_highWaterMark / 2;
+		if (m_data)
+		{
+			btAlignedFree(m_data);
+		}
+		m_data = (unsigned char*)btAlignedAlloc(newCapacity, 16);
+		m_capacity = newCapacity;
+	}
+
+	m_usedSize = 0;
+	m_overflowSize = 0;
+	m_stage = BT_FRAME_STAGE_OTHER;
+	clearCounters();
+}
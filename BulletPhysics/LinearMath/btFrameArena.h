@@ -0,0 +1,115 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_FRAME_ARENA_H
+#define BT_FRAME_ARENA_H
+
+#include "btScalar.h"
+#include "btAlignedObjectArray.h"
+
+///stages of a simulation step, used to attribute frame arena allocations.
+///Collision detection has no stage, it keeps its scratch memory in persistent members and doesn't use the arena
+enum btFrameArenaStage
+{
+	BT_FRAME_STAGE_OTHER = 0,
+	BT_FRAME_STAGE_PREDICT_MOTION,
+	BT_FRAME_STAGE_ISLANDS,
+	BT_FRAME_STAGE_SOLVER,
+	BT_FRAME_STAGE_INTEGRATE,
+	BT_FRAME_STAGE_COUNT
+};
+
+///allocation counters of one stage, they are cleared by btFrameArena::reset
+struct btFrameArenaCounters
+{
+	int				m_numAllocations;
+	unsigned int	m_numBytes;
+	///number of allocations that did not fit into the arena and went to the heap
+	int				m_numOverflows;
+};
+
+///The btFrameArena is a linear allocator for scratch memory that only lives during one simulation step.
+///Memory is handed out by bumping a pointer and is released all at once by reset(), which btDiscreteDynamicsWorld
+///calls at the start of each internal step. Requests that don't fit are served from the heap, and the next reset
+///grows the arena to the high-water mark, so after a few warm-up steps stepping does no heap allocation at all.
+class btFrameArena
+{
+	unsigned char*	m_data;
+	unsigned int	m_capacity;
+	unsigned int	m_usedSize;
+	unsigned int	m_highWaterMark;
+
+	btAlignedObjectArray<void*>	m_overflowBlocks;
+	unsigned int	m_overflowSize;
+
+	int				m_stage;
+	btFrameArenaCounters	m_counters[BT_FRAME_STAGE_COUNT];
+
+	void	clearCounters();
+
+public:
+
+	btFrameArena(unsigned int initialSize = 0);
+
+	~btFrameArena();
+
+	///returns size bytes of scratch memory, valid until the next reset. alignment must be a power of 2, at most 16
+	void*	allocate(unsigned int size, unsigned int alignment = 16);
+
+	template <typename T>
+	T*		allocateArray(int count)
+	{
+		return static_cast<T*>(allocate(sizeof(T) * count));
+	}
+
+	///invalidates all memory handed out since the last reset, clears the counters and grows the arena if it overflowed
+	void	reset();
+
+	void	setStage(int stage)
+	{
+		btAssert(stage >= 0 && stage < BT_FRAME_STAGE_COUNT);
+		m_stage = stage;
+	}
+
+	int		getStage() const
+	{
+		return m_stage;
+	}
+
+	const btFrameArenaCounters&	getCounters(int stage) const
+	{
+		btAssert(stage >= 0 && stage < BT_FRAME_STAGE_COUNT);
+		return m_counters[stage];
+	}
+
+	unsigned int	getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	///bytes in use since the last reset, including the heap overflow
+	unsigned int	getUsedSize() const
+	{
+		return m_usedSize + m_overflowSize;
+	}
+
+	///largest getUsedSize() seen before a reset
+	unsigned int	getHighWaterMark() const
+	{
+		return m_highWaterMark;
+	}
+};
+
+#endif //BT_FRAME_ARENA_H
@@ -0,0 +1,153 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "btMappedFile.h"
+#include "btAlignedAllocator.h"
+#include <stdio.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define BT_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+btMappedFile::btMappedFile()
+:m_data(0),
+m_size(0),
+m_mapped(false)
+#ifdef _WIN32
+,m_fileHandle(0),
+m_mappingHandle(0)
+#endif
+{
+}
+
+btMappedFile::~btMappedFile()
+{
+	close();
+}
+
+bool	btMappedFile::open(const char* fileName)
+{
+	close();
+
+#if defined(_WIN32)
+	HANDLE fileHandle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	DWORD size = GetFileSize(fileHandle, 0);
+	if (size == INVALID_FILE_SIZE || !size)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, 0, PAGE_WRITECOPY, 0, 0, 0);
+	if (!mappingHandle)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+	void* data = MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return false;
+	}
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+	m_data = (unsigned char*)data;
+	m_size = (unsigned int)size;
+	m_mapped = true;
+	return true;
+#elif defined(BT_USE_MMAP)
+	int fd = ::open(fileName, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(0, (size_t)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	//the mapping keeps its own reference to the file
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	m_data = (unsigned char*)data;
+	m_size = (unsigned int)fileStat.st_size;
+	m_mapped = true;
+	return true;
+#else
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+	{
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size <= 0)
+	{
+		fclose(file);
+		return false;
+	}
+	m_data = (unsigned char*)btAlignedAlloc((int)size, 16);
+	m_size = (unsigned int)size;
+	m_mapped = false;
+	bool ok = fread(m_data, 1, (size_t)size, file) == (size_t)size;
+	fclose(file);
+	if (!ok)
+	{
+		close();
+	}
+	return ok;
+#endif
+}
+
+void	btMappedFile::close()
+{
+	if (!m_data)
+	{
+		return;
+	}
+#if defined(_WIN32)
+	UnmapViewOfFile(m_data);
+	CloseHandle((HANDLE)m_mappingHandle);
+	CloseHandle((HANDLE)m_fileHandle);
+	m_mappingHandle = 0;
+	m_fileHandle = 0;
+#elif defined(BT_USE_MMAP)
+	munmap(m_data, m_size);
+#else
+	btAlignedFree(m_data);
+#endif
+	m_data = 0;
+	m_size = 0;
+	m_mapped = false;
+}
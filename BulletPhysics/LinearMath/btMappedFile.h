@@ -0,0 +1,74 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef BT_MAPPED_FILE_H
+#define BT_MAPPED_FILE_H
+
+#include "btScalar.h"
+
+///btMappedFile maps a file into memory as a private copy-on-write view: the pages are loaded on first access,
+///and writes go to private copies of the touched pages, never back to the file. Where there is no memory
+///mapping, the file is read into an aligned heap buffer instead. The data is always at least 16 byte aligned.
+class btMappedFile
+{
+	unsigned char*	m_data;
+	unsigned int	m_size;
+	bool			m_mapped;
+#ifdef _WIN32
+	void*			m_fileHandle;
+	void*			m_mappingHandle;
+#endif
+
+public:
+
+	btMappedFile();
+
+	~btMappedFile();
+
+	///maps the file, returns false if it can't be opened or is empty
+	bool	open(const char* fileName);
+
+	///unmaps the file, pointers into the data become invalid
+	void	close();
+
+	bool	isOpen() const
+	{
+		return m_data != 0;
+	}
+
+	unsigned char*	getData()
+	{
+		return m_data;
+	}
+
+	const unsigned char*	getData() const
+	{
+		return m_data;
+	}
+
+	unsigned int	getSize() const
+	{
+		return m_size;
+	}
+
+	///true when the file is memory mapped, false when it was read into a buffer
+	bool	isMapped() const
+	{
+		return m_mapped;
+	}
+};
+
+#endif //BT_MAPPED_FILE_H
@@ -0,0 +1,139 @@
+/*
+Copyright (c) 2003-2006 Gino van den Bergen / Erwin Coumans  http://continuousphysics.com/Bullet/
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose, 
+including commercial applications, and to alter it and redistribute it freely, 
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btPoolAllocator.h"
+#include <new>
+
+///elements moved between a magazine and the depot in one go
+#define BT_POOL_MAGAZINE_TRANSFER (BT_POOL_MAGAZINE_SIZE / 2)
+
+btPoolAllocator::btPoolAllocator(int elemSize, int maxElements)
+	:m_elemSize(elemSize),
+	m_maxElements(maxElements),
+	m_highWaterMark(0),
+	m_overflowCount(0)
+{
+	m_pool = (unsigned char*) btAlignedAlloc( static_cast<unsigned int>(m_elemSize*m_maxElements),16);
+
+	unsigned char* p = m_pool;
+	m_firstFree = p;
+	m_freeCount = m_maxElements;
+	int count = m_maxElements;
+	while (--count) {
+		*(void**)p = (p + m_elemSize);
+		p += m_elemSize;
+	}
+	*(void**)p = 0;
+
+	m_magazines = (btPoolMagazine*) btAlignedAlloc(sizeof(btPoolMagazine) * BT_MAX_THREAD_COUNT, 64);
+	for (int i = 0; i < BT_MAX_THREAD_COUNT; i++)
+	{
+		new (&m_magazines[i]) btPoolMagazine();
+		m_magazines[i].m_count = 0;
+	}
+}
+
+btPoolAllocator::~btPoolAllocator()
+{
+	btAlignedFree( m_magazines);
+	btAlignedFree( m_pool);
+}
+
+void	btPoolAllocator::resetStatistics()
+{
+	m_highWaterMark = getUsedCount();
+	m_overflowCount = 0;
+}
+
+void	btPoolAllocator::refillMagazine(btPoolMagazine& magazine)
+{
+	m_depotMutex.lock();
+	while (m_firstFree && magazine.m_count < BT_POOL_MAGAZINE_TRANSFER)
+	{
+		magazine.m_elements[magazine.m_count++] = m_firstFree;
+		m_firstFree = *(void**)m_firstFree;
+	}
+	m_depotMutex.unlock();
+
+	//keep the most recently freed element on top, like the plain free list did
+	for (int i = 0, j = magazine.m_count - 1; i < j; i++, j--)
+	{
+		btSwap(magazine.m_elements[i], magazine.m_elements[j]);
+	}
+}
+
+void	btPoolAllocator::flushMagazine(btPoolMagazine& magazine)
+{
+	//give the oldest half back, the recently freed (cache warm) elements stay with this thread
+	m_depotMutex.lock();
+	for (int i = BT_POOL_MAGAZINE_TRANSFER - 1; i >= 0; i--)
+	{
+		*(void**)magazine.m_elements[i] = m_firstFree;
+		m_firstFree = magazine.m_elements[i];
+	}
+	m_depotMutex.unlock();
+
+	for (int i = BT_POOL_MAGAZINE_TRANSFER; i < magazine.m_count; i++)
+	{
+		magazine.m_elements[i - BT_POOL_MAGAZINE_TRANSFER] = magazine.m_elements[i];
+	}
+	magazine.m_count -= BT_POOL_MAGAZINE_TRANSFER;
+}
+
+void*	btPoolAllocator::allocate(int size)
+{
+	// release mode fix
+	(void)size;
+	btAssert(!size || size<=m_elemSize);
+
+	unsigned int threadIndex = btGetCurrentThreadIndex();
+	btSharedThreadIndexLock sharedLock(threadIndex);
+	btPoolMagazine& magazine = m_magazines[threadIndex];
+	if (!magazine.m_count)
+	{
+		refillMagazine(magazine);
+		if (!magazine.m_count)
+		{
+			//empty, or the remaining elements are cached by other threads
+			btAtomicFetchAdd(&m_overflowCount, 1);
+			return 0;
+		}
+	}
+	void* result = magazine.m_elements[--magazine.m_count];
+
+	int usedCount = m_maxElements - (btAtomicFetchAdd(&m_freeCount, -1) - 1);
+	int highWaterMark = m_highWaterMark;
+	while (usedCount > highWaterMark && !btAtomicCompareAndSwap(&m_highWaterMark, highWaterMark, usedCount))
+	{
+		highWaterMark = m_highWaterMark;
+	}
+	return result;
+}
+
+void	btPoolAllocator::freeMemory(void* ptr)
+{
+	if (ptr) {
+		btAssert((unsigned char*)ptr >= m_pool && (unsigned char*)ptr < m_pool + m_maxElements * m_elemSize);
+
+		unsigned int threadIndex = btGetCurrentThreadIndex();
+		btSharedThreadIndexLock sharedLock(threadIndex);
+		btPoolMagazine& magazine = m_magazines[threadIndex];
+		if (magazine.m_count == BT_POOL_MAGAZINE_SIZE)
+		{
+			flushMagazine(magazine);
+		}
+		magazine.m_elements[magazine.m_count++] = ptr;
+		btAtomicFetchAdd(&m_freeCount, 1);
+	}
+}
@@ -18,39 +18,46 @@ subject to the following restrictions:
 
 #include "btScalar.h"
 #include "btAlignedAllocator.h"
+#include "btThreads.h"
+
+///number of free elements a thread keeps for itself before it has to go to the shared depot
+#define BT_POOL_MAGAZINE_SIZE 16
 
 ///The btPoolAllocator class allows to efficiently allocate a large pool of objects, instead of dynamically allocating them separately.
+///It is safe to allocate and free from several threads at once: every thread keeps a small magazine of free elements
+///that it uses without any synchronisation, and only exchanges half a magazine at a time with the shared free list (the depot).
+///The high-water mark and overflow count tell how large the pool really needs to be, see btDefaultCollisionConstructionInfo.
 class btPoolAllocator
 {
+	///per-thread cache of free elements, padded to a cache line so threads don't share one
+	ATTRIBUTE_ALIGNED64(struct) btPoolMagazine
+	{
+		void*	m_elements[BT_POOL_MAGAZINE_SIZE];
+		int		m_count;
+	};
+
 	int				m_elemSize;
 	int				m_maxElements;
-	int				m_freeCount;
+	///free elements, including the ones held in magazines
+	volatile int	m_freeCount;
+	volatile int	m_highWaterMark;
+	volatile int	m_overflowCount;
+
+	///the depot, a singly linked free list guarded by m_depotMutex
+	btSpinMutex		m_depotMutex;
 	void*			m_firstFree;
+
 	unsigned char*	m_pool;
+	btPoolMagazine*	m_magazines;
+
+	void	refillMagazine(btPoolMagazine& magazine);
+	void	flushMagazine(btPoolMagazine& magazine);
 
 public:
 
-	btPoolAllocator(int elemSize, int maxElements)
-		:m_elemSize(elemSize),
-		m_maxElements(maxElements)
-	{
-		m_pool = (unsigned char*) btAlignedAlloc( static_cast<unsigned int>(m_elemSize*m_maxElements),16);
-
-		unsigned char* p = m_pool;
-        m_firstFree = p;
-        m_freeCount = m_maxElements;
-        int count = m_maxElements;
-        while (--count) {
-            *(void**)p = (p + m_elemSize);
-            p += m_elemSize;
-        }
-        *(void**)p = 0;
-    }
-
-	~btPoolAllocator()
-	{
-		btAlignedFree( m_pool);
-	}
+	btPoolAllocator(int elemSize, int maxElements);
+
+	~btPoolAllocator();
 
 	int	getFreeCount() const
 	{
@@ -67,18 +74,24 @@ public:
 		return m_maxElements;
 	}
 
-	void*	allocate(int size)
+	///largest getUsedCount() seen since construction or the last resetStatistics
+	int	getHighWaterMark() const
 	{
-		// release mode fix
-		(void)size;
-		btAssert(!size || size<=m_elemSize);
-		btAssert(m_freeCount>0);
-        void* result = m_firstFree;
-        m_firstFree = *(void**)m_firstFree;
-        --m_freeCount;
-        return result;
+		return m_highWaterMark;
 	}
 
+	///number of allocate calls that found the pool empty and returned 0
+	int	getOverflowCount() const
+	{
+		return m_overflowCount;
+	}
+
+	void	resetStatistics();
+
+	///returns 0 when no element is available to the calling thread, the caller is expected to fall back to the heap.
+	///with a single thread that only happens when getFreeCount() is 0
+	void*	allocate(int size);
+
 	bool validPtr(void* ptr)
 	{
 		if (ptr) {
@@ -90,16 +103,7 @@ public:
 		return false;
 	}
 
-	void	freeMemory(void* ptr)
-	{
-		 if (ptr) {
-            btAssert((unsigned char*)ptr >= m_pool && (unsigned char*)ptr < m_pool + m_maxElements * m_elemSize);
-
-            *(void**)ptr = m_firstFree;
-            m_firstFree = ptr;
-            ++m_freeCount;
-        }
-	}
+	void	freeMemory(void* ptr);
 
 	int	getElementSize() const
 	{
@@ -0,0 +1,273 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btProfiler.h"
+#include "btQuickprof.h"
+#include "btAlignedAllocator.h"
+#include <stdio.h>
+
+///a span, or a counter value when m_counter is not negative (m_begin is the time, m_end the value)
+struct btProfileEvent
+{
+	const char*		m_name;
+	btProfileTicks	m_begin;
+	btProfileTicks	m_end;
+	int				m_counter;
+};
+
+struct btProfileThreadBuffer
+{
+	btProfileEvent	m_events[BT_PROFILE_RING_SIZE];
+	///total number of events written, the ring holds the last BT_PROFILE_RING_SIZE of them
+	unsigned int	m_head;
+	int				m_counters[BT_PROFILE_COUNTER_COUNT];
+};
+
+static const char* sCounterNames[BT_PROFILE_COUNTER_COUNT] =
+{
+	"pairs",
+	"manifolds",
+	"contacts",
+	"solverRows",
+	"islands"
+};
+
+volatile int	btProfiler::m_enabled = 0;
+
+static btProfileThreadBuffer*	gProfileBuffers[BT_MAX_THREAD_COUNT];
+static btSpinMutex	gProfileBufferMutex;
+
+#ifndef BT_NO_PROFILE
+static btClock	gProfileClock;
+#endif
+static btProfileTicks	gProfileStartTicks;
+static bool		gProfileTimeBaseValid = false;
+
+#ifdef BT_PROFILE_NO_TSC
+btProfileTicks	btProfileGetTicks()
+{
+#ifndef BT_NO_PROFILE
+	return gProfileClock.getTimeMicroseconds();
+#else
+	return 0;
+#endif
+}
+#endif //BT_PROFILE_NO_TSC
+
+static void	resetTimeBase()
+{
+#ifndef BT_NO_PROFILE
+	gProfileClock.reset();
+#endif
+	gProfileStartTicks = btProfileGetTicks();
+	gProfileTimeBaseValid = true;
+}
+
+///the caller holds a btSharedThreadIndexLock for 'threadIndex'
+static btProfileThreadBuffer*	getThreadBuffer(unsigned int threadIndex)
+{
+	btProfileThreadBuffer* buffer = gProfileBuffers[threadIndex];
+	if (!buffer)
+	{
+		//first event of this thread, the lock only protects the time base
+		gProfileBufferMutex.lock();
+		if (!gProfileTimeBaseValid)
+		{
+			resetTimeBase();
+		}
+		gProfileBufferMutex.unlock();
+
+		buffer = (btProfileThreadBuffer*)btAlignedAlloc(sizeof(btProfileThreadBuffer), 64);
+		buffer->m_head = 0;
+		for (int i = 0; i < BT_PROFILE_COUNTER_COUNT; i++)
+		{
+			buffer->m_counters[i] = 0;
+		}
+		gProfileBuffers[threadIndex] = buffer;
+	}
+	return buffer;
+}
+
+static SIMD_FORCE_INLINE btProfileEvent&	nextEvent(btProfileThreadBuffer* buffer)
+{
+	return buffer->m_events[(buffer->m_head++) & (BT_PROFILE_RING_SIZE - 1)];
+}
+
+void	btProfiler::recordSpan(const char* name, btProfileTicks begin, btProfileTicks end)
+{
+	unsigned int threadIndex = btGetCurrentThreadIndex();
+	btSharedThreadIndexLock sharedLock(threadIndex);
+	btProfileEvent& event = nextEvent(getThreadBuffer(threadIndex));
+	event.m_name = name;
+	event.m_begin = begin;
+	event.m_end = end;
+	event.m_counter = -1;
+}
+
+void	btProfiler::addCounter(int counter, int value)
+{
+	btAssert(counter >= 0 && counter < BT_PROFILE_COUNTER_COUNT);
+	unsigned int threadIndex = btGetCurrentThreadIndex();
+	btSharedThreadIndexLock sharedLock(threadIndex);
+	getThreadBuffer(threadIndex)->m_counters[counter] += value;
+}
+
+void	btProfiler::flushCounters()
+{
+	int sums[BT_PROFILE_COUNTER_COUNT];
+	for (int c = 0; c < BT_PROFILE_COUNTER_COUNT; c++)
+	{
+		sums[c] = 0;
+	}
+	for (int i = 0; i < BT_MAX_THREAD_COUNT; i++)
+	{
+		btProfileThreadBuffer* buffer = gProfileBuffers[i];
+		if (buffer)
+		{
+			for (int c = 0; c < BT_PROFILE_COUNTER_COUNT; c++)
+			{
+				sums[c] += buffer->m_counters[c];
+				buffer->m_counters[c] = 0;
+			}
+		}
+	}
+
+	if (!isEnabled())
+	{
+		return;
+	}
+
+	unsigned int threadIndex = btGetCurrentThreadIndex();
+	btSharedThreadIndexLock sharedLock(threadIndex);
+	btProfileThreadBuffer* buffer = getThreadBuffer(threadIndex);
+	btProfileTicks now = btProfileGetTicks();
+	for (int c = 0; c < BT_PROFILE_COUNTER_COUNT; c++)
+	{
+		btProfileEvent& event = nextEvent(buffer);
+		event.m_name = sCounterNames[c];
+		event.m_begin = now;
+		event.m_end = (btProfileTicks)sums[c];
+		event.m_counter = c;
+	}
+}
+
+void	btProfiler::reset()
+{
+	for (int i = 0; i < BT_MAX_THREAD_COUNT; i++)
+	{
+		btProfileThreadBuffer* buffer = gProfileBuffers[i];
+		if (buffer)
+		{
+			buffer->m_head = 0;
+			for (int c = 0; c < BT_PROFILE_COUNTER_COUNT; c++)
+			{
+				buffer->m_counters[c] = 0;
+			}
+		}
+	}
+	resetTimeBase();
+}
+
+void	btProfiler::cleanupMemory()
+{
+	for (int i = 0; i < BT_MAX_THREAD_COUNT; i++)
+	{
+		if (gProfileBuffers[i])
+		{
+			btAlignedFree(gProfileBuffers[i]);
+			gProfileBuffers[i] = 0;
+		}
+	}
+}
+
+static void	writeJsonString(FILE* file, const char* str)
+{
+	fputc('"', file);
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\')
+		{
+			fputc('\\', file);
+		}
+		fputc(*str, file);
+	}
+	fputc('"', file);
+}
+
+bool	btProfiler::writeChromeTrace(const char* fileName)
+{
+	FILE* file = fopen(fileName, "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	//calibrate the time stamp counter against the wall clock over the recorded period
+	double ticksPerMicrosecond = 1.0;
+#ifndef BT_NO_PROFILE
+	if (gProfileTimeBaseValid)
+	{
+		unsigned long int elapsedMicroseconds = gProfileClock.getTimeMicroseconds();
+		btProfileTicks elapsedTicks = btProfileGetTicks() - gProfileStartTicks;
+		if (elapsedMicroseconds)
+		{
+			ticksPerMicrosecond = double(elapsedTicks) / double(elapsedMicroseconds);
+		}
+	}
+#endif
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	bool first = true;
+	for (int i = 0; i < BT_MAX_THREAD_COUNT; i++)
+	{
+		btProfileThreadBuffer* buffer = gProfileBuffers[i];
+		if (!buffer)
+		{
+			continue;
+		}
+
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", i);
+		if (i == 0)
+		{
+			fprintf(file, "\"main\"}}");
+		} else
+		{
+			fprintf(file, "\"worker %d\"}}", i);
+		}
+		first = false;
+
+		unsigned int numEvents = buffer->m_head < BT_PROFILE_RING_SIZE ? buffer->m_head : BT_PROFILE_RING_SIZE;
+		for (unsigned int e = buffer->m_head - numEvents; e != buffer->m_head; e++)
+		{
+			const btProfileEvent& event = buffer->m_events[e & (BT_PROFILE_RING_SIZE - 1)];
+			double timeStamp = double((long long int)(event.m_begin - gProfileStartTicks)) / ticksPerMicrosecond;
+			fprintf(file, ",\n{\"name\":");
+			writeJsonString(file, event.m_name);
+			if (event.m_counter < 0)
+			{
+				double duration = double(event.m_end - event.m_begin) / ticksPerMicrosecond;
+				fprintf(file, ",\"cat\":\"bullet\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}", timeStamp, duration, i);
+			} else
+			{
+				fprintf(file, ",\"cat\":\"bullet\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{\"value\":%d}}", timeStamp, i, (int)event.m_end);
+			}
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
@@ -0,0 +1,128 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_PROFILER_H
+#define BT_PROFILER_H
+
+#include "btScalar.h"
+#include "btThreads.h"
+
+///number of events each thread keeps, older events are overwritten. Must be a power of 2
+#ifndef BT_PROFILE_RING_SIZE
+#define BT_PROFILE_RING_SIZE 8192
+#endif
+
+typedef unsigned long long int btProfileTicks;
+
+///reads the time stamp counter, or a microsecond clock where there is none
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+SIMD_FORCE_INLINE btProfileTicks btProfileGetTicks()
+{
+	return __rdtsc();
+}
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+SIMD_FORCE_INLINE btProfileTicks btProfileGetTicks()
+{
+	unsigned int lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((btProfileTicks)hi << 32) | lo;
+}
+#else
+#define BT_PROFILE_NO_TSC
+btProfileTicks btProfileGetTicks();
+#endif
+
+///counters that the simulation reports for every internal step, next to the profile spans
+enum btProfileCounter
+{
+	BT_PROFILE_COUNTER_PAIRS = 0,
+	BT_PROFILE_COUNTER_MANIFOLDS,
+	BT_PROFILE_COUNTER_CONTACTS,
+	BT_PROFILE_COUNTER_SOLVER_ROWS,
+	BT_PROFILE_COUNTER_ISLANDS,
+	BT_PROFILE_COUNTER_COUNT
+};
+
+///The btProfiler records BT_PROFILE scopes and simulation counters into a ring buffer per thread.
+///Recording takes two time stamp reads and one store into the buffer of the calling thread, there are no locks or atomics,
+///so it is safe to use from worker threads and cheap enough to use in release builds.
+///It is disabled by default, call setEnabled(true) to start recording. The flag may be changed while worker threads run.
+///The buffers are written to a Chrome trace event file (chrome://tracing, ui.perfetto.dev) by writeChromeTrace.
+///reset, writeChromeTrace and cleanupMemory must not run while other threads are recording, call them between steps.
+class btProfiler
+{
+	static volatile int	m_enabled;
+
+public:
+
+	static bool	isEnabled()
+	{
+		return btAtomicLoad(&m_enabled) != 0;
+	}
+
+	static void	setEnabled(bool enabled)
+	{
+		btAtomicStore(&m_enabled, enabled ? 1 : 0);
+	}
+
+	///records a span on the calling thread, normally done by btProfileScope
+	static void	recordSpan(const char* name, btProfileTicks begin, btProfileTicks end);
+
+	///adds to a counter of the calling thread, the sum over all threads is recorded by flushCounters
+	static void	addCounter(int counter, int value);
+
+	///records the counters accumulated since the last flush and clears them, btDiscreteDynamicsWorld calls this after each internal step
+	static void	flushCounters();
+
+	///discards all recorded events and counters
+	static void	reset();
+
+	///writes the recorded events as Chrome trace event JSON, returns false if the file can't be written
+	static bool	writeChromeTrace(const char* fileName);
+
+	///releases the per-thread buffers, they are allocated again when a thread records its next event
+	static void	cleanupMemory();
+};
+
+///btProfileScope records the time between its construction and destruction, use the BT_PROFILE macro
+class btProfileScope
+{
+	const char*		m_name;
+	btProfileTicks	m_begin;
+	bool			m_enabled;
+
+public:
+	btProfileScope(const char* name)
+		:m_name(name),
+		m_begin(0),
+		m_enabled(btProfiler::isEnabled())
+	{
+		if (m_enabled)
+		{
+			m_begin = btProfileGetTicks();
+		}
+	}
+
+	~btProfileScope()
+	{
+		if (m_enabled)
+		{
+			btProfiler::recordSpan(m_name, m_begin, btProfileGetTicks());
+		}
+	}
+};
+
+#endif //BT_PROFILER_H
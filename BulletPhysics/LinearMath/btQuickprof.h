@@ -21,6 +21,7 @@
 #include <stdio.h>//@todo remove this, backwards compatibility
 #include "btScalar.h"
 #include "btAlignedAllocator.h"
+#include "btProfiler.h"
 #include <new>
 
 
@@ -188,11 +189,21 @@ public:
 };
 
 
+///BT_PROFILE records into the per-thread btProfiler buffers, define BT_USE_PROFILE_TREE to get the CProfileManager tree instead.
+///The tree is not thread-safe, only use it when no BT_PROFILE scope runs on worker threads
+#ifdef BT_USE_PROFILE_TREE
 #define	BT_PROFILE( name )			CProfileSample __profile( name )
+#else
+#define	BT_PROFILE( name )			btProfileScope __profile( name )
+#endif //BT_USE_PROFILE_TREE
+
+///adds to one of the btProfileCounter counters, value is only evaluated while the profiler is enabled
+#define	BT_PROFILE_COUNTER( counter, value )	do { if (btProfiler::isEnabled()) btProfiler::addCounter( counter, value ); } while (0)
 
 #else
 
 #define	BT_PROFILE( name )
+#define	BT_PROFILE_COUNTER( counter, value )
 
 #endif //#ifndef BT_NO_PROFILE
 
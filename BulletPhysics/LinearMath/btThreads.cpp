@@ -0,0 +1,271 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "btThreads.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifndef BT_NO_THREAD_LOCAL
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
+
+int	btAtomicFetchAdd(volatile int* ptr, int value)
+{
+#if defined(_MSC_VER)
+	return _InterlockedExchangeAdd((volatile long*)ptr, value);
+#elif defined(__GNUC__)
+	return __sync_fetch_and_add(ptr, value);
+#else
+	int oldValue = *ptr;
+	*ptr = oldValue + value;
+	return oldValue;
+#endif
+}
+
+bool	btAtomicCompareAndSwap(volatile int* ptr, int expected, int newValue)
+{
+#if defined(_MSC_VER)
+	return _InterlockedCompareExchange((volatile long*)ptr, newValue, expected) == expected;
+#elif defined(__GNUC__)
+	return __sync_bool_compare_and_swap(ptr, expected, newValue);
+#else
+	if (*ptr != expected)
+		return false;
+	*ptr = newValue;
+	return true;
+#endif
+}
+
+int	btAtomicLoad(const volatile int* ptr)
+{
+#if defined(_MSC_VER)
+	// volatile reads have acquire semantics with MSVC
+	int value = *ptr;
+	_ReadWriteBarrier();
+	return value;
+#elif defined(__GNUC__)
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+	return *ptr;
+#endif
+}
+
+void	btAtomicStore(volatile int* ptr, int value)
+{
+#if defined(_MSC_VER)
+	// volatile writes have release semantics with MSVC
+	_ReadWriteBarrier();
+	*ptr = value;
+#elif defined(__GNUC__)
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+	*ptr = value;
+#endif
+}
+
+void*	btAtomicLoadPtr(void* const volatile* ptr)
+{
+#if defined(_MSC_VER)
+	// volatile reads have acquire semantics with MSVC
+	void* value = *ptr;
+	_ReadWriteBarrier();
+	return value;
+#elif defined(__GNUC__)
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+	return *ptr;
+#endif
+}
+
+void	btAtomicStorePtr(void* volatile* ptr, void* value)
+{
+#if defined(_MSC_VER)
+	// volatile writes have release semantics with MSVC
+	_ReadWriteBarrier();
+	*ptr = value;
+#elif defined(__GNUC__)
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+	*ptr = value;
+#endif
+}
+
+void	btSpinMutex::lock()
+{
+	while (!tryLock())
+	{
+		//spin until the owner releases the lock, read first to avoid hammering the cache line
+		while (m_lock)
+		{
+		}
+	}
+}
+
+void	btSpinMutex::unlock()
+{
+#if defined(__GNUC__) && !defined(_MSC_VER)
+	__sync_lock_release(&m_lock);
+#else
+	btAtomicCompareAndSwap(&m_lock, 1, 0);
+#endif
+}
+
+bool	btSpinMutex::tryLock()
+{
+	return btAtomicCompareAndSwap(&m_lock, 0, 1);
+}
+
+
+#ifndef BT_NO_THREAD_LOCAL
+static BT_THREAD_LOCAL int gThreadIndex = -1;
+
+///indices are handed out below BT_SHARED_THREAD_INDEX, the ones of exited threads are reused first
+static btSpinMutex	gThreadIndexMutex;
+static int	gNumThreadIndices = 0;
+static int	gFreeThreadIndices[BT_SHARED_THREAD_INDEX];
+static int	gNumFreeThreadIndices = 0;
+
+static void	releaseThreadIndex(int threadIndex)
+{
+	gThreadIndexMutex.lock();
+	gFreeThreadIndices[gNumFreeThreadIndices++] = threadIndex;
+	gThreadIndexMutex.unlock();
+}
+
+//call releaseThreadIndex when the thread exits
+#if defined(_WIN32)
+static DWORD	gThreadExitKey = FLS_OUT_OF_INDEXES;
+
+static void WINAPI	onThreadExit(void* value)
+{
+	gThreadIndex = -1;
+	releaseThreadIndex((int)(size_t)value - 1);
+}
+
+static void	registerThreadExit(int threadIndex)
+{
+	gThreadIndexMutex.lock();
+	if (gThreadExitKey == FLS_OUT_OF_INDEXES)
+		gThreadExitKey = FlsAlloc(onThreadExit);
+	gThreadIndexMutex.unlock();
+	FlsSetValue(gThreadExitKey, (void*)(size_t)(threadIndex + 1));
+}
+#else
+static pthread_key_t	gThreadExitKey;
+static pthread_once_t	gThreadExitKeyOnce = PTHREAD_ONCE_INIT;
+
+static void	onThreadExit(void* value)
+{
+	//destructors of other keys may still call in, they get a new index and this runs again
+	gThreadIndex = -1;
+	releaseThreadIndex((int)(size_t)value - 1);
+}
+
+static void	createThreadExitKey()
+{
+	pthread_key_create(&gThreadExitKey, onThreadExit);
+}
+
+static void	registerThreadExit(int threadIndex)
+{
+	pthread_once(&gThreadExitKeyOnce, createThreadExitKey);
+	pthread_setspecific(gThreadExitKey, (void*)(size_t)(threadIndex + 1));
+}
+#endif
+
+static int	acquireThreadIndex()
+{
+	int threadIndex = BT_SHARED_THREAD_INDEX;
+	gThreadIndexMutex.lock();
+	if (gNumFreeThreadIndices)
+	{
+		threadIndex = gFreeThreadIndices[--gNumFreeThreadIndices];
+	} else if (gNumThreadIndices < BT_SHARED_THREAD_INDEX)
+	{
+		threadIndex = gNumThreadIndices++;
+	}
+	gThreadIndexMutex.unlock();
+
+	if (threadIndex != BT_SHARED_THREAD_INDEX)
+	{
+		registerThreadExit(threadIndex);
+	}
+	return threadIndex;
+}
+#endif //BT_NO_THREAD_LOCAL
+
+static btSpinMutex	gSharedThreadIndexMutex;
+
+btSpinMutex&	btGetSharedThreadIndexMutex()
+{
+	return gSharedThreadIndexMutex;
+}
+
+unsigned int	btGetCurrentThreadIndex()
+{
+#ifdef BT_NO_THREAD_LOCAL
+	return 0;
+#else
+	if (gThreadIndex < 0)
+	{
+		gThreadIndex = acquireThreadIndex();
+	}
+	return (unsigned int)gThreadIndex;
+#endif
+}
+
+bool	btIsMainThread()
+{
+	return btGetCurrentThreadIndex() == 0;
+}
+
+
+static btITaskScheduler* gTaskScheduler = 0;
+
+void	btSetTaskScheduler(btITaskScheduler* taskScheduler)
+{
+	//make sure the thread that installs the scheduler (usually the main thread) gets its index first
+	btGetCurrentThreadIndex();
+	gTaskScheduler = taskScheduler;
+}
+
+btITaskScheduler*	btGetTaskScheduler()
+{
+	return gTaskScheduler;
+}
+
+int		btGetTaskSchedulerNumThreads()
+{
+	return gTaskScheduler ? gTaskScheduler->getNumThreads() : 1;
+}
+
+void	btParallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body)
+{
+	if (iBegin >= iEnd)
+		return;
+	if (gTaskScheduler && (iEnd - iBegin) > grainSize)
+	{
+		gTaskScheduler->parallelFor(iBegin, iEnd, grainSize, body);
+	} else
+	{
+		body.forLoop(iBegin, iEnd);
+	}
+}
@@ -0,0 +1,133 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BT_THREADS_H
+#define BT_THREADS_H
+
+#include "btScalar.h" // has definitions like SIMD_FORCE_INLINE
+
+///upper limit on the number of threads that may call into Bullet concurrently (main thread included)
+///per-thread storage (caches, profiler buffers, pair emission buffers) is sized with this constant
+#define BT_MAX_THREAD_COUNT 64
+
+#if defined(_MSC_VER)
+	#define BT_THREAD_LOCAL __declspec( thread )
+#elif defined(__GNUC__)
+	#define BT_THREAD_LOCAL __thread
+#else
+	///no thread local storage, every thread will report index 0
+	#define BT_NO_THREAD_LOCAL
+#endif
+
+///atomically adds 'value' to '*ptr' and returns the previous value
+int	btAtomicFetchAdd(volatile int* ptr, int value);
+
+///atomically replaces '*ptr' by 'newValue' if it equals 'expected', returns true on success
+bool	btAtomicCompareAndSwap(volatile int* ptr, int expected, int newValue);
+
+///reads '*ptr' with acquire semantics, for flags other threads may change at any time
+int	btAtomicLoad(const volatile int* ptr);
+
+///writes '*ptr' with release semantics
+void	btAtomicStore(volatile int* ptr, int value);
+
+///reads '*ptr' with acquire semantics, the data a pointer published with btAtomicStorePtr points to is visible afterwards
+void*	btAtomicLoadPtr(void* const volatile* ptr);
+
+///writes '*ptr' with release semantics, everything written before is visible to a btAtomicLoadPtr that sees 'value'
+void	btAtomicStorePtr(void* volatile* ptr, void* value);
+
+///btSpinMutex is a tiny lock for very short critical sections, it never sleeps
+class btSpinMutex
+{
+	volatile int	m_lock;
+
+public:
+	btSpinMutex()
+		:m_lock(0)
+	{
+	}
+	void	lock();
+	void	unlock();
+	bool	tryLock();
+};
+
+///returns a small, stable index for the calling thread in the range [0, BT_MAX_THREAD_COUNT)
+///the first thread that asks gets index 0, so call it once from the main thread at startup
+///the index of a thread is given back when it exits and reused by later threads. When BT_MAX_THREAD_COUNT-1 threads
+///hold an index, further threads share BT_SHARED_THREAD_INDEX, see btSharedThreadIndexLock
+unsigned int	btGetCurrentThreadIndex();
+
+#define BT_SHARED_THREAD_INDEX (BT_MAX_THREAD_COUNT - 1)
+
+btSpinMutex&	btGetSharedThreadIndexMutex();
+
+///per-thread storage is only private to a thread for indices below BT_SHARED_THREAD_INDEX
+///btSharedThreadIndexLock locks it for its scope when 'threadIndex' is the shared index
+class btSharedThreadIndexLock
+{
+	bool	m_locked;
+
+public:
+	btSharedThreadIndexLock(unsigned int threadIndex)
+		:m_locked(threadIndex == BT_SHARED_THREAD_INDEX)
+	{
+		if (m_locked)
+			btGetSharedThreadIndexMutex().lock();
+	}
+	~btSharedThreadIndexLock()
+	{
+		if (m_locked)
+			btGetSharedThreadIndexMutex().unlock();
+	}
+};
+
+bool	btIsMainThread();
+
+///btIParallelForBody is the work item for btParallelFor, forLoop is called for disjoint sub-ranges, possibly concurrently
+class btIParallelForBody
+{
+public:
+	virtual ~btIParallelForBody() {}
+	virtual void	forLoop(int iBegin, int iEnd) const = 0;
+};
+
+///btITaskScheduler is the hook that lets the multithreaded library (or the application) run btParallelFor on worker threads
+///see BulletMultiThreaded/btThreadSupportTaskScheduler.h for an implementation on top of btThreadSupportInterface
+class btITaskScheduler
+{
+public:
+	virtual ~btITaskScheduler() {}
+
+	virtual const char*	getName() const = 0;
+
+	///number of threads that work on a parallelFor, including the calling thread
+	virtual int		getNumThreads() const = 0;
+
+	virtual void	parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) = 0;
+};
+
+///set the task scheduler used by btParallelFor, 0 restores the serial fallback. Not thread-safe, call it between steps.
+void	btSetTaskScheduler(btITaskScheduler* taskScheduler);
+
+btITaskScheduler*	btGetTaskScheduler();
+
+///number of threads btParallelFor will use, 1 when no task scheduler is installed
+int		btGetTaskSchedulerNumThreads();
+
+///runs body.forLoop over [iBegin, iEnd) in chunks of (at most) grainSize, on the installed task scheduler when there is one
+void	btParallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body);
+
+#endif //BT_THREADS_H
@@ -0,0 +1,465 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "MiniCL/cl.h"
+#include "MiniCL/MiniCLKernel.h"
+#include "LinearMath/btAlignedAllocator.h"
+#include "LinearMath/btThreads.h"
+#include "BulletMultiThreaded/PlatformDefinitions.h"
+#include "BulletMultiThreaded/btThreadSupportTaskScheduler.h"
+#ifdef _WIN32
+#include "BulletMultiThreaded/Win32ThreadSupport.h"
+#endif
+#include "BulletMultiThreaded/PosixThreadSupport.h"
+#include <string.h>
+
+#define MINICL_DEFAULT_NUM_THREADS		4
+#define MINICL_DEFAULT_WORK_GROUP_SIZE	128
+
+///the context owns the worker threads, the command queue is the context itself
+struct MiniCLContext
+{
+	btThreadSupportInterface*		m_threadSupport;
+	btThreadSupportTaskScheduler*	m_scheduler;
+};
+
+struct MiniCLProgram
+{
+	cl_context	m_context;
+};
+
+struct MiniCLKernel
+{
+	const MiniCLKernelDesc*	m_desc;
+	MiniCLKernelArgument	m_args[MINICL_MAX_ARGUMENTS];
+	unsigned int			m_argumentsSet;
+};
+
+///there is one device, the CPU, its id only needs to be unique
+static int sMiniCLDevice;
+static const char* sMiniCLDeviceName = "MiniCL CPU";
+static const char* sMiniCLDeviceVendor = "Bullet Physics";
+
+static MiniCLKernelDesc* sKernelList = 0;
+
+MiniCLKernelDesc::MiniCLKernelDesc( const char* name, MiniCLGenericKernel kernel, const MiniCLKernelSignature& signature )
+	:m_name( name ),
+	m_kernel( kernel ),
+	m_signature( signature ),
+	m_next( sKernelList )
+{
+	sKernelList = this;
+}
+
+const MiniCLKernelDesc*	miniCLFindKernel( const char* name )
+{
+	for( const MiniCLKernelDesc* desc = sKernelList; desc; desc = desc->m_next )
+	{
+		if( !strcmp( desc->m_name, name ) )
+			return desc;
+	}
+	return 0;
+}
+
+///copies a value for the clGet*Info queries
+static cl_int	getInfo( const void* value, size_t valueSize, size_t param_value_size, void* param_value, size_t* param_value_size_ret )
+{
+	if( param_value_size_ret )
+		*param_value_size_ret = valueSize;
+	if( param_value )
+	{
+		if( param_value_size < valueSize )
+			return CL_INVALID_VALUE;
+		memcpy( param_value, value, valueSize );
+	}
+	return CL_SUCCESS;
+}
+
+
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContextFromType(const cl_context_properties * properties, cl_device_type device_type, void (*pfn_notify)(const char *, const void *, size_t, void *), void * user_data, cl_int * errcode_ret)
+{
+	if( !(device_type & (CL_DEVICE_TYPE_DEFAULT | CL_DEVICE_TYPE_CPU | CL_DEVICE_TYPE_DEBUG)) )
+	{
+		if( errcode_ret )
+			*errcode_ret = CL_DEVICE_NOT_FOUND;
+		return 0;
+	}
+
+	int numThreads = MINICL_DEFAULT_NUM_THREADS;
+	for( const cl_context_properties* property = properties; property && property[0]; property += 2 )
+	{
+		if( property[0] == CL_CONTEXT_NUM_THREADS_MINICL )
+			numThreads = (int)property[1];
+	}
+
+	MiniCLContext* context = new MiniCLContext;
+	context->m_threadSupport = 0;
+	context->m_scheduler = 0;
+	if( !(device_type & CL_DEVICE_TYPE_DEBUG) && numThreads > 0 )
+	{
+#if defined(_WIN32)
+		Win32ThreadSupport::Win32ThreadConstructionInfo threadConstructionInfo( "MiniCL", processParallelForTask, createParallelForLocalStoreMemory, numThreads );
+		context->m_threadSupport = new Win32ThreadSupport( threadConstructionInfo );
+#elif defined(USE_PTHREADS)
+		PosixThreadSupport::ThreadConstructionInfo threadConstructionInfo( "MiniCL", processParallelForTask, createParallelForLocalStoreMemory, numThreads );
+		context->m_threadSupport = new PosixThreadSupport( threadConstructionInfo );
+#endif
+		if( context->m_threadSupport )
+			context->m_scheduler = new btThreadSupportTaskScheduler( context->m_threadSupport );
+	}
+
+	if( errcode_ret )
+		*errcode_ret = CL_SUCCESS;
+	return (cl_context)context;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetContextInfo(cl_context context, cl_context_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret)
+{
+	if( !context )
+		return CL_INVALID_CONTEXT;
+
+	switch( param_name )
+	{
+	case CL_CONTEXT_DEVICES:
+		{
+			cl_device_id device = (cl_device_id)&sMiniCLDevice;
+			return getInfo( &device, sizeof(device), param_value_size, param_value, param_value_size_ret );
+		}
+	case CL_CONTEXT_REFERENCE_COUNT:
+		{
+			cl_uint referenceCount = 1;
+			return getInfo( &referenceCount, sizeof(referenceCount), param_value_size, param_value, param_value_size_ret );
+		}
+	default:
+		return CL_INVALID_VALUE;
+	}
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseContext(cl_context context)
+{
+	MiniCLContext* miniCLContext = (MiniCLContext*)context;
+	if( !miniCLContext )
+		return CL_INVALID_CONTEXT;
+
+	delete miniCLContext->m_scheduler;
+	//the thread support destructor stops the threads
+	delete miniCLContext->m_threadSupport;
+	delete miniCLContext;
+	return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetDeviceInfo(cl_device_id device, cl_device_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret)
+{
+	if( device != (cl_device_id)&sMiniCLDevice )
+		return CL_INVALID_DEVICE;
+
+	switch( param_name )
+	{
+	case CL_DEVICE_TYPE:
+		{
+			cl_device_type deviceType = CL_DEVICE_TYPE_CPU;
+			return getInfo( &deviceType, sizeof(deviceType), param_value_size, param_value, param_value_size_ret );
+		}
+	case CL_DEVICE_MAX_COMPUTE_UNITS:
+		{
+			cl_uint computeUnits = MINICL_DEFAULT_NUM_THREADS + 1;
+			return getInfo( &computeUnits, sizeof(computeUnits), param_value_size, param_value, param_value_size_ret );
+		}
+	case CL_DEVICE_MAX_WORK_GROUP_SIZE:
+		{
+			size_t workGroupSize = 1024;
+			return getInfo( &workGroupSize, sizeof(workGroupSize), param_value_size, param_value, param_value_size_ret );
+		}
+	case CL_DEVICE_NAME:
+		return getInfo( sMiniCLDeviceName, strlen( sMiniCLDeviceName ) + 1, param_value_size, param_value, param_value_size_ret );
+	case CL_DEVICE_VENDOR:
+		return getInfo( sMiniCLDeviceVendor, strlen( sMiniCLDeviceVendor ) + 1, param_value_size, param_value, param_value_size_ret );
+	default:
+		return CL_INVALID_VALUE;
+	}
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueue(cl_context context, cl_device_id device, cl_command_queue_properties properties, cl_int * errcode_ret)
+{
+	cl_int err = CL_SUCCESS;
+	if( !context )
+		err = CL_INVALID_CONTEXT;
+	else if( device && device != (cl_device_id)&sMiniCLDevice )
+		err = CL_INVALID_DEVICE;
+	if( errcode_ret )
+		*errcode_ret = err;
+	return err == CL_SUCCESS ? (cl_command_queue)context : 0;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue(cl_command_queue command_queue)
+{
+	return command_queue ? CL_SUCCESS : CL_INVALID_COMMAND_QUEUE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFlush(cl_command_queue command_queue)
+{
+	//commands have finished when they return
+	return command_queue ? CL_SUCCESS : CL_INVALID_COMMAND_QUEUE;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish(cl_command_queue command_queue)
+{
+	return command_queue ? CL_SUCCESS : CL_INVALID_COMMAND_QUEUE;
+}
+
+///a cl_mem is the host pointer of the buffer, so kernels receive it unchanged
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBuffer(cl_context context, cl_mem_flags flags, size_t size, void * host_ptr, cl_int * errcode_ret)
+{
+	cl_int err = CL_SUCCESS;
+	if( !context )
+		err = CL_INVALID_CONTEXT;
+	else if( !size )
+		err = CL_INVALID_BUFFER_SIZE;
+	else if( (host_ptr != 0) != ((flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR)) != 0) )
+		err = CL_INVALID_HOST_PTR;
+	if( err != CL_SUCCESS )
+	{
+		if( errcode_ret )
+			*errcode_ret = err;
+		return 0;
+	}
+
+	//CL_MEM_USE_HOST_PTR gets a copy as well, MiniCL does not keep pointers to application memory
+	void* buffer = btAlignedAlloc( size, 16 );
+	if( host_ptr )
+		memcpy( buffer, host_ptr, size );
+	if( errcode_ret )
+		*errcode_ret = buffer ? CL_SUCCESS : CL_OUT_OF_HOST_MEMORY;
+	return (cl_mem)buffer;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject(cl_mem memobj)
+{
+	if( !memobj )
+		return CL_INVALID_MEM_OBJECT;
+	btAlignedFree( memobj );
+	return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read, size_t offset, size_t cb, void * ptr, cl_uint num_events_in_wait_list, const cl_event * event_wait_list, cl_event * event)
+{
+	if( !command_queue )
+		return CL_INVALID_COMMAND_QUEUE;
+	if( !buffer )
+		return CL_INVALID_MEM_OBJECT;
+	if( !ptr )
+		return CL_INVALID_VALUE;
+	memcpy( ptr, (const char*)buffer + offset, cb );
+	if( event )
+		*event = 0;
+	return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write, size_t offset, size_t cb, const void * ptr, cl_uint num_events_in_wait_list, const cl_event * event_wait_list, cl_event * event)
+{
+	if( !command_queue )
+		return CL_INVALID_COMMAND_QUEUE;
+	if( !buffer )
+		return CL_INVALID_MEM_OBJECT;
+	if( !ptr )
+		return CL_INVALID_VALUE;
+	memcpy( (char*)buffer + offset, ptr, cb );
+	if( event )
+		*event = 0;
+	return CL_SUCCESS;
+}
+
+///the source is not compiled, the kernels it contains must be registered with MINICL_REGISTER
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource(cl_context context, cl_uint count, const char ** strings, const size_t * lengths, cl_int * errcode_ret)
+{
+	if( !context )
+	{
+		if( errcode_ret )
+			*errcode_ret = CL_INVALID_CONTEXT;
+		return 0;
+	}
+
+	MiniCLProgram* program = new MiniCLProgram;
+	program->m_context = context;
+	if( errcode_ret )
+		*errcode_ret = CL_SUCCESS;
+	return (cl_program)program;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clBuildProgram(cl_program program, cl_uint num_devices, const cl_device_id * device_list, const char * options, void (*pfn_notify)(cl_program program, void * user_data), void * user_data)
+{
+	if( !program )
+		return CL_INVALID_PROGRAM;
+	if( pfn_notify )
+		pfn_notify( program, user_data );
+	return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramInfo(cl_program program, cl_program_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret)
+{
+	MiniCLProgram* miniCLProgram = (MiniCLProgram*)program;
+	if( !miniCLProgram )
+		return CL_INVALID_PROGRAM;
+
+	switch( param_name )
+	{
+	case CL_PROGRAM_CONTEXT:
+		return getInfo( &miniCLProgram->m_context, sizeof(cl_context), param_value_size, param_value, param_value_size_ret );
+	case CL_PROGRAM_NUM_DEVICES:
+		{
+			cl_uint numDevices = 1;
+			return getInfo( &numDevices, sizeof(numDevices), param_value_size, param_value, param_value_size_ret );
+		}
+	case CL_PROGRAM_DEVICES:
+		{
+			cl_device_id device = (cl_device_id)&sMiniCLDevice;
+			return getInfo( &device, sizeof(device), param_value_size, param_value, param_value_size_ret );
+		}
+	default:
+		return CL_INVALID_VALUE;
+	}
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clGetProgramBuildInfo(cl_program program, cl_device_id device, cl_program_build_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret)
+{
+	if( !program )
+		return CL_INVALID_PROGRAM;
+
+	switch( param_name )
+	{
+	case CL_PROGRAM_BUILD_STATUS:
+		{
+			cl_build_status status = CL_BUILD_SUCCESS;
+			return getInfo( &status, sizeof(status), param_value_size, param_value, param_value_size_ret );
+		}
+	case CL_PROGRAM_BUILD_OPTIONS:
+	case CL_PROGRAM_BUILD_LOG:
+		return getInfo( "", 1, param_value_size, param_value, param_value_size_ret );
+	default:
+		return CL_INVALID_VALUE;
+	}
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram(cl_program program)
+{
+	if( !program )
+		return CL_INVALID_PROGRAM;
+	delete (MiniCLProgram*)program;
+	return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel(cl_program program, const char * kernel_name, cl_int * errcode_ret)
+{
+	cl_int err = CL_SUCCESS;
+	const MiniCLKernelDesc* desc = 0;
+	if( !program )
+		err = CL_INVALID_PROGRAM;
+	else if( !kernel_name )
+		err = CL_INVALID_VALUE;
+	else if( !(desc = miniCLFindKernel( kernel_name )) )
+		err = CL_INVALID_KERNEL_NAME;
+	if( errcode_ret )
+		*errcode_ret = err;
+	if( err != CL_SUCCESS )
+		return 0;
+
+	MiniCLKernel* kernel = new MiniCLKernel;
+	kernel->m_desc = desc;
+	kernel->m_argumentsSet = 0;
+	return (cl_kernel)kernel;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel(cl_kernel kernel)
+{
+	if( !kernel )
+		return CL_INVALID_KERNEL;
+	delete (MiniCLKernel*)kernel;
+	return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArg(cl_kernel kernel, cl_uint arg_index, size_t arg_size, const void * arg_value)
+{
+	MiniCLKernel* miniCLKernel = (MiniCLKernel*)kernel;
+	if( !miniCLKernel )
+		return CL_INVALID_KERNEL;
+
+	const MiniCLKernelSignature& signature = miniCLKernel->m_desc->m_signature;
+	if( arg_index >= (cl_uint)signature.m_numArguments )
+		return CL_INVALID_ARG_INDEX;
+	//a null value declares __local memory, which MiniCL does not support
+	if( !arg_value )
+		return CL_INVALID_ARG_VALUE;
+	if( arg_size != signature.m_argumentSizes[arg_index] )
+		return CL_INVALID_ARG_SIZE;
+
+	MiniCLKernelArgument& argument = miniCLKernel->m_args[arg_index];
+	memcpy( argument.m_data, arg_value, arg_size );
+	argument.m_size = arg_size;
+	miniCLKernel->m_argumentsSet |= 1u << arg_index;
+	return CL_SUCCESS;
+}
+
+struct MiniCLKernelBody : public btIParallelForBody
+{
+	const MiniCLKernel*	m_kernel;
+
+	virtual void forLoop( int iBegin, int iEnd ) const
+	{
+		const MiniCLKernelDesc* desc = m_kernel->m_desc;
+		desc->m_signature.m_launcher( desc->m_kernel, m_kernel->m_args, iBegin, iEnd );
+	}
+};
+
+///runs the work items in chunks of one work group on the worker threads of the context, and returns when they are done
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel(cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim, const size_t * global_work_offset, const size_t * global_work_size, const size_t * local_work_size, cl_uint num_events_in_wait_list, const cl_event * event_wait_list, cl_event * event)
+{
+	MiniCLContext* context = (MiniCLContext*)command_queue;
+	MiniCLKernel* miniCLKernel = (MiniCLKernel*)kernel;
+	if( !context )
+		return CL_INVALID_COMMAND_QUEUE;
+	if( !miniCLKernel )
+		return CL_INVALID_KERNEL;
+	if( work_dim != 1 )
+		return CL_INVALID_WORK_DIMENSION;
+	if( global_work_offset && global_work_offset[0] )
+		return CL_INVALID_GLOBAL_OFFSET;
+	if( !global_work_size )
+		return CL_INVALID_VALUE;
+
+	int numArguments = miniCLKernel->m_desc->m_signature.m_numArguments;
+	if( miniCLKernel->m_argumentsSet != (1u << numArguments) - 1 )
+		return CL_INVALID_KERNEL_ARGS;
+
+	int numWorkItems = (int)global_work_size[0];
+	int workGroupSize = MINICL_DEFAULT_WORK_GROUP_SIZE;
+	if( local_work_size )
+	{
+		if( !local_work_size[0] || global_work_size[0] % local_work_size[0] )
+			return CL_INVALID_WORK_GROUP_SIZE;
+		workGroupSize = (int)local_work_size[0];
+	}
+
+	MiniCLKernelBody body;
+	body.m_kernel = miniCLKernel;
+	if( context->m_scheduler )
+		context->m_scheduler->parallelFor( 0, numWorkItems, workGroupSize, body );
+	else
+		body.forLoop( 0, numWorkItems );
+
+	if( event )
+		*event = 0;
+	return CL_SUCCESS;
+}
@@ -0,0 +1,673 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MINICL_KERNEL_H
+#define MINICL_KERNEL_H
+
+#include <stddef.h>
+#include <string.h>
+
+#define MINICL_MAX_ARGUMENTS		16
+#define MINICL_MAX_ARGUMENT_SIZE	16
+
+///storage for one clSetKernelArg value, a buffer argument holds the cl_mem, which is the host pointer of the buffer
+struct MiniCLKernelArgument
+{
+	union
+	{
+		char	m_data[MINICL_MAX_ARGUMENT_SIZE];
+		void*	m_pointer;
+		double	m_alignment;
+	};
+	size_t	m_size;
+};
+
+template <typename T>
+inline T miniCLGetArgument( const MiniCLKernelArgument& argument )
+{
+	T value;
+	memcpy( &value, argument.m_data, sizeof(T) );
+	return value;
+}
+
+typedef void (*MiniCLGenericKernel)();
+
+///runs the work items [beginWorkItem, endWorkItem) of a kernel, after unpacking its arguments once
+typedef void (*MiniCLKernelLauncher)( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem );
+
+struct MiniCLKernelSignature
+{
+	MiniCLKernelLauncher	m_launcher;
+	int						m_numArguments;
+	size_t					m_argumentSizes[MINICL_MAX_ARGUMENTS];
+
+	MiniCLKernelSignature( MiniCLKernelLauncher launcher, int numArguments )
+		:m_launcher( launcher ),
+		m_numArguments( numArguments )
+	{
+	}
+};
+
+///MiniCLKernelDesc is a registry entry, the constructor adds it to the list that clCreateKernel searches.
+///Use MINICL_REGISTER from cl_MiniCL_Defs.h to create them.
+struct MiniCLKernelDesc
+{
+	const char*				m_name;
+	MiniCLGenericKernel		m_kernel;
+	MiniCLKernelSignature	m_signature;
+	MiniCLKernelDesc*		m_next;
+
+	MiniCLKernelDesc( const char* name, MiniCLGenericKernel kernel, const MiniCLKernelSignature& signature );
+};
+
+///returns the registered kernel with the given name, or 0
+const MiniCLKernelDesc*	miniCLFindKernel( const char* name );
+
+///miniCLGetKernelSignature deduces the argument types of a kernel compiled with GUID_ARG, so the launcher can
+///call it with correctly typed arguments. Kernels with up to MINICL_MAX_ARGUMENTS arguments are supported.
+
+template <typename A0>
+struct MiniCLLauncher1
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, int ) = (void (*)( A0, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, guid );
+		}
+	}
+};
+
+template <typename A0>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher1< A0 >::launch, 1 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	return signature;
+}
+
+template <typename A0, typename A1>
+struct MiniCLLauncher2
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, int ) = (void (*)( A0, A1, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher2< A0, A1 >::launch, 2 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2>
+struct MiniCLLauncher3
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, int ) = (void (*)( A0, A1, A2, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher3< A0, A1, A2 >::launch, 3 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3>
+struct MiniCLLauncher4
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, int ) = (void (*)( A0, A1, A2, A3, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher4< A0, A1, A2, A3 >::launch, 4 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4>
+struct MiniCLLauncher5
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, int ) = (void (*)( A0, A1, A2, A3, A4, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher5< A0, A1, A2, A3, A4 >::launch, 5 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5>
+struct MiniCLLauncher6
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, int ) = (void (*)( A0, A1, A2, A3, A4, A5, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher6< A0, A1, A2, A3, A4, A5 >::launch, 6 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+struct MiniCLLauncher7
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher7< A0, A1, A2, A3, A4, A5, A6 >::launch, 7 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+struct MiniCLLauncher8
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher8< A0, A1, A2, A3, A4, A5, A6, A7 >::launch, 8 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+struct MiniCLLauncher9
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher9< A0, A1, A2, A3, A4, A5, A6, A7, A8 >::launch, 9 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+struct MiniCLLauncher10
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher10< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9 >::launch, 10 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+struct MiniCLLauncher11
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		A10 a10 = miniCLGetArgument< A10 >( args[10] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher11< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10 >::launch, 11 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	signature.m_argumentSizes[10] = sizeof(A10);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+struct MiniCLLauncher12
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		A10 a10 = miniCLGetArgument< A10 >( args[10] );
+		A11 a11 = miniCLGetArgument< A11 >( args[11] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher12< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11 >::launch, 12 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	signature.m_argumentSizes[10] = sizeof(A10);
+	signature.m_argumentSizes[11] = sizeof(A11);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12>
+struct MiniCLLauncher13
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		A10 a10 = miniCLGetArgument< A10 >( args[10] );
+		A11 a11 = miniCLGetArgument< A11 >( args[11] );
+		A12 a12 = miniCLGetArgument< A12 >( args[12] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher13< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12 >::launch, 13 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	signature.m_argumentSizes[10] = sizeof(A10);
+	signature.m_argumentSizes[11] = sizeof(A11);
+	signature.m_argumentSizes[12] = sizeof(A12);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13>
+struct MiniCLLauncher14
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		A10 a10 = miniCLGetArgument< A10 >( args[10] );
+		A11 a11 = miniCLGetArgument< A11 >( args[11] );
+		A12 a12 = miniCLGetArgument< A12 >( args[12] );
+		A13 a13 = miniCLGetArgument< A13 >( args[13] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher14< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13 >::launch, 14 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	signature.m_argumentSizes[10] = sizeof(A10);
+	signature.m_argumentSizes[11] = sizeof(A11);
+	signature.m_argumentSizes[12] = sizeof(A12);
+	signature.m_argumentSizes[13] = sizeof(A13);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14>
+struct MiniCLLauncher15
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		A10 a10 = miniCLGetArgument< A10 >( args[10] );
+		A11 a11 = miniCLGetArgument< A11 >( args[11] );
+		A12 a12 = miniCLGetArgument< A12 >( args[12] );
+		A13 a13 = miniCLGetArgument< A13 >( args[13] );
+		A14 a14 = miniCLGetArgument< A14 >( args[14] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher15< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14 >::launch, 15 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	signature.m_argumentSizes[10] = sizeof(A10);
+	signature.m_argumentSizes[11] = sizeof(A11);
+	signature.m_argumentSizes[12] = sizeof(A12);
+	signature.m_argumentSizes[13] = sizeof(A13);
+	signature.m_argumentSizes[14] = sizeof(A14);
+	return signature;
+}
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15>
+struct MiniCLLauncher16
+{
+	static void launch( MiniCLGenericKernel kernel, const MiniCLKernelArgument* args, int beginWorkItem, int endWorkItem )
+	{
+		void (*func)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, A15, int ) = (void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, A15, int ))kernel;
+		A0 a0 = miniCLGetArgument< A0 >( args[0] );
+		A1 a1 = miniCLGetArgument< A1 >( args[1] );
+		A2 a2 = miniCLGetArgument< A2 >( args[2] );
+		A3 a3 = miniCLGetArgument< A3 >( args[3] );
+		A4 a4 = miniCLGetArgument< A4 >( args[4] );
+		A5 a5 = miniCLGetArgument< A5 >( args[5] );
+		A6 a6 = miniCLGetArgument< A6 >( args[6] );
+		A7 a7 = miniCLGetArgument< A7 >( args[7] );
+		A8 a8 = miniCLGetArgument< A8 >( args[8] );
+		A9 a9 = miniCLGetArgument< A9 >( args[9] );
+		A10 a10 = miniCLGetArgument< A10 >( args[10] );
+		A11 a11 = miniCLGetArgument< A11 >( args[11] );
+		A12 a12 = miniCLGetArgument< A12 >( args[12] );
+		A13 a13 = miniCLGetArgument< A13 >( args[13] );
+		A14 a14 = miniCLGetArgument< A14 >( args[14] );
+		A15 a15 = miniCLGetArgument< A15 >( args[15] );
+		for( int guid = beginWorkItem; guid < endWorkItem; guid++ )
+		{
+			func( a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, guid );
+		}
+	}
+};
+
+template <typename A0, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15>
+MiniCLKernelSignature miniCLGetKernelSignature( void (*)( A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, A15, int ) )
+{
+	MiniCLKernelSignature signature( &MiniCLLauncher16< A0, A1, A2, A3, A4, A5, A6, A7, A8, A9, A10, A11, A12, A13, A14, A15 >::launch, 16 );
+	signature.m_argumentSizes[0] = sizeof(A0);
+	signature.m_argumentSizes[1] = sizeof(A1);
+	signature.m_argumentSizes[2] = sizeof(A2);
+	signature.m_argumentSizes[3] = sizeof(A3);
+	signature.m_argumentSizes[4] = sizeof(A4);
+	signature.m_argumentSizes[5] = sizeof(A5);
+	signature.m_argumentSizes[6] = sizeof(A6);
+	signature.m_argumentSizes[7] = sizeof(A7);
+	signature.m_argumentSizes[8] = sizeof(A8);
+	signature.m_argumentSizes[9] = sizeof(A9);
+	signature.m_argumentSizes[10] = sizeof(A10);
+	signature.m_argumentSizes[11] = sizeof(A11);
+	signature.m_argumentSizes[12] = sizeof(A12);
+	signature.m_argumentSizes[13] = sizeof(A13);
+	signature.m_argumentSizes[14] = sizeof(A14);
+	signature.m_argumentSizes[15] = sizeof(A15);
+	return signature;
+}
+
+#endif //MINICL_KERNEL_H
@@ -0,0 +1,220 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __OPENCL_CL_H
+#define __OPENCL_CL_H
+
+///MiniCL implements the part of the OpenCL 1.0 host API that the Bullet OpenCL solvers use, on CPU threads.
+///Kernels are not compiled at run time: the .cl sources are compiled as C++ (see cl_MiniCL_Defs.h) and registered
+///by name with MINICL_REGISTER, clCreateKernel looks them up in that registry.
+///Memory objects live in host memory and commands execute synchronously, in order, when they are enqueued.
+
+#include <stddef.h>
+
+#define CL_API_ENTRY
+#define CL_API_CALL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef signed char			cl_char;
+typedef unsigned char		cl_uchar;
+typedef signed short		cl_short;
+typedef unsigned short		cl_ushort;
+typedef signed int			cl_int;
+typedef unsigned int		cl_uint;
+typedef signed long long	cl_long;
+typedef unsigned long long	cl_ulong;
+typedef float				cl_float;
+
+typedef struct _cl_platform_id*		cl_platform_id;
+typedef struct _cl_device_id*		cl_device_id;
+typedef struct _cl_context*			cl_context;
+typedef struct _cl_command_queue*	cl_command_queue;
+typedef struct _cl_mem*				cl_mem;
+typedef struct _cl_program*			cl_program;
+typedef struct _cl_kernel*			cl_kernel;
+typedef struct _cl_event*			cl_event;
+
+typedef cl_uint		cl_bool;
+typedef cl_ulong	cl_bitfield;
+typedef cl_bitfield	cl_device_type;
+typedef cl_uint		cl_device_info;
+typedef cl_bitfield	cl_mem_flags;
+typedef cl_bitfield	cl_command_queue_properties;
+typedef ptrdiff_t	cl_context_properties;
+typedef cl_uint		cl_context_info;
+typedef cl_uint		cl_program_info;
+typedef cl_uint		cl_program_build_info;
+typedef cl_int		cl_build_status;
+
+/* Error Codes */
+#define CL_SUCCESS						0
+#define CL_DEVICE_NOT_FOUND				-1
+#define CL_DEVICE_NOT_AVAILABLE			-2
+#define CL_MEM_OBJECT_ALLOCATION_FAILURE	-4
+#define CL_OUT_OF_RESOURCES				-5
+#define CL_OUT_OF_HOST_MEMORY			-6
+#define CL_BUILD_PROGRAM_FAILURE		-11
+
+#define CL_INVALID_VALUE				-30
+#define CL_INVALID_DEVICE_TYPE			-31
+#define CL_INVALID_PLATFORM				-32
+#define CL_INVALID_DEVICE				-33
+#define CL_INVALID_CONTEXT				-34
+#define CL_INVALID_QUEUE_PROPERTIES		-35
+#define CL_INVALID_COMMAND_QUEUE		-36
+#define CL_INVALID_HOST_PTR				-37
+#define CL_INVALID_MEM_OBJECT			-38
+#define CL_INVALID_BUILD_OPTIONS		-43
+#define CL_INVALID_PROGRAM				-44
+#define CL_INVALID_PROGRAM_EXECUTABLE	-45
+#define CL_INVALID_KERNEL_NAME			-46
+#define CL_INVALID_KERNEL_DEFINITION	-47
+#define CL_INVALID_KERNEL				-48
+#define CL_INVALID_ARG_INDEX			-49
+#define CL_INVALID_ARG_VALUE			-50
+#define CL_INVALID_ARG_SIZE				-51
+#define CL_INVALID_KERNEL_ARGS			-52
+#define CL_INVALID_WORK_DIMENSION		-53
+#define CL_INVALID_WORK_GROUP_SIZE		-54
+#define CL_INVALID_GLOBAL_OFFSET		-56
+#define CL_INVALID_BUFFER_SIZE			-61
+
+/* cl_bool */
+#define CL_FALSE	0
+#define CL_TRUE		1
+
+/* cl_device_type - bitfield */
+#define CL_DEVICE_TYPE_DEFAULT		(1 << 0)
+#define CL_DEVICE_TYPE_CPU			(1 << 1)
+#define CL_DEVICE_TYPE_GPU			(1 << 2)
+#define CL_DEVICE_TYPE_ACCELERATOR	(1 << 3)
+///MiniCL extension: run every kernel on the calling thread, handy for debugging kernels
+#define CL_DEVICE_TYPE_DEBUG		(1 << 4)
+#define CL_DEVICE_TYPE_ALL			0xFFFFFFFF
+
+/* cl_device_info */
+#define CL_DEVICE_TYPE					0x1000
+#define CL_DEVICE_MAX_COMPUTE_UNITS		0x1002
+#define CL_DEVICE_MAX_WORK_GROUP_SIZE	0x1004
+#define CL_DEVICE_NAME					0x102B
+#define CL_DEVICE_VENDOR				0x102C
+
+/* cl_context_info and cl_context_properties */
+#define CL_CONTEXT_REFERENCE_COUNT		0x1080
+#define CL_CONTEXT_DEVICES				0x1081
+///MiniCL extension: number of worker threads, in addition to the thread that enqueues the kernels
+#define CL_CONTEXT_NUM_THREADS_MINICL	0x10A0
+
+/* cl_mem_flags - bitfield */
+#define CL_MEM_READ_WRITE		(1 << 0)
+#define CL_MEM_WRITE_ONLY		(1 << 1)
+#define CL_MEM_READ_ONLY		(1 << 2)
+#define CL_MEM_USE_HOST_PTR		(1 << 3)
+#define CL_MEM_ALLOC_HOST_PTR	(1 << 4)
+#define CL_MEM_COPY_HOST_PTR	(1 << 5)
+
+/* cl_program_info */
+#define CL_PROGRAM_REFERENCE_COUNT	0x1160
+#define CL_PROGRAM_CONTEXT			0x1161
+#define CL_PROGRAM_NUM_DEVICES		0x1162
+#define CL_PROGRAM_DEVICES			0x1163
+#define CL_PROGRAM_SOURCE			0x1164
+
+/* cl_program_build_info */
+#define CL_PROGRAM_BUILD_STATUS		0x1181
+#define CL_PROGRAM_BUILD_OPTIONS	0x1182
+#define CL_PROGRAM_BUILD_LOG		0x1183
+
+/* cl_build_status */
+#define CL_BUILD_SUCCESS	0
+
+/* Context APIs */
+extern CL_API_ENTRY cl_context CL_API_CALL
+clCreateContextFromType(const cl_context_properties * properties, cl_device_type device_type, void (*pfn_notify)(const char *, const void *, size_t, void *), void * user_data, cl_int * errcode_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clGetContextInfo(cl_context context, cl_context_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clReleaseContext(cl_context context);
+
+/* Device APIs */
+extern CL_API_ENTRY cl_int CL_API_CALL
+clGetDeviceInfo(cl_device_id device, cl_device_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret);
+
+/* Command Queue APIs */
+extern CL_API_ENTRY cl_command_queue CL_API_CALL
+clCreateCommandQueue(cl_context context, cl_device_id device, cl_command_queue_properties properties, cl_int * errcode_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clReleaseCommandQueue(cl_command_queue command_queue);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clFlush(cl_command_queue command_queue);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clFinish(cl_command_queue command_queue);
+
+/* Memory Object APIs */
+extern CL_API_ENTRY cl_mem CL_API_CALL
+clCreateBuffer(cl_context context, cl_mem_flags flags, size_t size, void * host_ptr, cl_int * errcode_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clReleaseMemObject(cl_mem memobj);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueReadBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read, size_t offset, size_t cb, void * ptr, cl_uint num_events_in_wait_list, const cl_event * event_wait_list, cl_event * event);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write, size_t offset, size_t cb, const void * ptr, cl_uint num_events_in_wait_list, const cl_event * event_wait_list, cl_event * event);
+
+/* Program Object APIs */
+extern CL_API_ENTRY cl_program CL_API_CALL
+clCreateProgramWithSource(cl_context context, cl_uint count, const char ** strings, const size_t * lengths, cl_int * errcode_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clBuildProgram(cl_program program, cl_uint num_devices, const cl_device_id * device_list, const char * options, void (*pfn_notify)(cl_program program, void * user_data), void * user_data);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clGetProgramInfo(cl_program program, cl_program_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clGetProgramBuildInfo(cl_program program, cl_device_id device, cl_program_build_info param_name, size_t param_value_size, void * param_value, size_t * param_value_size_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clReleaseProgram(cl_program program);
+
+/* Kernel Object APIs */
+extern CL_API_ENTRY cl_kernel CL_API_CALL
+clCreateKernel(cl_program program, const char * kernel_name, cl_int * errcode_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clReleaseKernel(cl_kernel kernel);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clSetKernelArg(cl_kernel kernel, cl_uint arg_index, size_t arg_size, const void * arg_value);
+
+/* Enqueued Commands APIs */
+extern CL_API_ENTRY cl_int CL_API_CALL
+clEnqueueNDRangeKernel(cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim, const size_t * global_work_offset, const size_t * global_work_size, const size_t * local_work_size, cl_uint num_events_in_wait_list, const cl_event * event_wait_list, cl_event * event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __OPENCL_CL_H
@@ -0,0 +1,170 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MINICL_DEFS_H
+#define MINICL_DEFS_H
+
+///cl_MiniCL_Defs.h lets OpenCL C kernels compile as C++, so MiniCL can run them on CPU threads.
+///Include it, include the .cl files with MSTRINGIFY(A) defined as A, and register each kernel with MINICL_REGISTER.
+///Kernels take GUID_ARG as their last parameter, it carries get_global_id(0). Work groups have no shared state here,
+///so __local memory and barrier are not supported.
+///
+///Vector literals (float4)(s) and (float4)(v.xyz, w) are supported, the latter through operator, on float3.
+///A list of scalars such as (float4)(a, b, c, d) would evaluate as the C++ comma operator and splat d,
+///so kernels that run on MiniCL build such vectors from their components or with vector arithmetic.
+
+#include <math.h>
+#include "MiniCL/cl.h"
+#include "MiniCL/MiniCLKernel.h"
+
+#define __kernel
+#define __global
+#define __local
+#define __private
+#define __constant static const
+
+#define GUID_ARG ,int __guid_arg
+#define GUID_ARG_VAL ,__guid_arg
+
+#define get_global_id(a)	(__guid_arg)
+
+typedef unsigned int uint;
+
+struct float3
+{
+	float x, y, z;
+};
+
+///no constructor, so it can share storage with float4::xyz
+inline float3 make_float3( float x, float y, float z )
+{
+	float3 v;
+	v.x = x;
+	v.y = y;
+	v.z = z;
+	return v;
+}
+
+struct float4
+{
+	union
+	{
+		struct
+		{
+			float x, y, z, w;
+		};
+		float3 xyz;
+	};
+
+	float4()
+	{
+	}
+
+	explicit float4( float v )
+	{
+		x = y = z = w = v;
+	}
+
+	float4( float v0, float v1, float v2, float v3 )
+	{
+		x = v0;
+		y = v1;
+		z = v2;
+		w = v3;
+	}
+
+	float4& operator+=( const float4& b )
+	{
+		x += b.x; y += b.y; z += b.z; w += b.w;
+		return *this;
+	}
+
+	float4& operator-=( const float4& b )
+	{
+		x -= b.x; y -= b.y; z -= b.z; w -= b.w;
+		return *this;
+	}
+
+	float4& operator*=( float s )
+	{
+		x *= s; y *= s; z *= s; w *= s;
+		return *this;
+	}
+
+	float4& operator/=( float s )
+	{
+		x /= s; y /= s; z /= s; w /= s;
+		return *this;
+	}
+};
+
+struct int2
+{
+	int x, y;
+};
+
+struct int4
+{
+	int x, y, z, w;
+};
+
+inline float4 operator+( const float4& a, const float4& b ) { return float4( a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w ); }
+inline float4 operator-( const float4& a, const float4& b ) { return float4( a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w ); }
+inline float4 operator-( const float4& a ) { return float4( -a.x, -a.y, -a.z, -a.w ); }
+inline float4 operator*( const float4& a, const float4& b ) { return float4( a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w ); }
+inline float4 operator*( const float4& a, float s ) { return float4( a.x * s, a.y * s, a.z * s, a.w * s ); }
+inline float4 operator*( float s, const float4& a ) { return float4( a.x * s, a.y * s, a.z * s, a.w * s ); }
+inline float4 operator/( const float4& a, float s ) { return float4( a.x / s, a.y / s, a.z / s, a.w / s ); }
+
+inline float3 operator+( const float3& a, const float3& b ) { return make_float3( a.x + b.x, a.y + b.y, a.z + b.z ); }
+inline float3 operator-( const float3& a, const float3& b ) { return make_float3( a.x - b.x, a.y - b.y, a.z - b.z ); }
+inline float3 operator-( const float3& a ) { return make_float3( -a.x, -a.y, -a.z ); }
+inline float3 operator*( const float3& a, float s ) { return make_float3( a.x * s, a.y * s, a.z * s ); }
+inline float3 operator*( float s, const float3& a ) { return make_float3( a.x * s, a.y * s, a.z * s ); }
+inline float3 operator/( const float3& a, float s ) { return make_float3( a.x / s, a.y / s, a.z / s ); }
+inline float3& operator+=( float3& a, const float3& b ) { a = a + b; return a; }
+inline float3& operator-=( float3& a, const float3& b ) { a = a - b; return a; }
+inline float3& operator*=( float3& a, float s ) { a = a * s; return a; }
+
+///(float4)(v.xyz, w)
+inline float4 operator,( const float3& v, float w ) { return float4( v.x, v.y, v.z, w ); }
+
+inline float dot( const float4& a, const float4& b ) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline float dot( const float3& a, const float3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline float4 cross( const float4& a, const float4& b )
+{
+	return float4( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0.f );
+}
+
+inline float3 cross( const float3& a, const float3& b )
+{
+	return make_float3( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x );
+}
+
+inline float length( const float4& a ) { return sqrtf( dot( a, a ) ); }
+inline float length( const float3& a ) { return sqrtf( dot( a, a ) ); }
+inline float4 normalize( const float4& a ) { return a / length( a ); }
+inline float3 normalize( const float3& a ) { return a / length( a ); }
+
+///scalar select, c ? b : a
+inline float select( float a, float b, int c ) { return c ? b : a; }
+inline int select( int a, int b, int c ) { return c ? b : a; }
+
+///registers a kernel under its own name, at file or namespace scope after the kernel definition
+#define MINICL_REGISTER(__kernel_func) \
+	static MiniCLKernelDesc __kernel_func##Desc( #__kernel_func, (MiniCLGenericKernel)&__kernel_func, miniCLGetKernelSignature( &__kernel_func ) );
+
+#endif //MINICL_DEFS_H
@@ -0,0 +1,153 @@
+/*
+Bullet Continuous Collision Detection and Physics Library
+Copyright (c) 2003-2011 Erwin Coumans  http://bulletphysics.org
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of this software.
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+///MiniCLSoftBodyTest runs the same cloth scene with btCPUSoftBodySolver and with btOpenCLSoftBodySolver on MiniCL,
+///once on the calling thread (CL_DEVICE_TYPE_DEBUG) and once on worker threads. Without colliders both solvers
+///run the same batches in the same order, so every node must end at exactly the same position.
+///Returns 0 when all runs match, 1 otherwise.
+
+#include "btBulletDynamicsCommon.h"
+#include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+#include "BulletSoftBody/btSoftBodyHelpers.h"
+#include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
+#include "BulletMultiThreaded/GpuSoftBodySolvers/CPU/btSoftBodySolver_CPU.h"
+#include "BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolver_OpenCL.h"
+#include <stdio.h>
+
+#define NUM_CLOTHS 2
+#define CLOTH_RESOLUTION 32
+#define NUM_STEPS 60
+#define NUM_WORKER_THREADS 4
+
+enum SolverType
+{
+	SOLVER_CPU,
+	SOLVER_MINICL_DEBUG,
+	SOLVER_MINICL_THREADS
+};
+
+static const char* sSolverNames[] =
+{
+	"btCPUSoftBodySolver",
+	"MiniCL, calling thread",
+	"MiniCL, worker threads"
+};
+
+///steps the cloth scene with the given solver and returns the node positions of all cloths
+static void	runClothScene(int solverType, btAlignedObjectArray<btVector3>& positions)
+{
+	cl_context context = 0;
+	cl_command_queue queue = 0;
+	btSoftBodySolver* solver;
+	if (solverType == SOLVER_CPU)
+	{
+		solver = new btCPUSoftBodySolver();
+	} else
+	{
+		cl_context_properties properties[] = {CL_CONTEXT_NUM_THREADS_MINICL, NUM_WORKER_THREADS, 0};
+		cl_device_type deviceType = (solverType == SOLVER_MINICL_DEBUG) ? CL_DEVICE_TYPE_DEBUG : CL_DEVICE_TYPE_CPU;
+		cl_int error;
+		context = clCreateContextFromType(properties, deviceType, 0, 0, &error);
+		queue = clCreateCommandQueue(context, 0, 0, &error);
+		solver = new btOpenCLSoftBodySolver(queue, context);
+	}
+
+	btSoftBodyRigidBodyCollisionConfiguration collisionConfiguration;
+	btCollisionDispatcher dispatcher(&collisionConfiguration);
+	btDbvtBroadphase broadphase;
+	btSequentialImpulseConstraintSolver constraintSolver;
+	btSoftRigidDynamicsWorld* world = new btSoftRigidDynamicsWorld(&dispatcher, &broadphase, &constraintSolver, &collisionConfiguration, solver);
+	world->setGravity(btVector3(0, -10, 0));
+
+	btSoftBodyWorldInfo& worldInfo = world->getWorldInfo();
+	worldInfo.m_gravity = btVector3(0, -10, 0);
+	worldInfo.m_sparsesdf.Initialize();
+
+	btAlignedObjectArray<btSoftBody*> cloths;
+	for (int i = 0; i < NUM_CLOTHS; i++)
+	{
+		btScalar z = btScalar(i * 12);
+		//two corners are fixed
+		btSoftBody* cloth = btSoftBodyHelpers::CreatePatch(worldInfo, btVector3(-5, 10, z - 5), btVector3(5, 10, z - 5),
+			btVector3(-5, 10, z + 5), btVector3(5, 10, z + 5), CLOTH_RESOLUTION, CLOTH_RESOLUTION, 1 + 2, true);
+		cloth->m_cfg.piterations = 10;
+		cloth->m_cfg.viterations = 10;
+		cloth->setTotalMass(1);
+		world->addSoftBody(cloth);
+		cloths.push_back(cloth);
+	}
+
+	for (int i = 0; i < NUM_STEPS; i++)
+	{
+		world->stepSimulation(btScalar(1.) / btScalar(60.), 1, btScalar(1.) / btScalar(60.));
+	}
+	solver->copyBackToSoftBodies();
+
+	positions.resize(0);
+	for (int i = 0; i < cloths.size(); i++)
+	{
+		for (int n = 0; n < cloths[i]->m_nodes.size(); n++)
+		{
+			positions.push_back(cloths[i]->m_nodes[n].m_x);
+		}
+		world->removeSoftBody(cloths[i]);
+		delete cloths[i];
+	}
+
+	delete world;
+	delete solver;
+	if (queue)
+		clReleaseCommandQueue(queue);
+	if (context)
+		clReleaseContext(context);
+}
+
+int main(int argc, char** argv)
+{
+	btAlignedObjectArray<btVector3> reference;
+	runClothScene(SOLVER_CPU, reference);
+
+	int numFailures = 0;
+	for (int solverType = SOLVER_MINICL_DEBUG; solverType <= SOLVER_MINICL_THREADS; solverType++)
+	{
+		btAlignedObjectArray<btVector3> positions;
+		runClothScene(solverType, positions);
+
+		int numDifferent = 0;
+		btScalar maxDifference = btScalar(0.);
+		if (positions.size() != reference.size())
+		{
+			numDifferent = reference.size();
+		} else
+		{
+			for (int i = 0; i < positions.size(); i++)
+			{
+				if (!(positions[i] == reference[i]))
+				{
+					numDifferent++;
+					maxDifference = btMax(maxDifference, (positions[i] - reference[i]).length());
+				}
+			}
+		}
+
+		printf("%s: %d of %d nodes differ from %s, max difference %g\n", sSolverNames[solverType], numDifferent,
+			reference.size(), sSolverNames[SOLVER_CPU], maxDifference);
+		if (numDifferent)
+			numFailures++;
+	}
+
+	printf(numFailures ? "FAILED\n" : "PASSED\n");
+	return numFailures ? 1 : 0;
+}
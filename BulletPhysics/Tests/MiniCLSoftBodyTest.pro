@@ -0,0 +1,12 @@
+# Compares btOpenCLSoftBodySolver on MiniCL with btCPUSoftBodySolver.
+# Build with qmake && make, the program exits with 1 when the solvers disagree.
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+TARGET = MiniCLSoftBodyTest
+
+include(../BulletPhysics.pri)
+
+SOURCES += MiniCLSoftBodyTest.cpp
+
+unix:LIBS += -lpthread
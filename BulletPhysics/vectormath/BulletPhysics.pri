@@ -1,8 +1,12 @@
 
 INCLUDEPATH += $$PWD
 
+# the OpenCL soft body solver runs its kernels on CPU threads through MiniCL
+DEFINES += USE_MINICL
+
 SOURCES += \
     $$PWD/BulletCollision/BroadphaseCollision/btAxisSweep3.cpp \
+    $$PWD/BulletCollision/BroadphaseCollision/btBroadphaseInterface.cpp \
     $$PWD/BulletCollision/BroadphaseCollision/btBroadphaseProxy.cpp \
     $$PWD/BulletCollision/BroadphaseCollision/btCollisionAlgorithm.cpp \
     $$PWD/BulletCollision/BroadphaseCollision/btDbvt.cpp \
@@ -27,6 +31,7 @@ SOURCES += \
     $$PWD/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.cpp \
     $$PWD/BulletCollision/CollisionDispatch/btEmptyCollisionAlgorithm.cpp \
     $$PWD/BulletCollision/CollisionDispatch/btGhostObject.cpp \
+    $$PWD/BulletCollision/CollisionDispatch/btGhostTriggerSystem.cpp \
     $$PWD/BulletCollision/CollisionDispatch/btInternalEdgeUtility.cpp \
     $$PWD/BulletCollision/CollisionDispatch/btManifoldResult.cpp \
     $$PWD/BulletCollision/CollisionDispatch/btSimulationIslandManager.cpp \
@@ -69,6 +74,7 @@ SOURCES += \
     $$PWD/BulletCollision/CollisionShapes/btTriangleIndexVertexArray.cpp \
     $$PWD/BulletCollision/CollisionShapes/btTriangleIndexVertexMaterialArray.cpp \
     $$PWD/BulletCollision/CollisionShapes/btTriangleMesh.cpp \
+    $$PWD/BulletCollision/CollisionShapes/btTriangleMeshAsset.cpp \
     $$PWD/BulletCollision/CollisionShapes/btTriangleMeshShape.cpp \
     $$PWD/BulletCollision/CollisionShapes/btUniformScalingShape.cpp \
     $$PWD/BulletCollision/Gimpact/btContactProcessing.cpp \
@@ -113,12 +119,36 @@ SOURCES += \
     $$PWD/BulletDynamics/Dynamics/Bullet-C-API.cpp \
     $$PWD/BulletDynamics/Vehicle/btRaycastVehicle.cpp \
     $$PWD/BulletDynamics/Vehicle/btWheelInfo.cpp \
+    $$PWD/BulletMultiThreaded/btGpu3DGridBroadphase.cpp \
+    $$PWD/BulletMultiThreaded/btParallel3DGridBroadphase.cpp \
+    $$PWD/BulletMultiThreaded/btThreadSupportInterface.cpp \
+    $$PWD/BulletMultiThreaded/btThreadSupportTaskScheduler.cpp \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/CPU/btSoftBodySolver_CPU.cpp \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolver_OpenCL.cpp \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/MiniCL/MiniCLTaskWrap.cpp \
+    $$PWD/BulletMultiThreaded/PosixThreadSupport.cpp \
+    $$PWD/BulletMultiThreaded/SequentialThreadSupport.cpp \
+    $$PWD/BulletMultiThreaded/Win32ThreadSupport.cpp \
+    $$PWD/BulletSoftBody/btDefaultSoftBodySolver.cpp \
+    $$PWD/BulletSoftBody/btSoftBody.cpp \
+    $$PWD/BulletSoftBody/btSoftBodyConcaveCollisionAlgorithm.cpp \
+    $$PWD/BulletSoftBody/btSoftBodyHelpers.cpp \
+    $$PWD/BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.cpp \
+    $$PWD/BulletSoftBody/btSoftRigidCollisionAlgorithm.cpp \
+    $$PWD/BulletSoftBody/btSoftRigidDynamicsWorld.cpp \
+    $$PWD/BulletSoftBody/btSoftSoftCollisionAlgorithm.cpp \
     $$PWD/LinearMath/btAlignedAllocator.cpp \
     $$PWD/LinearMath/btConvexHull.cpp \
     $$PWD/LinearMath/btConvexHullComputer.cpp \
+    $$PWD/LinearMath/btFrameArena.cpp \
     $$PWD/LinearMath/btGeometryUtil.cpp \
+    $$PWD/LinearMath/btMappedFile.cpp \
+    $$PWD/LinearMath/btPoolAllocator.cpp \
+    $$PWD/LinearMath/btProfiler.cpp \
     $$PWD/LinearMath/btQuickprof.cpp \
-    $$PWD/LinearMath/btSerializer.cpp
+    $$PWD/LinearMath/btSerializer.cpp \
+    $$PWD/LinearMath/btThreads.cpp \
+    $$PWD/MiniCL/MiniCL.cpp
 
 
 HEADERS += \
@@ -153,6 +183,7 @@ HEADERS += \
     $$PWD/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h \
     $$PWD/BulletCollision/CollisionDispatch/btEmptyCollisionAlgorithm.h \
     $$PWD/BulletCollision/CollisionDispatch/btGhostObject.h \
+    $$PWD/BulletCollision/CollisionDispatch/btGhostTriggerSystem.h \
     $$PWD/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h \
     $$PWD/BulletCollision/CollisionDispatch/btManifoldResult.h \
     $$PWD/BulletCollision/CollisionDispatch/btSimulationIslandManager.h \
@@ -198,6 +229,7 @@ HEADERS += \
     $$PWD/BulletCollision/CollisionShapes/btTriangleIndexVertexMaterialArray.h \
     $$PWD/BulletCollision/CollisionShapes/btTriangleInfoMap.h \
     $$PWD/BulletCollision/CollisionShapes/btTriangleMesh.h \
+    $$PWD/BulletCollision/CollisionShapes/btTriangleMeshAsset.h \
     $$PWD/BulletCollision/CollisionShapes/btTriangleMeshShape.h \
     $$PWD/BulletCollision/CollisionShapes/btTriangleShape.h \
     $$PWD/BulletCollision/CollisionShapes/btUniformScalingShape.h \
@@ -273,13 +305,50 @@ HEADERS += \
     $$PWD/BulletDynamics/Vehicle/btRaycastVehicle.h \
     $$PWD/BulletDynamics/Vehicle/btVehicleRaycaster.h \
     $$PWD/BulletDynamics/Vehicle/btWheelInfo.h \
+    $$PWD/BulletMultiThreaded/btGpu3DGridBroadphase.h \
+    $$PWD/BulletMultiThreaded/btGpu3DGridBroadphaseSharedCode.h \
+    $$PWD/BulletMultiThreaded/btGpu3DGridBroadphaseSharedDefs.h \
+    $$PWD/BulletMultiThreaded/btGpu3DGridBroadphaseSharedTypes.h \
+    $$PWD/BulletMultiThreaded/btGpuDefines.h \
+    $$PWD/BulletMultiThreaded/btGpuUtilsSharedCode.h \
+    $$PWD/BulletMultiThreaded/btGpuUtilsSharedDefs.h \
+    $$PWD/BulletMultiThreaded/btParallel3DGridBroadphase.h \
+    $$PWD/BulletMultiThreaded/btThreadSupportInterface.h \
+    $$PWD/BulletMultiThreaded/btThreadSupportTaskScheduler.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/CPU/btSoftBodySolverData.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/CPU/btSoftBodySolver_CPU.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolverBuffer_OpenCL.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolverLinkData_OpenCL.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolverTriangleData_OpenCL.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolverVertexData_OpenCL.h \
+    $$PWD/BulletMultiThreaded/GpuSoftBodySolvers/OpenCL/btSoftBodySolver_OpenCL.h \
+    $$PWD/BulletMultiThreaded/PlatformDefinitions.h \
+    $$PWD/BulletMultiThreaded/PosixThreadSupport.h \
+    $$PWD/BulletMultiThreaded/PpuAddressSpace.h \
+    $$PWD/BulletMultiThreaded/SequentialThreadSupport.h \
+    $$PWD/BulletMultiThreaded/Win32ThreadSupport.h \
+    $$PWD/BulletSoftBody/btDefaultSoftBodySolver.h \
+    $$PWD/BulletSoftBody/btSoftBody.h \
+    $$PWD/BulletSoftBody/btSoftBodyConcaveCollisionAlgorithm.h \
+    $$PWD/BulletSoftBody/btSoftBodyData.h \
+    $$PWD/BulletSoftBody/btSoftBodyHelpers.h \
+    $$PWD/BulletSoftBody/btSoftBodyInternals.h \
+    $$PWD/BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h \
+    $$PWD/BulletSoftBody/btSoftBodySolverVertexBuffer.h \
+    $$PWD/BulletSoftBody/btSoftBodySolvers.h \
+    $$PWD/BulletSoftBody/btSoftRigidCollisionAlgorithm.h \
+    $$PWD/BulletSoftBody/btSoftRigidDynamicsWorld.h \
+    $$PWD/BulletSoftBody/btSoftSoftCollisionAlgorithm.h \
+    $$PWD/BulletSoftBody/btSparseSDF.h \
     $$PWD/LinearMath/btAabbUtil2.h \
     $$PWD/LinearMath/btAlignedAllocator.h \
     $$PWD/LinearMath/btAlignedObjectArray.h \
     $$PWD/LinearMath/btConvexHull.h \
     $$PWD/LinearMath/btConvexHullComputer.h \
     $$PWD/LinearMath/btDefaultMotionState.h \
+    $$PWD/LinearMath/btFrameArena.h \
     $$PWD/LinearMath/btGeometryUtil.h \
+    $$PWD/LinearMath/btMappedFile.h \
     $$PWD/LinearMath/btHashMap.h \
     $$PWD/LinearMath/btIDebugDraw.h \
     $$PWD/LinearMath/btList.h \
@@ -287,6 +356,7 @@ HEADERS += \
     $$PWD/LinearMath/btMinMax.h \
     $$PWD/LinearMath/btMotionState.h \
     $$PWD/LinearMath/btPoolAllocator.h \
+    $$PWD/LinearMath/btProfiler.h \
     $$PWD/LinearMath/btQuadWord.h \
     $$PWD/LinearMath/btQuaternion.h \
     $$PWD/LinearMath/btQuickprof.h \
@@ -294,9 +364,13 @@ HEADERS += \
     $$PWD/LinearMath/btScalar.h \
     $$PWD/LinearMath/btSerializer.h \
     $$PWD/LinearMath/btStackAlloc.h \
+    $$PWD/LinearMath/btThreads.h \
     $$PWD/LinearMath/btTransform.h \
     $$PWD/LinearMath/btTransformUtil.h \
     $$PWD/LinearMath/btVector3.h \
+    $$PWD/MiniCL/cl.h \
+    $$PWD/MiniCL/cl_MiniCL_Defs.h \
+    $$PWD/MiniCL/MiniCLKernel.h \
     $$PWD/vectormath/vmInclude.h \
     $$PWD/vectormath/scalar/boolInVec.h \
     $$PWD/vectormath/scalar/floatInVec.h \
@@ -36,7 +36,8 @@ SOURCES += src/main.cpp \
     ../src/ToyBlock.cpp \
     ../src/Skybox.cpp \
     ../../CommonGL/src/Camera.cpp \
-    ../src/MyMotionState.cpp
+    ../src/MyMotionState.cpp \
+    ../src/TowerGlue.cpp
 HEADERS += include/mainwindow.h \
            ../../CommonGL/include/MatrixOperations.h \
            ../../CommonGL/include/GLController.h \
@@ -52,7 +53,8 @@ HEADERS += include/mainwindow.h \
     ../include/MyMotionState.h \
     ../../CommonGL/include/PickingColor.h \
     ../../CommonGL/include/Rect.h \
-    ../include/MyPickingColors.h
+    ../include/MyPickingColors.h \
+    ../include/TowerGlue.h
 FORMS += ui/mainwindow.ui
 
 # Please do not modify the following two lines. Required for deployment.
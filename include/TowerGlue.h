@@ -0,0 +1,138 @@
+#ifndef TOWERGLUE_H
+#define TOWERGLUE_H
+
+#include <btBulletDynamicsCommon.h>
+#include <vector>
+#include <map>
+
+/**
+ * Glues resting, touching blocks together into compound rigid bodies.
+ *
+ * Blocks never fall asleep, so every block of a standing tower is simulated
+ * and solved against its neighbours on every step. When blocks have rested
+ * against each other for a while, this class removes them from the world and
+ * replaces them with a single body with a btCompoundShape whose children
+ * share the block shape; the compound's dynamic AABB tree is used for the
+ * child queries against other objects. A compound splits back into the
+ * individual blocks when a contact impulse on it exceeds a break threshold
+ * or when one of its blocks is picked.
+ *
+ * The glued block bodies stay valid: their motion states and world
+ * transforms follow the compound, so rendering and picking need not know
+ * about the gluing.
+ */
+class TowerGlue
+{
+public:
+    /**
+     * Constructs this object.
+     * @param dynamicsWorld the world the blocks are simulated in
+     * @param maxCompounds maximum number of compounds at a time; compounds of
+     * tall stacks are 'large' proxies in a grid broadphase, which has room
+     * for a limited number of them
+     */
+    TowerGlue(btDiscreteDynamicsWorld* dynamicsWorld, int maxCompounds);
+    virtual ~TowerGlue();
+
+    /** Registers a block body that is in the world and may be glued. */
+    void AddBlock(btRigidBody* blockBody);
+
+    /**
+     * Dissolves all compounds, adding their blocks back to the world, and
+     * forgets all the registered blocks.
+     */
+    void RemoveAllBlocks();
+
+    /**
+     * Asks for the compound containing the given block to be split. May be
+     * called from the UI thread; the request is carried out by the next
+     * call to Update().
+     */
+    void RequestRelease(btRigidBody* blockBody);
+
+    /**
+     * Splits and glues the compounds as needed and moves the glued blocks
+     * along with their compounds. Call after each simulation step.
+     * @param seconds time advanced by the step
+     */
+    void Update(btScalar seconds);
+
+    /** Returns the number of bodies currently simulated for the blocks. */
+    int GetNumSimulatedBodies() const;
+
+private:
+    struct Compound;
+
+    struct Block
+    {
+        btRigidBody* body;
+
+        // For how long the block has been at rest, in seconds
+        btScalar restTime;
+
+        // The compound this block is glued into, or NULL
+        Compound* compound;
+    };
+
+    struct Compound
+    {
+        btRigidBody* body;
+        btCompoundShape* shape;
+
+        // Indices of the glued blocks; block i is child i of the shape
+        std::vector<int> blocks;
+
+        // For how long the compound has been at rest, in seconds
+        btScalar restTime;
+    };
+
+    /**
+     * Returns the time a body has rested after a step, given the time it
+     * had rested before.
+     */
+    static btScalar UpdatedRestTime(const btRigidBody* body, btScalar restTime,
+                                    btScalar seconds);
+
+    /** Finds the union-find root of a block index */
+    int FindRoot(int block);
+
+    /**
+     * Returns the block that represents the given object for gluing, or
+     * -1 if the object is not a block or compound that has rested long
+     * enough.
+     */
+    int GluableBlock(const btCollisionObject* object) const;
+
+    void BreakCompounds();
+    void UpdateRestTimes(btScalar seconds);
+    void GlueRestingBlocks();
+    void SyncGluedBlocks();
+
+    /** Creates a compound from the given blocks, replacing their bodies */
+    void CreateCompound(const std::vector<int>& blocks);
+
+    /**
+     * Destroys a compound, handing its motion to the glued blocks.
+     * @param addBlocks whether to add the blocks back to the world
+     */
+    void DestroyCompound(Compound* compound, bool addBlocks);
+
+private:
+    btDiscreteDynamicsWorld* m_dynamicsWorld;
+    int m_maxCompounds;
+
+    std::vector<Block> m_blocks;
+    std::vector<Compound*> m_compounds;
+
+    // Lookups from the collision objects to blocks and compounds
+    std::map<const btCollisionObject*, int> m_blockIndices;
+    std::map<const btCollisionObject*, Compound*> m_compoundBodies;
+
+    // Union-find parents used while gluing
+    std::vector<int> m_parents;
+
+    // Block to release on the next update, set from the UI thread
+    btRigidBody* volatile m_releaseRequest;
+};
+
+#endif // TOWERGLUE_H
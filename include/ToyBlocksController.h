@@ -13,6 +13,9 @@
 class Skybox;
 class Ground;
 class ToyBlock;
+class TowerGlue;
+class btThreadSupportInterface;
+class btITaskScheduler;
 
 // Symbolic name for the "About" texture
 static const char* AboutTextureName = "about-texture";
@@ -266,6 +269,14 @@ protected:
     btSequentialImpulseConstraintSolver* m_solver;
     btDiscreteDynamicsWorld* m_dynamicsWorld;
 
+    // Worker threads for the broadphase grid passes; NULL if the physics
+    // runs on the main thread only
+    btThreadSupportInterface* m_threadSupport;
+    btITaskScheduler* m_taskScheduler;
+
+    // Glues resting blocks into compounds; NULL if gluing is disabled
+    TowerGlue* m_towerGlue;
+
     // Physics engine shapes
 //    std::vector<btStaticPlaneShape*> m_planeShapes;
 //    btStaticPlaneShape* m_groundShape;
@@ -0,0 +1,457 @@
+#include "TowerGlue.h"
+
+// Velocities below which a body counts as resting
+static const btScalar RestLinearVelocity = 0.05;
+static const btScalar RestAngularVelocity = 0.05;
+
+// Velocities above which a body starts to rest over again. Gluing a block
+// loses the warm started impulses of its contacts, which briefly shakes the
+// blocks standing on it; that must not keep them from being glued.
+static const btScalar MovingLinearVelocity = 0.2;
+static const btScalar MovingAngularVelocity = 0.2;
+
+// How long touching blocks must rest before they are glued, in seconds
+static const btScalar RestTimeToGlue = 1.0;
+
+// Contacts closer than this glue their bodies together
+static const btScalar GlueContactDistance = 0.02;
+
+// Impulse of a single contact that breaks a compound. A resting 5-block
+// tower puts roughly 0.2 on each of its ground contacts, a pushed or tossed
+// block several times the break impulse.
+static const btScalar BreakImpulse = 1.5;
+
+TowerGlue::TowerGlue(btDiscreteDynamicsWorld* dynamicsWorld, int maxCompounds)
+    : m_dynamicsWorld(dynamicsWorld),
+      m_maxCompounds(maxCompounds),
+      m_releaseRequest(NULL)
+{
+}
+
+TowerGlue::~TowerGlue()
+{
+    RemoveAllBlocks();
+}
+
+void TowerGlue::AddBlock(btRigidBody* blockBody)
+{
+    Block block;
+    block.body = blockBody;
+    block.restTime = 0.0;
+    block.compound = NULL;
+
+    m_blockIndices[blockBody] = m_blocks.size();
+    m_blocks.push_back(block);
+}
+
+void TowerGlue::RemoveAllBlocks()
+{
+    while ( !m_compounds.empty() )
+    {
+        DestroyCompound(m_compounds.back(), true);
+    }
+
+    m_blocks.clear();
+    m_blockIndices.clear();
+    m_releaseRequest = NULL;
+}
+
+void TowerGlue::RequestRelease(btRigidBody* blockBody)
+{
+    m_releaseRequest = blockBody;
+}
+
+int TowerGlue::GetNumSimulatedBodies() const
+{
+    int numBodies = m_blocks.size();
+    for ( unsigned int i = 0; i < m_compounds.size(); i++ )
+    {
+        numBodies -= m_compounds[i]->blocks.size() - 1;
+    }
+
+    return numBodies;
+}
+
+void TowerGlue::Update(btScalar seconds)
+{
+    // Split the compound of a picked block so that it can be pushed alone
+    btRigidBody* releaseBody = m_releaseRequest;
+    m_releaseRequest = NULL;
+    if ( releaseBody != NULL )
+    {
+        std::map<const btCollisionObject*, int>::iterator it =
+                m_blockIndices.find(releaseBody);
+        if ( (it != m_blockIndices.end()) &&
+             (m_blocks[it->second].compound != NULL) )
+        {
+            DestroyCompound(m_blocks[it->second].compound, true);
+        }
+    }
+
+    BreakCompounds();
+    UpdateRestTimes(seconds);
+    GlueRestingBlocks();
+    SyncGluedBlocks();
+}
+
+btScalar TowerGlue::UpdatedRestTime(const btRigidBody* body,
+                                    btScalar restTime, btScalar seconds)
+{
+    btScalar linear2 = body->getLinearVelocity().length2();
+    btScalar angular2 = body->getAngularVelocity().length2();
+
+    if ( (linear2 > MovingLinearVelocity * MovingLinearVelocity) ||
+         (angular2 > MovingAngularVelocity * MovingAngularVelocity) )
+    {
+        return 0.0;
+    }
+    if ( (linear2 < RestLinearVelocity * RestLinearVelocity) &&
+         (angular2 < RestAngularVelocity * RestAngularVelocity) )
+    {
+        return restTime + seconds;
+    }
+
+    return restTime;
+}
+
+int TowerGlue::FindRoot(int block)
+{
+    while ( m_parents[block] != block )
+    {
+        m_parents[block] = m_parents[m_parents[block]];
+        block = m_parents[block];
+    }
+
+    return block;
+}
+
+int TowerGlue::GluableBlock(const btCollisionObject* object) const
+{
+    std::map<const btCollisionObject*, int>::const_iterator blockIt =
+            m_blockIndices.find(object);
+    if ( blockIt != m_blockIndices.end() )
+    {
+        const Block& block = m_blocks[blockIt->second];
+        if ( (block.compound == NULL) && (block.restTime >= RestTimeToGlue) )
+        {
+            return blockIt->second;
+        }
+        return -1;
+    }
+
+    std::map<const btCollisionObject*, Compound*>::const_iterator compoundIt =
+            m_compoundBodies.find(object);
+    if ( compoundIt != m_compoundBodies.end() )
+    {
+        const Compound* compound = compoundIt->second;
+        if ( compound->restTime >= RestTimeToGlue )
+        {
+            return compound->blocks[0];
+        }
+    }
+
+    return -1;
+}
+
+void TowerGlue::BreakCompounds()
+{
+    if ( m_compounds.empty() )
+    {
+        return;
+    }
+
+    // Find the compounds first; destroying one also destroys its manifolds
+    std::vector<const btCollisionObject*> broken;
+    btDispatcher* dispatcher = m_dynamicsWorld->getDispatcher();
+    for ( int i = 0; i < dispatcher->getNumManifolds(); i++ )
+    {
+        btPersistentManifold* manifold =
+                dispatcher->getManifoldByIndexInternal(i);
+
+        btScalar maxImpulse = 0.0;
+        for ( int j = 0; j < manifold->getNumContacts(); j++ )
+        {
+            maxImpulse = btMax(maxImpulse,
+                               manifold->getContactPoint(j).m_appliedImpulse);
+        }
+        if ( maxImpulse <= BreakImpulse )
+        {
+            continue;
+        }
+
+        broken.push_back(
+                    static_cast<const btCollisionObject*>(manifold->getBody0()));
+        broken.push_back(
+                    static_cast<const btCollisionObject*>(manifold->getBody1()));
+    }
+
+    for ( unsigned int i = 0; i < broken.size(); i++ )
+    {
+        // A compound may appear in several manifolds, look it up every time
+        std::map<const btCollisionObject*, Compound*>::iterator it =
+                m_compoundBodies.find(broken[i]);
+        if ( it != m_compoundBodies.end() )
+        {
+            DestroyCompound(it->second, true);
+        }
+    }
+}
+
+void TowerGlue::UpdateRestTimes(btScalar seconds)
+{
+    for ( unsigned int i = 0; i < m_blocks.size(); i++ )
+    {
+        Block& block = m_blocks[i];
+        if ( block.compound == NULL )
+        {
+            block.restTime = UpdatedRestTime(block.body, block.restTime,
+                                             seconds);
+        }
+    }
+
+    for ( unsigned int i = 0; i < m_compounds.size(); i++ )
+    {
+        Compound* compound = m_compounds[i];
+        compound->restTime = UpdatedRestTime(compound->body,
+                                             compound->restTime, seconds);
+    }
+}
+
+void TowerGlue::GlueRestingBlocks()
+{
+    // Blocks of the same compound start out in the same set
+    m_parents.resize(m_blocks.size());
+    for ( unsigned int i = 0; i < m_blocks.size(); i++ )
+    {
+        const Block& block = m_blocks[i];
+        m_parents[i] = (block.compound != NULL) ? block.compound->blocks[0]
+                                                : i;
+    }
+
+    // Join the resting bodies that touch each other
+    bool joined = false;
+    btDispatcher* dispatcher = m_dynamicsWorld->getDispatcher();
+    for ( int i = 0; i < dispatcher->getNumManifolds(); i++ )
+    {
+        btPersistentManifold* manifold =
+                dispatcher->getManifoldByIndexInternal(i);
+
+        bool touching = false;
+        for ( int j = 0; j < manifold->getNumContacts(); j++ )
+        {
+            if ( manifold->getContactPoint(j).getDistance() <
+                 GlueContactDistance )
+            {
+                touching = true;
+                break;
+            }
+        }
+        if ( !touching )
+        {
+            continue;
+        }
+
+        int block0 = GluableBlock(
+                    static_cast<const btCollisionObject*>(manifold->getBody0()));
+        int block1 = GluableBlock(
+                    static_cast<const btCollisionObject*>(manifold->getBody1()));
+        if ( (block0 < 0) || (block1 < 0) )
+        {
+            continue;
+        }
+
+        int root0 = FindRoot(block0);
+        int root1 = FindRoot(block1);
+        if ( root0 != root1 )
+        {
+            m_parents[root1] = root0;
+            joined = true;
+        }
+    }
+
+    if ( !joined )
+    {
+        return;
+    }
+
+    std::map<int, std::vector<int> > groups;
+    for ( unsigned int i = 0; i < m_blocks.size(); i++ )
+    {
+        groups[FindRoot(i)].push_back(i);
+    }
+
+    std::map<int, std::vector<int> >::iterator it;
+    for ( it = groups.begin(); it != groups.end(); it++ )
+    {
+        const std::vector<int>& group = it->second;
+        if ( group.size() < 2 )
+        {
+            continue;
+        }
+
+        // Skip the groups that are already glued as they are
+        Compound* compound = m_blocks[group[0]].compound;
+        if ( (compound != NULL) && (compound->blocks.size() == group.size()) )
+        {
+            continue;
+        }
+
+        // The old compounds in the group are replaced by the new one
+        std::vector<Compound*> replaced;
+        for ( unsigned int i = 0; i < group.size(); i++ )
+        {
+            compound = m_blocks[group[i]].compound;
+            if ( (compound != NULL) && (compound->blocks[0] == group[i]) )
+            {
+                replaced.push_back(compound);
+            }
+        }
+        if ( (int)(m_compounds.size() - replaced.size()) >= m_maxCompounds )
+        {
+            continue;
+        }
+        for ( unsigned int i = 0; i < replaced.size(); i++ )
+        {
+            DestroyCompound(replaced[i], false);
+        }
+
+        CreateCompound(group);
+    }
+}
+
+void TowerGlue::SyncGluedBlocks()
+{
+    for ( unsigned int i = 0; i < m_compounds.size(); i++ )
+    {
+        const Compound* compound = m_compounds[i];
+        const btTransform& bodyTransform = compound->body->getWorldTransform();
+        btTransform graphicsTransform;
+        compound->body->getMotionState()->getWorldTransform(graphicsTransform);
+
+        for ( unsigned int j = 0; j < compound->blocks.size(); j++ )
+        {
+            btRigidBody* blockBody = m_blocks[compound->blocks[j]].body;
+            const btTransform& childTransform =
+                    compound->shape->getChildTransform(j);
+            blockBody->setWorldTransform(bodyTransform * childTransform);
+            blockBody->getMotionState()->setWorldTransform(
+                        graphicsTransform * childTransform);
+        }
+    }
+}
+
+void TowerGlue::CreateCompound(const std::vector<int>& blocks)
+{
+    Compound* compound = new Compound;
+    compound->shape = new btCompoundShape(true);
+    compound->blocks = blocks;
+    compound->restTime = RestTimeToGlue;
+
+    // Add the blocks at their world transforms to find the center of mass
+    std::vector<btScalar> masses;
+    btScalar totalMass = 0.0;
+    btVector3 momentum(0, 0, 0);
+    btVector3 angularVelocity(0, 0, 0);
+    for ( unsigned int i = 0; i < blocks.size(); i++ )
+    {
+        Block& block = m_blocks[blocks[i]];
+        btScalar mass = btScalar(1.0) / block.body->getInvMass();
+
+        compound->shape->addChildShape(block.body->getWorldTransform(),
+                                       block.body->getCollisionShape());
+        masses.push_back(mass);
+        totalMass += mass;
+        momentum += block.body->getLinearVelocity() * mass;
+        angularVelocity += block.body->getAngularVelocity() * mass;
+
+        m_dynamicsWorld->removeRigidBody(block.body);
+        block.compound = compound;
+    }
+
+    // Move the children into the principal frame of the compound
+    btTransform principal;
+    btVector3 inertia;
+    compound->shape->calculatePrincipalAxisTransform(&masses[0], principal,
+                                                     inertia);
+    btTransform toPrincipal = principal.inverse();
+    for ( unsigned int i = 0; i < blocks.size(); i++ )
+    {
+        compound->shape->updateChildTransform(
+                    i, toPrincipal * compound->shape->getChildTransform(i),
+                    false);
+    }
+    compound->shape->recalculateLocalAabb();
+
+    // The compound behaves like its blocks did
+    const btRigidBody* firstBody = m_blocks[blocks[0]].body;
+    btRigidBody::btRigidBodyConstructionInfo
+            compoundRigidBodyCI(totalMass, new btDefaultMotionState(principal),
+                                compound->shape, inertia);
+    compoundRigidBodyCI.m_friction = firstBody->getFriction();
+    compoundRigidBodyCI.m_restitution = firstBody->getRestitution();
+    compoundRigidBodyCI.m_linearSleepingThreshold =
+            firstBody->getLinearSleepingThreshold();
+    compoundRigidBodyCI.m_angularSleepingThreshold =
+            firstBody->getAngularSleepingThreshold();
+    compound->body = new btRigidBody(compoundRigidBodyCI);
+    compound->body->setLinearVelocity(momentum / totalMass);
+    compound->body->setAngularVelocity(angularVelocity / totalMass);
+
+    m_dynamicsWorld->addRigidBody(compound->body);
+
+    m_compounds.push_back(compound);
+    m_compoundBodies[compound->body] = compound;
+}
+
+void TowerGlue::DestroyCompound(Compound* compound, bool addBlocks)
+{
+    btRigidBody* body = compound->body;
+    const btTransform& bodyTransform = body->getWorldTransform();
+    btTransform graphicsTransform;
+    body->getMotionState()->getWorldTransform(graphicsTransform);
+    btVector3 linearVelocity = body->getLinearVelocity();
+    btVector3 angularVelocity = body->getAngularVelocity();
+
+    // Every block continues with the velocity of its point of the compound
+    for ( unsigned int i = 0; i < compound->blocks.size(); i++ )
+    {
+        Block& block = m_blocks[compound->blocks[i]];
+        const btTransform& childTransform = compound->shape->getChildTransform(i);
+        btTransform blockTransform = bodyTransform * childTransform;
+        btVector3 blockVelocity = linearVelocity + angularVelocity.cross(
+                    blockTransform.getOrigin() - bodyTransform.getOrigin());
+
+        block.body->setWorldTransform(blockTransform);
+        block.body->setInterpolationWorldTransform(blockTransform);
+        block.body->getMotionState()->setWorldTransform(
+                    graphicsTransform * childTransform);
+        block.body->setLinearVelocity(blockVelocity);
+        block.body->setAngularVelocity(angularVelocity);
+        block.body->setInterpolationLinearVelocity(blockVelocity);
+        block.body->setInterpolationAngularVelocity(angularVelocity);
+        block.compound = NULL;
+        block.restTime = 0.0;
+
+        if ( addBlocks )
+        {
+            m_dynamicsWorld->addRigidBody(block.body);
+            block.body->activate(true);
+        }
+    }
+
+    m_dynamicsWorld->removeRigidBody(body);
+    m_compoundBodies.erase(body);
+    for ( unsigned int i = 0; i < m_compounds.size(); i++ )
+    {
+        if ( m_compounds[i] == compound )
+        {
+            m_compounds.erase(m_compounds.begin() + i);
+            break;
+        }
+    }
+
+    delete body->getMotionState();
+    delete body;
+    delete compound->shape;
+    delete compound;
+}
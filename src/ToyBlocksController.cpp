@@ -9,6 +9,15 @@
 #include "ToyBlock.h"
 #include "MyMotionState.h"
 #include "MyPickingColors.h"
+#include "TowerGlue.h"
+
+#include "BulletMultiThreaded/btParallel3DGridBroadphase.h"
+#include "BulletMultiThreaded/btThreadSupportTaskScheduler.h"
+#include "BulletMultiThreaded/PlatformDefinitions.h"
+#ifdef _WIN32
+#include "BulletMultiThreaded/Win32ThreadSupport.h"
+#endif
+#include "BulletMultiThreaded/PosixThreadSupport.h"
 
 // bias matrix is used to transform unit cube [-1,1] into [0,1]
 // all components get c = c*0.5 + 0.5
@@ -58,6 +67,34 @@ static const float BlockDisplaceY = -1.0;
 static const float BlockSpacer = 0.5;
 static const float BlockSpacer2 = 0.7;
 
+// Whether resting, touching blocks are glued into compound bodies
+static const bool GlueRestingBlocks = false;
+
+// Maximum number of glued towers at a time
+static const int MaxGluedTowers = 16;
+
+// Broadphase grid; covers the fenced area and the height the blocks are
+// stacked / tossed to. A cell must fit the bounding box of a block in any
+// rotation (3 x ToyBlockSize + margin), anything outside is clamped to the
+// border cells. The ground, the fence and glued towers are 'large' objects;
+// room for the towers is only reserved when they are glued. Every block
+// takes a picking color, so there are never more blocks than colors.
+static const float GridCellSize = 6.5;
+static const int GridCellsXZ = 8;
+static const int GridCellsY = 6;
+static const int GridMaxBlocks = NumPickingColors;
+static const int GridMaxLargeObjects = 8 + (GlueRestingBlocks ? MaxGluedTowers : 0);
+static const int GridMaxPairsPerBlock = 32;
+static const int GridMaxBlocksPerCell = 64;
+
+// Worker threads that run the broadphase grid passes together with the
+// main thread; 0 keeps the physics on the main thread
+static const int PhysicsWorkerThreads = 2;
+
+// Whether blocks and the ground report contacts ahead of fast motion, so that
+// pushed and tossed blocks don't pass through each other or the fence
+static const bool UseSpeculativeContacts = true;
+
 // Button texture maps
 static const char* NextSetupButtonTextureName = "Forward.png";
 static const char* AboutButtonTextureName = "Info.png";
@@ -111,6 +148,9 @@ ToyBlocksController::ToyBlocksController()
       m_dispatcher(NULL),
       m_solver(NULL),
       m_dynamicsWorld(NULL),
+      m_threadSupport(NULL),
+      m_taskScheduler(NULL),
+      m_towerGlue(NULL),
       m_blockShape(NULL)
 {
     m_lastStepTime.tv_sec = 0;
@@ -139,6 +179,12 @@ ToyBlocksController::~ToyBlocksController()
     //TODO delete all physics engine resources
 
     DeleteBlocks();
+    delete m_towerGlue;
+
+    // stop the worker threads
+    btSetTaskScheduler(NULL);
+    delete m_taskScheduler;
+    delete m_threadSupport;
 }
 
 bool ToyBlocksController::NextPickingColor(PickingColor& color)
@@ -321,6 +367,12 @@ void ToyBlocksController::PickBlockBody(int x, int y)
         if ( motionState->GetPickingColor().Matches(red, green, blue) )
         {
             m_pickedBody = blockBody;
+
+            // A glued block must be freed from its tower to be pushed
+            if ( m_towerGlue != NULL )
+            {
+                m_towerGlue->RequestRelease(blockBody);
+            }
             break;
         }
     }
@@ -349,6 +401,12 @@ void ToyBlocksController::PinchGesture(float scaleFactor, float rotationAngle)
 
 void ToyBlocksController::DeleteBlocks()
 {
+    // Return the glued blocks to the world
+    if ( m_towerGlue != NULL )
+    {
+        m_towerGlue->RemoveAllBlocks();
+    }
+
     for ( unsigned int i = 0; i < m_blockRigidBodies.size(); i++ )
     {
         btRigidBody* body = m_blockRigidBodies[i];
@@ -575,16 +633,68 @@ bool ToyBlocksController::CreateToyBlock(float x, float y, float z)
     // Add the created body to the world
     m_dynamicsWorld->addRigidBody(blockRigidBody);
 
+    // The broadphase has a fixed number of proxies; a block without one
+    // would never collide
+    if ( blockRigidBody->getBroadphaseHandle() == NULL )
+    {
+        Debug("ToyBlocksController::CreateToyBlock(): broadphase is full!");
+        m_dynamicsWorld->removeRigidBody(blockRigidBody);
+        delete motionState;
+        delete blockRigidBody;
+        return false;
+    }
+
     // ..and to our internal list of bodies
     m_blockRigidBodies.push_back(blockRigidBody);
 
+    if ( m_towerGlue != NULL )
+    {
+        m_towerGlue->AddBlock(blockRigidBody);
+    }
+
     return true;
 }
 
 void ToyBlocksController::InitPhysics()
 {
     // create the engine resources
-    m_broadphase = new btDbvtBroadphase();
+    // all the blocks are the same size, so a uniform grid suits them better
+    // than a tree; the ground and fence planes become 'large' proxies
+    btVector3 gridMin(-GridCellSize * GridCellsXZ / 2, GroundY - 1.0,
+                      -GridCellSize * GridCellsXZ / 2);
+    btVector3 gridMax = gridMin + btVector3(GridCellSize * GridCellsXZ,
+                                            GridCellSize * GridCellsY,
+                                            GridCellSize * GridCellsXZ);
+    m_broadphase = new btParallel3DGridBroadphase(gridMin, gridMax,
+                                                  GridCellsXZ, GridCellsY,
+                                                  GridCellsXZ,
+                                                  GridMaxBlocks,
+                                                  GridMaxLargeObjects,
+                                                  GridMaxPairsPerBlock,
+                                                  GridMaxBlocksPerCell);
+
+    // the grid passes run through btParallelFor, which uses the installed
+    // task scheduler or else the calling thread
+    if ( PhysicsWorkerThreads > 0 )
+    {
+#if defined(_WIN32)
+        Win32ThreadSupport::Win32ThreadConstructionInfo threadConstructionInfo(
+                "ToyBlocksPhysics", processParallelForTask,
+                createParallelForLocalStoreMemory, PhysicsWorkerThreads);
+        m_threadSupport = new Win32ThreadSupport(threadConstructionInfo);
+#elif defined(USE_PTHREADS)
+        PosixThreadSupport::ThreadConstructionInfo threadConstructionInfo(
+                "ToyBlocksPhysics", processParallelForTask,
+                createParallelForLocalStoreMemory, PhysicsWorkerThreads);
+        m_threadSupport = new PosixThreadSupport(threadConstructionInfo);
+#endif
+        if ( m_threadSupport != NULL )
+        {
+            m_taskScheduler = new btThreadSupportTaskScheduler(m_threadSupport);
+            btSetTaskScheduler(m_taskScheduler);
+        }
+    }
+
     m_collisionConfiguration = new btDefaultCollisionConfiguration();
     m_dispatcher = new btCollisionDispatcher(m_collisionConfiguration);
     m_solver = new btSequentialImpulseConstraintSolver;
@@ -595,6 +705,14 @@ void ToyBlocksController::InitPhysics()
                                                   m_collisionConfiguration);
     m_dynamicsWorld->setGravity(btVector3(0, -9.81, 0));
 
+    if ( UseSpeculativeContacts )
+    {
+        // A block approaching the ground gets contacts for its whole face
+        // at once instead of a single corner
+        m_collisionConfiguration->setPlaneConvexMultipointIterations();
+        m_dynamicsWorld->getDispatchInfo().m_useSpeculativeContacts = true;
+    }
+
     // Create the ground static shapes and add them all to the world
     Ground::CreateShapes(m_groundRigidBodies);
     for ( unsigned int i = 0; i < m_groundRigidBodies.size(); i++ )
@@ -602,6 +720,11 @@ void ToyBlocksController::InitPhysics()
          m_dynamicsWorld->addRigidBody(m_groundRigidBodies[i]);
     }
 
+    if ( GlueRestingBlocks )
+    {
+        m_towerGlue = new TowerGlue(m_dynamicsWorld, MaxGluedTowers);
+    }
+
     // Create the initial blocks setup
     InitBlockSetup();
 }
@@ -818,6 +941,12 @@ void ToyBlocksController::StepPhysics()
     m_lastStepTime.tv_usec = now.tv_usec;
 
     m_dynamicsWorld->stepSimulation(seconds, 2);
+
+    // Glue resting towers and split hit ones
+    if ( m_towerGlue != NULL )
+    {
+        m_towerGlue->Update(seconds);
+    }
 }
 
 void ToyBlocksController::CopyPhysicsTransforms()